@@ -0,0 +1,159 @@
+"""Build-time stack report from GCC -fstack-usage output.
+
+Runs as a PlatformIO post script (see platformio.ini) after the firmware is
+linked, or standalone:
+
+    python scripts/stack_usage.py .pio/build/esp32
+
+For every task in src/TaskConfig.h it lists the static frame sizes of the
+functions that run on that task, and their sum as a rough lower bound of the
+stack the project's own code needs. GCC 8 cannot emit call graphs
+(-fcallgraph-info needs GCC 10), and library frames (Wire, GFX, printf) are
+not included, so the runtime StackMonitor report remains the source of truth
+for the final sizes.
+"""
+
+import os
+import re
+import sys
+
+# Functions run by each task, as Class::method without template arguments:
+# the views are templates (OLEDView is BasicOLEDView<OledPanel>), and GCC
+# writes their members as "void BasicOLEDView<P>::drawMenu() [with P = ...]"
+TASK_ENTRY_POINTS = {
+    "TASK_UI_STACK": [
+        "ExecutorTask::run",
+        "CoExecutor::runOnce",
+        "Controller::step",
+        "Controller::dispatchEvents",
+        "Controller::handleEvent",
+        "Controller::handleMenuState",
+        "View::step",
+    ],
+    "TASK_I2C_STACK": [
+        "BusWorker::run",
+        "ViewBase::renderJob",
+        "BasicOLEDView::beginFrame",
+        "BasicOLEDView::drawMenu",
+        "BasicLCDView::beginFrame",
+        "BasicLCDView::displayMenu",
+        "GlyphManager::place",
+    ],
+    "TASK_BOOT_STAGE_STACK": [
+        "BootSequencer::stageTask",
+        "BootSequencer::runStage",
+        "ViewBase::initialize",
+        "BasicOLEDView::initializeDisplay",
+        "BasicLCDView::initializeDisplay",
+        "Model::initialize",
+    ],
+}
+
+
+def function_key(name):
+    """Reduces a .su function name to Class::method.
+
+    "static bool ViewBase<D, G>::renderJob(void*) [with D = ...; G = ...]"
+    becomes "ViewBase::renderJob".
+    """
+    name = name.split(" [with ", 1)[0]
+    depth = 0
+    key = ""
+    for char in name:
+        if char == "<":
+            depth += 1
+        elif char == ">":
+            depth -= 1
+        elif depth == 0:
+            if char == "(":
+                break
+            key = "" if char == " " else key + char
+    return key
+
+
+def parse_su_line(line):
+    """Parses "file:line:col:function<TAB>bytes<TAB>kind"; returns None if malformed."""
+    fields = line.rstrip("\n").split("\t")
+    if len(fields) != 3 or not fields[1].isdigit():
+        return None
+    location = fields[0].split(":", 3)
+    if len(location) != 4:
+        return None
+    return location[3], int(fields[1]), fields[2], ":".join(location[:2])
+
+
+def read_config(project_dir):
+    """Returns {define: value} for the *_STACK defines in TaskConfig.h."""
+    sizes = {}
+    path = os.path.join(project_dir, "src", "TaskConfig.h")
+    if not os.path.exists(path):
+        return sizes
+    with open(path) as config:
+        for line in config:
+            match = re.match(r"#define\s+(TASK_\w+_STACK)\s+(\d+)", line)
+            if match:
+                sizes[match.group(1)] = int(match.group(2))
+    return sizes
+
+
+def read_frames(build_dir):
+    """Returns a list of (function, bytes, kind, location) from all .su files."""
+    frames = []
+    for root, _, files in os.walk(build_dir):
+        for name in files:
+            if not name.endswith(".su"):
+                continue
+            with open(os.path.join(root, name)) as su:
+                for line in su:
+                    frame = parse_su_line(line)
+                    if frame:
+                        frames.append(frame)
+    return frames
+
+
+def report(build_dir, project_dir):
+    frames = read_frames(os.path.join(build_dir, "src"))
+    if not frames:
+        print("stack_usage: no .su files under %s (is -fstack-usage set?)" % build_dir)
+        return
+
+    sizes = read_config(project_dir)
+    print("=== Static stack frames per task (bytes) ===")
+    for key, entry_points in TASK_ENTRY_POINTS.items():
+        total = 0
+        print("%s (configured %s)" % (key, sizes.get(key, "?")))
+        for entry in entry_points:
+            matches = [f for f in frames
+                       if function_key(f[0]) == entry or function_key(f[0]).endswith("::" + entry)]
+            if not matches:
+                print("  %-32s   (not found)" % entry)
+                continue
+            deepest = max(matches, key=lambda f: f[1])
+            total += deepest[1]
+            print("  %-32s %5d  %s" % (entry, deepest[1], deepest[2]))
+        print("  %-32s %5d" % ("sum of listed frames", total))
+
+    print("=== Largest frames ===")
+    for function, size, kind, location in sorted(frames, key=lambda f: -f[1])[:10]:
+        print("  %5d  %-8s %s  (%s)" % (size, kind, function, location))
+
+    dynamic = [f for f in frames if f[2] != "static"]
+    if dynamic:
+        print("=== Frames with dynamic size (alloca/VLA) ===")
+        for function, size, kind, location in dynamic:
+            print("  %5d  %-8s %s  (%s)" % (size, kind, function, location))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+
+    def _after_link(source, target, env):
+        report(env.subst("$BUILD_DIR"), env.subst("$PROJECT_DIR"))
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", _after_link)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        if len(sys.argv) != 2:
+            print("usage: stack_usage.py <build dir>")
+            sys.exit(1)
+        report(sys.argv[1], os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
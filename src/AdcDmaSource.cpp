@@ -0,0 +1,142 @@
+#include "AdcDmaSource.h"
+#include <driver/adc.h>
+
+// Default reference when the eFuse holds no Vref calibration
+static const uint32_t DEFAULT_VREF_MV = 1100;
+
+/**
+ * @brief Constructor - conversions start in begin()
+ */
+AdcDmaSource::AdcDmaSource() : m_running(false), m_overruns(0) {
+  memset(&m_characteristics, 0, sizeof(m_characteristics));
+}
+
+/**
+ * @brief Destructor - Releases the ADC controller and its DMA buffer
+ */
+AdcDmaSource::~AdcDmaSource() {
+  end();
+}
+
+/**
+ * @brief Configures the ADC1 pattern and starts continuous conversion
+ * @param channels ADC1 channel numbers (0..7)
+ * @param channelCount Number of channels in the pattern
+ * @param sampleRateHz Total conversion rate, shared by all channels
+ * @return true if the driver started, false otherwise
+ */
+bool AdcDmaSource::begin(const uint8_t* channels, uint8_t channelCount, uint32_t sampleRateHz) {
+  if (m_running) {
+    end();
+  }
+
+  if (channelCount == 0 || channelCount > MAX_CHANNELS ||
+      sampleRateHz < MIN_SAMPLE_RATE_HZ || sampleRateHz > MAX_SAMPLE_RATE_HZ) {
+    Serial.println("Invalid ADC DMA configuration");
+    return false;
+  }
+
+  uint32_t channelMask = 0;
+  adc_digi_pattern_config_t pattern[MAX_CHANNELS];
+  memset(pattern, 0, sizeof(pattern));
+  for (uint8_t i = 0; i < channelCount; i++) {
+    if (channels[i] >= ADC1_CHANNEL_MAX) {
+      Serial.println("Invalid ADC1 channel");
+      return false;
+    }
+    channelMask |= 1u << channels[i];
+    pattern[i].atten = ADC_ATTEN_DB_11;
+    pattern[i].channel = channels[i];
+    pattern[i].unit = 0;   // ADC1
+    pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+  }
+
+  adc_digi_init_config_t initConfig;
+  memset(&initConfig, 0, sizeof(initConfig));
+  initConfig.max_store_buf_size = DMA_BUFFER_BYTES;
+  initConfig.conv_num_each_intr = DMA_FRAME_BYTES;
+  initConfig.adc1_chan_mask = channelMask;
+  initConfig.adc2_chan_mask = 0;
+  if (adc_digi_initialize(&initConfig) != ESP_OK) {
+    Serial.println("ADC DMA initialization failed");
+    return false;
+  }
+
+  adc_digi_configuration_t config;
+  memset(&config, 0, sizeof(config));
+  config.conv_limit_en = 1;       // Required on ESP32
+  config.conv_limit_num = 250;
+  config.pattern_num = channelCount;
+  config.adc_pattern = pattern;
+  config.sample_freq_hz = sampleRateHz;
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+    Serial.println("ADC DMA start failed");
+    adc_digi_deinitialize();
+    return false;
+  }
+
+  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                           DEFAULT_VREF_MV, &m_characteristics);
+  m_running = true;
+  return true;
+}
+
+/**
+ * @brief Stops conversions and frees the driver
+ */
+void AdcDmaSource::end() {
+  if (m_running) {
+    adc_digi_stop();
+    adc_digi_deinitialize();
+    m_running = false;
+  }
+}
+
+/**
+ * @brief Drains converted samples from the DMA ring buffer without blocking
+ * @param out Destination
+ * @param maxSamples Capacity of the destination
+ * @return Number of samples copied
+ */
+size_t AdcDmaSource::read(SensorSample* out, size_t maxSamples) {
+  if (!m_running) return 0;
+
+  size_t count = 0;
+  while (count < maxSamples) {
+    uint32_t wanted = (maxSamples - count) * SOC_ADC_DIGI_RESULT_BYTES;
+    if (wanted > sizeof(m_frame)) wanted = sizeof(m_frame);
+
+    uint32_t length = 0;
+    esp_err_t result = adc_digi_read_bytes(m_frame, wanted, &length, 0);
+    if (result == ESP_ERR_INVALID_STATE) {
+      // The ring buffer filled up and the driver discarded a frame; the data read is valid
+      m_overruns++;
+    } else if (result != ESP_OK) {
+      break;   // ESP_ERR_TIMEOUT: nothing pending
+    }
+
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+      const adc_digi_output_data_t* data = reinterpret_cast<const adc_digi_output_data_t*>(&m_frame[i]);
+      out[count].channel = data->type1.channel;
+      out[count].raw = data->type1.data;
+      count++;
+    }
+
+    if (length < wanted) break;
+  }
+  return count;
+}
+
+/**
+ * @brief Linear fit from the eFuse characterization (raw 0..4095 to mV)
+ * @param channel Unused: all ADC1 channels share one characterization
+ * @return Calibration for the pipeline
+ */
+SensorCalibration AdcDmaSource::defaultCalibration(uint8_t channel) const {
+  (void)channel;
+  // esp_adc_cal_raw_to_voltage() computes (coeff_a * raw + 32768) / 65536 + coeff_b
+  return SensorCalibration(static_cast<int32_t>(m_characteristics.coeff_a),
+                           static_cast<int32_t>(m_characteristics.coeff_b));
+}
@@ -0,0 +1,45 @@
+#ifndef ADC_DMA_SOURCE_H
+#define ADC_DMA_SOURCE_H
+
+#include <Arduino.h>
+#include <esp_adc_cal.h>
+#include "SensorSource.h"
+
+/**
+ * ADC1 in continuous (DMA) mode.
+ *
+ * The digital controller walks the channel pattern on its own and DMA moves
+ * the results into the driver's ring buffer one frame at a time, so the CPU
+ * only sees a frame interrupt every DMA_FRAME_BYTES / 2 conversions and the
+ * consumer drains the buffer whenever it likes. ESP32 continuous mode supports
+ * ADC1 only (ADC2 is shared with Wi-Fi) and at least 20 kHz in total.
+ */
+class AdcDmaSource : public SensorSource {
+public:
+  static const uint32_t MIN_SAMPLE_RATE_HZ = 20000;
+  static const uint32_t MAX_SAMPLE_RATE_HZ = 2000000;
+  static const uint8_t MAX_CHANNELS = 8;
+  static const uint32_t DMA_FRAME_BYTES = 1024;     // Conversions per frame interrupt x 2
+  static const uint32_t DMA_BUFFER_BYTES = 8192;    // Driver ring buffer: ~200 ms at 20 kHz
+
+  AdcDmaSource();
+  ~AdcDmaSource() override;
+
+  bool begin(const uint8_t* channels, uint8_t channelCount, uint32_t sampleRateHz) override;
+  void end() override;
+  size_t read(SensorSample* out, size_t maxSamples) override;
+
+  size_t getBufferCapacity() const override { return DMA_BUFFER_BYTES / 2; }
+  uint32_t getOverrunCount() const override { return m_overruns; }
+
+  // eFuse-based characterization for the 11 dB range, in millivolts
+  SensorCalibration defaultCalibration(uint8_t channel) const override;
+
+private:
+  bool m_running;
+  uint32_t m_overruns;
+  esp_adc_cal_characteristics_t m_characteristics;
+  uint8_t m_frame[DMA_FRAME_BYTES];
+};
+
+#endif // ADC_DMA_SOURCE_H
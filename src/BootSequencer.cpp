@@ -0,0 +1,249 @@
+#include "BootSequencer.h"
+#include <esp_timer.h>
+#include "Synchronization.h"
+#include "StackMonitor.h"
+
+// Initialize static instance pointer to nullptr
+BootTimeline* BootTimeline::m_instance = nullptr;
+
+BootTimeline::BootTimeline()
+  : m_entryCount(0), m_setupUs(0), m_firstFrameUs(0), m_framesExpected(0) {
+  m_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+BootTimeline* BootTimeline::getInstance() {
+  if (m_instance == nullptr) {
+    m_instance = new BootTimeline();
+  }
+  return m_instance;
+}
+
+/**
+ * @brief Starts a new timeline at entry into setup()
+ */
+void BootTimeline::begin() {
+  m_entryCount = 0;
+  m_firstFrameUs = 0;
+  m_setupUs = esp_timer_get_time();
+}
+
+/**
+ * @brief Records the start of a boot stage
+ * @param name Stage name (must outlive the timeline)
+ * @return Entry index for stageFinished(), or -1 if the timeline is full
+ */
+int BootTimeline::stageStarted(const char* name) {
+  int entry = -1;
+  portENTER_CRITICAL(&m_lock);
+  if (m_entryCount < MAX_ENTRIES) {
+    entry = m_entryCount++;
+    m_entries[entry].name = name;
+    m_entries[entry].startUs = esp_timer_get_time();
+    m_entries[entry].endUs = 0;
+    m_entries[entry].core = xPortGetCoreID();
+    m_entries[entry].ok = false;
+  }
+  portEXIT_CRITICAL(&m_lock);
+  return entry;
+}
+
+/**
+ * @brief Records the end of a boot stage
+ * @param entry Index returned by stageStarted()
+ * @param ok Whether the stage succeeded
+ */
+void BootTimeline::stageFinished(int entry, bool ok) {
+  if (entry < 0) return;
+  m_entries[entry].endUs = esp_timer_get_time();
+  m_entries[entry].ok = ok;
+}
+
+void BootTimeline::expectFrames(int count) {
+  m_framesExpected = count;
+}
+
+/**
+ * @brief Records a view's first rendered frame
+ * @param viewName Name of the view (must outlive the timeline)
+ */
+void BootTimeline::markFirstFrame(const char* viewName) {
+  int entry = stageStarted(viewName);
+  if (entry >= 0) {
+    m_entries[entry].startUs = m_entries[entry].endUs = esp_timer_get_time();
+    m_entries[entry].ok = true;
+  }
+
+  bool last = false;
+  portENTER_CRITICAL(&m_lock);
+  if (m_firstFrameUs == 0 && entry >= 0) {
+    m_firstFrameUs = m_entries[entry].endUs;
+  }
+  if (m_framesExpected > 0 && --m_framesExpected == 0) {
+    last = true;
+  }
+  portEXIT_CRITICAL(&m_lock);
+
+  if (last) {
+    printReport();
+  }
+}
+
+/**
+ * @brief Prints the boot timeline over serial
+ */
+void BootTimeline::printReport() {
+  Synchronization* sync = Synchronization::getInstance();
+
+  sync->safePrintf("=== Boot timeline (ms since reset) ===\n");
+  sync->safePrintf("  %-14s %8.1f\n", "setup()", m_setupUs / 1000.0);
+  for (int i = 0; i < m_entryCount; i++) {
+    const Entry& e = m_entries[i];
+    if (e.startUs == e.endUs) {
+      sync->safePrintf("  %-14s %8.1f  first frame\n", e.name, e.endUs / 1000.0);
+    } else {
+      sync->safePrintf("  %-14s %8.1f -> %8.1f  (%6.1f ms, core %d)%s\n",
+                       e.name, e.startUs / 1000.0, e.endUs / 1000.0,
+                       (e.endUs - e.startUs) / 1000.0, e.core, e.ok ? "" : " FAILED");
+    }
+  }
+  sync->safePrintf("Time to first frame: %.1f ms (%.1f ms after setup)\n",
+                   m_firstFrameUs / 1000.0, (m_firstFrameUs - m_setupUs) / 1000.0);
+}
+
+BootSequencer::BootSequencer() : m_stageCount(0), m_doneGroup(nullptr) {
+}
+
+BootSequencer::~BootSequencer() {
+  if (m_doneGroup != nullptr) {
+    vEventGroupDelete(m_doneGroup);
+  }
+}
+
+/**
+ * @brief Adds a boot stage
+ * @param name Stage name, also used as the worker task name
+ * @param function Stage entry point
+ * @param context Argument passed to the entry point
+ * @param dependsOn BOOT_DEP() mask of stages that must complete first
+ * @param required Whether a failure aborts the boot
+ * @return Stage id, or -1 if the stage table is full
+ */
+int BootSequencer::addStage(const char* name, BootStageFunction function, void* context,
+                            uint32_t dependsOn, bool required) {
+  if (m_stageCount >= MAX_STAGES || function == nullptr) {
+    return -1;
+  }
+
+  Stage& stage = m_stages[m_stageCount];
+  stage.name = name;
+  stage.function = function;
+  stage.context = context;
+  stage.dependsOn = dependsOn;
+  stage.required = required;
+  stage.ok = false;
+  stage.id = m_stageCount;
+  stage.owner = this;
+  return m_stageCount++;
+}
+
+/**
+ * @brief Runs the stage graph, starting stages as soon as their dependencies complete
+ * @param timeout Maximum time for the whole graph
+ * @return true if every required stage succeeded
+ */
+bool BootSequencer::run(TickType_t timeout) {
+  if (m_doneGroup == nullptr) {
+    m_doneGroup = xEventGroupCreate();
+    if (m_doneGroup == nullptr) return false;
+  }
+
+  const uint32_t allStages = (1UL << m_stageCount) - 1;
+  uint32_t started = 0;
+  uint32_t finished = 0;
+  uint32_t failed = 0;
+  TickType_t deadline = xTaskGetTickCount() + timeout;
+
+  while (finished != allStages) {
+    // Launch every stage whose dependencies are satisfied
+    for (int i = 0; i < m_stageCount; i++) {
+      uint32_t bit = BOOT_DEP(i);
+      Stage& stage = m_stages[i];
+      if (started & bit) continue;
+
+      if (stage.dependsOn & failed) {
+        // A dependency failed; skip this stage
+        started |= bit;
+        finished |= bit;
+        failed |= bit;
+        Serial.printf("Boot stage %s skipped\n", stage.name);
+        continue;
+      }
+
+      if ((stage.dependsOn & finished) == stage.dependsOn) {
+        started |= bit;
+        if (xTaskCreate(stageTask, stage.name, STAGE_STACK_SIZE, &stage, STAGE_PRIORITY, nullptr) != pdPASS) {
+          // Fall back to running inline
+          runStage(&stage);
+        }
+      }
+    }
+
+    if (finished == allStages) break;
+
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(deadline - now) <= 0) {
+      Serial.println("Boot sequence timeout");
+      return false;
+    }
+
+    // Event group bits are limited to 24, which MAX_STAGES stays below
+    EventBits_t bits = xEventGroupWaitBits(m_doneGroup, allStages & ~finished,
+                                           pdTRUE, pdFALSE, deadline - now);
+    for (int i = 0; i < m_stageCount; i++) {
+      uint32_t bit = BOOT_DEP(i);
+      if ((bits & bit) && !(finished & bit)) {
+        finished |= bit;
+        if (!m_stages[i].ok) failed |= bit;
+      }
+    }
+  }
+
+  bool ok = true;
+  for (int i = 0; i < m_stageCount; i++) {
+    if (m_stages[i].required && (failed & BOOT_DEP(i))) {
+      Serial.printf("Required boot stage %s failed\n", m_stages[i].name);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+bool BootSequencer::stageSucceeded(int stageId) const {
+  return stageId >= 0 && stageId < m_stageCount && m_stages[stageId].ok;
+}
+
+/**
+ * @brief Worker task for one boot stage
+ * @param pvParameters Pointer to the Stage
+ */
+void BootSequencer::stageTask(void* pvParameters) {
+  runStage(static_cast<Stage*>(pvParameters));
+  
+  // The task is gone before any periodic sample could see it
+  StackMonitor::getInstance()->sampleCurrentTask("TASK_BOOT_STAGE_STACK");
+  vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Runs a stage, records it on the timeline and signals completion
+ * @param stage Stage to run
+ */
+void BootSequencer::runStage(Stage* stage) {
+  BootTimeline* timeline = BootTimeline::getInstance();
+
+  int entry = timeline->stageStarted(stage->name);
+  stage->ok = stage->function(stage->context);
+  timeline->stageFinished(entry, stage->ok);
+
+  xEventGroupSetBits(stage->owner->m_doneGroup, BOOT_DEP(stage->id));
+}
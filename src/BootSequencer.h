@@ -0,0 +1,111 @@
+#ifndef BOOT_SEQUENCER_H
+#define BOOT_SEQUENCER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include "TaskConfig.h"
+
+// Dependency mask helper for BootSequencer::addStage()
+#define BOOT_DEP(stageId) (1UL << (stageId))
+
+// Boot stage entry point, returns false on failure
+typedef bool (*BootStageFunction)(void* context);
+
+/**
+ * Records a per-stage boot timeline and the time to first frame.
+ * Timestamps are microseconds since reset, so ROM and bootloader time is
+ * included in the first-frame figure.
+ */
+class BootTimeline {
+private:
+  static BootTimeline* m_instance;
+
+  static const int MAX_ENTRIES = 16;
+
+  struct Entry {
+    const char* name;
+    int64_t startUs;
+    int64_t endUs;
+    int8_t core;
+    bool ok;
+  };
+
+  Entry m_entries[MAX_ENTRIES];
+  volatile int m_entryCount;
+  int64_t m_setupUs;
+  int64_t m_firstFrameUs;
+  volatile int m_framesExpected;
+  portMUX_TYPE m_lock;
+
+  BootTimeline();
+
+public:
+  static BootTimeline* getInstance();
+
+  // Marks entry into setup(); starts a new timeline
+  void begin();
+
+  // Stage bookkeeping (thread-safe)
+  int stageStarted(const char* name);
+  void stageFinished(int entry, bool ok);
+
+  // Number of views whose first frame completes the boot
+  void expectFrames(int count);
+
+  // Called by each view after its first render; prints the report after the last one
+  void markFirstFrame(const char* viewName);
+
+  int64_t getTimeToFirstFrameUs() const { return m_firstFrameUs; }
+  void printReport();
+};
+
+/**
+ * Dependency-graph boot orchestrator.
+ *
+ * Stages declare the stages they depend on. Every stage whose dependencies
+ * have completed is started on its own short-lived task, so independent
+ * devices are brought up concurrently (the I2C driver serializes bus access,
+ * so one device's settle delays overlap another's transfers).
+ */
+class BootSequencer {
+public:
+  static const int MAX_STAGES = 12;
+
+  BootSequencer();
+  ~BootSequencer();
+
+  // Adds a stage; returns its id for use with BOOT_DEP(), or -1 if full
+  int addStage(const char* name, BootStageFunction function, void* context = nullptr,
+               uint32_t dependsOn = 0, bool required = true);
+
+  // Runs all stages; returns false if a required stage failed or timed out
+  bool run(TickType_t timeout);
+
+  bool stageSucceeded(int stageId) const;
+
+private:
+  static const uint32_t STAGE_STACK_SIZE = TASK_BOOT_STAGE_STACK;
+  static const UBaseType_t STAGE_PRIORITY = TASK_BOOT_STAGE_PRIORITY;
+
+  struct Stage {
+    const char* name;
+    BootStageFunction function;
+    void* context;
+    uint32_t dependsOn;
+    bool required;
+    volatile bool ok;
+    int id;
+    BootSequencer* owner;
+  };
+
+  Stage m_stages[MAX_STAGES];
+  int m_stageCount;
+  EventGroupHandle_t m_doneGroup;
+
+  static void stageTask(void* pvParameters);
+  static void runStage(Stage* stage);
+};
+
+#endif // BOOT_SEQUENCER_H
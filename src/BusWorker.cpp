@@ -0,0 +1,92 @@
+#include "BusWorker.h"
+#include "Trace.h"
+
+BusWorker::BusWorker(const char* name, uint32_t stackSize, UBaseType_t priority)
+  : m_name(name), m_stackSize(stackSize), m_priority(priority),
+    m_taskHandle(nullptr), m_queue(nullptr), m_jobs(0), m_traceTrack(0) {
+}
+
+BusWorker::~BusWorker() {
+  stop();
+}
+
+/**
+ * @brief Creates the job queue and the worker task
+ * @return true if the worker is running
+ */
+bool BusWorker::start() {
+  if (m_taskHandle != nullptr) {
+    Serial.print(m_name);
+    Serial.println(" worker already running");
+    return false;
+  }
+
+  if (m_queue == nullptr) {
+    m_queue = xQueueCreate(QUEUE_LENGTH, sizeof(Job));
+    if (m_queue == nullptr) {
+      Serial.println("Failed to create bus job queue");
+      return false;
+    }
+  }
+
+  m_traceTrack = TRACE_REGISTER_TRACK(TRACE_ID_TASK, m_name);
+  BaseType_t result = xTaskCreate(taskWrapper, m_name, m_stackSize, this, m_priority, &m_taskHandle);
+  return result == pdPASS;
+}
+
+void BusWorker::setPriority(UBaseType_t priority) {
+  m_priority = priority;
+  if (m_taskHandle != nullptr) {
+    vTaskPrioritySet(m_taskHandle, priority);
+  }
+}
+
+void BusWorker::stop() {
+  if (m_taskHandle != nullptr) {
+    vTaskDelete(m_taskHandle);
+    m_taskHandle = nullptr;
+  }
+  if (m_queue != nullptr) {
+    vQueueDelete(m_queue);
+    m_queue = nullptr;
+  }
+}
+
+/**
+ * @brief Queues a bus job
+ * @param function Job to run on the worker task
+ * @param context Argument passed to the job
+ * @param done Signal set once the job has run (may be nullptr)
+ * @param result Receives the job's return value (may be nullptr)
+ * @return true if queued, false if the queue is full or the worker is stopped
+ */
+bool BusWorker::submit(BusJobFunction function, void* context, CoSignal* done, volatile bool* result) {
+  if (m_queue == nullptr || function == nullptr) return false;
+
+  Job job = { function, context, done, result };
+  return xQueueSend(m_queue, &job, 0) == pdTRUE;
+}
+
+/**
+ * @brief FreeRTOS task wrapper function
+ * @param pvParameters Pointer to the BusWorker instance
+ */
+void BusWorker::taskWrapper(void* pvParameters) {
+  BusWorker* worker = static_cast<BusWorker*>(pvParameters);
+  worker->run();
+}
+
+void BusWorker::run() {
+  Job job;
+  while (true) {
+    if (xQueueReceive(m_queue, &job, portMAX_DELAY) == pdTRUE) {
+      TRACE_BEGIN(TRACE_ID_TASK, m_traceTrack);
+      bool ok = job.function(job.context);
+      TRACE_END(TRACE_ID_TASK, m_traceTrack);
+      m_jobs++;
+
+      if (job.result != nullptr) *job.result = ok;
+      if (job.done != nullptr) job.done->set();
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef BUS_WORKER_H
+#define BUS_WORKER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "Coroutine.h"
+
+// Blocking bus operation run on the worker; returns false on failure
+typedef bool (*BusJobFunction)(void* context);
+
+/**
+ * Runs blocking I2C work (display flushes, RTC reads) on a dedicated task so
+ * coroutines can await its completion instead of stalling their executor.
+ * Jobs run in submission order, which also serializes bus access.
+ *
+ *   m_done.reset();
+ *   bus.submit(job, this, &m_done, &m_ok);
+ *   CO_AWAIT(m_done.poll(this));
+ */
+class BusWorker {
+public:
+  static const int QUEUE_LENGTH = 8;
+
+  BusWorker(const char* name, uint32_t stackSize, UBaseType_t priority);
+  ~BusWorker();
+
+  bool start();
+  void stop();
+
+  // Takes effect at once if running, else at start()
+  void setPriority(UBaseType_t priority);
+
+  // Queues a job; done is set (and *result written) when it has run
+  bool submit(BusJobFunction function, void* context, CoSignal* done, volatile bool* result = nullptr);
+
+  TaskHandle_t getTaskHandle() const { return m_taskHandle; }
+  uint32_t getJobCount() const { return m_jobs; }
+
+private:
+  struct Job {
+    BusJobFunction function;
+    void* context;
+    CoSignal* done;
+    volatile bool* result;
+  };
+
+  const char* m_name;
+  uint32_t m_stackSize;
+  UBaseType_t m_priority;
+  TaskHandle_t m_taskHandle;
+  QueueHandle_t m_queue;
+  volatile uint32_t m_jobs;
+  uint16_t m_traceTrack;
+
+  static void taskWrapper(void* pvParameters);
+  void run();
+};
+
+#endif // BUS_WORKER_H
@@ -1,19 +1,31 @@
 #include "Controller.h"
-#include "RTClib.h"  
+#include "SleepManager.h"
+#include "PowerManager.h"
+#include "Trace.h"
+#include "FlightRecorder.h"
+#include "TaskConfig.h"
+#include "Tunables.h"
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <esp_sleep.h>
+
+CoSignal* Controller::s_wakeSignal = nullptr;
 
-extern RTC_DS1307 rtc;
 /**
  * @brief Constructor - Initializes controller with model reference
  */
-Controller::Controller() : m_model(nullptr), m_taskHandle(nullptr) {
+Controller::Controller()
+  : m_debounceMs(INPUT_DEBOUNCE_MS), m_model(nullptr), m_running(false),
+    m_eventHead(nullptr), m_eventTail(nullptr), m_eventsDropped(0),
+    m_observer(nullptr), m_observerContext(nullptr), m_pollIntervalMs(INPUT_POLL_MS) {
   m_model = Model::getInstance();
 }
 
 /**
- * @brief Destructor - Ensures proper task cleanup
+ * @brief Destructor - Ensures the button interrupts are masked
  */
 Controller::~Controller() {
-  stop(); // Safely stop FreeRTOS task
+  stop();
 }
 
 /**
@@ -28,6 +40,7 @@ bool Controller::initialize() {
   }
   
   initializeButtons();
+  initializeEncoder();
   // Hardware button setup
   Serial.println("Controller initialized");
   return true;
@@ -47,69 +60,268 @@ void Controller::initializeButtons() {
   m_buttons[5] = {BTN_SELECT2_PIN, HIGH, 0, false}; // Secondary select
   
   // Configure all button pins as INPUT_PULLUP
-  for (int i = 0; i < 6; i++) {
+  for (int i = 0; i < BUTTON_COUNT; i++) {
     pinMode(m_buttons[i].pin, INPUT_PULLUP);
   }
+  
+  // Low-level interrupts double as GPIO wake sources for automatic light
+  // sleep, which only supports level triggers; the ISR masks them until the
+  // buttons settle again.
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    gpio_num_t pin = static_cast<gpio_num_t>(m_buttons[i].pin);
+    attachInterruptArg(m_buttons[i].pin, buttonIsr, reinterpret_cast<void*>(static_cast<intptr_t>(pin)), ONLOW);
+    gpio_intr_disable(pin);
+    gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+  }
+  esp_sleep_enable_gpio_wakeup();
+}
+
+/**
+ * @brief Starts the PCNT encoder and its wake interrupts
+ * Light sleep stops the counter clock, so both inputs wake the CPU like the
+ * buttons do; the step lost to the wake-up is rounded off at the next detent.
+ */
+void Controller::initializeEncoder() {
+  if (!m_encoder.begin()) {
+    Serial.println("Rotary encoder unavailable");
+    return;
+  }
+  
+  const int pins[2] = {RotaryEncoder::PIN_A, RotaryEncoder::PIN_B};
+  for (int i = 0; i < 2; i++) {
+    gpio_num_t pin = static_cast<gpio_num_t>(pins[i]);
+    attachInterruptArg(pins[i], buttonIsr, reinterpret_cast<void*>(static_cast<intptr_t>(pin)), ONLOW);
+    gpio_intr_disable(pin);
+    gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+  }
+}
+
+/**
+ * @brief Maps a button index to its GPIO
+ * @param buttonIndex One of ButtonIndex
+ * @return GPIO number, or -1 for an invalid index
+ */
+int Controller::getButtonPin(int buttonIndex) {
+  static const int pins[BUTTON_COUNT] = {
+    BTN_UP_PIN, BTN_DOWN_PIN, BTN_LEFT_PIN, BTN_RIGHT_PIN, BTN_SELECT1_PIN, BTN_SELECT2_PIN
+  };
+  return (buttonIndex >= 0 && buttonIndex < BUTTON_COUNT) ? pins[buttonIndex] : -1;
 }
 
 /**
- * @brief Starts the controller task
- * @return true if task started successfully, false otherwise
+ * @brief Starts the button coroutine
+ * @param executor Executor to run it on
+ * @return true if started, false if already running
  */
-bool Controller::start() {
-  if (m_taskHandle != nullptr) {
-    Serial.println("Controller task already running");
+bool Controller::start(ExecutorTask& executor) {
+  if (m_running) {
+    Serial.println("Controller already running");
     return false;
   }
   
-  // Create FreeRTOS task for button handling
-  BaseType_t result = xTaskCreate(
-    taskWrapper,
-    "ButtonTask",
-    2048, // Stack size
-    this, // Task parameter
-    2,    // Priority (higher than display tasks)
-    &m_taskHandle
-  );
+  // Watchers are registered from setup(), not from the concurrent boot stages
+  Tunables::getInstance()->watch(TUNE_DEBOUNCE_MS, applyDebounce, this);
+  Tunables::getInstance()->watch(TUNE_POLL_MS, applyPollInterval, this);
   
-  return result == pdPASS;
-  // pdPASS indicates success
+  m_running = true;
+  s_wakeSignal = &m_wakeSignal;
+  executor.spawn(*this);
+  armButtonInterrupts();
+  return true;
 }
 
 /**
- * @brief Stops the controller task
+ * @brief Stops the button coroutine and masks the button interrupts
  */
 void Controller::stop() {
-  if (m_taskHandle != nullptr) {
-    vTaskDelete(m_taskHandle);
-    m_taskHandle = nullptr;
+  if (m_running) {
+    m_running = false;
+    s_wakeSignal = nullptr;
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+      gpio_intr_disable(static_cast<gpio_num_t>(m_buttons[i].pin));
+    }
+    if (m_encoder.isRunning()) {
+      gpio_intr_disable(static_cast<gpio_num_t>(RotaryEncoder::PIN_A));
+      gpio_intr_disable(static_cast<gpio_num_t>(RotaryEncoder::PIN_B));
+    }
   }
 }
 
 /**
- * @brief FreeRTOS task wrapper function
- * @param pvParameters Pointer to the Controller instance
+ * @brief Button edge interrupt; wakes the button coroutine
+ * @param arg GPIO number of the button
  */
-void Controller::taskWrapper(void* pvParameters) {
-  Controller* controller = static_cast<Controller*>(pvParameters);
-  controller->buttonTask();
+void IRAM_ATTR Controller::buttonIsr(void* arg) {
+  // Level interrupt: mask it until the coroutine has debounced the press
+  gpio_ll_intr_disable(&GPIO, static_cast<gpio_num_t>(reinterpret_cast<intptr_t>(arg)));
+  PowerManager::markButtonEdgeFromISR();
+  TRACE_INSTANT(TRACE_ID_BUTTON, static_cast<uint16_t>(reinterpret_cast<intptr_t>(arg)));
+  
+  CoSignal* signal = s_wakeSignal;
+  if (signal != nullptr) {
+    signal->setFromISR();
+  }
+}
+
+// Tunable watchers; run on the UI executor like the button coroutine
+void Controller::applyDebounce(void* context, int32_t value) {
+  static_cast<Controller*>(context)->m_debounceMs = static_cast<uint32_t>(value);
+}
+
+void Controller::applyPollInterval(void* context, int32_t value) {
+  static_cast<Controller*>(context)->m_pollIntervalMs = static_cast<uint32_t>(value);
 }
 
 /**
- * @brief Main button task function
- * Continuously polls buttons and handles events
+ * @brief Button loop coroutine
+ * Polls buttons and the encoder while any is active, otherwise waits for an edge
  */
-void Controller::buttonTask() {
-  Serial.println("Button task started");
+void Controller::step() {
+  CO_BEGIN();
+  Serial.println("Button coroutine started");
   
-  while (true) {
-    SystemEvent event = readButtons();
+  while (m_running) {
+    {
+      SystemEvent event = readButtons();
+      if (event != EVENT_NONE) {
+        postEvent(event, EVENT_SOURCE_BUTTON);
+      }
+      
+      // All steps since the last scan become one move (at most COUNTER_LIMIT / 8 detents)
+      int detents = m_encoder.readDetents();
+      if (detents != 0) {
+        postEvent(EVENT_SCROLL, EVENT_SOURCE_ENCODER, static_cast<int16_t>(detents));
+      }
+    }
+    dispatchEvents();
+    dispatchModelEvents();
     
-    if (event != EVENT_NONE) {
-      handleEvent(event);
+    PowerManager::getInstance()->poll();
+    
+    if (buttonsSettled()) {
+      // Nothing to debounce: wait so the idle task can enter light sleep
+      armButtonInterrupts();
+      CO_AWAIT_TIMEOUT(m_wakeSignal.poll(this) || m_model->hasPendingEvents(),
+                       PowerManager::getInstance()->isBoosted() ? ACTIVE_WAIT_MS : CO_FOREVER);
+      if (!coTimedOut()) {
+        PowerManager::getInstance()->noteWake();
+        PowerManager::getInstance()->noteActivity();
+      }
+    } else {
+      CO_DELAY(m_pollIntervalMs);
     }
+  }
+  
+  CO_END();
+}
+
+/**
+ * @brief Handles the events raised by the Model scheduler
+ * Polling also registers this coroutine to be woken by the next event.
+ */
+void Controller::dispatchModelEvents() {
+  ModelEvent event;
+  while (m_model->pollEvent(event, this)) {
+    if (event.type == MODEL_EVENT_TASK_DUE) {
+      // The task may have been deleted since the reminder was set
+      Task task;
+      if (m_model->getTaskManager().getTask(event.id, task)) {
+        Serial.print("Reminder: ");
+        Serial.println(task.title);
+        PowerManager::getInstance()->noteActivity();
+      }
+    }
+  }
+}
+
+/**
+ * @brief Queues an input event for the button coroutine
+ * @param event Event to handle
+ * @param source EventSource of the producer
+ * @param delta Detents for EVENT_SCROLL (positive moves down)
+ * @return false if the event pool is exhausted (the event is dropped)
+ */
+bool Controller::postEvent(SystemEvent event, uint8_t source, int16_t delta) {
+  InputEvent* item = m_eventPool.create(event, source, static_cast<uint32_t>(micros()), delta);
+  if (item == nullptr) {
+    m_eventsDropped++;
+    return false;
+  }
+  TRACE_INSTANT(TRACE_ID_INPUT, static_cast<uint16_t>(event | source << 8));
+  if (source != EVENT_SOURCE_LOAD) {
+    FlightRecorder::record(FLIGHT_INPUT, event, source);
+  }
+  
+  m_queueLock.lock();
+  if (m_eventTail != nullptr) {
+    m_eventTail->next = item;
+  } else {
+    m_eventHead = item;
+  }
+  m_eventTail = item;
+  m_queueLock.unlock();
+  
+  if (xPortInIsrContext()) {
+    m_wakeSignal.setFromISR();
+  } else {
+    m_wakeSignal.set();
+  }
+  return true;
+}
+
+/**
+ * @brief Handles every queued event in arrival order and returns them to the pool
+ */
+void Controller::dispatchEvents() {
+  while (true) {
+    m_queueLock.lock();
+    InputEvent* item = m_eventHead;
+    if (item != nullptr) {
+      m_eventHead = item->next;
+      if (m_eventHead == nullptr) m_eventTail = nullptr;
+    }
+    m_queueLock.unlock();
+    
+    if (item == nullptr) break;
     
-    vTaskDelay(pdMS_TO_TICKS(10)); // 10ms polling rate
+    handleEvent(item->event, item->delta);
+    if (m_observer != nullptr) {
+      m_observer(m_observerContext, *item);
+    }
+    m_eventPool.destroy(item);
+  }
+}
+
+/**
+ * @brief Checks whether all buttons are released and debounced
+ * @return true if no button (and not the encoder) needs further polling
+ */
+bool Controller::buttonsSettled() {
+  unsigned long currentTime = millis();
+  
+  if (!m_encoder.isAtRest()) {
+    return false;
+  }
+  
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    if (m_buttons[i].pressed || m_buttons[i].lastState == LOW ||
+        (currentTime - m_buttons[i].lastDebounceTime) <= m_debounceMs) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Re-enables the button interrupts masked by the ISR
+ */
+void Controller::armButtonInterrupts() {
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    gpio_intr_enable(static_cast<gpio_num_t>(m_buttons[i].pin));
+  }
+  if (m_encoder.isRunning()) {
+    gpio_intr_enable(static_cast<gpio_num_t>(RotaryEncoder::PIN_A));
+    gpio_intr_enable(static_cast<gpio_num_t>(RotaryEncoder::PIN_B));
   }
 }
 
@@ -120,7 +332,7 @@ void Controller::buttonTask() {
 SystemEvent Controller::readButtons() {
   unsigned long currentTime = millis();
   
-  for (int i = 0; i < 6; i++) {
+  for (int i = 0; i < BUTTON_COUNT; i++) {
     bool currentState = digitalRead(m_buttons[i].pin);
     
     // Check for state change
@@ -129,7 +341,7 @@ SystemEvent Controller::readButtons() {
     }
     
     // Check if debounce period has passed
-    if ((currentTime - m_buttons[i].lastDebounceTime) > DEBOUNCE_DELAY) {
+    if ((currentTime - m_buttons[i].lastDebounceTime) > m_debounceMs) {
       // Detect button press (LOW for pull-up)
       if (!m_buttons[i].pressed && currentState == LOW) {
         m_buttons[i].pressed = true;
@@ -160,10 +372,21 @@ SystemEvent Controller::readButtons() {
 /**
  * @brief Handles system events based on current state
  * @param event The system event to handle
+ * @param delta Detents for EVENT_SCROLL
  */
-void Controller::handleEvent(SystemEvent event) {
+void Controller::handleEvent(SystemEvent event, int delta) {
+  // Any input postpones sleep and keeps the CPU at full speed
+  SleepManager::getInstance()->noteActivity();
+  PowerManager* power = PowerManager::getInstance();
+  power->noteActivity();
+  
   SystemState currentState = m_model->getCurrentState();
   
+  if (event == EVENT_SCROLL) {
+    handleScroll(currentState, delta);
+    return;
+  }
+  
   // Route to appropriate state handler
   switch (currentState) {
     case STATE_MENU:
@@ -178,6 +401,27 @@ void Controller::handleEvent(SystemEvent event) {
     case STATE_CONFIRM_EXIT:
       handleConfirmExitState(event);
       break;
+    case STATE_GRAPH:
+      handleGraphState(event);
+      break;
+  }
+}
+
+/**
+ * @brief Applies an encoder move as a single model update
+ * @param state Current system state
+ * @param detents Signed detents (positive moves down / to the next channel)
+ */
+void Controller::handleScroll(SystemState state, int detents) {
+  switch (state) {
+    case STATE_MENU:
+      m_model->moveMenuIndex(detents);
+      break;
+    case STATE_GRAPH:
+      m_model->selectGraphChannel(detents);
+      break;
+    default:
+      break;
   }
 }
 
@@ -195,16 +439,13 @@ void Controller::handleMenuState(SystemEvent event) {
         int menuIndex = m_model->getMenuIndex();
         switch (menuIndex) {
           case 0: { // Home
-            DateTime now = rtc.now();
-            char timeStr[25];
-            snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d %02d/%02d/%04d",
-              now.hour(), now.minute(), now.second(),
-              now.day(), now.month(), now.year());
+            // Refresh from the RTC the Model already probed at boot
+            m_model->updateTime();
+            char timeStr[24];
+            m_model->getFormattedTime(timeStr, sizeof(timeStr));
 
             Serial.print("Home selected - Current Time: ");
             Serial.println(timeStr);
-
-            m_model->setCurrentTime(now);
             break;
           }
           case 1: // Settings
@@ -220,7 +461,8 @@ void Controller::handleMenuState(SystemEvent event) {
       }
       break;
     case EVENT_SELECT2:
-      Serial.println("Secondary select in menu");
+      // Secondary select opens the sensor graph
+      m_model->setState(STATE_GRAPH);
       break;
     default:
       break;
@@ -254,6 +496,24 @@ void Controller::handleAboutState(SystemEvent event) {
   }
 }
 
+void Controller::handleGraphState(SystemEvent event) {
+  switch (event) {
+    case EVENT_UP:
+      m_model->selectGraphChannel(-1);
+      break;
+    case EVENT_DOWN:
+      m_model->selectGraphChannel(1);
+      break;
+    case EVENT_LEFT:
+    case EVENT_SELECT2:
+      m_model->setState(STATE_MENU);
+      Serial.println("Returning to menu from graph");
+      break;
+    default:
+      break;
+  }
+}
+
 void Controller::handleConfirmExitState(SystemEvent event) {
   switch (event) {
     case EVENT_SELECT1: // Confirm exit
@@ -3,8 +3,11 @@
 
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 #include "Model.h"
+#include "Coroutine.h"
+#include "ExecutorTask.h"
+#include "FixedPool.h"
+#include "RotaryEncoder.h"
 
 // Button configuration
 struct ButtonConfig {
@@ -14,7 +17,45 @@ struct ButtonConfig {
   bool pressed;
 };
 
-class Controller {
+// Where an input event came from
+enum EventSource {
+  EVENT_SOURCE_BUTTON,
+  EVENT_SOURCE_ENCODER,
+  EVENT_SOURCE_EXTERNAL,
+  EVENT_SOURCE_LOAD       // LoadGenerator (load tests)
+};
+
+// Input event travelling from a producer (button scan, ISR, other task) to the controller
+struct InputEvent {
+  SystemEvent event;
+  uint8_t source;
+  int16_t delta;       // Detents for EVENT_SCROLL
+  uint32_t timestampUs;  // When it was posted (micros())
+  InputEvent* next;   // Intrusive FIFO link
+
+  InputEvent(SystemEvent e, uint8_t src, uint32_t timestamp, int16_t d = 0)
+    : event(e), source(src), delta(d), timestampUs(timestamp), next(nullptr) {}
+};
+
+class Controller : public Coroutine {
+public:
+  // Called on the controller coroutine after each event has been handled
+  typedef void (*EventObserver)(void* context, const InputEvent& event);
+
+  // Button indices into the pin table
+  enum ButtonIndex {
+    BUTTON_UP,
+    BUTTON_DOWN,
+    BUTTON_LEFT,
+    BUTTON_RIGHT,
+    BUTTON_SELECT1,
+    BUTTON_SELECT2,
+    BUTTON_COUNT
+  };
+
+  // GPIO for a button index (used for sleep wake sources)
+  static int getButtonPin(int buttonIndex);
+
 private:
   // Button pins
   static const int BTN_UP_PIN = 32;
@@ -24,34 +65,64 @@ private:
   static const int BTN_SELECT1_PIN = 27;
   static const int BTN_SELECT2_PIN = 14;
   
-  // Debounce timing
-  static const unsigned long DEBOUNCE_DELAY = 50;
+  // Debounce timing (debounce is TUNE_DEBOUNCE_MS)
   static const unsigned long REPEAT_DELAY = 200;
+  uint32_t m_debounceMs;
   
   // Button states
-  ButtonConfig m_buttons[6];
+  ButtonConfig m_buttons[BUTTON_COUNT];
+  
+  // Scroll input, read once per scan
+  RotaryEncoder m_encoder;
   
   // Model reference
   Model* m_model;
   
-  // Task handle
-  TaskHandle_t m_taskHandle;
+  // Coroutine state
+  bool m_running;
+  CoSignal m_wakeSignal;   // Button edge or posted event
+  
+  // Signal set by the button ISR
+  static CoSignal* s_wakeSignal;
+  
+  // Event pipeline: pooled events in an intrusive FIFO, shared with ISRs
+  static const int EVENT_POOL_SIZE = 16;
+  FixedPool<InputEvent, EVENT_POOL_SIZE, PoolCriticalLock> m_eventPool;
+  PoolCriticalLock m_queueLock;
+  InputEvent* m_eventHead;
+  InputEvent* m_eventTail;
+  volatile uint32_t m_eventsDropped;
+  EventObserver m_observer;
+  void* m_observerContext;
+  
+  // Polling rate while a button is active (TUNE_POLL_MS), and the longest
+  // idle wait while the interaction window is open
+  uint32_t m_pollIntervalMs;
+  static const uint32_t ACTIVE_WAIT_MS = 100;
   
   // Private methods
   void initializeButtons();
+  void initializeEncoder();
   SystemEvent readButtons();
   bool isButtonPressed(int buttonIndex);
-  void handleEvent(SystemEvent event);
+  bool buttonsSettled();
+  void dispatchEvents();
+  void dispatchModelEvents();
+  void armButtonInterrupts();
+  static void IRAM_ATTR buttonIsr(void* arg);
+  static void applyDebounce(void* context, int32_t value);
+  static void applyPollInterval(void* context, int32_t value);
+  void handleEvent(SystemEvent event, int delta);
+  void handleScroll(SystemState state, int detents);
   void handleMenuState(SystemEvent event);
   void handleSettingsState(SystemEvent event);
   void handleAboutState(SystemEvent event);
   void handleConfirmExitState(SystemEvent event);
+  void handleGraphState(SystemEvent event);
   
-  // Static task wrapper
-  static void taskWrapper(void* pvParameters);
-  
-  // Task implementation
-  void buttonTask();
+protected:
+  // Button loop, run as a coroutine on the UI executor
+  void step() override;
 
 public:
   Controller();
@@ -60,11 +131,26 @@ public:
   // Initialize controller
   bool initialize();
   
-  // Start the controller task
-  bool start();
+  // Start the button coroutine
+  bool start(ExecutorTask& executor);
   
-  // Stop the controller task
+  // Stop the button coroutine
   void stop();
+  
+  // Queues an input event for the controller (any task or ISR)
+  bool postEvent(SystemEvent event, uint8_t source = EVENT_SOURCE_EXTERNAL, int16_t delta = 0);
+  
+  // Event pool statistics
+  size_t getEventPoolSize() const { return EVENT_POOL_SIZE; }
+  size_t getEventHighWater() const { return m_eventPool.getHighWater(); }
+  uint32_t getEventsDropped() const { return m_eventsDropped; }
+  void resetEventHighWater() { m_eventPool.resetHighWater(); }
+  
+  // Instrumentation hook (load tests); set before start()
+  void setEventObserver(EventObserver observer, void* context) {
+    m_observer = observer;
+    m_observerContext = context;
+  }
 };
 
 #endif // CONTROLLER_H
\ No newline at end of file
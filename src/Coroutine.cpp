@@ -0,0 +1,98 @@
+#include "Coroutine.h"
+
+// ISR entry points must not live in flash on the target
+#if defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#define CO_ISR_ATTR IRAM_ATTR
+#else
+#define CO_ISR_ATTR
+#endif
+
+void Coroutine::wake() {
+  if (m_coExecutor != nullptr) {
+    m_coExecutor->notify();
+  }
+}
+
+void CO_ISR_ATTR Coroutine::wakeFromISR() {
+  if (m_coExecutor != nullptr) {
+    m_coExecutor->notifyFromISR();
+  }
+}
+
+void CO_ISR_ATTR CoSignal::setFromISR() {
+  m_set = true;
+  Coroutine* waiter = m_waiter;
+  if (waiter != nullptr) waiter->wakeFromISR();
+}
+
+/**
+ * @brief Adds a coroutine to the executor
+ * @param coroutine Coroutine to run; must outlive the executor or finish first
+ */
+void CoExecutor::spawn(Coroutine& coroutine) {
+  coroutine.m_coExecutor = this;
+  coroutine.m_coReady = true;
+  coroutine.m_coNext = m_head;
+  m_head = &coroutine;
+}
+
+/**
+ * @brief Runs one pass over the coroutines
+ * @param now Current time in milliseconds
+ * @return Milliseconds the caller may block before the next pass (CO_FOREVER if only events can wake)
+ */
+uint32_t CoExecutor::runOnce(CoTime now) {
+  // One atomic step: a notify() from the other core or an ISR between a
+  // separate read and clear would be lost, leaving untimed awaits asleep
+  bool events = __atomic_exchange_n(&m_eventPending, false, __ATOMIC_ACQ_REL);
+
+  uint32_t wait = CO_FOREVER;
+  Coroutine** link = &m_head;
+
+  while (*link != nullptr) {
+    Coroutine* co = *link;
+    co->m_coNow = now;
+
+    bool due = co->coDeadlinePassed();
+    if (co->m_coReady || due || (co->m_coAwaiting && events)) {
+      co->step();
+    }
+
+    if (co->m_coDone) {
+      // Unlink finished coroutines
+      *link = co->m_coNext;
+      co->m_coExecutor = nullptr;
+      continue;
+    }
+
+    if (co->m_coReady) {
+      wait = 0;
+    } else if (co->m_coHasDeadline) {
+      int32_t remaining = static_cast<int32_t>(co->m_coWakeAt - now);
+      uint32_t delay = remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+      if (delay < wait) wait = delay;
+    }
+    link = &co->m_coNext;
+  }
+
+  return wait;
+}
+
+void CoExecutor::notify() {
+  __atomic_store_n(&m_eventPending, true, __ATOMIC_RELEASE);
+  if (m_hook != nullptr) m_hook(m_hookContext, false);
+}
+
+void CO_ISR_ATTR CoExecutor::notifyFromISR() {
+  __atomic_store_n(&m_eventPending, true, __ATOMIC_RELEASE);
+  if (m_hook != nullptr) m_hook(m_hookContext, true);
+}
+
+size_t CoExecutor::getCoroutineCount() const {
+  size_t count = 0;
+  for (Coroutine* co = m_head; co != nullptr; co = co->m_coNext) {
+    count++;
+  }
+  return count;
+}
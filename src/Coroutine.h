@@ -0,0 +1,256 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Time base for the executor, in milliseconds (wraps after ~49 days)
+typedef uint32_t CoTime;
+
+// Timeout value meaning "no deadline"
+#define CO_FOREVER 0xFFFFFFFFUL
+
+// First entry into an await falls through to its resume label on purpose
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define CO_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define CO_FALLTHROUGH
+#endif
+
+class CoExecutor;
+
+/**
+ * Stackless coroutine.
+ *
+ * The body is written in step() between CO_BEGIN() and CO_END(); the CO_*
+ * macros save the resume point and return to the executor, so a coroutine
+ * costs a few bytes of state instead of a task stack. Like any switch-based
+ * coroutine, locals do not survive a suspension point (keep state in members),
+ * each line may hold at most one CO_* macro, and CO_* macros cannot appear
+ * inside a switch statement of the body.
+ */
+class Coroutine {
+public:
+  Coroutine()
+    : m_coLine(0), m_coNow(0), m_coWakeAt(0), m_coHasDeadline(false),
+      m_coReady(true), m_coAwaiting(false), m_coTimedOut(false), m_coDone(false),
+      m_coExecutor(nullptr), m_coNext(nullptr) {
+  }
+  virtual ~Coroutine() {}
+
+  bool isDone() const { return m_coDone; }
+  CoExecutor* executor() const { return m_coExecutor; }
+
+  // Wakes the executor running this coroutine (task or ISR context)
+  void wake();
+  void wakeFromISR();
+
+protected:
+  // Coroutine body; runs until the next suspension point
+  virtual void step() = 0;
+
+  // Starts the body again from CO_BEGIN() on the next pass, dropping any
+  // wait it was suspended in; call from outside step(). A finished
+  // coroutine has left its executor and must be spawned again.
+  void restart() {
+    m_coLine = 0;
+    m_coHasDeadline = false;
+    m_coAwaiting = false;
+    m_coTimedOut = false;
+    m_coDone = false;
+    m_coReady = true;
+  }
+
+  // Executor time at which this step started
+  CoTime coNow() const { return m_coNow; }
+
+  // Whether the last CO_AWAIT_TIMEOUT() ended by timing out
+  bool coTimedOut() const { return m_coTimedOut; }
+
+  // Helpers for the CO_* macros
+  void coSetDeadline(uint32_t delayMs) {
+    m_coHasDeadline = (delayMs != CO_FOREVER);
+    m_coWakeAt = m_coNow + delayMs;
+  }
+  void coClearDeadline() { m_coHasDeadline = false; }
+  bool coDeadlinePassed() const {
+    return m_coHasDeadline && static_cast<int32_t>(m_coNow - m_coWakeAt) >= 0;
+  }
+
+  int m_coLine;
+  CoTime m_coNow;
+  CoTime m_coWakeAt;
+  bool m_coHasDeadline;
+  bool m_coReady;      // Runs on the next pass regardless of deadline or events
+  bool m_coAwaiting;   // Re-evaluates its await condition when an event arrives
+  bool m_coTimedOut;
+  bool m_coDone;
+
+private:
+  friend class CoExecutor;
+  CoExecutor* m_coExecutor;
+  Coroutine* m_coNext;
+};
+
+#define CO_BEGIN() \
+  m_coReady = false; \
+  switch (m_coLine) { case 0:
+
+#define CO_END() \
+  } m_coDone = true; return
+
+// Suspends until the next executor pass
+#define CO_YIELD() \
+  do { m_coReady = true; m_coLine = __LINE__; return; case __LINE__:; } while (0)
+
+// Suspends for ms milliseconds
+#define CO_DELAY(ms) \
+  do { coSetDeadline(ms); m_coLine = __LINE__; return; \
+       case __LINE__: coClearDeadline(); } while (0)
+
+// Suspends until an absolute executor time (for drift-free periods)
+#define CO_DELAY_UNTIL(t) \
+  CO_DELAY(static_cast<int32_t>((t) - m_coNow) > 0 ? static_cast<uint32_t>((t) - m_coNow) : 0)
+
+// Suspends until cond is true; cond is re-evaluated whenever the executor is woken
+#define CO_AWAIT(cond) \
+  do { m_coAwaiting = true; m_coLine = __LINE__; CO_FALLTHROUGH; \
+       case __LINE__: if (!(cond)) return; m_coAwaiting = false; } while (0)
+
+// As CO_AWAIT(), giving up after ms milliseconds; check coTimedOut() afterwards
+#define CO_AWAIT_TIMEOUT(cond, ms) \
+  do { m_coAwaiting = true; coSetDeadline(ms); m_coLine = __LINE__; CO_FALLTHROUGH; \
+       case __LINE__: m_coTimedOut = false; \
+       if (!(cond)) { if (!coDeadlinePassed()) return; m_coTimedOut = true; } \
+       m_coAwaiting = false; coClearDeadline(); } while (0)
+
+/**
+ * Cooperative executor for stackless coroutines.
+ *
+ * runOnce() steps every coroutine that is due and returns how long the caller
+ * may block before the next deadline. notify() (ISR-safe) marks that an event
+ * arrived, so awaiting coroutines re-check their conditions on the next pass,
+ * and invokes the wake hook to unblock the thread running the executor.
+ *
+ * Pure C++: the host drives it with its own clock, the target through
+ * ExecutorTask.
+ */
+class CoExecutor {
+public:
+  // Wake hook: called from notify(); fromISR tells which notify variant to use
+  typedef void (*WakeHook)(void* context, bool fromISR);
+
+  CoExecutor() : m_head(nullptr), m_eventPending(false), m_hook(nullptr), m_hookContext(nullptr) {}
+
+  void setWakeHook(WakeHook hook, void* context) {
+    m_hook = hook;
+    m_hookContext = context;
+  }
+
+  // Adds a coroutine; it first runs on the next pass. Call from the executor thread.
+  void spawn(Coroutine& coroutine);
+
+  // Steps due coroutines; returns ms until the next deadline, 0 if any is ready, or CO_FOREVER
+  uint32_t runOnce(CoTime now);
+
+  // Signals an event to awaiting coroutines
+  void notify();
+  void notifyFromISR();
+
+  size_t getCoroutineCount() const;
+
+private:
+  Coroutine* m_head;
+  volatile bool m_eventPending;
+  WakeHook m_hook;
+  void* m_hookContext;
+};
+
+/**
+ * One-shot event flag a coroutine can await, set from tasks or ISRs.
+ * Await with CO_AWAIT(signal.poll(this)).
+ */
+class CoSignal {
+public:
+  CoSignal() : m_set(false), m_waiter(nullptr) {}
+
+  void set() {
+    m_set = true;
+    Coroutine* waiter = m_waiter;
+    if (waiter != nullptr) waiter->wake();
+  }
+
+  void setFromISR();
+
+  void reset() { m_set = false; }
+
+  // Consumes the flag if set and registers the caller to be woken by the next set()
+  bool poll(Coroutine* waiter) {
+    m_waiter = waiter;
+    if (!m_set) return false;
+    m_set = false;
+    return true;
+  }
+
+private:
+  volatile bool m_set;
+  Coroutine* volatile m_waiter;
+};
+
+/**
+ * Single-producer, single-consumer queue a coroutine can await.
+ * The producer may be another task or an ISR; the consumer is a coroutine.
+ * Await with CO_AWAIT(queue.pop(item, this)).
+ */
+template <typename T, size_t N>
+class CoQueue {
+public:
+  CoQueue() : m_head(0), m_tail(0), m_waiter(nullptr), m_drops(0) {}
+
+  bool push(const T& item) {
+    if (!enqueue(item)) return false;
+    Coroutine* waiter = m_waiter;
+    if (waiter != nullptr) waiter->wake();
+    return true;
+  }
+
+  bool pushFromISR(const T& item) {
+    if (!enqueue(item)) return false;
+    Coroutine* waiter = m_waiter;
+    if (waiter != nullptr) waiter->wakeFromISR();
+    return true;
+  }
+
+  // Takes the oldest item if any and registers the caller to be woken by the next push
+  bool pop(T& item, Coroutine* waiter) {
+    m_waiter = waiter;
+    if (m_tail == m_head) return false;
+    item = m_items[m_tail];
+    m_tail = (m_tail + 1) % (N + 1);
+    return true;
+  }
+
+  bool isEmpty() const { return m_tail == m_head; }
+  uint32_t getDropCount() const { return m_drops; }
+
+private:
+  // One slot stays free to tell full from empty without a shared counter
+  T m_items[N + 1];
+  volatile size_t m_head;
+  volatile size_t m_tail;
+  Coroutine* volatile m_waiter;
+  uint32_t m_drops;
+
+  bool enqueue(const T& item) {
+    size_t next = (m_head + 1) % (N + 1);
+    if (next == m_tail) {
+      m_drops++;
+      return false;
+    }
+    m_items[m_head] = item;
+    m_head = next;
+    return true;
+  }
+};
+
+#endif // COROUTINE_H
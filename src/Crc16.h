@@ -0,0 +1,23 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), bitwise.
+ * Small enough for RTC-memory records and serial frames; pass the previous
+ * result as crc to continue over split buffers.
+ */
+inline uint16_t crc16Ccitt(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i]) << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                           : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+#endif // CRC16_H
@@ -0,0 +1,95 @@
+#ifndef DISPLAY_LAYOUT_H
+#define DISPLAY_LAYOUT_H
+
+#include <stdint.h>
+
+// Fitted panels; the views are instantiated for these sizes only.
+// OLED: 128x64 or 128x32 pixels. LCD: 16x2 or 20x4 characters.
+#ifndef OLED_PANEL_WIDTH
+#define OLED_PANEL_WIDTH 128
+#endif
+#ifndef OLED_PANEL_HEIGHT
+#define OLED_PANEL_HEIGHT 64
+#endif
+#ifndef LCD_PANEL_COLS
+#define LCD_PANEL_COLS 16
+#endif
+#ifndef LCD_PANEL_ROWS
+#define LCD_PANEL_ROWS 2
+#endif
+
+// Panel size in the view's drawing units (pixels, or character cells)
+template <int W, int H>
+struct PanelGeometry {
+  static constexpr int WIDTH = W;
+  static constexpr int HEIGHT = H;
+};
+
+typedef PanelGeometry<OLED_PANEL_WIDTH, OLED_PANEL_HEIGHT> OledPanel;
+typedef PanelGeometry<LCD_PANEL_COLS, LCD_PANEL_ROWS> LcdPanel;
+
+/**
+ * OLED screen layout for the 6x8 font at text size 1, folded from the panel
+ * size at compile time. Everything below the header rule is split between
+ * the body and, on panels tall enough, a one-line footer hint.
+ */
+template <typename Panel>
+struct OledLayout {
+  static constexpr int CHAR_WIDTH = 6;
+  static constexpr int LINE_HEIGHT = 8;
+  static constexpr int TEXT_COLUMNS = Panel::WIDTH / CHAR_WIDTH;
+  static constexpr int PAGES = Panel::HEIGHT / 8;   // SSD1306 memory pages
+
+  static constexpr int HEADER_RULE_Y = 10;
+  static constexpr bool HAS_FOOTER = Panel::HEIGHT >= 64;
+  static constexpr int FOOTER_Y = Panel::HEIGHT - LINE_HEIGHT;
+  static constexpr int CONTENT_BOTTOM = HAS_FOOTER ? FOOTER_Y : Panel::HEIGHT;
+
+  // Menu: one row per item, scrolled when they do not all fit
+  static constexpr int MENU_TOP = HEADER_RULE_Y + (HAS_FOOTER ? 5 : 2);
+  static constexpr int MENU_PITCH = LINE_HEIGHT + 2;
+  static constexpr int MENU_ROWS = (CONTENT_BOTTOM - LINE_HEIGHT - MENU_TOP) / MENU_PITCH + 1;
+  static constexpr int MENU_SELECT_X = 2 * CHAR_WIDTH + 3;   // After the "> " marker
+  static constexpr int MENU_SELECT_WIDTH = 80;
+  static constexpr int menuRowY(int row) { return MENU_TOP + row * MENU_PITCH; }
+
+  // Text pages (settings, about)
+  static constexpr int BODY_TOP = HEADER_RULE_Y + 4;
+  static constexpr int BODY_LINES = (CONTENT_BOTTOM - BODY_TOP) / LINE_HEIGHT;
+  static constexpr int bodyLineY(int line) { return BODY_TOP + line * LINE_HEIGHT; }
+
+  // Confirmation: two option lines at the bottom, the large prompt above if it fits
+  static constexpr int OPTIONS_Y = Panel::HEIGHT - 2 * LINE_HEIGHT - (HAS_FOOTER ? 3 : 0);
+  static constexpr int PROMPT_Y = HEADER_RULE_Y + 15;
+  static constexpr bool SHOW_PROMPT = PROMPT_Y + 2 * LINE_HEIGHT <= OPTIONS_Y;
+
+  // Graph: sweep plot on the pages below the header
+  static constexpr int GRAPH_FIRST_PAGE = 2;
+  static constexpr int GRAPH_LAST_PAGE = PAGES - 1;
+  static constexpr int GRAPH_TOP = GRAPH_FIRST_PAGE * 8;
+  static constexpr int GRAPH_HEIGHT = (GRAPH_LAST_PAGE - GRAPH_FIRST_PAGE + 1) * 8;
+  static constexpr int GRAPH_MESSAGE_Y = GRAPH_TOP + (GRAPH_HEIGHT - LINE_HEIGHT) / 2;
+
+  static_assert(Panel::HEIGHT % 8 == 0, "SSD1306 panels are whole pages high");
+  static_assert(MENU_ROWS >= 1 && BODY_LINES >= 1, "Panel too small for the menu layout");
+};
+
+/**
+ * Character LCD layout: the title on the first row, content below it and,
+ * on the graph screen, a sparkline across the last row.
+ */
+template <typename Panel>
+struct LcdLayout {
+  static constexpr int COLS = Panel::WIDTH;
+  static constexpr int ROWS = Panel::HEIGHT;
+  static constexpr int LINE_SIZE = COLS + 1;     // Line buffers, with the terminator
+
+  static constexpr int ARROW_UP_COL = COLS - 2;  // Scroll hint, top-right corner
+  static constexpr int ARROW_DOWN_COL = COLS - 1;
+  static constexpr int MENU_ROWS = ROWS - 1;     // Items below the title row
+  static constexpr int SPARKLINE_ROW = ROWS - 1;
+
+  static_assert(ROWS >= 2 && COLS >= 16, "Layouts need at least 16x2 characters");
+};
+
+#endif // DISPLAY_LAYOUT_H
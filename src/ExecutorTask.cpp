@@ -0,0 +1,93 @@
+#include "ExecutorTask.h"
+#include "Trace.h"
+
+ExecutorTask::ExecutorTask(const char* name, uint32_t stackSize, UBaseType_t priority)
+  : m_name(name), m_stackSize(stackSize), m_priority(priority),
+    m_taskHandle(nullptr), m_passes(0), m_traceTrack(0) {
+  m_executor.setWakeHook(wakeHook, this);
+}
+
+ExecutorTask::~ExecutorTask() {
+  stop();
+}
+
+/**
+ * @brief Starts the executor task
+ * @return true if the task was created
+ */
+bool ExecutorTask::start() {
+  if (m_taskHandle != nullptr) {
+    Serial.print(m_name);
+    Serial.println(" executor already running");
+    return false;
+  }
+
+  m_traceTrack = TRACE_REGISTER_TRACK(TRACE_ID_TASK, m_name);
+  BaseType_t result = xTaskCreate(taskWrapper, m_name, m_stackSize, this, m_priority, &m_taskHandle);
+  return result == pdPASS;
+}
+
+void ExecutorTask::setPriority(UBaseType_t priority) {
+  m_priority = priority;
+  if (m_taskHandle != nullptr) {
+    vTaskPrioritySet(m_taskHandle, priority);
+  }
+}
+
+void ExecutorTask::stop() {
+  if (m_taskHandle != nullptr) {
+    vTaskDelete(m_taskHandle);
+    m_taskHandle = nullptr;
+  }
+}
+
+/**
+ * @brief FreeRTOS task wrapper function
+ * @param pvParameters Pointer to the ExecutorTask instance
+ */
+void ExecutorTask::taskWrapper(void* pvParameters) {
+  ExecutorTask* task = static_cast<ExecutorTask*>(pvParameters);
+  task->run();
+}
+
+/**
+ * @brief Executor loop: one pass, then sleep until the next deadline or event
+ */
+void ExecutorTask::run() {
+  while (true) {
+    TRACE_BEGIN(TRACE_ID_TASK, m_traceTrack);
+    uint32_t waitMs = m_executor.runOnce(millis());
+    TRACE_END(TRACE_ID_TASK, m_traceTrack);
+    m_passes++;
+
+    if (waitMs == 0) {
+      // A coroutine yielded; let equal-priority tasks run first
+      taskYIELD();
+      continue;
+    }
+
+    TickType_t ticks = (waitMs == CO_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+    if (ticks == 0) ticks = 1;
+    ulTaskNotifyTake(pdTRUE, ticks);
+  }
+}
+
+/**
+ * @brief Unblocks the executor task when a coroutine is notified
+ * @param context ExecutorTask instance
+ * @param fromISR Whether the caller is an interrupt handler
+ */
+void IRAM_ATTR ExecutorTask::wakeHook(void* context, bool fromISR) {
+  ExecutorTask* task = static_cast<ExecutorTask*>(context);
+  if (task->m_taskHandle == nullptr) return;
+
+  if (fromISR) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(task->m_taskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) {
+      portYIELD_FROM_ISR();
+    }
+  } else {
+    xTaskNotifyGive(task->m_taskHandle);
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef EXECUTOR_TASK_H
+#define EXECUTOR_TASK_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Coroutine.h"
+
+/**
+ * Runs a CoExecutor on one FreeRTOS task. Between passes the task blocks on
+ * its notification until the earliest coroutine deadline, so an idle
+ * executor does not wake at all.
+ */
+class ExecutorTask {
+public:
+  ExecutorTask(const char* name, uint32_t stackSize, UBaseType_t priority);
+  ~ExecutorTask();
+
+  // Adds a coroutine; call before start()
+  void spawn(Coroutine& coroutine) { m_executor.spawn(coroutine); }
+
+  bool start();
+  void stop();
+
+  // Takes effect at once if running, else at start()
+  void setPriority(UBaseType_t priority);
+
+  TaskHandle_t getTaskHandle() const { return m_taskHandle; }
+  uint32_t getPassCount() const { return m_passes; }
+
+private:
+  CoExecutor m_executor;
+  const char* m_name;
+  uint32_t m_stackSize;
+  UBaseType_t m_priority;
+  TaskHandle_t m_taskHandle;
+  volatile uint32_t m_passes;
+  uint16_t m_traceTrack;
+
+  static void taskWrapper(void* pvParameters);
+  static void wakeHook(void* context, bool fromISR);
+  void run();
+};
+
+#endif // EXECUTOR_TASK_H
@@ -0,0 +1,162 @@
+#ifndef FIXED_POOL_H
+#define FIXED_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#endif
+
+// Locking policy for pools used from a single task (or the host)
+struct PoolNoLock {
+  void lock() {}
+  void unlock() {}
+};
+
+#if defined(ESP_PLATFORM)
+// Locking policy for pools shared between tasks, cores and ISRs
+struct PoolCriticalLock {
+  portMUX_TYPE m_mux;
+
+  PoolCriticalLock() {
+    m_mux = portMUX_INITIALIZER_UNLOCKED;
+  }
+
+  // _SAFE variants pick the task or ISR form of the critical section
+  void lock() { portENTER_CRITICAL_SAFE(&m_mux); }
+  void unlock() { portEXIT_CRITICAL_SAFE(&m_mux); }
+};
+#endif
+
+/**
+ * Fixed-block pool for objects of type T.
+ *
+ * Storage for N objects is reserved inside the pool, so a pool declared at
+ * namespace scope never touches the heap. Free blocks form an index-linked
+ * list: allocate() and release() are O(1). The Lock policy makes the pool
+ * usable from ISRs (PoolCriticalLock) or keeps it lock-free for
+ * single-context use (PoolNoLock). A pointer that is not a block in use
+ * (foreign, misaligned or already released) is refused and counted rather
+ * than linked into the free list.
+ *
+ *   FixedPool<InputEvent, 16, PoolCriticalLock> pool;
+ *   InputEvent* e = pool.create(EVENT_UP);
+ *   pool.destroy(e);
+ */
+template <typename T, size_t N, typename Lock = PoolNoLock>
+class FixedPool {
+public:
+  static const size_t CAPACITY = N;
+
+  FixedPool() : m_freeHead(0), m_inUse(0), m_highWater(0), m_failures(0), m_badReleases(0) {
+    for (size_t i = 0; i < N; i++) {
+      m_next[i] = static_cast<Index>(i + 1);
+    }
+  }
+
+  // Returns uninitialized storage for one T, or nullptr if the pool is exhausted
+  void* allocate() {
+    void* block = nullptr;
+    m_lock.lock();
+    if (m_freeHead < N) {
+      Index index = m_freeHead;
+      m_freeHead = m_next[index];
+      m_next[index] = ALLOCATED;
+      block = &m_blocks[index];
+      if (++m_inUse > m_highWater) m_highWater = m_inUse;
+    } else {
+      m_failures++;
+    }
+    m_lock.unlock();
+    return block;
+  }
+
+  // Returns a block obtained from allocate(); nullptr is ignored. Returns
+  // false, leaving the pool as it was, if block is not one in use
+  bool release(void* block) {
+    if (block == nullptr) return true;
+    Index index = 0;
+    bool ok = indexOf(block, index);
+    m_lock.lock();
+    ok = ok && m_next[index] == ALLOCATED;
+    if (ok) {
+      m_next[index] = m_freeHead;
+      m_freeHead = index;
+      m_inUse--;
+    } else {
+      m_badReleases++;
+    }
+    m_lock.unlock();
+    return ok;
+  }
+
+  // Allocates and constructs a T
+  template <typename... Args>
+  T* create(Args&&... args) {
+    void* block = allocate();
+    return block ? new (block) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  // Destroys a T from create() and returns its block; false (and no
+  // destructor call) if object is not a block in use
+  bool destroy(T* object) {
+    if (object == nullptr) return true;
+    Index index = 0;
+    if (!indexOf(object, index) || m_next[index] != ALLOCATED) {
+      m_lock.lock();
+      m_badReleases++;
+      m_lock.unlock();
+      return false;
+    }
+    object->~T();
+    return release(object);
+  }
+
+  bool owns(const void* pointer) const {
+    const Block* block = static_cast<const Block*>(pointer);
+    return block >= m_blocks && block < m_blocks + N;
+  }
+
+  // Statistics
+  size_t getInUse() const { return m_inUse; }
+  size_t getHighWater() const { return m_highWater; }
+  uint32_t getFailureCount() const { return m_failures; }
+  uint32_t getBadReleaseCount() const { return m_badReleases; }
+  void resetHighWater() { m_highWater = m_inUse; }
+
+private:
+  typedef uint16_t Index;
+
+  // m_next of a block in use (no free-list link is this large)
+  static const Index ALLOCATED = 0xFFFF;
+
+  // Raw, suitably aligned storage so T needs no default constructor
+  union Block {
+    alignas(T) unsigned char bytes[sizeof(T)];
+  };
+
+  Block m_blocks[N];
+  Index m_next[N];
+  Index m_freeHead;
+  volatile size_t m_inUse;
+  size_t m_highWater;
+  uint32_t m_failures;
+  uint32_t m_badReleases;
+  Lock m_lock;
+
+  // Index of the block starting at pointer; false if there is none
+  bool indexOf(const void* pointer, Index& index) const {
+    if (!owns(pointer)) return false;
+    size_t offset = static_cast<const unsigned char*>(pointer) - m_blocks[0].bytes;
+    if (offset % sizeof(Block) != 0) return false;
+    index = static_cast<Index>(offset / sizeof(Block));
+    return true;
+  }
+
+  static_assert(N > 0 && N < 0xFFFF, "FixedPool capacity must fit a 16-bit index");
+};
+
+#endif // FIXED_POOL_H
@@ -0,0 +1,175 @@
+#include "FlightRecorder.h"
+#include <string.h>
+#include <esp_system.h>
+#include "TraceFormat.h"
+
+static_assert((FlightRecorder::RECORDS & (FlightRecorder::RECORDS - 1)) == 0,
+              "FLIGHT_RECORDER_RECORDS must be a power of two");
+
+static const uint32_t FLIGHT_MAGIC = 0x464C5431;   // "FLT1"; change with the layout
+
+// The log in RTC slow memory; left alone by the bootloader on every reset
+struct FlightLog {
+  uint32_t magic;
+  uint32_t head;          // Records written since the log was created
+  uint32_t headCheck;     // ~head, so a garbage header is not taken for a log
+  uint32_t bootHead;      // head when the current boot started
+  uint32_t boots;         // Boots since the log was created
+  FlightRecord records[FlightRecorder::RECORDS];
+};
+
+RTC_NOINIT_ATTR static FlightLog s_log;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_open = false;
+
+// Initialize static instance pointer to nullptr
+FlightRecorder* FlightRecorder::m_instance = nullptr;
+
+FlightRecorder::FlightRecorder() : m_lastHeapMin(0) {
+}
+
+FlightRecorder* FlightRecorder::getInstance() {
+  if (m_instance == nullptr) {
+    m_instance = new FlightRecorder();
+  }
+  return m_instance;
+}
+
+/**
+ * @brief Checks the RTC log, prints the previous boot's events and starts this boot's
+ * A log that fails the header check (power-on, layout change) is started afresh.
+ * After a deep sleep wake nothing is printed: the previous boot ended on purpose.
+ * @param out Where the previous boot is printed
+ */
+void FlightRecorder::begin(Print& out) {
+  if (s_open) return;
+
+  uint8_t reason = static_cast<uint8_t>(esp_reset_reason());
+  bool valid = s_log.magic == FLIGHT_MAGIC && s_log.headCheck == ~s_log.head &&
+               s_log.head - s_log.bootHead <= s_log.head;
+
+  if (!valid) {
+    if (reason != ESP_RST_POWERON) {
+      out.println("Flight recorder: no valid log, starting a new one");
+    }
+    memset(&s_log, 0, sizeof(s_log));
+    s_log.magic = FLIGHT_MAGIC;
+    s_log.headCheck = ~0u;
+  } else if (reason != ESP_RST_DEEPSLEEP) {
+    out.printf("=== Flight recorder: boot %lu ended in a %s reset ===\n",
+               (unsigned long)s_log.boots, resetReasonName(reason));
+    printRange(out, s_log.bootHead, s_log.head);
+    out.println("=== End of flight recorder ===");
+  }
+
+  s_log.boots++;
+  s_log.bootHead = s_log.head;
+  s_open = true;
+  record(FLIGHT_BOOT, reason, static_cast<uint16_t>(s_log.boots));
+  sampleHeap();
+}
+
+/**
+ * @brief Appends one event to the log
+ * @param type FlightEventType
+ * @param a First argument (see FlightEventType)
+ * @param b Second argument (see FlightEventType)
+ */
+void IRAM_ATTR FlightRecorder::record(uint8_t type, uint8_t a, uint16_t b) {
+  if (!s_open) return;
+
+  uint32_t ms = millis();
+  portENTER_CRITICAL_SAFE(&s_lock);
+  uint32_t head = s_log.head;
+  FlightRecord& entry = s_log.records[head & (RECORDS - 1)];
+  entry.ms = ms;
+  entry.type = type;
+  entry.a = a;
+  entry.b = b;
+  s_log.head = head + 1;
+  s_log.headCheck = ~(head + 1);
+  portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+/**
+ * @brief Logs the lowest free heap since boot when it has dropped by HEAP_STEP_BYTES
+ */
+void FlightRecorder::sampleHeap() {
+  uint32_t minFree = ESP.getMinFreeHeap();
+  if (m_lastHeapMin != 0 && minFree + HEAP_STEP_BYTES > m_lastHeapMin) return;
+
+  m_lastHeapMin = minFree;
+  uint32_t units = minFree / 16;
+  record(FLIGHT_HEAP_MIN, 0, static_cast<uint16_t>(units > 0xFFFF ? 0xFFFF : units));
+}
+
+/**
+ * @brief Prints the records with indices from..to-1 that the ring still holds
+ */
+void FlightRecorder::printRange(Print& out, uint32_t from, uint32_t to) {
+  if (to - from > RECORDS) {
+    out.printf("  (%lu older events overwritten)\n", (unsigned long)(to - from - RECORDS));
+    from = to - RECORDS;
+  }
+
+  static const char* const fatalNames[] = { "init failed", "task start failed", "ready timeout", "no RTC" };
+  for (uint32_t i = from; i != to; i++) {
+    const FlightRecord& entry = s_log.records[i & (RECORDS - 1)];
+    out.printf("  %8lu ms  %-7s ", (unsigned long)entry.ms, typeName(entry.type));
+    switch (entry.type) {
+      case FLIGHT_BOOT:
+        out.printf("%s reset, boot %u\n", resetReasonName(entry.a), entry.b);
+        break;
+      case FLIGHT_STATE:
+        out.printf("%u -> %u\n", entry.a, entry.b);
+        break;
+      case FLIGHT_INPUT:
+        out.printf("event %u from source %u\n", entry.a, entry.b);
+        break;
+      case FLIGHT_LOCK_TIMEOUT:
+        out.printf("%s after %u ms\n", traceMutexName(entry.a), entry.b);
+        break;
+      case FLIGHT_HEAP_MIN:
+        out.printf("%lu bytes free\n", (unsigned long)entry.b * 16);
+        break;
+      case FLIGHT_SLEEP:
+        out.printf("mode %u\n", entry.a);
+        break;
+      case FLIGHT_FATAL:
+        out.println(entry.a < sizeof(fatalNames) / sizeof(fatalNames[0]) ? fatalNames[entry.a] : "?");
+        break;
+      default:
+        out.printf("%u %u\n", entry.a, entry.b);
+        break;
+    }
+  }
+}
+
+const char* FlightRecorder::typeName(uint8_t type) {
+  switch (type) {
+    case FLIGHT_BOOT: return "boot";
+    case FLIGHT_STATE: return "state";
+    case FLIGHT_INPUT: return "input";
+    case FLIGHT_LOCK_TIMEOUT: return "lock";
+    case FLIGHT_HEAP_MIN: return "heap";
+    case FLIGHT_SLEEP: return "sleep";
+    case FLIGHT_FATAL: return "fatal";
+    default: return "?";
+  }
+}
+
+const char* FlightRecorder::resetReasonName(uint8_t reason) {
+  switch (reason) {
+    case ESP_RST_POWERON: return "power-on";
+    case ESP_RST_EXT: return "external";
+    case ESP_RST_SW: return "software";
+    case ESP_RST_PANIC: return "panic";
+    case ESP_RST_INT_WDT: return "interrupt watchdog";
+    case ESP_RST_TASK_WDT: return "task watchdog";
+    case ESP_RST_WDT: return "watchdog";
+    case ESP_RST_DEEPSLEEP: return "deep sleep";
+    case ESP_RST_BROWNOUT: return "brownout";
+    case ESP_RST_SDIO: return "SDIO";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * Crash-surviving event log.
+ *
+ * The last FLIGHT_RECORDER_RECORDS compact events live in RTC slow memory
+ * (RTC_NOINIT), which keeps its contents across panics, watchdog, software
+ * and brownout resets and deep sleep; only power loss clears it. begin()
+ * validates the log early in setup() and prints the previous boot's events
+ * if that boot did not end in deep sleep, then starts the new boot's entries.
+ *
+ * record() is a few stores under a spinlock, safe from tasks and ISRs on
+ * either core, so it stays on in production builds.
+ */
+
+// Records kept (8 bytes each in RTC slow memory)
+#ifndef FLIGHT_RECORDER_RECORDS
+#define FLIGHT_RECORDER_RECORDS 256
+#endif
+
+enum FlightEventType {
+  FLIGHT_BOOT = 1,            // a = esp_reset_reason_t, b = boots since power-on
+  FLIGHT_STATE,               // a = previous SystemState, b = new SystemState
+  FLIGHT_INPUT,               // a = SystemEvent, b = EventSource
+  FLIGHT_LOCK_TIMEOUT,        // a = TraceMutex, b = timeout in ms
+  FLIGHT_HEAP_MIN,            // b = lowest free heap since boot / 16 bytes
+  FLIGHT_SLEEP,               // a = SleepMode
+  FLIGHT_FATAL                // a = FlightFatal
+};
+
+// Why setup() gave up
+enum FlightFatal {
+  FLIGHT_FATAL_INIT,          // Component initialization failed
+  FLIGHT_FATAL_TASKS,         // Task startup failed
+  FLIGHT_FATAL_READY_TIMEOUT, // Tasks never reported ready
+  FLIGHT_FATAL_NO_RTC         // RTC missing; abort() follows
+};
+
+struct FlightRecord {
+  uint32_t ms;                // millis() of the boot that wrote it
+  uint8_t type;
+  uint8_t a;
+  uint16_t b;
+};
+
+class FlightRecorder {
+public:
+  static const uint32_t RECORDS = FLIGHT_RECORDER_RECORDS;
+  // A lower heap minimum is logged once it is this far below the last one logged
+  static const uint32_t HEAP_STEP_BYTES = 1024;
+
+  static FlightRecorder* getInstance();
+
+  // Validates the RTC log, prints the previous boot and opens this one; call first in setup()
+  void begin(Print& out);
+
+  // Appends one event (task or ISR context); dropped before begin()
+  static void record(uint8_t type, uint8_t a = 0, uint16_t b = 0);
+
+  // Logs a new low of the free heap (call periodically)
+  void sampleHeap();
+
+private:
+  static FlightRecorder* m_instance;
+
+  uint32_t m_lastHeapMin;
+
+  FlightRecorder();
+
+  static void printRange(Print& out, uint32_t from, uint32_t to);
+  static const char* typeName(uint8_t type);
+  static const char* resetReasonName(uint8_t reason);
+};
+
+// xSemaphoreTake that logs a timed-out wait (timeout > 0) as FLIGHT_LOCK_TIMEOUT
+static inline bool flightTake(SemaphoreHandle_t mutex, TickType_t timeout, uint8_t lock) {
+  if (xSemaphoreTake(mutex, timeout) == pdTRUE) return true;
+  if (timeout > 0) {
+    uint32_t ms = timeout * portTICK_PERIOD_MS;
+    FlightRecorder::record(FLIGHT_LOCK_TIMEOUT, lock, static_cast<uint16_t>(ms > 0xFFFF ? 0xFFFF : ms));
+  }
+  return false;
+}
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,196 @@
+#include "GlyphManager.h"
+
+// 5x8 patterns, one byte per pixel row (bit 4 = leftmost column)
+static const uint8_t GLYPH_PATTERNS[GLYPH_COUNT][8] = {
+  { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 }, // GLYPH_BAR_1
+  { 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 }, // GLYPH_BAR_2
+  { 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C }, // GLYPH_BAR_3
+  { 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E }, // GLYPH_BAR_4
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // GLYPH_SPARK_1
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F }, // GLYPH_SPARK_2
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F }, // GLYPH_SPARK_3
+  { 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F }, // GLYPH_SPARK_4
+  { 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F }, // GLYPH_SPARK_5
+  { 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F }, // GLYPH_SPARK_6
+  { 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F }, // GLYPH_SPARK_7
+  { 0x00, 0x01, 0x03, 0x16, 0x1C, 0x08, 0x00, 0x00 }, // GLYPH_CHECK
+  { 0x04, 0x0E, 0x15, 0x04, 0x04, 0x04, 0x04, 0x00 }, // GLYPH_ARROW_UP
+  { 0x04, 0x04, 0x04, 0x04, 0x15, 0x0E, 0x04, 0x00 }, // GLYPH_ARROW_DOWN
+  { 0x00, 0x04, 0x02, 0x1F, 0x02, 0x04, 0x00, 0x00 }, // GLYPH_ARROW_RIGHT
+};
+
+static const char GLYPH_FALLBACK[GLYPH_COUNT] = {
+  '|', '|', '|', '|',                    // Bars
+  '_', '_', '-', '-', '-', '=', '=',     // Sparkline steps
+  'v', '^', 'v', '>'                     // Icons
+};
+
+GlyphManager::GlyphManager(LcdTransport& transport, uint8_t cols, uint8_t rows)
+  : m_transport(transport),
+    m_cols(cols > MAX_COLS ? MAX_COLS : cols),
+    m_rows(rows > MAX_ROWS ? MAX_ROWS : rows),
+    m_blankObserver(nullptr), m_blankContext(nullptr),
+    m_frame(0), m_useCounter(0), m_uploads(0), m_hits(0), m_evictions(0) {
+  reset();
+}
+
+/**
+ * @brief Forgets all slot contents and cell dependencies
+ */
+void GlyphManager::reset() {
+  for (uint8_t s = 0; s < SLOT_COUNT; s++) {
+    m_slotGlyph[s] = GLYPH_COUNT;
+    m_slotLastUse[s] = 0;
+    m_slotFrame[s] = 0;
+    m_slotCells[s] = 0;
+  }
+  for (uint8_t g = 0; g < GLYPH_COUNT; g++) {
+    m_glyphSlot[g] = NO_SLOT;
+  }
+  for (uint16_t c = 0; c < MAX_COLS * MAX_ROWS; c++) {
+    m_cellSlot[c] = NO_SLOT;
+  }
+}
+
+/**
+ * @brief Starts a new frame, unpinning slots used by the previous one
+ */
+void GlyphManager::beginFrame() {
+  m_frame++;
+}
+
+/**
+ * @brief Places a glyph at a screen cell
+ * @param glyph Logical glyph to show
+ * @param col Column of the cell
+ * @param row Row of the cell
+ * @return true if a CGRAM slot was available, false if the fallback char was written
+ */
+bool GlyphManager::place(GlyphId glyph, uint8_t col, uint8_t row) {
+  if (col >= m_cols || row >= m_rows || glyph >= GLYPH_COUNT) return false;
+
+  uint8_t cell = row * m_cols + col;
+  releaseCell(cell);
+
+  uint8_t slot = acquire(glyph);
+
+  // Uploading moves the address counter into CGRAM, so always reposition
+  m_transport.setCursor(col, row);
+  if (slot == NO_SLOT) {
+    m_transport.data(static_cast<uint8_t>(fallbackChar(glyph)));
+    return false;
+  }
+
+  m_transport.data(slot);
+  m_cellSlot[cell] = slot;
+  m_slotCells[slot]++;
+  return true;
+}
+
+/**
+ * @brief Drops slot dependencies for cells overwritten with text
+ * @param col First column
+ * @param row Row
+ * @param count Number of cells
+ */
+void GlyphManager::releaseCells(uint8_t col, uint8_t row, uint8_t count) {
+  if (row >= m_rows) return;
+  for (uint8_t c = col; c < m_cols && c < col + count; c++) {
+    releaseCell(row * m_cols + c);
+  }
+}
+
+/**
+ * @brief Drops all cell dependencies (screen cleared), keeping slot contents
+ */
+void GlyphManager::releaseAll() {
+  for (uint16_t c = 0; c < MAX_COLS * MAX_ROWS; c++) {
+    m_cellSlot[c] = NO_SLOT;
+  }
+  for (uint8_t s = 0; s < SLOT_COUNT; s++) {
+    m_slotCells[s] = 0;
+  }
+}
+
+char GlyphManager::fallbackChar(GlyphId glyph) {
+  return (glyph < GLYPH_COUNT) ? GLYPH_FALLBACK[glyph] : '?';
+}
+
+// Private helper methods
+uint8_t GlyphManager::acquire(GlyphId glyph) {
+  uint8_t slot = m_glyphSlot[glyph];
+
+  if (slot != NO_SLOT) {
+    m_hits++;
+  } else {
+    slot = chooseVictim();
+    if (slot == NO_SLOT) return NO_SLOT;
+    evict(slot);
+    upload(slot, glyph);
+  }
+
+  m_slotLastUse[slot] = ++m_useCounter;
+  m_slotFrame[slot] = m_frame;
+  return slot;
+}
+
+uint8_t GlyphManager::chooseVictim() const {
+  uint8_t unusedSlot = NO_SLOT;   // Resident but not on screen
+  uint8_t staleSlot = NO_SLOT;    // On screen from an earlier frame
+
+  for (uint8_t s = 0; s < SLOT_COUNT; s++) {
+    if (m_slotGlyph[s] == GLYPH_COUNT) return s;   // Empty slot
+    if (m_slotFrame[s] == m_frame) continue;       // Pinned by this frame
+
+    if (m_slotCells[s] == 0) {
+      if (unusedSlot == NO_SLOT || m_slotLastUse[s] < m_slotLastUse[unusedSlot]) {
+        unusedSlot = s;
+      }
+    } else if (staleSlot == NO_SLOT || m_slotLastUse[s] < m_slotLastUse[staleSlot]) {
+      staleSlot = s;
+    }
+  }
+
+  return (unusedSlot != NO_SLOT) ? unusedSlot : staleSlot;
+}
+
+void GlyphManager::evict(uint8_t slot) {
+  if (m_slotGlyph[slot] == GLYPH_COUNT) return;
+
+  // Cells still showing the old pattern would change with the upload
+  if (m_slotCells[slot] > 0) {
+    for (uint16_t c = 0; c < m_cols * m_rows; c++) {
+      if (m_cellSlot[c] == slot) {
+        m_transport.setCursor(c % m_cols, c / m_cols);
+        m_transport.data(LCD_CHAR_BLANK);
+        m_cellSlot[c] = NO_SLOT;
+        if (m_blankObserver != nullptr) {
+          m_blankObserver(m_blankContext, c % m_cols, c / m_cols);
+        }
+      }
+    }
+    m_slotCells[slot] = 0;
+  }
+
+  m_glyphSlot[m_slotGlyph[slot]] = NO_SLOT;
+  m_slotGlyph[slot] = GLYPH_COUNT;
+  m_evictions++;
+}
+
+void GlyphManager::upload(uint8_t slot, GlyphId glyph) {
+  m_transport.command(0x40 | (slot << 3));  // Set CGRAM address
+  for (uint8_t i = 0; i < 8; i++) {
+    m_transport.data(GLYPH_PATTERNS[glyph][i]);
+  }
+  m_slotGlyph[slot] = glyph;
+  m_glyphSlot[glyph] = slot;
+  m_uploads++;
+}
+
+void GlyphManager::releaseCell(uint8_t cell) {
+  uint8_t slot = m_cellSlot[cell];
+  if (slot != NO_SLOT) {
+    m_slotCells[slot]--;
+    m_cellSlot[cell] = NO_SLOT;
+  }
+}
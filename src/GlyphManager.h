@@ -0,0 +1,114 @@
+#ifndef GLYPH_MANAGER_H
+#define GLYPH_MANAGER_H
+
+#include <stdint.h>
+#include "LcdTransport.h"
+
+// Logical icons that can be placed on the character LCD
+enum GlyphId {
+  // Horizontal progress bar cells with 1-4 of 5 pixel columns filled
+  GLYPH_BAR_1,
+  GLYPH_BAR_2,
+  GLYPH_BAR_3,
+  GLYPH_BAR_4,
+  // Sparkline steps, 1-7 of 8 pixel rows filled from the bottom
+  GLYPH_SPARK_1,
+  GLYPH_SPARK_2,
+  GLYPH_SPARK_3,
+  GLYPH_SPARK_4,
+  GLYPH_SPARK_5,
+  GLYPH_SPARK_6,
+  GLYPH_SPARK_7,
+  // Icons
+  GLYPH_CHECK,
+  GLYPH_ARROW_UP,
+  GLYPH_ARROW_DOWN,
+  GLYPH_ARROW_RIGHT,
+  GLYPH_COUNT
+};
+
+// Built-in HD44780 (ROM A00) characters used around the custom glyphs
+#define LCD_CHAR_BLANK      0x20
+#define LCD_CHAR_FULL_BLOCK 0xFF
+
+/**
+ * Maps logical glyphs onto the 8 HD44780 CGRAM slots.
+ *
+ * A glyph is uploaded only when it is not already resident; otherwise the
+ * slot is reused as-is. When all slots are taken, the least recently used
+ * slot that is not needed by the current frame is evicted. The manager tracks
+ * which screen cells show each slot, so cells left showing an evicted slot are
+ * blanked instead of silently turning into the new pattern, and reported to the
+ * blank observer so a text shadow of the screen can follow.
+ *
+ * Writes are queued on the transport; the caller flushes.
+ */
+class GlyphManager {
+public:
+  static const uint8_t SLOT_COUNT = 8;
+  static const uint8_t NO_SLOT = 0xFF;
+  static const uint8_t MAX_COLS = 20;
+  static const uint8_t MAX_ROWS = 4;
+
+  // Called for each cell blanked because the slot it showed was evicted
+  typedef void (*BlankObserver)(void* context, uint8_t col, uint8_t row);
+
+  GlyphManager(LcdTransport& transport, uint8_t cols, uint8_t rows);
+
+  // Forget all slot contents (after LCD init, CGRAM is undefined)
+  void reset();
+
+  // Marks the start of a frame; slots used from now on are pinned until the next frame
+  void beginFrame();
+
+  // Places a glyph at a cell, uploading it if needed; returns false if no slot was free
+  bool place(GlyphId glyph, uint8_t col, uint8_t row);
+
+  // Notes that text overwrote cells, dropping their slot dependencies
+  void releaseCells(uint8_t col, uint8_t row, uint8_t count);
+  void releaseAll();
+
+  void setBlankObserver(BlankObserver observer, void* context) {
+    m_blankObserver = observer;
+    m_blankContext = context;
+  }
+
+  // ASCII stand-in for a glyph when no slot is available
+  static char fallbackChar(GlyphId glyph);
+
+  // Statistics
+  uint32_t getUploadCount() const { return m_uploads; }
+  uint32_t getHitCount() const { return m_hits; }
+  uint32_t getEvictionCount() const { return m_evictions; }
+
+private:
+  LcdTransport& m_transport;
+  uint8_t m_cols;
+  uint8_t m_rows;
+  BlankObserver m_blankObserver;
+  void* m_blankContext;
+
+  // Slot state
+  uint8_t m_slotGlyph[SLOT_COUNT];    // GlyphId held by the slot, or GLYPH_COUNT if empty
+  uint32_t m_slotLastUse[SLOT_COUNT]; // LRU stamp
+  uint32_t m_slotFrame[SLOT_COUNT];   // Frame in which the slot was last used
+  uint8_t m_slotCells[SLOT_COUNT];    // Number of on-screen cells showing the slot
+
+  // Reverse maps
+  uint8_t m_glyphSlot[GLYPH_COUNT];
+  uint8_t m_cellSlot[MAX_COLS * MAX_ROWS];
+
+  uint32_t m_frame;
+  uint32_t m_useCounter;
+  uint32_t m_uploads;
+  uint32_t m_hits;
+  uint32_t m_evictions;
+
+  uint8_t acquire(GlyphId glyph);
+  uint8_t chooseVictim() const;
+  void evict(uint8_t slot);
+  void upload(uint8_t slot, GlyphId glyph);
+  void releaseCell(uint8_t cell);
+};
+
+#endif // GLYPH_MANAGER_H
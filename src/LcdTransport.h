@@ -0,0 +1,171 @@
+#ifndef LCD_TRANSPORT_H
+#define LCD_TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// PCF8574 backpack wiring used by LiquidCrystal_I2C modules:
+// P0=RS, P1=RW, P2=EN, P3=backlight, P4..P7=D4..D7
+#define LCD_PCF_RS        0x01
+#define LCD_PCF_RW        0x02
+#define LCD_PCF_EN        0x04
+#define LCD_PCF_BACKLIGHT 0x08
+
+// HD44780 execution times (datasheet, fosc = 270 kHz)
+#define LCD_EXEC_TIME_US  37
+#define LCD_CLEAR_TIME_US 1520
+
+/**
+ * Minimal byte-sink interface for the I2C bus behind the LCD.
+ * Implemented by the Wire adapter on target and by mock buses on the host.
+ */
+class LcdBus {
+public:
+  virtual ~LcdBus() {}
+
+  // Writes len bytes to the device as a single bus transaction
+  virtual bool write(uint8_t address, const uint8_t* data, size_t len) = 0;
+
+  // Largest payload accepted by write()
+  virtual size_t maxTransfer() const = 0;
+
+  // Time needed to clock one byte (8 data bits + ACK) in nanoseconds
+  virtual uint32_t byteTimeNs() const = 0;
+};
+
+/**
+ * Batched HD44780 transport for PCF8574 backpacks.
+ *
+ * Encodes commands and characters as the PCF8574 byte sequence (nibble with
+ * EN high, nibble with EN low) into one buffer and sends it as a single I2C
+ * write. The expander latches every byte it receives, so the bus clock itself
+ * spaces the enable pulses; the settle times LiquidCrystal_I2C implements with
+ * delayMicroseconds() are encoded as idle bytes instead.
+ *
+ * A character costs 4 bytes at 100 kHz instead of 6 separate transactions.
+ * The power-on init sequence uses the same padding for its 4.1 ms waits.
+ */
+class LcdTransport {
+public:
+  static const size_t BUFFER_SIZE = 128;
+
+  LcdTransport(LcdBus& bus, uint8_t address)
+    : m_bus(bus), m_address(address), m_backlight(LCD_PCF_BACKLIGHT),
+      m_length(0), m_transactions(0), m_bytesSent(0), m_errors(0) {
+  }
+
+  // Backlight bit is carried in every byte written to the expander
+  void setBacklight(bool on) {
+    m_backlight = on ? LCD_PCF_BACKLIGHT : 0;
+    appendRaw(0);
+  }
+
+  bool isBacklightOn() const { return m_backlight != 0; }
+
+  // Queue an instruction; settleUs is the execution time before the next one
+  void command(uint8_t value, uint32_t settleUs = LCD_EXEC_TIME_US) {
+    queueByte(value, 0, settleUs);
+  }
+
+  // Queue a single high nibble (used by the 8-bit to 4-bit reset sequence)
+  void nibble(uint8_t bits, uint32_t settleUs) {
+    appendNibble(bits & 0xF0);
+    appendIdle(bits & 0xF0, settleUs);
+  }
+
+  // Queue a byte for DDRAM/CGRAM at the current address
+  void data(uint8_t value) {
+    queueByte(value, LCD_PCF_RS, LCD_EXEC_TIME_US);
+  }
+
+  void write(const char* text, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      data(static_cast<uint8_t>(text[i]));
+    }
+  }
+
+  void write(const char* text) {
+    while (*text != '\0') {
+      data(static_cast<uint8_t>(*text++));
+    }
+  }
+
+  void setCursor(uint8_t col, uint8_t row) {
+    static const uint8_t rowOffsets[] = { 0x00, 0x40, 0x14, 0x54 };
+    command(0x80 | (col + rowOffsets[row & 0x03]));
+  }
+
+  void clear() {
+    command(0x01, LCD_CLEAR_TIME_US);
+  }
+
+  // Sends everything queued so far; returns false if any chunk was NAKed
+  bool flush() {
+    bool ok = true;
+    if (m_length > 0) {
+      ok = send(m_buffer, m_length);
+      m_length = 0;
+    }
+    return ok;
+  }
+
+  // Statistics
+  uint32_t getTransactionCount() const { return m_transactions; }
+  uint32_t getBytesSent() const { return m_bytesSent; }
+  uint32_t getErrorCount() const { return m_errors; }
+  void resetStatistics() { m_transactions = m_bytesSent = m_errors = 0; }
+
+private:
+  LcdBus& m_bus;
+  uint8_t m_address;
+  uint8_t m_backlight;
+  uint8_t m_buffer[BUFFER_SIZE];
+  size_t m_length;
+  uint32_t m_transactions;
+  uint32_t m_bytesSent;
+  uint32_t m_errors;
+
+  void queueByte(uint8_t value, uint8_t mode, uint32_t settleUs) {
+    // High nibble first; the low nibble latches the instruction
+    appendNibble((value & 0xF0) | mode);
+    appendNibble(((value << 4) & 0xF0) | mode);
+    appendIdle((value & 0xF0) | mode, settleUs);
+  }
+
+  void appendNibble(uint8_t bits) {
+    // One byte time (>= 22 us at 400 kHz) covers the 450 ns enable pulse width
+    appendRaw(bits | LCD_PCF_EN);
+    appendRaw(bits);
+  }
+
+  void appendIdle(uint8_t bits, uint32_t settleUs) {
+    // The EN-low byte already took one byte time; pad until settled
+    uint32_t byteNs = m_bus.byteTimeNs();
+    if (byteNs == 0) return;
+    uint32_t bytes = (settleUs * 1000 + byteNs - 1) / byteNs;
+    for (uint32_t i = 1; i < bytes; i++) {
+      appendRaw(bits & ~LCD_PCF_EN);
+    }
+  }
+
+  void appendRaw(uint8_t bits) {
+    size_t limit = m_bus.maxTransfer();
+    if (limit == 0 || limit > BUFFER_SIZE) limit = BUFFER_SIZE;
+    if (m_length >= limit) {
+      flush();
+    }
+    m_buffer[m_length++] = bits | m_backlight;
+  }
+
+  bool send(const uint8_t* data, size_t len) {
+    m_transactions++;
+    m_bytesSent += len;
+    if (!m_bus.write(m_address, data, len)) {
+      m_errors++;
+      return false;
+    }
+    return true;
+  }
+};
+
+#endif // LCD_TRANSPORT_H
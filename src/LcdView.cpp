@@ -1,15 +1,19 @@
 #include "LCDView.h"
+#include "TaskConfig.h"
 
 /**
  * @brief Constructor - Initializes the LCD view with task name and stack size
  */
-LCDView::LCDView() : View("LCD Task", 500), m_lcd(nullptr) {
+template <typename Panel>
+BasicLCDView<Panel>::BasicLCDView() : Base("LCD Task", VIEW_LCD_INTERVAL_MS), m_lcd(nullptr) {
+  memset(m_resumeFrame, ' ', sizeof(m_resumeFrame));
 }
 
 /**
  * @brief Destructor - Ensures proper cleanup of LCD resources
  */
-LCDView::~LCDView() {
+template <typename Panel>
+BasicLCDView<Panel>::~BasicLCDView() {
   cleanup();
 }
 
@@ -17,20 +21,22 @@ LCDView::~LCDView() {
  * @brief Initializes the LCD display hardware
  * @return true if initialization succeeded, false otherwise
  */
-bool LCDView::initializeDisplay() {
-  m_lcd = new SimpleLCD();
+template <typename Panel>
+bool BasicLCDView<Panel>::initializeDisplay() {
+  m_lcd = &m_display;
+  
+  // After deep sleep the HD44780 kept its configuration; just restore the text
+  if (m_warmStart) {
+    m_lcd->resume(m_resumeFrame);
+    Serial.println("LCD resumed");
+    return true;
+  }
   
   // Initialize the LCD (SimpleLCD::begin() returns void)
   m_lcd->begin();
   
-  // Verify LCD was properly allocated
-  if (m_lcd == nullptr) {
-    Serial.println("LCD allocation failed");
-    return false;
-  }
-  
   // Display initial welcome message
-  m_lcd->print("System Ready", 0, 0);
+  m_lcd->printPadded("System Ready", 0, 0);
   m_lcd->printPadded("Loading...", 0, 1);
   
   Serial.println("LCD initialized successfully");
@@ -38,123 +44,212 @@ bool LCDView::initializeDisplay() {
 }
 
 /**
- * @brief Cleans up LCD resources
+ * @brief Sets the text restored on a warm start
+ * @param snapshot Snapshot taken before deep sleep
+ */
+template <typename Panel>
+void BasicLCDView<Panel>::setResumeFrame(const UiSnapshot& snapshot) {
+  static_assert(sizeof(m_resumeFrame) == sizeof(snapshot.lcdFrame), "Snapshot holds another panel size");
+  memcpy(m_resumeFrame, snapshot.lcdFrame, sizeof(m_resumeFrame));
+}
+
+/**
+ * @brief Copies the text currently on the LCD into a snapshot
+ * @param snapshot Snapshot to fill
  */
-void LCDView::cleanup() {
+template <typename Panel>
+void BasicLCDView<Panel>::captureFrame(UiSnapshot& snapshot) const {
   if (m_lcd != nullptr) {
-    m_lcd->clear();
-    delete m_lcd;
-    m_lcd = nullptr;
+    m_lcd->copyFrame(snapshot.lcdFrame);
+  } else {
+    memset(snapshot.lcdFrame, ' ', sizeof(snapshot.lcdFrame));
   }
 }
 
 /**
- * @brief FreeRTOS task wrapper function
- * @param pvParameters Pointer to the LCDView instance
+ * @brief Switches the backlight for sleep/wake
+ * @param on true to light the panel
  */
-void LCDView::taskWrapper(void* pvParameters) {
-  LCDView* view = static_cast<LCDView*>(pvParameters);
-  view->displayTask();
+template <typename Panel>
+void BasicLCDView<Panel>::setDisplayPower(bool on) {
+  if (m_lcd == nullptr) return;
+  if (on) {
+    m_lcd->backlight();
+  } else {
+    m_lcd->noBacklight();
+  }
 }
 
 /**
- * @brief Main display rendering function
- * Routes to appropriate state-specific renderer
+ * @brief Cleans up LCD resources
  */
-void LCDView::renderDisplay() {
-  if (m_lcd == nullptr) return;
-  
-  // Get current system state from model
-  SystemState currentState = m_model->getCurrentState();
-  
-  // Call appropriate renderer for current state
-  switch (currentState) {
-    case STATE_MENU:
-      renderMenuState();
-      break;
-    case STATE_SETTINGS:
-      renderSettingsState();
-      break;
-    case STATE_ABOUT:
-      renderAboutState();
-      break;
-    case STATE_CONFIRM_EXIT:
-      renderConfirmExitState();
-      break;
+template <typename Panel>
+void BasicLCDView<Panel>::cleanup() {
+  if (m_lcd != nullptr) {
+    m_lcd->clear();
+    m_lcd = nullptr;
   }
 }
 
+/**
+ * @brief Prepares a frame before the state renderer runs
+ * @param state State about to be rendered
+ * @return false if the LCD is not initialized
+ */
+template <typename Panel>
+bool BasicLCDView<Panel>::beginFrame(SystemState state) {
+  if (m_lcd == nullptr) return false;
+  
+  // Glyphs placed during this render keep their CGRAM slots
+  m_lcd->beginFrame();
+  return true;
+}
+
 // State-specific renderers
-void LCDView::renderMenuState() {
+template <typename Panel>
+void BasicLCDView<Panel>::renderMenuState() {
   displayMenu();
 }
 
-void LCDView::renderSettingsState() {
+template <typename Panel>
+void BasicLCDView<Panel>::renderSettingsState() {
   displaySettings();
 }
 
-void LCDView::renderAboutState() {
+template <typename Panel>
+void BasicLCDView<Panel>::renderAboutState() {
   displayAbout();
 }
 
-void LCDView::renderConfirmExitState() {
+template <typename Panel>
+void BasicLCDView<Panel>::renderConfirmExitState() {
   displayConfirmExit();
 }
 
+template <typename Panel>
+void BasicLCDView<Panel>::renderGraphState() {
+  displayGraph();
+}
+
 /**
  * @brief Renders menu state
- * Shows menu position and current time
+ * Shows menu position and current time; taller panels list the next items
  */
-void LCDView::displayMenu() {
+template <typename Panel>
+void BasicLCDView<Panel>::displayMenu() {
     // Get model data
     const char* currentItem = m_model->getCurrentMenuItem();
     int currentIndex = m_model->getMenuIndex();
+    int menuLength = m_model->getMenuLength();
     
     // Format display lines
-    char line1[21], line2[21];
-    snprintf(line1, sizeof(line1), "Menu [%d/%d]", currentIndex + 1, m_model->getMenuLength());
+    char line1[Layout::LINE_SIZE], line2[Layout::LINE_SIZE];
+    snprintf(line1, sizeof(line1), "Menu [%d/%d]", currentIndex + 1, menuLength);
 
     // Get and format time
-   DateTime now = m_model->getTime(); 
-    char timeStr[21];
-    snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d",
-             now.hour(), now.minute(), now.second());
+    char timeStr[12];
+    m_model->getCurrentTimeString(timeStr, sizeof(timeStr));
 
     snprintf(line2, sizeof(line2), "> %s %s", currentItem, timeStr);
 
-    clearAndPrint(line1, line2);  // Atomic display update
+    m_lcd->printPadded(line1, 0, 0);
+    m_lcd->printPadded(line2, 0, 1);
+    
+    // Rows below the selection list the next items (none on a two-row panel)
+    for (int row = 2; row <= Layout::MENU_ROWS; row++) {
+        int index = currentIndex + row - 1;
+        line2[0] = '\0';
+        if (index < menuLength) snprintf(line2, sizeof(line2), "  %s", m_model->getMenuItem(index));
+        m_lcd->printPadded(line2, 0, row);
+    }
+
+    // Scroll hint in the top-right corner
+    m_lcd->printGlyph(GLYPH_ARROW_UP, Layout::ARROW_UP_COL, 0);
+    m_lcd->printGlyph(GLYPH_ARROW_DOWN, Layout::ARROW_DOWN_COL, 0);
 }
 
 /**
  * @brief Displays the settings state on LCD
  */
-void LCDView::displaySettings() {
+template <typename Panel>
+void BasicLCDView<Panel>::displaySettings() {
   clearAndPrint("Settings", "Configure System");
 }
 
 /**
  * @brief Displays the about state on LCD
  */
-void LCDView::displayAbout() {
+template <typename Panel>
+void BasicLCDView<Panel>::displayAbout() {
   clearAndPrint("About", "ESP32 Menu v1.0");
 }
 
 /**
  * @brief Displays the exit confirmation state on LCD
  */
-void LCDView::displayConfirmExit() {
+template <typename Panel>
+void BasicLCDView<Panel>::displayConfirmExit() {
   clearAndPrint("Exit System?", "SEL1:Yes SEL2:No");
 }
 
 /**
- * @brief Helper function to clear LCD and print two lines
+ * @brief Displays the graph channel's latest value and a sparkline
+ * The sparkline, on the last row, scales the last COLS readings to their own range
+ */
+template <typename Panel>
+void BasicLCDView<Panel>::displayGraph() {
+  int channel = m_model->getGraphChannel();
+  int32_t values[Layout::COLS];
+  uint32_t sequence = 0;
+  size_t count = m_model->copyRecentSensorValues(channel, values, Layout::COLS, &sequence);
+  m_graphSequence = sequence;
+  
+  char line1[Layout::LINE_SIZE];
+  if (count == 0) {
+    snprintf(line1, sizeof(line1), "Sensor %d", channel + 1);
+    clearAndPrint(line1, "No readings yet");
+    return;
+  }
+  
+  snprintf(line1, sizeof(line1), "S%d %ld mV", channel + 1, (long)values[count - 1]);
+  m_lcd->printPadded(line1, 0, 0);
+  for (int row = 1; row < Layout::SPARKLINE_ROW; row++) {
+    m_lcd->printPadded("", 0, row);
+  }
+  
+  int32_t low = values[0];
+  int32_t high = values[0];
+  for (size_t i = 1; i < count; i++) {
+    if (values[i] < low) low = values[i];
+    if (values[i] > high) high = values[i];
+  }
+  
+  // Right-aligned, newest reading in the last cell
+  uint8_t levels[Layout::COLS];
+  memset(levels, 0, sizeof(levels));
+  size_t first = Layout::COLS - count;
+  for (size_t i = 0; i < count; i++) {
+    levels[first + i] = (high > low)
+        ? static_cast<uint8_t>(1 + (values[i] - low) * 7 / (high - low))
+        : 4;
+  }
+  m_lcd->printSparkline(0, Layout::SPARKLINE_ROW, levels, Layout::COLS);
+}
+
+/**
+ * @brief Helper function to overwrite the LCD with two lines of text
+ * Padded writes replace every cell, so no clear (and its 1.5 ms wait) is needed
  * @param line1 First line to display
- * @param line2 Second line to display (optional)
+ * @param line2 Second line to display (optional, blank if nullptr); further rows are blanked
  */
-void LCDView::clearAndPrint(const char* line1, const char* line2) {
-  m_lcd->clear();
+template <typename Panel>
+void BasicLCDView<Panel>::clearAndPrint(const char* line1, const char* line2) {
   m_lcd->printPadded(line1, 0, 0);
-  if (line2 != nullptr) {
-    m_lcd->printPadded(line2, 0, 1);
+  m_lcd->printPadded(line2 != nullptr ? line2 : "", 0, 1);
+  for (int row = 2; row < Layout::ROWS; row++) {
+    m_lcd->printPadded("", 0, row);
   }
-}
\ No newline at end of file
+}
+
+// Layouts are folded per panel size; only the fitted panel is instantiated
+template class BasicLCDView<LcdPanel>;
\ No newline at end of file
@@ -3,36 +3,57 @@
 
 #include "View.h"
 #include "SimpleLCD.h"
+#include "UiSnapshot.h"
 
-class LCDView : public View {
+// Character LCD view for a Panel of COLS x ROWS cells (instantiated in LcdView.cpp)
+template <typename Panel>
+class BasicLCDView : public ViewBase<BasicLCDView<Panel>, Panel> {
 private:
-  SimpleLCD* m_lcd;
-  
+  typedef ViewBase<BasicLCDView, Panel> Base;
+  typedef LcdLayout<Panel> Layout;
+  typedef SimpleLCDPanel<Panel::WIDTH, Panel::HEIGHT> Display;
+  friend class ViewBase<BasicLCDView, Panel>;
+
+  using Base::m_model;
+  using Base::m_warmStart;
+  using Base::m_graphSequence;
+
+  Display m_display;
+  Display* m_lcd;   // &m_display once initialized
+  char m_resumeFrame[Layout::ROWS][Layout::COLS];
+
   // Display helper methods
   void displayMenu();
   void displaySettings();
   void displayAbout();
   void displayConfirmExit();
+  void displayGraph();
   void clearAndPrint(const char* line1, const char* line2 = nullptr);
 
 protected:
-  // Override virtual methods from View
-  bool initializeDisplay() override;
-  void renderDisplay() override;
-  void cleanup() override;
-  
-  // Static task wrapper for this specific view
-  static void taskWrapper(void* pvParameters);
+  // Hooks called by ViewBase
+  bool initializeDisplay();
+  bool beginFrame(SystemState state);
+  void cleanup();
 
 public:
-  LCDView();
-  virtual ~LCDView();
-  
-  // Override display state methods
-  void renderMenuState() override;
-  void renderSettingsState() override;
-  void renderAboutState() override;
-  void renderConfirmExitState() override;
+  BasicLCDView();
+  ~BasicLCDView();
+
+  // Sleep snapshot support
+  void setResumeFrame(const UiSnapshot& snapshot);
+  void captureFrame(UiSnapshot& snapshot) const;
+  void setDisplayPower(bool on);
+
+  // Display state renderers
+  void renderMenuState();
+  void renderSettingsState();
+  void renderAboutState();
+  void renderConfirmExitState();
+  void renderGraphState();
 };
 
-#endif // LCDVIEW_H
\ No newline at end of file
+// The fitted panel (see DisplayLayout.h)
+typedef BasicLCDView<LcdPanel> LCDView;
+
+#endif // LCDVIEW_H
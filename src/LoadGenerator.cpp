@@ -0,0 +1,252 @@
+#include "LoadGenerator.h"
+#include <stdio.h>
+#include <string.h>
+
+// ---- LatencyHistogram ----
+
+/**
+ * @brief Empties the histogram
+ */
+void LatencyHistogram::reset() {
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_count = 0;
+  m_max = 0;
+}
+
+/**
+ * @brief Adds one latency sample
+ * @param us Latency in microseconds
+ */
+void LatencyHistogram::record(uint32_t us) {
+  m_buckets[bucketOf(us)]++;
+  m_count++;
+  if (us > m_max) m_max = us;
+}
+
+/**
+ * @brief Latency below which the given share of samples fall
+ * @param percent Percentile, 0..100
+ * @return Upper bound of the bucket holding it (capped at the maximum seen), 0 if empty
+ */
+uint32_t LatencyHistogram::percentile(uint8_t percent) const {
+  if (m_count == 0) return 0;
+  if (percent > 100) percent = 100;
+
+  // Rank of the sample, rounded up so p100 is the largest
+  uint32_t rank = static_cast<uint32_t>((static_cast<uint64_t>(m_count) * percent + 99) / 100);
+  if (rank == 0) rank = 1;
+
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += m_buckets[i];
+    if (seen >= rank) {
+      uint32_t limit = bucketLimit(i);
+      return limit < m_max ? limit : m_max;
+    }
+  }
+  return m_max;
+}
+
+/**
+ * @brief Bucket of a latency: the power of two above it, split SUB_BUCKETS ways
+ * Values below SUB_BUCKETS get a bucket each.
+ */
+uint8_t LatencyHistogram::bucketOf(uint32_t us) {
+  if (us < SUB_BUCKETS) return static_cast<uint8_t>(us);
+  uint8_t exponent = static_cast<uint8_t>(31 - __builtin_clz(us));    // us >= 2^exponent
+  uint8_t sub = static_cast<uint8_t>((us >> (exponent - 2)) & (SUB_BUCKETS - 1));
+  return static_cast<uint8_t>((exponent - 1) * SUB_BUCKETS + sub);
+}
+
+/**
+ * @brief Largest latency a bucket holds
+ */
+uint32_t LatencyHistogram::bucketLimit(uint8_t bucket) {
+  if (bucket < SUB_BUCKETS) return bucket;
+  uint8_t exponent = static_cast<uint8_t>(bucket / SUB_BUCKETS + 1);
+  uint8_t sub = static_cast<uint8_t>(bucket % SUB_BUCKETS);
+  uint64_t limit = (static_cast<uint64_t>(SUB_BUCKETS + sub + 1) << (exponent - 2)) - 1;
+  return limit > 0xFFFFFFFFull ? 0xFFFFFFFFu : static_cast<uint32_t>(limit);
+}
+
+// ---- LoadReport ----
+
+void LoadReport::clear() {
+  memset(this, 0, sizeof(*this));
+}
+
+/**
+ * @brief Formats the report on one line
+ * @param buffer Destination
+ * @param size Size of buffer
+ * @return Length of the full line (may exceed size, as with snprintf)
+ */
+int LoadReport::format(char* buffer, size_t size) const {
+  uint32_t rate = elapsedMs ? static_cast<uint32_t>(static_cast<uint64_t>(handled) * 1000 / elapsedMs) : 0;
+  return snprintf(buffer, size,
+                  "Load: %lu posted, %lu handled (%lu/s), %lu dropped, queue high-water %lu/%lu, "
+                  "%lu frames in %lu ms, latency p50/p90/p99/max %lu/%lu/%lu/%lu us",
+                  (unsigned long)posted, (unsigned long)handled, (unsigned long)rate,
+                  (unsigned long)dropped, (unsigned long)queueHighWater, (unsigned long)queueCapacity,
+                  (unsigned long)frames, (unsigned long)elapsedMs,
+                  (unsigned long)latencyP50Us, (unsigned long)latencyP90Us,
+                  (unsigned long)latencyP99Us, (unsigned long)latencyMaxUs);
+}
+
+// ---- LoadGenerator ----
+
+/**
+ * @brief Constructor - nothing is posted until begin()
+ * @param clock Microsecond clock shared with the consumer
+ */
+LoadGenerator::LoadGenerator(MicrosClock clock)
+  : m_clock(clock), m_sink(nullptr), m_sinkContext(nullptr), m_mixCount(0), m_random(1),
+    m_running(false), m_finished(false), m_startUs(0), m_endUs(0), m_nextWake(0),
+    m_posted(0), m_dropped(0), m_handled(0) {
+}
+
+/**
+ * @brief Sets the events the generator posts
+ * @param events Event codes understood by the sink
+ * @param count Number of codes (1..MAX_EVENT_MIX)
+ * @return false if count is out of range
+ */
+bool LoadGenerator::setEventMix(const int* events, uint8_t count) {
+  if (count == 0 || count > MAX_EVENT_MIX) return false;
+  memcpy(m_mix, events, count * sizeof(int));
+  m_mixCount = count;
+  return true;
+}
+
+/**
+ * @brief Arms a run with a fresh report; the generator must then be spawned
+ * A finished generator leaves its executor, so it can be armed and spawned again.
+ * @param profile Shape, rate and duration of the load
+ * @param sink Where events go
+ * @param context Passed to sink
+ * @return false while a run is in progress, without a sink or event mix, or
+ *         if the duration (or burst period) exceeds MAX_DURATION_MS
+ */
+bool LoadGenerator::begin(const LoadProfile& profile, EventSink sink, void* context) {
+  if (m_running || sink == nullptr || m_mixCount == 0) return false;
+  if (profile.durationMs > MAX_DURATION_MS) return false;
+  if (profile.pattern == LOAD_BURST ? profile.burstSize == 0 || profile.burstPeriodMs == 0 ||
+                                      profile.burstPeriodMs > MAX_DURATION_MS
+                                    : profile.rateHz == 0) {
+    return false;
+  }
+
+  m_profile = profile;
+  m_sink = sink;
+  m_sinkContext = context;
+  m_random = profile.seed != 0 ? profile.seed : 1;
+  m_posted = 0;
+  m_dropped = 0;
+  m_handled = 0;
+  m_latency.reset();
+  m_finished = false;
+  m_running = true;
+
+  restart();
+  return true;
+}
+
+/**
+ * @brief Records that the consumer handled an event from this generator
+ * @param postedUs Clock value passed to the sink with the event
+ */
+void LoadGenerator::recordHandled(uint32_t postedUs) {
+  m_latency.record(m_clock() - postedUs);
+  m_handled++;
+}
+
+/**
+ * @brief Copies the run's totals and latency percentiles
+ * @param report Destination; frames and queue figures are left to the caller
+ */
+void LoadGenerator::getReport(LoadReport& report) const {
+  uint32_t end = m_finished ? m_endUs : m_clock();
+  report.elapsedMs = m_running || m_finished ? (end - m_startUs) / 1000 : 0;
+  report.posted = m_posted;
+  report.dropped = m_dropped;
+  report.handled = m_handled;
+  report.latencyP50Us = m_latency.percentile(50);
+  report.latencyP90Us = m_latency.percentile(90);
+  report.latencyP99Us = m_latency.percentile(99);
+  report.latencyMaxUs = m_latency.getMax();
+}
+
+/**
+ * @brief Generator loop: posts whatever the profile has made due, then sleeps
+ * Events due while the generator waited are posted back to back, so rates
+ * above the executor's 1 ms resolution arrive as small bursts.
+ */
+void LoadGenerator::step() {
+  CO_BEGIN();
+  m_startUs = m_clock();
+
+  while (true) {
+    {
+      uint32_t elapsedUs = m_clock() - m_startUs;
+      if (elapsedUs >= m_profile.durationMs * 1000u) break;
+
+      for (uint32_t due = eventsDue(elapsedUs); due > 0; due--) {
+        m_posted++;
+        if (!m_sink(m_sinkContext, nextEvent(), m_clock())) {
+          m_dropped++;
+        }
+      }
+    }
+    CO_DELAY(waitMs());
+  }
+
+  m_endUs = m_clock();
+  m_running = false;
+  m_finished = true;
+  CO_END();
+}
+
+/**
+ * @brief Events the profile calls for by now that have not been posted yet
+ */
+uint32_t LoadGenerator::eventsDue(uint32_t elapsedUs) const {
+  uint64_t target;
+  if (m_profile.pattern == LOAD_BURST) {
+    target = (static_cast<uint64_t>(elapsedUs / (m_profile.burstPeriodMs * 1000u)) + 1) * m_profile.burstSize;
+  } else {
+    target = static_cast<uint64_t>(elapsedUs) * m_profile.rateHz / 1000000u;
+  }
+  return target > m_posted ? static_cast<uint32_t>(target - m_posted) : 0;
+}
+
+/**
+ * @brief Milliseconds until the profile makes the next event due (at least 1)
+ */
+uint32_t LoadGenerator::waitMs() const {
+  uint32_t elapsedMs = (m_clock() - m_startUs) / 1000;
+  uint32_t wait;
+  if (m_profile.pattern == LOAD_BURST) {
+    wait = m_profile.burstPeriodMs - elapsedMs % m_profile.burstPeriodMs;
+  } else {
+    wait = 1000 / m_profile.rateHz;
+  }
+  return wait > 0 ? wait : 1;
+}
+
+/**
+ * @brief Picks the next event code
+ * Sustained and burst loads alternate the first two codes (e.g. up/down), so
+ * every event changes the model but the screen stays put; a random walk draws
+ * from the whole mix and moves between states.
+ */
+int LoadGenerator::nextEvent() {
+  if (m_profile.pattern != LOAD_RANDOM_WALK || m_mixCount == 1) {
+    return m_mix[(m_posted & 1) % m_mixCount];
+  }
+
+  // xorshift32: cheap and reproducible from the seed
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  return m_mix[m_random % m_mixCount];
+}
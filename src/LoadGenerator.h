@@ -0,0 +1,149 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Coroutine.h"
+
+/**
+ * Synthetic input for saturating the Controller -> Model -> View pipeline.
+ *
+ * LoadGenerator is a coroutine that posts events into a sink at the rate and
+ * shape of a LoadProfile; the consumer reports each handled event back with
+ * recordHandled(), which feeds the latency histogram. Pure C++ on top of
+ * Coroutine.h: the target runs it on its own ExecutorTask next to the real
+ * tasks (build with LOAD_TEST), the host drives it from tools/loadbench.cpp.
+ *
+ *   LoadGenerator load(micros);
+ *   load.setEventMix(events, 4);
+ *   load.begin(profile, postToController, &controller);
+ *   executor.spawn(load);
+ *   ...                                  // consumer: load.recordHandled(postedUs)
+ *   load.getReport(report);
+ */
+
+enum LoadPattern {
+  LOAD_SUSTAINED,     // rateHz events per second, alternating the first two mix events
+  LOAD_BURST,         // burstSize events back to back every burstPeriodMs
+  LOAD_RANDOM_WALK    // rateHz events per second, each drawn from the whole mix
+};
+
+struct LoadProfile {
+  LoadPattern pattern;
+  uint32_t rateHz;
+  uint16_t burstSize;
+  uint32_t burstPeriodMs;    // Up to LoadGenerator::MAX_DURATION_MS
+  uint32_t durationMs;       // Up to LoadGenerator::MAX_DURATION_MS
+  uint32_t seed;
+
+  LoadProfile()
+    : pattern(LOAD_SUSTAINED), rateHz(100), burstSize(32), burstPeriodMs(500),
+      durationMs(10000), seed(1) {}
+};
+
+/**
+ * Log-linear latency histogram: SUB_BUCKETS buckets per power of two, so a
+ * percentile is exact to within 1/SUB_BUCKETS of its value (25%) in fixed
+ * memory. record() is O(1) and takes one writer; read after it stops.
+ */
+class LatencyHistogram {
+public:
+  static const uint8_t SUB_BUCKETS = 4;
+  static const uint8_t BUCKET_COUNT = 32 * SUB_BUCKETS;
+
+  LatencyHistogram() { reset(); }
+
+  void reset();
+  void record(uint32_t us);
+
+  // Upper bound of the bucket holding the given percentile (0..100), 0 if empty
+  uint32_t percentile(uint8_t percent) const;
+  uint32_t getCount() const { return m_count; }
+  uint32_t getMax() const { return m_max; }
+
+private:
+  uint32_t m_buckets[BUCKET_COUNT];
+  uint32_t m_count;
+  uint32_t m_max;
+
+  static uint8_t bucketOf(uint32_t us);
+  static uint32_t bucketLimit(uint8_t bucket);
+};
+
+// Outcome of one run; queue and frame figures are filled in by the runner
+struct LoadReport {
+  uint32_t elapsedMs;
+  uint32_t posted;
+  uint32_t dropped;          // Refused by the sink (queue or pool full)
+  uint32_t handled;
+  uint32_t frames;
+  uint32_t queueHighWater;
+  uint32_t queueCapacity;
+  uint32_t latencyP50Us;     // Post -> handled
+  uint32_t latencyP90Us;
+  uint32_t latencyP99Us;
+  uint32_t latencyMaxUs;
+
+  LoadReport() { clear(); }
+  void clear();
+
+  // One-line summary; returns the length snprintf() would write
+  int format(char* buffer, size_t size) const;
+};
+
+class LoadGenerator : public Coroutine {
+public:
+  typedef uint32_t (*MicrosClock)();
+  // Posts one event; false if it was dropped
+  typedef bool (*EventSink)(void* context, int event, uint32_t postedUs);
+
+  static const uint8_t MAX_EVENT_MIX = 8;
+  // Runs are timed on the 32-bit microsecond clock, which wraps after 71
+  // minutes; an hour leaves room for a late wake-up near the end
+  static const uint32_t MAX_DURATION_MS = 3600000;
+
+  explicit LoadGenerator(MicrosClock clock);
+
+  // Events to post (the caller's event codes); at least one, up to MAX_EVENT_MIX
+  bool setEventMix(const int* events, uint8_t count);
+
+  // Arms a run; spawn the generator (or let a spawned one restart) afterwards
+  bool begin(const LoadProfile& profile, EventSink sink, void* context);
+
+  // Consumer side: an event posted at postedUs has been handled
+  void recordHandled(uint32_t postedUs);
+
+  bool isRunning() const { return m_running; }
+  bool isFinished() const { return m_finished; }
+
+  // Totals and latency percentiles of the current or last run
+  void getReport(LoadReport& report) const;
+
+protected:
+  void step() override;
+
+private:
+  MicrosClock m_clock;
+  LoadProfile m_profile;
+  EventSink m_sink;
+  void* m_sinkContext;
+  int m_mix[MAX_EVENT_MIX];
+  uint8_t m_mixCount;
+  uint32_t m_random;
+
+  volatile bool m_running;
+  volatile bool m_finished;
+  uint32_t m_startUs;
+  uint32_t m_endUs;
+  CoTime m_nextWake;
+  volatile uint32_t m_posted;
+  volatile uint32_t m_dropped;
+  volatile uint32_t m_handled;
+  LatencyHistogram m_latency;
+
+  uint32_t eventsDue(uint32_t elapsedUs) const;
+  uint32_t waitMs() const;
+  int nextEvent();
+};
+
+#endif // LOAD_GENERATOR_H
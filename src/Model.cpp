@@ -1,4 +1,7 @@
 #include "Model.h"
+#include "Trace.h"
+#include "FlightRecorder.h"
+#include "QuadratureDecoder.h"
 
 
 // Initialize static members
@@ -12,7 +15,20 @@ Model::Model()
     m_stateChanged(false),
     m_stateMutex(nullptr),
     m_displayMutex(nullptr),
-    m_timeMutex(nullptr) {
+    m_timeMutex(nullptr),
+    m_graphChannel(0),
+    m_sensorMutex(nullptr),
+    m_schedulerMutex(nullptr),
+    m_changeListenerCount(0) {
+  for (int i = 0; i < MAX_SENSOR_CHANNELS; i++) {
+    m_sensorSequence[i] = 0;
+  }
+  for (int i = 0; i < TaskManager::MAX_TASKS; i++) {
+    m_reminders[i].timer.callback = reminderFired;
+    m_reminders[i].timer.context = &m_reminders[i];
+    m_reminders[i].taskId = 0;
+    m_reminders[i].dueTime = 0;
+  }
 }
 
 Model* Model::getInstance() {
@@ -27,8 +43,10 @@ bool Model::initialize() {
   m_stateMutex = xSemaphoreCreateMutex();
   m_displayMutex = xSemaphoreCreateMutex();
   m_timeMutex = xSemaphoreCreateMutex();
+  m_sensorMutex = xSemaphoreCreateMutex();
+  m_schedulerMutex = xSemaphoreCreateMutex();
 
-  if (!m_stateMutex || !m_displayMutex || !m_timeMutex) {
+  if (!m_stateMutex || !m_displayMutex || !m_timeMutex || !m_sensorMutex || !m_schedulerMutex) {
     Serial.println("Failed to create mutexes");
     return false;
   }
@@ -36,7 +54,7 @@ bool Model::initialize() {
   // Initialize RTC hardware
   if (m_rtc.begin()) {
     m_rtcAvailable = true;
-    if (xSemaphoreTake(m_timeMutex, pdMS_TO_TICKS(100))) {
+    if (TRACE_TAKE(m_timeMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_TIME)) {
       m_currentTime = m_rtc.now();
       xSemaphoreGive(m_timeMutex);
     }
@@ -46,40 +64,279 @@ bool Model::initialize() {
     Serial.println("RTC not available - using system time");
   }
 
+  // The scheduler counts from the current RTC second
+  m_scheduler.reset(m_currentTime.unixtime());
   return true;
 }
 
+/**
+ * @brief Reads the RTC and runs the timers that came due
+ * Timer callbacks run here, on the caller's task.
+ */
 void Model::updateTime() {
-  if (m_rtcAvailable && xSemaphoreTake(m_timeMutex, pdMS_TO_TICKS(100))) {
+  uint32_t now = 0;
+  if (m_rtcAvailable && TRACE_TAKE(m_timeMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_TIME)) {
     m_currentTime = m_rtc.now();
+    now = m_currentTime.unixtime();
     xSemaphoreGive(m_timeMutex);
   }
   // Else maintain existing time (no RTC fallback implementation)
+  
+  // One wheel tick per elapsed second, however many timers are pending
+  if (now != 0 && TRACE_TAKE(m_schedulerMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_SCHEDULER)) {
+    m_scheduler.advance(now);
+    xSemaphoreGive(m_schedulerMutex);
+  }
 }
 
 DateTime Model::getTime() {
   DateTime copy;
-  if (xSemaphoreTake(m_timeMutex, portMAX_DELAY)) {
+  if (TRACE_TAKE(m_timeMutex, portMAX_DELAY, TRACE_MUTEX_MODEL_TIME)) {
     copy = m_currentTime;
     xSemaphoreGive(m_timeMutex);
   }
   return copy;
 }
 
-String Model::getFormattedTime() {
+/**
+ * @brief Formats the current date and time as "hh:mm:ss dd/mm/yyyy"
+ * @param buffer Destination (24 bytes fit the full string)
+ * @param size Size of the destination
+ */
+void Model::getFormattedTime(char* buffer, size_t size) {
   DateTime now = getTime();
-  char buf[24];
-  snprintf(buf, sizeof(buf), "%02u:%02u:%02u %02u/%02u/%04u",
+  snprintf(buffer, size, "%02u:%02u:%02u %02u/%02u/%04u",
            now.hour(), now.minute(), now.second(),
            now.day(), now.month(), now.year());
-  return String(buf);
 }
 
-String Model::getCurrentTimeString() const {
-  char buf[20];
-  snprintf(buf, sizeof(buf), "%02d:%02d:%02d", 
+/**
+ * @brief Formats the current time as "hh:mm:ss"
+ * @param buffer Destination (9 bytes fit the full string)
+ * @param size Size of the destination
+ */
+void Model::getCurrentTimeString(char* buffer, size_t size) const {
+  snprintf(buffer, size, "%02d:%02d:%02d", 
            m_currentTime.hour(), m_currentTime.minute(), m_currentTime.second());
-  return String(buf);
+}
+
+/**
+ * @brief Stores the latest reading of a sensor channel
+ * @param channel Sensor slot (0-based)
+ * @param reading Averaged, calibrated reading
+ * @return true if stored, false if the slot is invalid or the mutex timed out
+ */
+bool Model::setSensorReading(int channel, const SensorReading& reading) {
+  if (channel < 0 || channel >= MAX_SENSOR_CHANNELS) return false;
+  if (TRACE_TAKE(m_sensorMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_SENSOR)) {
+    m_sensorReadings[channel] = reading;
+    m_recentSensorValues[channel].push(reading.value);
+    m_sensorSequence[channel]++;
+    xSemaphoreGive(m_sensorMutex);
+    
+    // The graph screen redraws per reading; other screens ignore sensor updates
+    if (m_currentState == STATE_GRAPH && channel == m_graphChannel) {
+      notifyListeners();
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Gets the latest reading of a sensor channel
+ * @param channel Sensor slot (0-based)
+ * @param reading Destination
+ * @return true if a reading has been published for the slot
+ */
+bool Model::getSensorReading(int channel, SensorReading& reading) {
+  if (channel < 0 || channel >= MAX_SENSOR_CHANNELS) return false;
+  bool valid = false;
+  if (TRACE_TAKE(m_sensorMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_SENSOR)) {
+    reading = m_sensorReadings[channel];
+    valid = reading.timestampMs != 0;
+    xSemaphoreGive(m_sensorMutex);
+  }
+  return valid;
+}
+
+/**
+ * @brief Appends the latest readings to the history at the current RTC time
+ * @return true if a record was stored (false before the first reading,
+ *         if the clock has not advanced, or if the mutex timed out)
+ */
+bool Model::recordSensorHistory() {
+  uint32_t now = getTime().unixtime();
+  bool stored = false;
+  if (TRACE_TAKE(m_sensorMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_SENSOR)) {
+    int32_t values[MAX_SENSOR_CHANNELS];
+    bool any = false;
+    for (int i = 0; i < MAX_SENSOR_CHANNELS; i++) {
+      values[i] = m_sensorReadings[i].value;
+      any = any || m_sensorReadings[i].timestampMs != 0;
+    }
+    stored = any && m_sensorHistory.append(now, values);
+    xSemaphoreGive(m_sensorMutex);
+  }
+  return stored;
+}
+
+/**
+ * @brief Visits the history records in a time range, oldest first
+ * @param from First unix time to include
+ * @param to Last unix time to include
+ * @param visitor Called per record with the sensor mutex held (keep it short)
+ * @param context Passed to the visitor
+ * @return Number of records visited
+ */
+size_t Model::querySensorHistory(uint32_t from, uint32_t to, SensorHistory::Visitor visitor, void* context) {
+  size_t visited = 0;
+  if (TRACE_TAKE(m_sensorMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_SENSOR)) {
+    visited = m_sensorHistory.query(from, to, visitor, context);
+    xSemaphoreGive(m_sensorMutex);
+  }
+  return visited;
+}
+
+/**
+ * @brief Visits the history records of the last minutes, oldest first
+ * @param minutes Span back from the newest record
+ * @param visitor Called per record with the sensor mutex held (keep it short)
+ * @param context Passed to the visitor
+ * @return Number of records visited
+ */
+size_t Model::querySensorHistoryLast(uint32_t minutes, SensorHistory::Visitor visitor, void* context) {
+  size_t visited = 0;
+  if (TRACE_TAKE(m_sensorMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_SENSOR)) {
+    visited = m_sensorHistory.queryLast(minutes * 60, visitor, context);
+    xSemaphoreGive(m_sensorMutex);
+  }
+  return visited;
+}
+
+/**
+ * @brief Reports how much history is kept and its compressed size
+ * @param records Records currently stored
+ * @param bytes Compressed bytes in use
+ */
+void Model::getSensorHistoryStats(size_t& records, size_t& bytes) {
+  records = bytes = 0;
+  if (TRACE_TAKE(m_sensorMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_SENSOR)) {
+    records = m_sensorHistory.getRecordCount();
+    bytes = m_sensorHistory.getBytesUsed();
+    xSemaphoreGive(m_sensorMutex);
+  }
+}
+
+/**
+ * @brief Number of readings published for a slot so far
+ * @param channel Sensor slot (0-based)
+ * @return Sequence number of the newest reading (0 if none)
+ */
+uint32_t Model::getSensorSequence(int channel) const {
+  if (channel < 0 || channel >= MAX_SENSOR_CHANNELS) return 0;
+  return m_sensorSequence[channel];
+}
+
+/**
+ * @brief Copies the newest readings of a slot, oldest first
+ * @param channel Sensor slot (0-based)
+ * @param values Destination
+ * @param count Capacity of the destination
+ * @param sequence Receives the sequence number of the newest value copied (optional)
+ * @return Number of values copied
+ */
+size_t Model::copyRecentSensorValues(int channel, int32_t* values, size_t count, uint32_t* sequence) {
+  if (channel < 0 || channel >= MAX_SENSOR_CHANNELS) return 0;
+  size_t copied = 0;
+  if (TRACE_TAKE(m_sensorMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_SENSOR)) {
+    copied = m_recentSensorValues[channel].copyNewest(values, count);
+    if (sequence != nullptr) *sequence = m_sensorSequence[channel];
+    xSemaphoreGive(m_sensorMutex);
+  }
+  return copied;
+}
+
+/**
+ * @brief Moves the graph through the slots that have readings
+ * @param delta Signed detents: one slot with readings per detent, wrapping
+ */
+void Model::selectGraphChannel(int delta) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_STATE)) {
+    int channel = quadratureSelectSlot(m_graphChannel, delta, MAX_SENSOR_CHANNELS,
+                                       [this](int slot) { return m_sensorSequence[slot] != 0; });
+    if (channel != m_graphChannel) {
+      m_graphChannel = channel;
+      markStateChanged();
+    }
+    xSemaphoreGive(m_stateMutex);
+  }
+}
+
+/**
+ * @brief Rebuilds every reminder from the due times in the task list
+ * Used after an import, when task ids no longer match the armed reminders.
+ */
+void Model::syncTaskReminders() {
+  if (!TRACE_TAKE(m_schedulerMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_SCHEDULER)) return;
+  
+  for (int i = 0; i < TaskManager::MAX_TASKS; i++) {
+    m_scheduler.cancel(m_reminders[i].timer);
+    m_reminders[i].taskId = 0;
+  }
+  
+  int slot = 0;
+  uint32_t now = m_scheduler.getTime();
+  TaskSnapshot snapshot(m_taskManager);
+  for (uint16_t i = 0; i < snapshot.getTaskCount() && slot < TaskManager::MAX_TASKS; i++) {
+    const Task* task = snapshot.getTaskByIndex(i);
+    if (task->dueTime > now) {
+      m_reminders[slot].taskId = task->id;
+      m_reminders[slot].dueTime = task->dueTime;
+      m_scheduler.schedule(m_reminders[slot].timer, task->dueTime);
+      slot++;
+    }
+  }
+  xSemaphoreGive(m_schedulerMutex);
+}
+
+/**
+ * @brief Arms a caller-owned timer on the RTC clock
+ * @param timer Timer with its callback and context set
+ * @param when Unix time to run it (a past time runs on the next second)
+ * @return false if the mutex timed out
+ */
+bool Model::scheduleAction(TimerNode& timer, uint32_t when) {
+  if (TRACE_TAKE(m_schedulerMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_SCHEDULER)) {
+    m_scheduler.schedule(timer, when);
+    xSemaphoreGive(m_schedulerMutex);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Disarms a timer armed with scheduleAction()
+ * @param timer Timer to cancel (idle timers are ignored)
+ */
+void Model::cancelAction(TimerNode& timer) {
+  if (TRACE_TAKE(m_schedulerMutex, portMAX_DELAY, TRACE_MUTEX_MODEL_SCHEDULER)) {
+    m_scheduler.cancel(timer);
+    xSemaphoreGive(m_schedulerMutex);
+  }
+}
+
+/**
+ * @brief Number of reminders and actions waiting to fire
+ * @return Pending timers
+ */
+size_t Model::getPendingTimerCount() {
+  size_t pending = 0;
+  if (TRACE_TAKE(m_schedulerMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_SCHEDULER)) {
+    pending = m_scheduler.getPendingCount();
+    xSemaphoreGive(m_schedulerMutex);
+  }
+  return pending;
 }
 
 /**
@@ -89,7 +346,7 @@ String Model::getCurrentTimeString() const {
 int Model::getMenuIndex() {
   int index = 0;
   // Protect access with mutex
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(10))) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_STATE)) {
     index = m_menuIndex;
     xSemaphoreGive(m_stateMutex);
   }
@@ -102,11 +359,11 @@ int Model::getMenuIndex() {
  */
 void Model::setMenuIndex(int index) {
   // Protect access with mutex
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(100))) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_STATE)) {
     // Validate index range
     if (index >= 0 && index < m_menuLength) {
       m_menuIndex = index;
-      m_stateChanged = true;  // Mark state as changed
+      markStateChanged();
     }
     xSemaphoreGive(m_stateMutex);
   }
@@ -116,22 +373,29 @@ void Model::setMenuIndex(int index) {
  * @brief Increments menu index with wrap-around
  */
 void Model::incrementMenuIndex() {
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(100))) {
-    // Circular increment
-    m_menuIndex = (m_menuIndex + 1) % m_menuLength;
-    m_stateChanged = true;
-    xSemaphoreGive(m_stateMutex);
-  }
+  moveMenuIndex(1);
 }
 
 /**
  * @brief Decrements menu index with wrap-around
  */
 void Model::decrementMenuIndex() {
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(100))) {
-    // Circular decrement (with positive modulo)
-    m_menuIndex = (m_menuIndex - 1 + m_menuLength) % m_menuLength;
-    m_stateChanged = true;
+  moveMenuIndex(-1);
+}
+
+/**
+ * @brief Moves the menu index by several items at once, with wrap-around
+ * A fast encoder spin lands here as one update and one redraw.
+ * @param delta Items to move (positive moves down the list)
+ */
+void Model::moveMenuIndex(int delta) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_STATE)) {
+    // Circular move (with positive modulo)
+    int index = (m_menuIndex + delta % m_menuLength + m_menuLength) % m_menuLength;
+    if (index != m_menuIndex) {
+      m_menuIndex = index;
+      markStateChanged();
+    }
     xSemaphoreGive(m_stateMutex);
   }
 }
@@ -142,7 +406,7 @@ void Model::decrementMenuIndex() {
  */
 SystemState Model::getCurrentState() {
   SystemState state = STATE_MENU;  // Default fallback
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(10))) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_STATE)) {
     state = m_currentState;
     xSemaphoreGive(m_stateMutex);
   }
@@ -154,11 +418,12 @@ SystemState Model::getCurrentState() {
  * @param newState State to transition to
  */
 void Model::setState(SystemState newState) {
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(10))) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_STATE)) {
     // Only update if state actually changed
     if (m_currentState != newState) {
+      FlightRecorder::record(FLIGHT_STATE, m_currentState, newState);
       m_currentState = newState;
-      m_stateChanged = true;
+      markStateChanged();
       Serial.print("State changed to: ");
       Serial.println(newState);
     }
@@ -172,7 +437,7 @@ void Model::setState(SystemState newState) {
  */
 bool Model::hasStateChanged() {
   bool changed = false;
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(20))) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(20), TRACE_MUTEX_MODEL_STATE)) {
     changed = m_stateChanged;
     xSemaphoreGive(m_stateMutex);
   }
@@ -183,12 +448,46 @@ bool Model::hasStateChanged() {
  * @brief Clears the state changed flag
  */
 void Model::clearStateChanged() {
-  if (xSemaphoreTake(m_stateMutex, pdMS_TO_TICKS(10))) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(10), TRACE_MUTEX_MODEL_STATE)) {
     m_stateChanged = false;
     xSemaphoreGive(m_stateMutex);
   }
 }
 
+/**
+ * @brief Registers a signal to be set whenever the state changes
+ * @param signal Signal awaited by a view coroutine
+ * @return true if registered, false if the listener table is full
+ */
+bool Model::addChangeListener(CoSignal* signal) {
+  bool added = false;
+  if (signal != nullptr && TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_STATE)) {
+    if (m_changeListenerCount < MAX_CHANGE_LISTENERS) {
+      m_changeListeners[m_changeListenerCount++] = signal;
+      added = true;
+    }
+    xSemaphoreGive(m_stateMutex);
+  }
+  return added;
+}
+
+/**
+ * @brief Restores navigation state saved before deep sleep
+ * @param state State to resume in
+ * @param menuIndex Menu selection to resume with (ignored if out of range)
+ */
+void Model::restoreState(SystemState state, int menuIndex) {
+  if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_STATE)) {
+    FlightRecorder::record(FLIGHT_STATE, m_currentState, state);
+    m_currentState = state;
+    if (menuIndex >= 0 && menuIndex < m_menuLength) {
+      m_menuIndex = menuIndex;
+    }
+    markStateChanged();
+    xSemaphoreGive(m_stateMutex);
+  }
+}
+
 /**
  * @brief Gets the current menu item text
  * @return Pointer to menu item string
@@ -224,7 +523,7 @@ int Model::getMenuLength() {
  * @return true if mutex acquired, false otherwise
  */
 bool Model::acquireDisplayMutex(TickType_t timeout) {
-  return xSemaphoreTake(m_displayMutex, timeout) == pdTRUE;
+  return TRACE_TAKE(m_displayMutex, timeout, TRACE_MUTEX_MODEL_DISPLAY) == pdTRUE;
 }
 
 /**
@@ -241,5 +540,37 @@ void Model::cleanup() {
   if (m_stateMutex) vSemaphoreDelete(m_stateMutex);
   if (m_displayMutex) vSemaphoreDelete(m_displayMutex);
   if (m_timeMutex) vSemaphoreDelete(m_timeMutex);
-  m_stateMutex = m_displayMutex = m_timeMutex = nullptr;
-}
\ No newline at end of file
+  if (m_sensorMutex) vSemaphoreDelete(m_sensorMutex);
+  if (m_schedulerMutex) vSemaphoreDelete(m_schedulerMutex);
+  m_stateMutex = m_displayMutex = m_timeMutex = m_sensorMutex = m_schedulerMutex = nullptr;
+}
+
+// Private helper methods
+void Model::markStateChanged() {
+  m_stateChanged = true;
+  notifyListeners();
+}
+
+void Model::notifyListeners() {
+  // Views block until notified instead of polling
+  for (int i = 0; i < m_changeListenerCount; i++) {
+    m_changeListeners[i]->set();
+  }
+}
+
+uint32_t Model::reminderFired(TimerNode* timer, uint32_t now, void* context) {
+  // Runs inside updateTime() with m_schedulerMutex held, which also keeps the
+  // event queue single-producer
+  TaskReminder* reminder = static_cast<TaskReminder*>(context);
+  if (reminder->taskId != 0) {
+    // The task list can change without the reminders (getTaskManager() edits,
+    // a reset that hands the id to a new task); only the armed due time counts
+    Task task;
+    if (m_instance->m_taskManager.getTask(reminder->taskId, task) &&
+        task.dueTime == reminder->dueTime) {
+      m_instance->m_events.push(ModelEvent(MODEL_EVENT_TASK_DUE, reminder->taskId, now));
+    }
+    reminder->taskId = 0;
+  }
+  return 0;   // One-shot
+}
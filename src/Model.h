@@ -5,13 +5,19 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include "RTClib.h"
+#include "Coroutine.h"
+#include "TimeSeriesStore.h"
+#include "RingBuffer.h"
+#include "TaskManager.h"
+#include "TimerWheel.h"
 
 // System state machine states
 enum SystemState {
   STATE_MENU,
   STATE_SETTINGS,
   STATE_ABOUT,
-  STATE_CONFIRM_EXIT
+  STATE_CONFIRM_EXIT,
+  STATE_GRAPH
 };
 
 // System event types for state transitions
@@ -22,11 +28,44 @@ enum SystemEvent {
   EVENT_RIGHT,
   EVENT_SELECT1,
   EVENT_SELECT2,
+  EVENT_SCROLL,     // Encoder turn; the InputEvent carries the detents
   EVENT_TIMEOUT,
   EVENT_NONE
 };
 
+// Averaged sensor value published by the SensorPipeline
+struct SensorReading {
+  int32_t value;          // Calibrated (millivolts by default)
+  uint16_t raw;           // Average raw conversion
+  uint16_t samples;       // Decimated samples in the average
+  uint32_t timestampMs;   // When it was published (0: never)
+
+  SensorReading() : value(0), raw(0), samples(0), timestampMs(0) {}
+};
+
+// Events raised by the scheduler for the controller
+enum ModelEventType {
+  MODEL_EVENT_TASK_DUE
+};
+
+struct ModelEvent {
+  uint8_t type;     // ModelEventType
+  uint16_t id;      // Task ID for MODEL_EVENT_TASK_DUE
+  uint32_t time;    // Unix time it fired
+
+  ModelEvent() : type(MODEL_EVENT_TASK_DUE), id(0), time(0) {}
+  ModelEvent(uint8_t t, uint16_t i, uint32_t when) : type(t), id(i), time(when) {}
+};
+
 class Model {
+public:
+  static const int MAX_SENSOR_CHANNELS = 4;
+  static const uint32_t SENSOR_HISTORY_PERIOD_S = 60;
+  static const size_t RECENT_SENSOR_VALUES = 128;   // One OLED column each
+
+  // Per-minute sensor values (calibrated), compressed: ~1.5 bytes per record in 4.4 KB
+  typedef TimeSeriesStore<MAX_SENSOR_CHANNELS> SensorHistory;
+
 private:
   // Singleton instance
   static Model* m_instance;  // <-- This is the crucial declaration
@@ -50,6 +89,42 @@ private:
   SemaphoreHandle_t m_timeMutex;
   bool m_rtcAvailable = false;
 
+  // Latest sensor readings (not part of the navigation state: no change signal)
+  SensorReading m_sensorReadings[MAX_SENSOR_CHANNELS];
+  SensorHistory m_sensorHistory;
+  RingBuffer<int32_t, RECENT_SENSOR_VALUES> m_recentSensorValues[MAX_SENSOR_CHANNELS];
+  volatile uint32_t m_sensorSequence[MAX_SENSOR_CHANNELS];   // Readings published per slot
+  volatile int m_graphChannel;
+  SemaphoreHandle_t m_sensorMutex;
+
+  // Tasks, their reminders and scheduled actions on the RTC timebase (seconds)
+  struct TaskReminder {
+    TimerNode timer;
+    uint16_t taskId;   // 0: slot free
+    uint32_t dueTime;  // Task due time the reminder was armed for
+  };
+  TaskManager m_taskManager;
+  TimerWheel m_scheduler;
+  TaskReminder m_reminders[TaskManager::MAX_TASKS];
+  SemaphoreHandle_t m_schedulerMutex;
+  
+  // Produced by timer callbacks (scheduler mutex held), consumed by the controller
+  CoQueue<ModelEvent, 8> m_events;
+
+  // Signals set when the navigation state changes
+  static const int MAX_CHANGE_LISTENERS = 4;
+  CoSignal* m_changeListeners[MAX_CHANGE_LISTENERS];
+  int m_changeListenerCount;
+
+  // Marks the state changed and wakes listeners (caller holds m_stateMutex)
+  void markStateChanged();
+  
+  // Wakes listeners without marking a navigation change (new content only)
+  void notifyListeners();
+
+  // Reminder expiry: raises MODEL_EVENT_TASK_DUE if the task still has that due time
+  static uint32_t reminderFired(TimerNode* timer, uint32_t now, void* context);
+
   // Private constructor for singleton
   Model();
 
@@ -67,15 +142,55 @@ public:
   // Time management
   void updateTime();
   DateTime getTime();
-  String getFormattedTime();
-  String getCurrentTimeString() const;
+  void getFormattedTime(char* buffer, size_t size);
+  void getCurrentTimeString(char* buffer, size_t size) const;
   void setCurrentTime(const DateTime& dt) { m_currentTime = dt; }
 
+  // Sensor readings
+  bool setSensorReading(int channel, const SensorReading& reading);
+  bool getSensorReading(int channel, SensorReading& reading);
+  
+  // Sensor history, timestamped with the RTC time (unix seconds)
+  bool recordSensorHistory();
+  size_t querySensorHistory(uint32_t from, uint32_t to, SensorHistory::Visitor visitor, void* context);
+  size_t querySensorHistoryLast(uint32_t minutes, SensorHistory::Visitor visitor, void* context);
+  void getSensorHistoryStats(size_t& records, size_t& bytes);
+  
+  // Recent readings at the publish rate, for graphs; the sequence counts publishes
+  uint32_t getSensorSequence(int channel) const;
+  size_t copyRecentSensorValues(int channel, int32_t* values, size_t count, uint32_t* sequence);
+  
+  // Sensor slot shown by the graph screen
+  int getGraphChannel() const { return m_graphChannel; }
+  void selectGraphChannel(int delta);
+
+  // Task list (callers serialize access). Reminders are armed from the tasks'
+  // due times by syncTaskReminders(); one whose task was deleted, replaced or
+  // given another due time since then does not fire.
+  TaskManager& getTaskManager() { return m_taskManager; }
+  
+  // Re-arms reminders from the tasks' due times after a change (past ones are dropped);
+  // MODEL_EVENT_TASK_DUE is raised when updateTime() reaches a due time
+  void syncTaskReminders();
+  
+  // Scheduled actions: the callback runs on the task calling updateTime(), with the
+  // scheduler lock held; it re-arms through its return value and must not call back
+  // into the scheduler
+  bool scheduleAction(TimerNode& timer, uint32_t when);
+  void cancelAction(TimerNode& timer);
+  size_t getPendingTimerCount();
+  
+  // Scheduler events; pollEvent registers the caller to be woken by the next one
+  bool pollEvent(ModelEvent& event, Coroutine* waiter) { return m_events.pop(event, waiter); }
+  bool hasPendingEvents() const { return !m_events.isEmpty(); }
+  uint32_t getDroppedEventCount() const { return m_events.getDropCount(); }
+
   // Menu operations
   int getMenuIndex();
   void setMenuIndex(int index);
   void incrementMenuIndex();
   void decrementMenuIndex();
+  void moveMenuIndex(int delta);
   
   // State operations
   SystemState getCurrentState();
@@ -83,6 +198,12 @@ public:
   bool hasStateChanged();
   void clearStateChanged();
   
+  // Registers a signal to be set on every state change
+  bool addChangeListener(CoSignal* signal);
+  
+  // Restores navigation state from a sleep snapshot
+  void restoreState(SystemState state, int menuIndex);
+  
   // Menu data access
   const char* getCurrentMenuItem();
   const char* getMenuItem(int index);
@@ -1,17 +1,25 @@
 #include "OLEDView.h"
+#include "Trace.h"
+#include "TaskConfig.h"
 
 /**
  * @brief Constructor - Initializes the OLED display view
  * @param name Task name
  * @param stackSize Task stack size in bytes
  */
-OLEDView::OLEDView() : View("OLED Task", 250), m_oled(nullptr) {
+template <typename Panel>
+BasicOLEDView<Panel>::BasicOLEDView()
+  : Base("OLED Task", VIEW_OLED_INTERVAL_MS),
+    m_display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET),
+    m_oled(nullptr), m_graphValid(false), m_graphChannel(0), m_graphCursor(0),
+    m_graphMin(0), m_graphMax(0), m_graphLast(0) {
 }
 
 /**
  * @brief Destructor - Cleans up display resources
  */
-OLEDView::~OLEDView() {
+template <typename Panel>
+BasicOLEDView<Panel>::~BasicOLEDView() {
   cleanup();
 }
 
@@ -19,208 +27,281 @@ OLEDView::~OLEDView() {
  * @brief Initializes the OLED display hardware
  * @return true if initialization succeeded, false otherwise
  */
-bool OLEDView::initializeDisplay() {
-  // Create new SSD1306 display instance
-  m_oled = new Adafruit_SSD1306(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
-  
-  // Attempt to initialize the display
-  if (!m_oled->begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
+template <typename Panel>
+bool BasicOLEDView<Panel>::initializeDisplay() {
+  // The driver object is a member; begin() allocates the frame buffer once
+  if (!m_display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
     Serial.println("OLED allocation failed");
-    delete m_oled;
-    m_oled = nullptr;
     return false;
   }
+  m_oled = &m_display;
   
   // Initial display setup
   m_oled->clearDisplay();
   m_oled->setTextSize(1);              // Normal 1:1 pixel scale
   m_oled->setTextColor(SSD1306_WHITE); // Draw white text
+  
+  // On a warm start the panel still holds the last frame; the first render replaces it
+  if (m_warmStart) {
+    return true;
+  }
+  
   m_oled->setCursor(0, 0);             // Start at top-left corner
   m_oled->println("System Starting...");
-  m_oled->display();                   // Show initial message
+  flushDisplay();                      // Show initial message
   
   return true;
 }
 
+/**
+ * @brief Turns the panel off for sleep (GDDRAM is retained) or back on
+ * @param on true to turn the panel on
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::setDisplayPower(bool on) {
+  if (m_oled == nullptr) return;
+  m_oled->ssd1306_command(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+}
+
 /**
  * @brief Cleans up display resources
  */
-void OLEDView::cleanup() {
+template <typename Panel>
+void BasicOLEDView<Panel>::cleanup() {
   if (m_oled != nullptr) {
     // Clear display before shutting down
     m_oled->clearDisplay();
-    m_oled->display();
-    delete m_oled;
+    flushDisplay();
     m_oled = nullptr;
   }
 }
 
 /**
- * @brief FreeRTOS task wrapper function
- * @param pvParameters Pointer to the OLEDView instance
+ * @brief Prepares a frame before the state renderer runs
+ * @param state State about to be rendered
+ * @return false if the display is not initialized
  */
-void OLEDView::taskWrapper(void* pvParameters) {
-  OLEDView* view = static_cast<OLEDView*>(pvParameters);
-  view->displayTask();
-}
-
-/**
- * @brief Main display rendering function
- * Calls appropriate state-specific renderer based on current model state
- */
-void OLEDView::renderDisplay() {
-  if (m_oled == nullptr) return;
-  
-  // Get current system state from model
-  SystemState currentState = m_model->getCurrentState();
+template <typename Panel>
+bool BasicOLEDView<Panel>::beginFrame(SystemState state) {
+  if (m_oled == nullptr) return false;
   
-  // Render appropriate view based on state
-  switch (currentState) {
-    case STATE_MENU:
-      renderMenuState();
-      break;
-    case STATE_SETTINGS:
-      renderSettingsState();
-      break;
-    case STATE_ABOUT:
-      renderAboutState();
-      break;
-    case STATE_CONFIRM_EXIT:
-      renderConfirmExitState();
-      break;
+  // Any other screen overwrites the graph; it is redrawn in full next time
+  if (state != STATE_GRAPH) {
+    m_graphValid = false;
   }
+  return true;
 }
 
 // State-specific renderers
-void OLEDView::renderMenuState() {
+template <typename Panel>
+void BasicOLEDView<Panel>::renderMenuState() {
   drawMenu();
 }
 
-void OLEDView::renderSettingsState() {
+template <typename Panel>
+void BasicOLEDView<Panel>::renderSettingsState() {
   drawSettings();
 }
 
-void OLEDView::renderAboutState() {
+template <typename Panel>
+void BasicOLEDView<Panel>::renderAboutState() {
   drawAbout();
 }
 
-void OLEDView::renderConfirmExitState() {
+template <typename Panel>
+void BasicOLEDView<Panel>::renderConfirmExitState() {
   drawConfirmExit();
 }
 
+/**
+ * @brief Renders the sensor graph incrementally
+ * New samples are plotted in sweep mode: each one replaces the column at the
+ * cursor and blanks the column ahead as a gap, and only those columns are sent
+ * (6 bytes each), so the rest of the panel is never retransmitted. A channel
+ * change, a value outside the current scale or a long backlog redraws it all.
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::renderGraphState() {
+  int channel = m_model->getGraphChannel();
+  if (!m_graphValid || channel != m_graphChannel) {
+    drawGraphFull(channel);
+    return;
+  }
+  
+  uint32_t sequence = 0;
+  size_t count = m_model->copyRecentSensorValues(channel, m_graphValues, GRAPH_MAX_INCREMENT, &sequence);
+  uint32_t fresh = sequence - m_graphSequence;
+  if (fresh == 0) return;
+  if (fresh > count) {
+    drawGraphFull(channel);
+    return;
+  }
+  
+  const int32_t* values = m_graphValues + (count - fresh);
+  for (uint32_t i = 0; i < fresh; i++) {
+    if (values[i] < m_graphMin || values[i] > m_graphMax) {
+      drawGraphFull(channel);
+      return;
+    }
+  }
+  
+  for (uint32_t i = 0; i < fresh; i++) {
+    int gap = (m_graphCursor + 1) % GRAPH_WIDTH;
+    plotGraphColumn(m_graphCursor, m_graphLast, values[i]);
+    clearGraphColumn(gap);
+    sendGraphColumn(m_graphCursor);
+    sendGraphColumn(gap);
+    m_graphLast = values[i];
+    m_graphCursor = gap;
+  }
+  m_graphSequence = sequence;
+}
+
 /**
  * @brief Renders the main menu view
  */
-void OLEDView::drawMenu() {
+template <typename Panel>
+void BasicOLEDView<Panel>::drawMenu() {
   m_oled->clearDisplay();
-  drawHeader("Main Menu");
+  
+  // The header shows the most urgent open task (O(1) from the priority buckets)
+  Task next;
+  if (m_model->getTaskManager().getNextTask(next)) {
+    char header[Layout::TEXT_COLUMNS + 1];
+    snprintf(header, sizeof(header), "Next: %s", next.title);
+    drawHeader(header);
+  } else {
+    drawHeader("Main Menu");
+  }
   
   // Get menu information from model
   int menuLength = m_model->getMenuLength();
   int currentIndex = m_model->getMenuIndex();
   
-  // Draw all menu items
-  for (int i = 0; i < menuLength; i++) {
-    drawMenuItem(i, i == currentIndex);
+  // Draw the items that fit, scrolled to keep the selection visible
+  int first = (currentIndex >= Layout::MENU_ROWS) ? currentIndex - Layout::MENU_ROWS + 1 : 0;
+  for (int row = 0; row < Layout::MENU_ROWS && first + row < menuLength; row++) {
+    drawMenuItem(first + row, row, first + row == currentIndex);
   }
   
   // Add navigation hint at bottom
-  m_oled->setCursor(0, SCREEN_HEIGHT - 8);
-  m_oled->setTextSize(1);
-  m_oled->print("UP/DOWN: Navigate SELECT: Choose");
+  if (Layout::HAS_FOOTER) {
+    m_oled->setCursor(0, Layout::FOOTER_Y);
+    m_oled->setTextSize(1);
+    m_oled->print("UP/DOWN: Navigate SELECT: Choose");
+  }
   
-  m_oled->display();
+  flushDisplay();
 }
 
 /**
  * @brief Renders the settings view
  */
-void OLEDView::drawSettings() {
+template <typename Panel>
+void BasicOLEDView<Panel>::drawSettings() {
   m_oled->clearDisplay();
   drawHeader("Settings");
   
   // Draw settings content
-  m_oled->setCursor(0, 20);
-  m_oled->setTextSize(1);
-  m_oled->println("System Configuration");
-  m_oled->println("");
-  m_oled->println("Version: 1.0.0");
-  m_oled->println("FreeRTOS: Active");
-  m_oled->println("Display: OLED + LCD");
+  static const char* const lines[] = {
+    "System Configuration", "", "Version: 1.0.0", "FreeRTOS: Active", "Display: OLED + LCD"
+  };
+  drawBody(lines, sizeof(lines) / sizeof(lines[0]));
   
   // Add navigation hint
-  m_oled->setCursor(0, SCREEN_HEIGHT - 8);
-  m_oled->print("LEFT/SELECT2: Back");
+  if (Layout::HAS_FOOTER) {
+    m_oled->setCursor(0, Layout::FOOTER_Y);
+    m_oled->print("LEFT/SELECT2: Back");
+  }
   
-  m_oled->display();
+  flushDisplay();
 }
 
 /**
  * @brief Renders the about view
  */
-void OLEDView::drawAbout() {
+template <typename Panel>
+void BasicOLEDView<Panel>::drawAbout() {
   m_oled->clearDisplay();
   drawHeader("About");
   
   // Draw about content
-  m_oled->setCursor(0, 20);
-  m_oled->setTextSize(1);
-  m_oled->println("ESP32 Menu System");
-  m_oled->println("MVC Architecture");
-  m_oled->println("FreeRTOS Tasks");
-  m_oled->println("");
-  m_oled->println("Dual Display Support");
+  static const char* const lines[] = {
+    "ESP32 Menu System", "MVC Architecture", "FreeRTOS Tasks", "", "Dual Display Support"
+  };
+  drawBody(lines, sizeof(lines) / sizeof(lines[0]));
   
   // Add navigation hint
-  m_oled->setCursor(0, SCREEN_HEIGHT - 8);
-  m_oled->print("LEFT/SELECT2: Back");
+  if (Layout::HAS_FOOTER) {
+    m_oled->setCursor(0, Layout::FOOTER_Y);
+    m_oled->print("LEFT/SELECT2: Back");
+  }
   
-  m_oled->display();
+  flushDisplay();
 }
 
 /**
  * @brief Renders the exit confirmation view
  */
-void OLEDView::drawConfirmExit() {
+template <typename Panel>
+void BasicOLEDView<Panel>::drawConfirmExit() {
   m_oled->clearDisplay();
   drawHeader("Confirm Exit");
   
-  // Draw confirmation prompt
-  m_oled->setCursor(0, 25);
-  m_oled->setTextSize(2);
-  m_oled->println("EXIT?");
+  // Draw confirmation prompt (the header alone says it on short panels)
+  if (Layout::SHOW_PROMPT) {
+    m_oled->setCursor(0, Layout::PROMPT_Y);
+    m_oled->setTextSize(2);
+    m_oled->print("EXIT?");
+  }
   
   // Draw options
   m_oled->setTextSize(1);
-  m_oled->setCursor(0, 45);
-  m_oled->println("SELECT1: Yes");
-  m_oled->println("LEFT/SELECT2: No");
+  m_oled->setCursor(0, Layout::OPTIONS_Y);
+  m_oled->print("SELECT1: Yes");
+  m_oled->setCursor(0, Layout::OPTIONS_Y + Layout::LINE_HEIGHT);
+  m_oled->print("LEFT/SELECT2: No");
   
-  m_oled->display();
+  flushDisplay();
 }
 
 /**
  * @brief Draws a standard header for views
  * @param title Header text to display
  */
-void OLEDView::drawHeader(const char* title) {
+template <typename Panel>
+void BasicOLEDView<Panel>::drawHeader(const char* title) {
   m_oled->setTextSize(1);
   m_oled->setCursor(0, 0);
   m_oled->print(title);
   
   // Draw underline below header
-  for (int x = 0; x < SCREEN_WIDTH; x++) {
-    m_oled->drawPixel(x, 10, SSD1306_WHITE);
+  m_oled->drawFastHLine(0, Layout::HEADER_RULE_Y, SCREEN_WIDTH, SSD1306_WHITE);
+}
+
+/**
+ * @brief Draws text lines below the header, as many as the panel has room for
+ * @param lines Lines to draw
+ * @param count Number of lines
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::drawBody(const char* const* lines, int count) {
+  m_oled->setTextSize(1);
+  for (int i = 0; i < count && i < Layout::BODY_LINES; i++) {
+    m_oled->setCursor(0, Layout::bodyLineY(i));
+    m_oled->print(lines[i]);
   }
 }
 
 /**
  * @brief Draws a single menu item
  * @param index Item position in menu
+ * @param row Screen row to draw it on
  * @param selected Whether this item is currently selected
  */
-void OLEDView::drawMenuItem(int index, bool selected) {
-  int y = 15 + (index * 10);  // Calculate Y position based on index
+template <typename Panel>
+void BasicOLEDView<Panel>::drawMenuItem(int index, int row, bool selected) {
+  int y = Layout::menuRowY(row);
   
   m_oled->setTextSize(1);
   m_oled->setCursor(0, y);
@@ -228,7 +309,7 @@ void OLEDView::drawMenuItem(int index, bool selected) {
   if (selected) {
     m_oled->print("> ");  // Selection indicator
     // Highlight background for selected item
-    m_oled->fillRect(15, y, 80, 8, SSD1306_WHITE);
+    m_oled->fillRect(Layout::MENU_SELECT_X, y, Layout::MENU_SELECT_WIDTH, Layout::LINE_HEIGHT, SSD1306_WHITE);
     m_oled->setTextColor(SSD1306_BLACK);  // Black text on white background
   } else {
     m_oled->print("  ");  // Empty space for unselected items
@@ -240,4 +321,137 @@ void OLEDView::drawMenuItem(int index, bool selected) {
   
   // Reset text color to default
   m_oled->setTextColor(SSD1306_WHITE);
-}
\ No newline at end of file
+}
+/**
+ * @brief Redraws the whole graph screen, rescaling to the samples shown
+ * @param channel Sensor slot to plot
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::drawGraphFull(int channel) {
+  uint32_t sequence = 0;
+  size_t count = m_model->copyRecentSensorValues(channel, m_graphValues, GRAPH_WIDTH, &sequence);
+  
+  m_oled->clearDisplay();
+  char title[Layout::TEXT_COLUMNS + 1];
+  
+  if (count == 0) {
+    snprintf(title, sizeof(title), "Sensor %d", channel + 1);
+    drawHeader(title);
+    m_oled->setCursor(0, Layout::GRAPH_MESSAGE_Y);
+    m_oled->print("No readings yet");
+  } else {
+    // Scale to the visible samples with some headroom, so small drifts stay incremental
+    int32_t low = m_graphValues[0];
+    int32_t high = m_graphValues[0];
+    for (size_t i = 1; i < count; i++) {
+      if (m_graphValues[i] < low) low = m_graphValues[i];
+      if (m_graphValues[i] > high) high = m_graphValues[i];
+    }
+    int32_t margin = (high - low) / 4;
+    if (high - low + 2 * margin < GRAPH_MIN_SPAN) margin = (GRAPH_MIN_SPAN - (high - low)) / 2;
+    m_graphMin = low - margin;
+    m_graphMax = high + margin;
+    
+    snprintf(title, sizeof(title), "S%d %ld..%ld mV", channel + 1,
+             (long)m_graphMin, (long)m_graphMax);
+    drawHeader(title);
+    
+    // Oldest sample at column 0; the cursor continues after the newest
+    int32_t previous = m_graphValues[0];
+    for (size_t i = 0; i < count; i++) {
+      plotGraphColumn(static_cast<int>(i), previous, m_graphValues[i]);
+      previous = m_graphValues[i];
+    }
+    m_graphLast = previous;
+    m_graphCursor = static_cast<int>(count % GRAPH_WIDTH);
+    clearGraphColumn(m_graphCursor);
+  }
+  
+  flushDisplay();
+  m_graphChannel = channel;
+  m_graphSequence = sequence;
+  m_graphValid = true;
+}
+
+/**
+ * @brief Draws one sample as a vertical segment joining it to the previous one
+ * @param x Column
+ * @param from Previous value
+ * @param to New value
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::plotGraphColumn(int x, int32_t from, int32_t to) {
+  clearGraphColumn(x);
+  int y0 = graphY(from);
+  int y1 = graphY(to);
+  if (y0 > y1) {
+    int swap = y0;
+    y0 = y1;
+    y1 = swap;
+  }
+  m_oled->drawFastVLine(x, y0, y1 - y0 + 1, SSD1306_WHITE);
+}
+
+/**
+ * @brief Blanks one column of the graph area in the frame buffer
+ * @param x Column
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::clearGraphColumn(int x) {
+  m_oled->drawFastVLine(x, Layout::GRAPH_TOP, Layout::GRAPH_HEIGHT, SSD1306_BLACK);
+}
+
+/**
+ * @brief Maps a value to a graph row (larger values higher up)
+ * @param value Sample within the current scale
+ * @return Row in the graph area
+ */
+template <typename Panel>
+int BasicOLEDView<Panel>::graphY(int32_t value) const {
+  int32_t span = m_graphMax - m_graphMin;
+  int32_t offset = (value - m_graphMin) * (Layout::GRAPH_HEIGHT - 1) / (span > 0 ? span : 1);
+  return Layout::GRAPH_TOP + Layout::GRAPH_HEIGHT - 1 - static_cast<int>(offset);
+}
+
+/**
+ * @brief Sends the whole frame buffer to the panel
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::flushDisplay() {
+  TRACE_BEGIN(TRACE_ID_I2C, FRAME_BYTES);
+  m_oled->display();
+  TRACE_END(TRACE_ID_I2C, FRAME_BYTES);
+}
+
+/**
+ * @brief Sends one graph column from the frame buffer to the panel
+ * Sets a one-column window over the graph pages (horizontal addressing wraps to
+ * the next page after each byte), then writes the column's bytes top to bottom.
+ * @param x Column
+ */
+template <typename Panel>
+void BasicOLEDView<Panel>::sendGraphColumn(int x) {
+  const uint8_t* buffer = m_oled->getBuffer();
+  
+  TRACE_BEGIN(TRACE_ID_I2C, GRAPH_COLUMN_BYTES);
+  Wire.beginTransmission(OLED_ADDR);
+  Wire.write(static_cast<uint8_t>(0x00));   // Co = 0, D/C = 0: command stream
+  Wire.write(static_cast<uint8_t>(SSD1306_COLUMNADDR));
+  Wire.write(static_cast<uint8_t>(x));
+  Wire.write(static_cast<uint8_t>(x));
+  Wire.write(static_cast<uint8_t>(SSD1306_PAGEADDR));
+  Wire.write(static_cast<uint8_t>(Layout::GRAPH_FIRST_PAGE));
+  Wire.write(static_cast<uint8_t>(Layout::GRAPH_LAST_PAGE));
+  Wire.endTransmission();
+  
+  Wire.beginTransmission(OLED_ADDR);
+  Wire.write(static_cast<uint8_t>(0x40));   // D/C = 1: data stream
+  for (int page = Layout::GRAPH_FIRST_PAGE; page <= Layout::GRAPH_LAST_PAGE; page++) {
+    Wire.write(buffer[x + page * SCREEN_WIDTH]);
+  }
+  Wire.endTransmission();
+  TRACE_END(TRACE_ID_I2C, GRAPH_COLUMN_BYTES);
+}
+
+// Layouts are folded per panel size; only the fitted panel is instantiated
+template class BasicOLEDView<OledPanel>;
@@ -5,15 +5,43 @@
 #include <Adafruit_SSD1306.h>
 #include <Wire.h>
 
-class OLEDView : public View {
+// SSD1306 view for a Panel of WIDTH x HEIGHT pixels (instantiated in OledView.cpp)
+template <typename Panel>
+class BasicOLEDView : public ViewBase<BasicOLEDView<Panel>, Panel> {
 private:
+  typedef ViewBase<BasicOLEDView, Panel> Base;
+  typedef OledLayout<Panel> Layout;
+  friend class ViewBase<BasicOLEDView, Panel>;
+  
+  using Base::m_model;
+  using Base::m_warmStart;
+  using Base::m_graphSequence;
+  
   // OLED configuration
-  static const int SCREEN_WIDTH = 128;
-  static const int SCREEN_HEIGHT = 64;
+  static const int SCREEN_WIDTH = Panel::WIDTH;
+  static const int SCREEN_HEIGHT = Panel::HEIGHT;
   static const int OLED_ADDR = 0x3C;
   static const int OLED_RESET = -1;
+  static const uint16_t FRAME_BYTES = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+  
+  // Graph screen: sweep-mode plot below the header (see OledLayout)
+  static const int GRAPH_WIDTH = SCREEN_WIDTH;
+  static const int GRAPH_MAX_INCREMENT = 32;   // More new samples than this: redraw everything
+  static const int32_t GRAPH_MIN_SPAN = 64;
+  // Bytes of both transmissions in sendGraphColumn(): window commands, then one byte per page
+  static const uint16_t GRAPH_COLUMN_BYTES = 8 + Layout::GRAPH_LAST_PAGE - Layout::GRAPH_FIRST_PAGE + 1;
+  
+  Adafruit_SSD1306 m_display;
+  Adafruit_SSD1306* m_oled;   // &m_display once begin() succeeded
   
-  Adafruit_SSD1306* m_oled;
+  // Graph state (bus worker only)
+  bool m_graphValid;          // Panel shows a complete graph of m_graphChannel
+  int m_graphChannel;
+  int m_graphCursor;          // Column of the next sample; the column after it is the gap
+  int32_t m_graphMin;
+  int32_t m_graphMax;
+  int32_t m_graphLast;        // Newest plotted value, joined to the next one
+  int32_t m_graphValues[GRAPH_WIDTH];
   
   // Display helper methods
   void drawMenu();
@@ -21,26 +49,37 @@ private:
   void drawAbout();
   void drawConfirmExit();
   void drawHeader(const char* title);
-  void drawMenuItem(int index, bool selected);
+  void drawMenuItem(int index, int row, bool selected);
+  void drawBody(const char* const* lines, int count);
+  void drawGraphFull(int channel);
+  void plotGraphColumn(int x, int32_t from, int32_t to);
+  void clearGraphColumn(int x);
+  int graphY(int32_t value) const;
+  void sendGraphColumn(int x);
+  void flushDisplay();
 
 protected:
-  // Override virtual methods from View
-  bool initializeDisplay() override;
-  void renderDisplay() override;
-  void cleanup() override;
-  
-  // Static task wrapper for this specific view
-  static void taskWrapper(void* pvParameters);
+  // Hooks called by ViewBase
+  bool initializeDisplay();
+  bool beginFrame(SystemState state);
+  void cleanup();
 
 public:
-  OLEDView();
-  virtual ~OLEDView();
-  
-  // Override display state methods
-  void renderMenuState() override;
-  void renderSettingsState() override;
-  void renderAboutState() override;
-  void renderConfirmExitState() override;
+  BasicOLEDView();
+  ~BasicOLEDView();
+  
+  // Panel on/off for sleep
+  void setDisplayPower(bool on);
+  
+  // Display state renderers
+  void renderMenuState();
+  void renderSettingsState();
+  void renderAboutState();
+  void renderConfirmExitState();
+  void renderGraphState();
 };
 
+// The fitted panel (see DisplayLayout.h)
+typedef BasicOLEDView<OledPanel> OLEDView;
+
 #endif // OLEDVIEW_H
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "PowerManager.h"
+#include <esp_timer.h>
+
+// Initialize static members
+PowerManager* PowerManager::m_instance = nullptr;
+volatile int64_t PowerManager::s_edgeTimeUs = 0;
+
+PowerManager::PowerManager()
+  : m_mutex(nullptr), m_pmAvailable(false), m_boosted(false), m_interacting(false), m_renderDepth(0),
+    m_holdUntilUs(0), m_boostStartUs(0), m_startUs(0),
+    m_interactions(0), m_latencyCount(0), m_latencyTotalUs(0),
+    m_latencyLastUs(0), m_latencyMaxUs(0), m_boostedUs(0),
+    m_idleObserver(nullptr), m_idleContext(nullptr) {
+#if CONFIG_PM_ENABLE
+  m_cpuLock = nullptr;
+  m_sleepLock = nullptr;
+#endif
+}
+
+PowerManager* PowerManager::getInstance() {
+  if (m_instance == nullptr) {
+    m_instance = new PowerManager();
+  }
+  return m_instance;
+}
+
+/**
+ * @brief Configures dynamic frequency scaling and tickless idle
+ * @return true if the policy is active (esp_pm or fallback)
+ */
+bool PowerManager::initialize() {
+  m_mutex = xSemaphoreCreateMutex();
+  if (m_mutex == nullptr) {
+    Serial.println("Failed to create power manager mutex");
+    return false;
+  }
+  m_startUs = esp_timer_get_time();
+
+#if CONFIG_PM_ENABLE
+  esp_pm_config_esp32_t config = {};
+  config.max_freq_mhz = MAX_FREQ_MHZ;
+  config.min_freq_mhz = MIN_FREQ_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  config.light_sleep_enable = true;
+#endif
+
+  if (esp_pm_configure(&config) == ESP_OK &&
+      esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ui-active", &m_cpuLock) == ESP_OK &&
+      esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ui-awake", &m_sleepLock) == ESP_OK) {
+    m_pmAvailable = true;
+    Serial.println("Power management: esp_pm DFS enabled");
+  }
+#endif
+
+  if (!m_pmAvailable) {
+    // No esp_pm in this SDK build: scale the clock directly
+    setCpuFrequencyMhz(MIN_FREQ_MHZ);
+    Serial.println("Power management: manual frequency scaling");
+  }
+  return true;
+}
+
+/**
+ * @brief Starts or extends the interaction window
+ */
+void PowerManager::noteActivity() {
+  if (m_mutex == nullptr) return;
+  bool started = false;
+  if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(10))) {
+    m_holdUntilUs = esp_timer_get_time() + INTERACTION_HOLD_MS * 1000LL;
+    if (!m_boosted) {
+      m_interactions++;
+      boost();
+    }
+    started = !m_interacting;
+    m_interacting = true;
+    xSemaphoreGive(m_mutex);
+  }
+  if (started && m_idleObserver != nullptr) {
+    m_idleObserver(m_idleContext, false);
+  }
+}
+
+/**
+ * @brief Records latency from the button edge to the woken task
+ * Includes the light sleep exit and clock ramp when idle.
+ */
+void PowerManager::noteWake() {
+  int64_t edge = s_edgeTimeUs;
+  if (edge == 0) return;
+  s_edgeTimeUs = 0;
+
+  uint32_t latency = static_cast<uint32_t>(esp_timer_get_time() - edge);
+  m_latencyLastUs = latency;
+  if (latency > m_latencyMaxUs) m_latencyMaxUs = latency;
+  m_latencyTotalUs += latency;
+  m_latencyCount++;
+}
+
+/**
+ * @brief Ends the interaction window once it has expired and no render holds it
+ * The idle observer is told here, whether or not a render released the locks first.
+ */
+void PowerManager::poll() {
+  if (m_mutex == nullptr || (!m_boosted && !m_interacting)) return;
+  bool ended = false;
+  if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(10))) {
+    if (esp_timer_get_time() >= m_holdUntilUs) {
+      if (m_boosted && m_renderDepth == 0) {
+        unboost();
+      }
+      ended = m_interacting;
+      m_interacting = false;
+    }
+    xSemaphoreGive(m_mutex);
+  }
+  if (ended && m_idleObserver != nullptr) {
+    m_idleObserver(m_idleContext, true);
+  }
+}
+
+/**
+ * @brief Holds max frequency for a render burst
+ */
+void PowerManager::beginRender() {
+  if (m_mutex == nullptr) return;
+  if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(10))) {
+    // Changing the clock costs more than an idle render; only esp_pm locks are cheap
+    if (m_renderDepth++ == 0 && m_pmAvailable && !m_boosted) {
+      boost();
+    }
+    xSemaphoreGive(m_mutex);
+  }
+}
+
+void PowerManager::endRender() {
+  if (m_mutex == nullptr) return;
+  if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(10))) {
+    if (m_renderDepth > 0 && --m_renderDepth == 0 &&
+        m_boosted && esp_timer_get_time() >= m_holdUntilUs) {
+      unboost();
+    }
+    xSemaphoreGive(m_mutex);
+  }
+}
+
+/**
+ * @brief Records the first button edge of an interaction (ISR context)
+ */
+void IRAM_ATTR PowerManager::markButtonEdgeFromISR() {
+  if (s_edgeTimeUs == 0) {
+    s_edgeTimeUs = esp_timer_get_time();
+  }
+}
+
+/**
+ * @brief Returns power metrics
+ * @return Snapshot of the current metrics
+ */
+PowerMetrics PowerManager::getMetrics() {
+  PowerMetrics metrics = {};
+  int64_t now = esp_timer_get_time();
+
+  if (m_mutex != nullptr && xSemaphoreTake(m_mutex, pdMS_TO_TICKS(10))) {
+    metrics.interactions = m_interactions;
+    metrics.wakeLatencyLastUs = m_latencyLastUs;
+    metrics.wakeLatencyMaxUs = m_latencyMaxUs;
+    metrics.wakeLatencyAvgUs = m_latencyCount ? static_cast<uint32_t>(m_latencyTotalUs / m_latencyCount) : 0;
+    metrics.boostedUs = m_boostedUs + (m_boosted ? now - m_boostStartUs : 0);
+    metrics.uptimeUs = now - m_startUs;
+    xSemaphoreGive(m_mutex);
+  }
+
+  // E[mJ] = t[us] * I[mA] * V[V] / 1e6
+  if (metrics.interactions > 0) {
+    double boostedMj = metrics.boostedUs * (double)ACTIVE_MAX_MA * (SUPPLY_MV / 1000.0) / 1e6;
+    metrics.energyPerInteractionMj = static_cast<float>(boostedMj / metrics.interactions);
+  }
+  return metrics;
+}
+
+// Private helper methods (called with m_mutex held)
+void PowerManager::boost() {
+#if CONFIG_PM_ENABLE
+  if (m_pmAvailable) {
+    esp_pm_lock_acquire(m_cpuLock);
+    esp_pm_lock_acquire(m_sleepLock);
+  }
+#endif
+  if (!m_pmAvailable) {
+    setCpuFrequencyMhz(MAX_FREQ_MHZ);
+  }
+  m_boosted = true;
+  m_boostStartUs = esp_timer_get_time();
+}
+
+void PowerManager::unboost() {
+#if CONFIG_PM_ENABLE
+  if (m_pmAvailable) {
+    esp_pm_lock_release(m_sleepLock);
+    esp_pm_lock_release(m_cpuLock);
+  }
+#endif
+  if (!m_pmAvailable) {
+    setCpuFrequencyMhz(MIN_FREQ_MHZ);
+  }
+  m_boosted = false;
+  m_boostedUs += esp_timer_get_time() - m_boostStartUs;
+}
@@ -0,0 +1,116 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+// Power metrics exposed to the status report
+struct PowerMetrics {
+  uint32_t interactions;        // Boost windows started by input
+  uint32_t wakeLatencyLastUs;   // Button edge -> button task running
+  uint32_t wakeLatencyMaxUs;
+  uint32_t wakeLatencyAvgUs;
+  uint64_t boostedUs;           // Total time at max frequency
+  uint64_t uptimeUs;
+  float energyPerInteractionMj; // Estimated from the current model below
+};
+
+/**
+ * Activity-driven CPU frequency and sleep policy.
+ *
+ * Input starts an interaction window that holds the CPU at its maximum
+ * frequency; renders hold it for their duration. When nothing holds it, the
+ * CPU drops to the minimum frequency and, with tickless idle, the idle task
+ * enters automatic light sleep until the next timeout or button edge.
+ *
+ * Uses esp_pm locks when the SDK is built with CONFIG_PM_ENABLE; otherwise
+ * falls back to setCpuFrequencyMhz() without automatic light sleep.
+ */
+class PowerManager {
+public:
+  // Called when the interaction window opens (idle false) or expires (idle true)
+  typedef void (*IdleObserver)(void* context, bool idle);
+
+private:
+  // Singleton instance
+  static PowerManager* m_instance;
+
+  // Button edge timestamp written from the GPIO ISR
+  static volatile int64_t s_edgeTimeUs;
+
+#if CONFIG_PM_ENABLE
+  esp_pm_lock_handle_t m_cpuLock;
+  esp_pm_lock_handle_t m_sleepLock;
+#endif
+  SemaphoreHandle_t m_mutex;
+  bool m_pmAvailable;
+  bool m_boosted;
+  bool m_interacting;
+  int m_renderDepth;
+  int64_t m_holdUntilUs;
+  int64_t m_boostStartUs;
+  int64_t m_startUs;
+
+  // Metrics
+  uint32_t m_interactions;
+  uint32_t m_latencyCount;
+  uint64_t m_latencyTotalUs;
+  uint32_t m_latencyLastUs;
+  uint32_t m_latencyMaxUs;
+  uint64_t m_boostedUs;
+
+  IdleObserver m_idleObserver;
+  void* m_idleContext;
+
+  PowerManager();
+
+  void boost();
+  void unboost();
+
+public:
+  // Policy
+  static const uint32_t MAX_FREQ_MHZ = 240;
+  static const uint32_t MIN_FREQ_MHZ = 80;           // Lowest that keeps APB (UART/I2C) at 80 MHz
+  static const uint32_t INTERACTION_HOLD_MS = 3000;  // Max frequency after the last input
+
+  // Supply current model for the energy estimate (ESP32 datasheet, typical)
+  static const uint32_t SUPPLY_MV = 3300;
+  static const uint32_t ACTIVE_MAX_MA = 50;
+
+  static PowerManager* getInstance();
+
+  // Configures DFS and automatic light sleep
+  bool initialize();
+
+  // Input activity: starts or extends the interaction window
+  void noteActivity();
+
+  // The button task woke for an edge; records latency from the ISR
+  void noteWake();
+
+  // Releases the interaction window once it expires; call from the input loop
+  void poll();
+  bool isBoosted() const { return m_boosted; }
+
+  // Lets a peripheral that holds a clock lock stop while the UI is idle.
+  // Called on the input loop's task, without the power manager's mutex held.
+  void setIdleObserver(IdleObserver observer, void* context) {
+    m_idleObserver = observer;
+    m_idleContext = context;
+  }
+
+  // Hold max frequency (and block light sleep) around a render burst
+  void beginRender();
+  void endRender();
+
+  // Called from the button GPIO ISR
+  static void IRAM_ATTR markButtonEdgeFromISR();
+
+  PowerMetrics getMetrics();
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,175 @@
+#ifndef QUADRATURE_DECODER_H
+#define QUADRATURE_DECODER_H
+
+#include <stdint.h>
+
+/**
+ * Quadrature decoding for the rotary encoder.
+ *
+ * On the target the PCNT peripheral does the edge counting (RotaryEncoder);
+ * what remains in software is turning its 16-bit counter into step deltas
+ * and steps into detents. QuadratureDecoder is the same 4x decoding applied
+ * to sampled A/B levels, with the PCNT glitch filter modelled as a minimum
+ * stable time, so synthetic traces can be checked against the firmware path
+ * on the host. Pure C++: no Arduino or IDF dependency.
+ *
+ *   QuadratureDecoder decoder(2);       // Ignore pulses shorter than 2 samples
+ *   DetentAccumulator detents;
+ *   for (...) steps += decoder.sample(a, b);
+ *   int moved = detents.add(steps);     // Whole detents, remainder kept
+ */
+
+// Steps the encoder moves between two detents (one full A/B cycle)
+static const int QUADRATURE_STEPS_PER_DETENT = 4;
+
+/**
+ * Steps between two readings of a counter that wraps to zero at +/-limit,
+ * as the PCNT counter does at its high and low limits. Exact as long as the
+ * encoder moved less than limit/2 steps between the readings.
+ */
+inline int32_t quadratureCounterDelta(int16_t current, int16_t previous, int16_t limit) {
+  int32_t delta = (static_cast<int32_t>(current) - previous) % limit;
+  if (delta > limit / 2) {
+    delta -= limit;
+  } else if (delta < -limit / 2) {
+    delta += limit;
+  }
+  return delta;
+}
+
+/**
+ * Slot reached by turning detents (signed) through count slots in a ring:
+ * one occupied slot per detent, skipping the rest. Returns current when no
+ * other slot is occupied.
+ *
+ *   channel = quadratureSelectSlot(channel, detents, 4, hasReadings);
+ */
+template <typename Occupied>
+int quadratureSelectSlot(int current, int detents, int count, Occupied occupied) {
+  int step = detents > 0 ? 1 : -1;
+  int moves = detents > 0 ? detents : -detents;
+  int selected = current;
+  for (int m = 0; m < moves; m++) {
+    // A full lap without an occupied slot ends where it started
+    for (int i = 0; i < count; i++) {
+      selected = (selected + step + count) % count;
+      if (occupied(selected)) break;
+    }
+  }
+  return selected;
+}
+
+/**
+ * 4x decoder over sampled A/B levels.
+ *
+ * A leading B counts up: 00 -> 10 -> 11 -> 01 -> 00, one step per edge,
+ * which matches the PCNT channel setup in RotaryEncoder. A sample where
+ * both inputs changed at once cannot be decoded; it counts nothing and is
+ * recorded in getMissedSteps().
+ */
+class QuadratureDecoder {
+public:
+  // filterSamples: a level change is accepted once it held for this many samples
+  explicit QuadratureDecoder(uint8_t filterSamples = 0)
+    : m_filterSamples(filterSamples) {
+    reset(true, true);
+  }
+
+  // Starts from the given levels (a detent is both inputs high)
+  void reset(bool a, bool b) {
+    m_state = encode(a, b);
+    m_pending = m_state;
+    m_stableFor = 0;
+    m_missedSteps = 0;
+  }
+
+  // Feeds one sample, returns the steps it decoded (-1, 0 or +1)
+  int sample(bool a, bool b) {
+    uint8_t raw = encode(a, b);
+    if (raw != m_pending) {
+      m_pending = raw;
+      m_stableFor = 0;
+    }
+    if (m_pending == m_state || m_stableFor++ < m_filterSamples) {
+      return 0;
+    }
+
+    int8_t step = transition(m_state, m_pending);
+    m_state = m_pending;
+    if (step == INVALID) {
+      m_missedSteps++;
+      return 0;
+    }
+    return step;
+  }
+
+  uint8_t getState() const { return m_state; }
+  uint32_t getMissedSteps() const { return m_missedSteps; }
+
+private:
+  static const int8_t INVALID = 2;
+
+  uint8_t m_filterSamples;
+  uint8_t m_state;       // Accepted levels, A in bit 1
+  uint8_t m_pending;     // Raw levels waiting out the filter
+  uint8_t m_stableFor;
+  uint32_t m_missedSteps;
+
+  static uint8_t encode(bool a, bool b) {
+    return static_cast<uint8_t>((a ? 2 : 0) | (b ? 1 : 0));
+  }
+
+  static int8_t transition(uint8_t from, uint8_t to) {
+    static const int8_t table[16] = {
+       0, -1, +1,  INVALID,    // from 00
+      +1,  0,  INVALID, -1,    // from 01
+      -1,  INVALID,  0, +1,    // from 10
+       INVALID, +1, -1,  0     // from 11
+    };
+    return table[(from << 2) | to];
+  }
+};
+
+/**
+ * Folds steps into whole detents. The partial detent is carried over, so a
+ * slow turn split across scans still moves exactly once per click, and a
+ * wobble around one detent moves nothing.
+ */
+class DetentAccumulator {
+public:
+  explicit DetentAccumulator(int stepsPerDetent = QUADRATURE_STEPS_PER_DETENT)
+    : m_stepsPerDetent(stepsPerDetent), m_remainder(0) {}
+
+  // Adds steps, returns the whole detents completed (signed)
+  int add(int32_t steps) {
+    m_remainder += steps;
+    int detents = static_cast<int>(m_remainder / m_stepsPerDetent);
+    m_remainder -= static_cast<int32_t>(detents) * m_stepsPerDetent;
+    return detents;
+  }
+
+  /**
+   * The encoder rests in a detent: a partial left over from missed steps is
+   * rounded to the nearest detent and dropped, so the phase cannot drift.
+   * Returns the detent the rounding completed, if any.
+   */
+  int settle() {
+    int detents = 0;
+    if (m_remainder * 2 > m_stepsPerDetent) {
+      detents = 1;
+    } else if (m_remainder * 2 < -m_stepsPerDetent) {
+      detents = -1;
+    }
+    m_remainder = 0;
+    return detents;
+  }
+
+  void reset() { m_remainder = 0; }
+  int32_t getRemainder() const { return m_remainder; }
+
+private:
+  int m_stepsPerDetent;
+  int32_t m_remainder;
+};
+
+#endif // QUADRATURE_DECODER_H
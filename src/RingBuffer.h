@@ -0,0 +1,63 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Fixed-capacity history that overwrites its oldest entry when full.
+ * Not synchronized: owned by one task or coroutine.
+ *
+ *   RingBuffer<uint16_t, 32> history;
+ *   history.push(sample);
+ *   uint16_t oldest = history[0], newest = history.newest();
+ */
+template <typename T, size_t N>
+class RingBuffer {
+public:
+  static const size_t CAPACITY = N;
+
+  RingBuffer() : m_head(0), m_count(0) {}
+
+  void push(const T& item) {
+    m_items[m_head] = item;
+    m_head = (m_head + 1) % N;
+    if (m_count < N) m_count++;
+  }
+
+  void clear() {
+    m_head = 0;
+    m_count = 0;
+  }
+
+  size_t size() const { return m_count; }
+  bool isEmpty() const { return m_count == 0; }
+  bool isFull() const { return m_count == N; }
+
+  // index 0 is the oldest entry, size() - 1 the newest
+  const T& operator[](size_t index) const {
+    return m_items[(m_head + N - m_count + index) % N];
+  }
+
+  const T& newest() const {
+    return m_items[(m_head + N - 1) % N];
+  }
+
+  // Copies the newest min(count, size()) entries oldest-first; returns the number copied
+  size_t copyNewest(T* out, size_t count) const {
+    if (count > m_count) count = m_count;
+    for (size_t i = 0; i < count; i++) {
+      out[i] = (*this)[m_count - count + i];
+    }
+    return count;
+  }
+
+private:
+  T m_items[N];
+  size_t m_head;    // Next slot to write
+  size_t m_count;
+
+  static_assert(N > 0, "RingBuffer needs a capacity");
+};
+
+#endif // RING_BUFFER_H
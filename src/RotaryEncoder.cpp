@@ -0,0 +1,124 @@
+#include "RotaryEncoder.h"
+#include <driver/pcnt.h>
+
+static const pcnt_unit_t ENCODER_UNIT = PCNT_UNIT_0;
+
+/**
+ * @brief Constructor - counting starts in begin()
+ */
+RotaryEncoder::RotaryEncoder() : m_running(false), m_lastCount(0), m_steps(0) {
+}
+
+/**
+ * @brief Destructor - Stops the counter
+ */
+RotaryEncoder::~RotaryEncoder() {
+  end();
+}
+
+/**
+ * @brief Configures both PCNT channels for 4x quadrature counting
+ * Channel 0 counts A edges with B as direction, channel 1 counts B edges
+ * with A as direction; the signs match QuadratureDecoder.
+ * @return true if the unit is counting, false otherwise
+ */
+bool RotaryEncoder::begin() {
+  if (m_running) {
+    return true;
+  }
+
+  pcnt_config_t config;
+  memset(&config, 0, sizeof(config));
+  config.unit = ENCODER_UNIT;
+  config.counter_h_lim = COUNTER_LIMIT;
+  config.counter_l_lim = -COUNTER_LIMIT;
+
+  config.channel = PCNT_CHANNEL_0;
+  config.pulse_gpio_num = PIN_A;
+  config.ctrl_gpio_num = PIN_B;
+  config.pos_mode = PCNT_COUNT_DEC;
+  config.neg_mode = PCNT_COUNT_INC;
+  config.hctrl_mode = PCNT_MODE_KEEP;
+  config.lctrl_mode = PCNT_MODE_REVERSE;
+  bool ok = pcnt_unit_config(&config) == ESP_OK;
+
+  config.channel = PCNT_CHANNEL_1;
+  config.pulse_gpio_num = PIN_B;
+  config.ctrl_gpio_num = PIN_A;
+  config.pos_mode = PCNT_COUNT_INC;
+  config.neg_mode = PCNT_COUNT_DEC;
+  ok = ok && pcnt_unit_config(&config) == ESP_OK;
+
+  // Pulses shorter than the filter window (contact bounce) never reach the counter
+  ok = ok && pcnt_set_filter_value(ENCODER_UNIT, GLITCH_FILTER_CYCLES) == ESP_OK &&
+       pcnt_filter_enable(ENCODER_UNIT) == ESP_OK;
+
+  ok = ok && pcnt_counter_pause(ENCODER_UNIT) == ESP_OK &&
+       pcnt_counter_clear(ENCODER_UNIT) == ESP_OK &&
+       pcnt_counter_resume(ENCODER_UNIT) == ESP_OK;
+  if (!ok) {
+    Serial.println("Encoder PCNT configuration failed");
+    return false;
+  }
+
+  m_lastCount = 0;
+  m_detents.reset();
+  m_running = true;
+  return true;
+}
+
+/**
+ * @brief Stops counting; the pins keep their pull-ups
+ */
+void RotaryEncoder::end() {
+  if (m_running) {
+    pcnt_counter_pause(ENCODER_UNIT);
+    m_running = false;
+  }
+}
+
+/**
+ * @brief Reads the steps counted since the last call and folds them into detents
+ * At rest a partial detent (steps lost to the filter or to light sleep,
+ * which stops the counter clock) is rounded off so the phase cannot drift.
+ * @return Signed detents, 0 if none completed or the encoder is not running
+ */
+int RotaryEncoder::readDetents() {
+  if (!m_running) return 0;
+
+  int16_t count = readCounter();
+  int32_t steps = quadratureCounterDelta(count, m_lastCount, COUNTER_LIMIT);
+  m_lastCount = count;
+  m_steps += static_cast<uint32_t>(steps < 0 ? -steps : steps);
+
+  int detents = m_detents.add(steps);
+  if (m_detents.getRemainder() != 0 && inputsAtDetent()) {
+    detents += m_detents.settle();
+  }
+  return detents;
+}
+
+/**
+ * @brief Checks whether the controller may stop polling the encoder
+ * @return true if the knob sits in a detent and every step has been read
+ */
+bool RotaryEncoder::isAtRest() {
+  if (!m_running) return true;
+  return inputsAtDetent() && readCounter() == m_lastCount;
+}
+
+/**
+ * @brief Current PCNT counter value
+ */
+int16_t RotaryEncoder::readCounter() {
+  int16_t count = 0;
+  pcnt_get_counter_value(ENCODER_UNIT, &count);
+  return count;
+}
+
+/**
+ * @brief Both inputs pulled high: the encoder is between clicks
+ */
+bool RotaryEncoder::inputsAtDetent() const {
+  return digitalRead(PIN_A) == HIGH && digitalRead(PIN_B) == HIGH;
+}
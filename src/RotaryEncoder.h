@@ -0,0 +1,50 @@
+#ifndef ROTARY_ENCODER_H
+#define ROTARY_ENCODER_H
+
+#include <Arduino.h>
+#include "QuadratureDecoder.h"
+
+/**
+ * Quadrature rotary encoder counted by the PCNT peripheral.
+ *
+ * Both channels of one PCNT unit count every A and B edge (4x decoding),
+ * with the hardware glitch filter rejecting contact bounce, so the CPU takes
+ * no interrupt per step. The controller reads the accumulated detents once
+ * per scan: a fast spin arrives as one signed move, not one event per click.
+ * The counter wraps at +/-COUNTER_LIMIT without an interrupt; deltas stay
+ * exact while fewer than COUNTER_LIMIT / 2 steps happen between two reads.
+ */
+class RotaryEncoder {
+public:
+  static const int PIN_A = 18;
+  static const int PIN_B = 19;
+  static const int16_t COUNTER_LIMIT = 10000;
+  static const uint16_t GLITCH_FILTER_CYCLES = 1000;   // APB cycles: 12.5 us at 80 MHz (max 1023)
+
+  RotaryEncoder();
+  ~RotaryEncoder();
+
+  // Configures the PCNT unit on PIN_A/PIN_B (pull-ups on, common to ground)
+  bool begin();
+  void end();
+  bool isRunning() const { return m_running; }
+
+  // Detents turned since the last call; positive when A leads B
+  int readDetents();
+
+  // Resting in a detent (both inputs high) with no step left unread
+  bool isAtRest();
+
+  uint32_t getStepCount() const { return m_steps; }
+
+private:
+  bool m_running;
+  int16_t m_lastCount;
+  uint32_t m_steps;          // Steps seen in either direction, for diagnostics
+  DetentAccumulator m_detents;
+
+  int16_t readCounter();
+  bool inputsAtDetent() const;
+};
+
+#endif // ROTARY_ENCODER_H
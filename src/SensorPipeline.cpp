@@ -0,0 +1,243 @@
+#include "SensorPipeline.h"
+
+/**
+ * @brief Constructor - the pipeline is idle until initialize()
+ */
+SensorPipeline::SensorPipeline()
+  : m_source(nullptr), m_channelCount(0), m_drainIntervalMs(0),
+    m_running(false), m_suspended(false), m_idle(false), m_nextDrain(0), m_nextPublish(0),
+    m_samples(0), m_drains(0), m_publishes(0) {
+}
+
+/**
+ * @brief Starts the source and sizes the drain period to its buffer
+ * @param source Sample producer (ADC DMA on the target, synthetic on the host)
+ * @param channels Source channel numbers; Model slot i receives channels[i]
+ * @param channelCount Number of channels (at most MAX_CHANNELS)
+ * @param config Acquisition and publishing rates
+ * @return true if the source started, false otherwise
+ */
+bool SensorPipeline::initialize(SensorSource& source, const uint8_t* channels, uint8_t channelCount,
+                                const SensorPipelineConfig& config) {
+  if (channelCount == 0 || channelCount > MAX_CHANNELS ||
+      config.decimation == 0 || config.publishIntervalMs == 0 || config.idleIntervalMs == 0) {
+    Serial.println("Invalid sensor pipeline configuration");
+    return false;
+  }
+
+  if (!source.begin(channels, channelCount, config.sampleRateHz)) {
+    Serial.println("Sensor source failed to start");
+    return false;
+  }
+
+  m_source = &source;
+  m_config = config;
+  m_channelCount = channelCount;
+  for (uint8_t i = 0; i < channelCount; i++) {
+    Channel& channel = m_channels[i];
+    channel.id = channels[i];
+    channel.calibration = source.defaultCalibration(channels[i]);
+    channel.decimator.setFactor(config.decimation);
+    channel.median.reset();
+    channel.smoothing.reset();
+    channel.publishSum = 0;
+    channel.publishCount = 0;
+    channel.history.clear();
+  }
+
+  // Drain at half the time the source can buffer, but no more often than needed to publish
+  m_drainIntervalMs = config.publishIntervalMs;
+  size_t capacity = source.getBufferCapacity();
+  if (capacity > 0) {
+    uint32_t bufferMs = static_cast<uint32_t>(static_cast<uint64_t>(capacity) * 1000 / config.sampleRateHz);
+    if (bufferMs / 2 < m_drainIntervalMs) m_drainIntervalMs = bufferMs / 2;
+  }
+  if (m_drainIntervalMs < MIN_DRAIN_MS) m_drainIntervalMs = MIN_DRAIN_MS;
+
+  Serial.printf("Sensors: %u channels at %lu Hz, drained every %lu ms, published every %lu ms\n",
+                channelCount, (unsigned long)config.sampleRateHz,
+                (unsigned long)m_drainIntervalMs, (unsigned long)config.publishIntervalMs);
+  return true;
+}
+
+/**
+ * @brief Spawns the acquisition coroutine
+ * @param executor Executor to run it on
+ * @return true if started, false if not initialized or already running
+ */
+bool SensorPipeline::start(ExecutorTask& executor) {
+  if (m_source == nullptr || m_running) {
+    return false;
+  }
+
+  m_running = true;
+  executor.spawn(*this);
+  return true;
+}
+
+/**
+ * @brief Ends the coroutine and stops the source
+ */
+void SensorPipeline::stop() {
+  m_running = false;
+  if (m_source != nullptr) {
+    m_source->end();
+  }
+}
+
+/**
+ * @brief Stops conversions; partial decimation sums are discarded
+ */
+void SensorPipeline::suspend() {
+  if (m_source != nullptr && !m_suspended) {
+    m_suspended = true;
+    m_source->end();
+  }
+}
+
+/**
+ * @brief Restarts conversions after suspend()
+ */
+void SensorPipeline::resume() {
+  if (m_source == nullptr || !m_suspended) return;
+
+  uint8_t channels[MAX_CHANNELS];
+  for (uint8_t i = 0; i < m_channelCount; i++) {
+    channels[i] = m_channels[i].id;
+    m_channels[i].decimator.reset();
+  }
+  if (!m_source->begin(channels, m_channelCount, m_config.sampleRateHz)) {
+    Serial.println("Sensor source failed to restart");
+    return;
+  }
+  m_suspended = false;
+}
+
+/**
+ * @brief Switches between continuous conversion and idle bursts
+ * @param idle true when the UI has gone idle, false on the next interaction
+ */
+void SensorPipeline::setIdle(bool idle) {
+  m_idle = idle;
+  if (!idle) {
+    // Ends the wait between bursts now rather than up to idleIntervalMs later
+    wake();
+  }
+}
+
+/**
+ * @brief Overrides the calibration of one slot
+ * @param slot Index into the initialize() channel list
+ * @param calibration Raw to engineering units
+ */
+void SensorPipeline::setCalibration(uint8_t slot, const SensorCalibration& calibration) {
+  if (slot < m_channelCount) {
+    m_channels[slot].calibration = calibration;
+  }
+}
+
+/**
+ * @brief Copies the newest filtered, decimated raw values of a slot
+ * @param slot Index into the initialize() channel list
+ * @param out Destination, oldest first
+ * @param count Capacity of the destination
+ * @return Number of values copied
+ */
+size_t SensorPipeline::copyHistory(uint8_t slot, uint16_t* out, size_t count) const {
+  if (slot >= m_channelCount) return 0;
+  return m_channels[slot].history.copyNewest(out, count);
+}
+
+/**
+ * @brief Acquisition coroutine: drain on the buffer period, publish on the publish period
+ * While idle, each burst of one drain interval is published and the source stopped.
+ */
+void SensorPipeline::step() {
+  CO_BEGIN();
+  m_nextDrain = coNow();
+  m_nextPublish = coNow() + m_config.publishIntervalMs;
+
+  while (m_running) {
+    if (!m_suspended) {
+      drain();
+    }
+
+    if (m_idle || static_cast<int32_t>(coNow() - m_nextPublish) >= 0) {
+      publish(coNow());
+      m_nextPublish += m_config.publishIntervalMs;
+    }
+
+    if (m_idle) {
+      suspend();
+      CO_AWAIT_TIMEOUT(!m_idle, m_config.idleIntervalMs);
+      resume();
+      m_nextDrain = coNow();
+      m_nextPublish = coNow() + m_config.publishIntervalMs;
+    }
+
+    m_nextDrain += m_drainIntervalMs;
+    CO_DELAY_UNTIL(m_nextDrain);
+  }
+
+  CO_END();
+}
+
+/**
+ * @brief Reads everything the source has buffered, one batch at a time
+ */
+void SensorPipeline::drain() {
+  m_drains++;
+  while (true) {
+    size_t count = m_source->read(m_batch, BATCH_SIZE);
+    for (size_t i = 0; i < count; i++) {
+      accumulate(m_batch[i]);
+    }
+    m_samples += count;
+    if (count < BATCH_SIZE) break;
+  }
+}
+
+/**
+ * @brief Feeds one conversion through its channel's decimator and filters
+ * @param sample Conversion from the source
+ */
+void SensorPipeline::accumulate(const SensorSample& sample) {
+  for (uint8_t i = 0; i < m_channelCount; i++) {
+    Channel& channel = m_channels[i];
+    if (channel.id != sample.channel) continue;
+
+    // Filters run at the decimated rate, so their cost per conversion is negligible
+    uint16_t value;
+    if (channel.decimator.process(sample.raw, value)) {
+      value = channel.smoothing.process(channel.median.process(value));
+      channel.history.push(value);
+      channel.publishSum += value;
+      channel.publishCount++;
+    }
+    return;
+  }
+}
+
+/**
+ * @brief Averages the history collected since the last publish into the Model
+ * @param now Executor time of the publish
+ */
+void SensorPipeline::publish(CoTime now) {
+  Model* model = Model::getInstance();
+  for (uint8_t i = 0; i < m_channelCount; i++) {
+    Channel& channel = m_channels[i];
+    if (channel.publishCount == 0) continue;   // Keep the previous reading rather than publish a gap
+
+    SensorReading reading;
+    reading.raw = static_cast<uint16_t>(
+        (channel.publishSum + channel.publishCount / 2) / channel.publishCount);
+    reading.value = channel.calibration.apply(reading.raw);
+    reading.samples = channel.publishCount;
+    reading.timestampMs = now;
+    model->setSensorReading(i, reading);
+
+    channel.publishSum = 0;
+    channel.publishCount = 0;
+  }
+  m_publishes++;
+}
@@ -0,0 +1,116 @@
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <Arduino.h>
+#include "Coroutine.h"
+#include "ExecutorTask.h"
+#include "Model.h"
+#include "RingBuffer.h"
+#include "SensorSource.h"
+#include "SignalFilters.h"
+
+// Acquisition and publishing rates
+struct SensorPipelineConfig {
+  uint32_t sampleRateHz;        // Total conversion rate, shared by all channels
+  uint16_t decimation;          // Conversions per channel averaged into one history entry
+  uint32_t publishIntervalMs;   // How often averaged readings reach the Model
+  uint32_t idleIntervalMs;      // Time between conversion bursts while the UI is idle
+
+  SensorPipelineConfig()
+    : sampleRateHz(20000), decimation(200), publishIntervalMs(500), idleIntervalMs(10000) {}
+};
+
+/**
+ * Sensor acquisition pipeline.
+ *
+ * The source converts in the background; this coroutine drains it in
+ * batches, often enough that the source's buffer never fills and otherwise
+ * as rarely as possible, so the CPU wakes per batch rather than per sample.
+ * Each channel's conversions are box-averaged by the decimation factor, then
+ * median-filtered (spike rejection) and exponentially smoothed into a history
+ * ring; the entries collected since the last publish are averaged, calibrated
+ * and written to the Model.
+ *
+ * Continuous conversion holds the APB clock, which keeps the CPU out of
+ * automatic light sleep. While the UI is idle (setIdle()) the source only
+ * runs for one drain interval every idleIntervalMs and is stopped between.
+ */
+class SensorPipeline : public Coroutine {
+public:
+  static const uint8_t MAX_CHANNELS = Model::MAX_SENSOR_CHANNELS;
+  static const size_t HISTORY_SIZE = 32;
+  static const uint32_t MIN_DRAIN_MS = 10;
+  static const size_t MEDIAN_WINDOW = 3;        // Decimated samples
+  static const unsigned SMOOTHING_SHIFT = 2;    // alpha = 1/4 per decimated sample
+
+  SensorPipeline();
+
+  // Starts the source on the given channels; Model slot i receives channels[i]
+  bool initialize(SensorSource& source, const uint8_t* channels, uint8_t channelCount,
+                  const SensorPipelineConfig& config = SensorPipelineConfig());
+
+  bool start(ExecutorTask& executor);
+  void stop();
+
+  // Stops conversions (e.g. around explicit sleep) without losing history
+  void suspend();
+  void resume();
+
+  // Idle UI: convert in short bursts instead of continuously. Call on the executor's task.
+  void setIdle(bool idle);
+  bool isIdle() const { return m_idle; }
+
+  // Overrides the source's default calibration for one slot
+  void setCalibration(uint8_t slot, const SensorCalibration& calibration);
+
+  // Filtered, decimated raw history of a slot, oldest first; returns the number copied
+  size_t copyHistory(uint8_t slot, uint16_t* out, size_t count) const;
+
+  uint8_t getChannelCount() const { return m_channelCount; }
+  uint32_t getDrainIntervalMs() const { return m_drainIntervalMs; }
+
+  // Statistics
+  uint32_t getSampleCount() const { return m_samples; }
+  uint32_t getDrainCount() const { return m_drains; }
+  uint32_t getPublishCount() const { return m_publishes; }
+  uint32_t getOverrunCount() const { return m_source ? m_source->getOverrunCount() : 0; }
+
+protected:
+  void step() override;
+
+private:
+  struct Channel {
+    uint8_t id;
+    SensorCalibration calibration;
+    Decimator<uint16_t> decimator;
+    MedianFilter<uint16_t, MEDIAN_WINDOW> median;
+    ExponentialFilter<uint16_t, SMOOTHING_SHIFT> smoothing;
+    uint32_t publishSum;          // Sum of history entries since the last publish
+    uint16_t publishCount;
+    RingBuffer<uint16_t, HISTORY_SIZE> history;
+  };
+
+  static const size_t BATCH_SIZE = 128;
+
+  SensorSource* m_source;
+  SensorPipelineConfig m_config;
+  Channel m_channels[MAX_CHANNELS];
+  uint8_t m_channelCount;
+  uint32_t m_drainIntervalMs;
+  bool m_running;
+  volatile bool m_suspended;
+  volatile bool m_idle;
+  CoTime m_nextDrain;
+  CoTime m_nextPublish;
+  SensorSample m_batch[BATCH_SIZE];
+
+  uint32_t m_samples;
+  uint32_t m_drains;
+  uint32_t m_publishes;
+
+  void drain();
+  void accumulate(const SensorSample& sample);
+  void publish(CoTime now);
+};
+
+#endif // SENSOR_PIPELINE_H
@@ -0,0 +1,60 @@
+#ifndef SENSOR_SOURCE_H
+#define SENSOR_SOURCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// One conversion result
+struct SensorSample {
+  uint8_t channel;   // Source channel number (ADC1 channel on the target)
+  uint16_t raw;      // Raw conversion, 0..SensorSource::maxRaw()
+};
+
+// Linear calibration: value = ((raw * gainQ16 + 0x8000) >> 16) + offset
+struct SensorCalibration {
+  int32_t gainQ16;
+  int32_t offset;
+
+  SensorCalibration() : gainQ16(1 << 16), offset(0) {}
+  SensorCalibration(int32_t gain, int32_t off) : gainQ16(gain), offset(off) {}
+
+  int32_t apply(int32_t raw) const {
+    return static_cast<int32_t>((static_cast<int64_t>(raw) * gainQ16 + 0x8000) >> 16) + offset;
+  }
+};
+
+/**
+ * Producer of raw samples for the SensorPipeline.
+ *
+ * A source converts continuously in the background (DMA on the target) and
+ * read() drains whatever has accumulated without blocking, so the consumer
+ * decides how often the CPU wakes up, not the sample rate.
+ */
+class SensorSource {
+public:
+  virtual ~SensorSource() {}
+
+  // Starts conversions of the given channels at sampleRateHz total (all channels together)
+  virtual bool begin(const uint8_t* channels, uint8_t channelCount, uint32_t sampleRateHz) = 0;
+  virtual void end() = 0;
+
+  // Copies up to maxSamples pending samples to out; returns the number copied
+  virtual size_t read(SensorSample* out, size_t maxSamples) = 0;
+
+  // Samples the source holds before it overruns, 0 if unbounded
+  virtual size_t getBufferCapacity() const { return 0; }
+
+  // Samples lost because the consumer drained too late
+  virtual uint32_t getOverrunCount() const { return 0; }
+
+  // Full-scale raw value
+  virtual uint16_t maxRaw() const { return 4095; }
+
+  // Raw to engineering units (millivolts unless the source says otherwise)
+  virtual SensorCalibration defaultCalibration(uint8_t channel) const {
+    (void)channel;
+    return SensorCalibration();
+  }
+};
+
+#endif // SENSOR_SOURCE_H
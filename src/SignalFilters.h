@@ -0,0 +1,351 @@
+#ifndef SIGNAL_FILTERS_H
+#define SIGNAL_FILTERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <limits>
+
+/**
+ * Fixed-point streaming filters.
+ *
+ * Every filter takes one sample at a time through process(x) or a block
+ * through process(in, out, count); in and out may be the same buffer. The
+ * block loops carry no per-sample branches beyond the filter's own state, so
+ * the compiler can unroll or vectorize them where the target allows. All
+ * arithmetic is integer: no floating point per sample.
+ *
+ *   MovingAverage<uint16_t, 8> average;
+ *   MedianFilter<int16_t, 5> median;
+ *   ExponentialFilter<uint16_t, 3> smooth;     // alpha = 1/8
+ *   BiquadCascade<int16_t, 2> lowPass;         // 4th-order IIR
+ */
+
+// Accumulator wide enough for sums of N samples of type T
+template <typename T> struct FilterTraits { typedef int32_t Accumulator; };
+template <> struct FilterTraits<int32_t> { typedef int64_t Accumulator; };
+template <> struct FilterTraits<uint32_t> { typedef int64_t Accumulator; };
+
+// Clamps a wide intermediate to the range of T
+template <typename T, typename Wide>
+inline T saturateSample(Wide value) {
+  if (value < static_cast<Wide>(std::numeric_limits<T>::min())) return std::numeric_limits<T>::min();
+  if (value > static_cast<Wide>(std::numeric_limits<T>::max())) return std::numeric_limits<T>::max();
+  return static_cast<T>(value);
+}
+
+/**
+ * Box average over the last N samples (running sum, O(1) per sample).
+ * Until N samples have arrived the average covers those seen so far.
+ */
+template <typename T, size_t N>
+class MovingAverage {
+public:
+  typedef typename FilterTraits<T>::Accumulator Accumulator;
+
+  MovingAverage() { reset(); }
+
+  void reset() {
+    m_index = 0;
+    m_count = 0;
+    m_sum = 0;
+  }
+
+  T process(T x) {
+    if (m_count == N) {
+      m_sum -= m_window[m_index];
+    } else {
+      m_count++;
+    }
+    m_window[m_index] = x;
+    m_sum += x;
+    m_index = (m_index + 1 == N) ? 0 : m_index + 1;
+    // Constant divisor once full: a shift when N is a power of two
+    return static_cast<T>(m_count == N ? m_sum / static_cast<Accumulator>(N)
+                                       : m_sum / static_cast<Accumulator>(m_count));
+  }
+
+  void process(const T* in, T* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      out[i] = process(in[i]);
+    }
+  }
+
+private:
+  T m_window[N];
+  size_t m_index;
+  size_t m_count;
+  Accumulator m_sum;
+
+  static_assert(N > 0, "MovingAverage needs a window");
+};
+
+/**
+ * Exponential moving average with alpha = 1 / 2^SHIFT.
+ * The state keeps SHIFT fractional bits, so small steps are not lost to
+ * truncation; the first sample initializes it.
+ */
+template <typename T, unsigned SHIFT>
+class ExponentialFilter {
+public:
+  typedef typename FilterTraits<T>::Accumulator Accumulator;
+
+  ExponentialFilter() : m_state(0), m_primed(false) {}
+
+  void reset() { m_primed = false; }
+
+  T process(T x) {
+    Accumulator scaled = static_cast<Accumulator>(x) * (static_cast<Accumulator>(1) << SHIFT);
+    if (!m_primed) {
+      m_state = scaled;
+      m_primed = true;
+    }
+    m_state += (scaled - m_state) / (static_cast<Accumulator>(1) << SHIFT);
+    return static_cast<T>((m_state + (static_cast<Accumulator>(1) << SHIFT) / 2) /
+                          (static_cast<Accumulator>(1) << SHIFT));
+  }
+
+  void process(const T* in, T* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      out[i] = process(in[i]);
+    }
+  }
+
+  T value() const {
+    return static_cast<T>(m_state / (static_cast<Accumulator>(1) << SHIFT));
+  }
+
+private:
+  Accumulator m_state;   // Filtered value << SHIFT
+  bool m_primed;
+
+  static_assert(SHIFT > 0 && SHIFT < 16, "ExponentialFilter shift out of range");
+};
+
+/**
+ * Median of the last N samples (N odd), for spike rejection.
+ * Keeps the window sorted alongside the arrival order: O(N) per sample,
+ * which beats a heap for the small N this is meant for.
+ */
+template <typename T, size_t N>
+class MedianFilter {
+public:
+  MedianFilter() { reset(); }
+
+  void reset() {
+    m_index = 0;
+    m_count = 0;
+  }
+
+  T process(T x) {
+    size_t pos;
+    if (m_count == N) {
+      // Remove the oldest sample from the sorted window
+      T oldest = m_window[m_index];
+      pos = 0;
+      while (m_sorted[pos] != oldest) pos++;
+      for (; pos + 1 < m_count; pos++) m_sorted[pos] = m_sorted[pos + 1];
+      m_count--;
+    }
+    m_window[m_index] = x;
+    m_index = (m_index + 1 == N) ? 0 : m_index + 1;
+
+    // Insert the new sample
+    pos = m_count;
+    while (pos > 0 && m_sorted[pos - 1] > x) {
+      m_sorted[pos] = m_sorted[pos - 1];
+      pos--;
+    }
+    m_sorted[pos] = x;
+    m_count++;
+
+    return m_sorted[m_count / 2];
+  }
+
+  void process(const T* in, T* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      out[i] = process(in[i]);
+    }
+  }
+
+private:
+  T m_window[N];   // Arrival order
+  T m_sorted[N];
+  size_t m_index;
+  size_t m_count;
+
+  static_assert(N % 2 == 1 && N <= 31, "MedianFilter window must be odd and small");
+};
+
+/**
+ * Second-order section coefficients in Q(FRAC) fixed point, normalized so
+ * a0 = 1: y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2.
+ * The design helpers (RBJ audio EQ cookbook) use floating point once, at
+ * configuration time.
+ */
+struct BiquadCoefficients {
+  static const unsigned FRAC = 14;
+
+  int32_t b0, b1, b2, a1, a2;
+
+  BiquadCoefficients() : b0(1 << FRAC), b1(0), b2(0), a1(0), a2(0) {}
+
+  static BiquadCoefficients lowPass(float sampleHz, float cutoffHz, float q = 0.7071f) {
+    float w0 = 6.2831853f * cutoffHz / sampleHz;
+    float alpha = sinf(w0) / (2.0f * q);
+    float cosW0 = cosf(w0);
+    return fromFloat((1.0f - cosW0) / 2.0f, 1.0f - cosW0, (1.0f - cosW0) / 2.0f,
+                     1.0f + alpha, -2.0f * cosW0, 1.0f - alpha);
+  }
+
+  static BiquadCoefficients highPass(float sampleHz, float cutoffHz, float q = 0.7071f) {
+    float w0 = 6.2831853f * cutoffHz / sampleHz;
+    float alpha = sinf(w0) / (2.0f * q);
+    float cosW0 = cosf(w0);
+    return fromFloat((1.0f + cosW0) / 2.0f, -(1.0f + cosW0), (1.0f + cosW0) / 2.0f,
+                     1.0f + alpha, -2.0f * cosW0, 1.0f - alpha);
+  }
+
+  static BiquadCoefficients fromFloat(float fb0, float fb1, float fb2,
+                                      float fa0, float fa1, float fa2) {
+    const float scale = static_cast<float>(1 << FRAC) / fa0;
+    BiquadCoefficients c;
+    c.b0 = static_cast<int32_t>(lroundf(fb0 * scale));
+    c.b1 = static_cast<int32_t>(lroundf(fb1 * scale));
+    c.b2 = static_cast<int32_t>(lroundf(fb2 * scale));
+    c.a1 = static_cast<int32_t>(lroundf(fa1 * scale));
+    c.a2 = static_cast<int32_t>(lroundf(fa2 * scale));
+    return c;
+  }
+};
+
+/**
+ * Cascade of SECTIONS biquads (order 2 x SECTIONS), direct form I.
+ * Products accumulate in 64 bits and each section's output saturates to T,
+ * so an overshooting design clips instead of wrapping. The outputs are kept
+ * at T's resolution, so a settled section can sit up to about
+ * 2^(FRAC-1) / (2^FRAC + a1 + a2) LSB away from its exact value: keep the
+ * cutoff within a few hundredths of the sample rate or decimate first.
+ */
+template <typename T, size_t SECTIONS = 1>
+class BiquadCascade {
+public:
+  BiquadCascade() { reset(); }
+
+  void setCoefficients(size_t section, const BiquadCoefficients& coefficients) {
+    if (section < SECTIONS) m_coefficients[section] = coefficients;
+  }
+
+  // Same coefficients for every section (e.g. a steeper low-pass)
+  void setCoefficients(const BiquadCoefficients& coefficients) {
+    for (size_t s = 0; s < SECTIONS; s++) m_coefficients[s] = coefficients;
+  }
+
+  void reset() {
+    for (size_t s = 0; s < SECTIONS; s++) {
+      m_state[s].x1 = m_state[s].x2 = 0;
+      m_state[s].y1 = m_state[s].y2 = 0;
+    }
+  }
+
+  // Starts from steady state for a constant input x (no start-up transient
+  // from zero): each section's outputs settle at its input times its DC gain,
+  // (b0 + b1 + b2) / (1 + a1 + a2), which is x for a low-pass and 0 for a high-pass
+  void prime(T x) {
+    int32_t value = x;
+    for (size_t s = 0; s < SECTIONS; s++) {
+      const BiquadCoefficients& c = m_coefficients[s];
+      int64_t numerator = static_cast<int64_t>(c.b0) + c.b1 + c.b2;
+      int64_t denominator = (static_cast<int64_t>(1) << BiquadCoefficients::FRAC) + c.a1 + c.a2;
+      // A pole at DC has no steady state; leave that section's output at its input
+      int32_t y = denominator != 0 ? saturateSample<T>(value * numerator / denominator) : value;
+      m_state[s].x1 = m_state[s].x2 = value;
+      m_state[s].y1 = m_state[s].y2 = y;
+      value = y;
+    }
+  }
+
+  T process(T x) {
+    int32_t value = x;
+    for (size_t s = 0; s < SECTIONS; s++) {
+      const BiquadCoefficients& c = m_coefficients[s];
+      State& st = m_state[s];
+      int64_t acc = static_cast<int64_t>(c.b0) * value
+                  + static_cast<int64_t>(c.b1) * st.x1
+                  + static_cast<int64_t>(c.b2) * st.x2
+                  - static_cast<int64_t>(c.a1) * st.y1
+                  - static_cast<int64_t>(c.a2) * st.y2;
+      int32_t y = saturateSample<T>((acc + (1 << (BiquadCoefficients::FRAC - 1))) >> BiquadCoefficients::FRAC);
+      st.x2 = st.x1;
+      st.x1 = value;
+      st.y2 = st.y1;
+      st.y1 = y;
+      value = y;
+    }
+    return static_cast<T>(value);
+  }
+
+  void process(const T* in, T* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      out[i] = process(in[i]);
+    }
+  }
+
+private:
+  struct State {
+    int32_t x1, x2, y1, y2;
+  };
+
+  BiquadCoefficients m_coefficients[SECTIONS];
+  State m_state[SECTIONS];
+
+  static_assert(sizeof(T) <= 2, "BiquadCascade state is 32-bit: use 8- or 16-bit samples");
+};
+
+/**
+ * Box-average decimator: emits the mean of every factor input samples.
+ * The factor is a run-time setting so acquisition rates can be configured.
+ */
+template <typename T>
+class Decimator {
+public:
+  typedef typename FilterTraits<T>::Accumulator Accumulator;
+
+  explicit Decimator(uint16_t factor = 1) : m_factor(factor ? factor : 1), m_sum(0), m_count(0) {}
+
+  void setFactor(uint16_t factor) {
+    m_factor = factor ? factor : 1;
+    reset();
+  }
+
+  void reset() {
+    m_sum = 0;
+    m_count = 0;
+  }
+
+  // Returns true and writes out when a decimated sample is complete
+  bool process(T x, T& out) {
+    m_sum += x;
+    if (++m_count < m_factor) return false;
+    out = static_cast<T>((m_sum + m_factor / 2) / m_factor);
+    m_sum = 0;
+    m_count = 0;
+    return true;
+  }
+
+  // Decimates a block; returns the number of samples written to out
+  size_t process(const T* in, T* out, size_t count) {
+    size_t written = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (process(in[i], out[written])) written++;
+    }
+    return written;
+  }
+
+private:
+  uint16_t m_factor;
+  Accumulator m_sum;
+  uint16_t m_count;
+};
+
+#endif // SIGNAL_FILTERS_H
@@ -1,59 +1,246 @@
 #ifndef SIMPLE_LCD_H
 #define SIMPLE_LCD_H
 
-#include <LiquidCrystal_I2C.h>
+#include <Arduino.h>
+#include <Wire.h>
+#include "LcdTransport.h"
+#include "GlyphManager.h"
+#include "DisplayLayout.h"
+#include "Trace.h"
 
-class SimpleLCD {
+// Wire-backed bus for the batched LCD transport
+class WireLcdBus : public LcdBus {
 public:
-  // Constructor with default I2C address and size (can be extended later)
-  SimpleLCD() : lcd(0x27, 16, 2) {}
+  explicit WireLcdBus(TwoWire& wire = Wire) : m_wire(wire) {}
 
-  // Initialize LCD
+  bool write(uint8_t address, const uint8_t* data, size_t len) override {
+    TRACE_BEGIN(TRACE_ID_I2C, static_cast<uint16_t>(len));
+    m_wire.beginTransmission(address);
+    m_wire.write(data, len);
+    bool ok = m_wire.endTransmission() == 0;
+    TRACE_END(TRACE_ID_I2C, static_cast<uint16_t>(len));
+    return ok;
+  }
+
+  size_t maxTransfer() const override {
+#ifdef I2C_BUFFER_LENGTH
+    return I2C_BUFFER_LENGTH;
+#else
+    return 32;
+#endif
+  }
+
+  // Sampled when bytes are queued: nothing may change the clock before they are sent
+  uint32_t byteTimeNs() const override {
+    uint32_t clock = m_wire.getClock();
+    if (clock == 0) clock = 400000; // Assume the fastest standard clock
+    return static_cast<uint32_t>(9000000000ULL / clock);
+  }
+
+private:
+  TwoWire& m_wire;
+};
+
+// HD44780 behind a PCF8574 backpack, C columns by R rows
+template <uint8_t C, uint8_t R>
+class SimpleLCDPanel {
+public:
+  static const uint8_t ADDRESS = 0x27;
+  static const uint8_t COLS = C;
+  static const uint8_t ROWS = R;
+
+  static_assert(C <= GlyphManager::MAX_COLS && R <= GlyphManager::MAX_ROWS,
+                "Panel larger than the glyph cell map");
+
+  // Constructor with default I2C address
+  SimpleLCDPanel() : m_transport(m_bus, ADDRESS), m_glyphs(m_transport, COLS, ROWS) {
+    memset(m_frame, ' ', sizeof(m_frame));
+    m_glyphs.setBlankObserver(&SimpleLCDPanel::cellBlanked, this);
+  }
+
+  // Initialize LCD (HD44780 datasheet figure 24, waits are bus-timed)
   void begin() {
-    lcd.begin(16, 2);
-    lcd.backlight();
+    // The controller needs 40 ms after power-up before accepting commands
+    unsigned long uptime = millis();
+    if (uptime < 50) {
+      delay(50 - uptime);
+    }
+
+    m_transport.setBacklight(true);
+
+    // Force 8-bit mode from any state, then switch to 4-bit
+    m_transport.nibble(0x30, 4100);
+    m_transport.nibble(0x30, 100);
+    m_transport.nibble(0x30, LCD_EXEC_TIME_US);
+    m_transport.nibble(0x20, LCD_EXEC_TIME_US);
+
+    m_transport.command(0x28);   // Function set: 4-bit, 2 lines (4-row panels too), 5x8 dots
+    m_transport.command(0x0C);   // Display on, cursor off, blink off
+    m_transport.clear();
+    m_transport.command(0x06);   // Entry mode: increment, no shift
+    m_transport.flush();
+
+    m_glyphs.reset();
+    memset(m_frame, ' ', sizeof(m_frame));
+  }
+
+  // Warm start after deep sleep: the controller kept its configuration,
+  // so only the backlight and the saved text are restored
+  void resume(const char frame[][COLS]) {
+    m_glyphs.reset();
+    m_transport.setBacklight(true);
+    for (uint8_t row = 0; row < ROWS; row++) {
+      char line[COLS + 1];
+      memcpy(line, frame[row], COLS);
+      line[COLS] = '\0';
+      printPadded(line, 0, row);
+    }
+  }
+
+  // Copy of the text currently on screen (glyph cells as ASCII stand-ins)
+  void copyFrame(char frame[][COLS]) const {
+    memcpy(frame, m_frame, sizeof(m_frame));
   }
 
   // Clear screen
   void clear() {
-    lcd.clear();
+    m_transport.clear();
+    m_transport.flush();
+    m_glyphs.releaseAll();
+    memset(m_frame, ' ', sizeof(m_frame));
+  }
+
+  // Start of a rendered frame; glyphs placed from now on keep their CGRAM slots
+  void beginFrame() {
+    m_glyphs.beginFrame();
   }
 
   // Print at default (0,0)
-  void print(const String &text) {
-    lcd.setCursor(0, 0);
-    lcd.print(text);
+  void print(const char* text) {
+    print(text, 0, 0);
   }
 
-  // Print at a given position
-  void print(const String &text, uint8_t col, uint8_t row) {
-    lcd.setCursor(col, row);
-    lcd.print(text);
+  // Print at a given position (C strings only: no heap traffic while rendering)
+  void print(const char* text, uint8_t col, uint8_t row) {
+    size_t len = strlen(text);
+    m_glyphs.releaseCells(col, row, len);
+    m_transport.setCursor(col, row);
+    m_transport.write(text, len);
+    m_transport.flush();
+    shadow(text, len, col, row);
   }
 
   // Print padded text at position to fully overwrite a line
-  void printPadded(const String &text, uint8_t col, uint8_t row) {
-    lcd.setCursor(col, row);
-    String padded = text + "                ";  // Add extra spaces
-    lcd.print(padded.substring(0, 16));         // Trim to 16 characters
+  void printPadded(const char* text, uint8_t col, uint8_t row) {
+    m_glyphs.releaseCells(col, row, COLS - col);
+    m_transport.setCursor(col, row);
+    for (uint8_t i = col; i < COLS; i++) {
+      char c = (*text != '\0') ? *text++ : ' ';
+      m_transport.data(static_cast<uint8_t>(c));
+      if (row < ROWS) m_frame[row][i] = c;
+    }
+    m_transport.flush();
+  }
+
+  // Show a custom glyph in one cell
+  void printGlyph(GlyphId glyph, uint8_t col, uint8_t row) {
+    placeGlyph(glyph, col, row);
+    m_transport.flush();
+  }
+
+  // Horizontal bar over width cells, 5 pixel columns per cell
+  void printBar(uint8_t col, uint8_t row, uint8_t width, uint32_t value, uint32_t maxValue) {
+    uint32_t total = width * 5;
+    uint32_t filled = (maxValue == 0) ? 0 : (value >= maxValue ? total : value * total / maxValue);
+
+    for (uint8_t i = 0; i < width && col + i < COLS; i++) {
+      uint32_t cellStart = i * 5;
+      if (filled >= cellStart + 5) {
+        writeCell(LCD_CHAR_FULL_BLOCK, col + i, row);
+      } else if (filled <= cellStart) {
+        writeCell(LCD_CHAR_BLANK, col + i, row);
+      } else {
+        placeGlyph(static_cast<GlyphId>(GLYPH_BAR_1 + (filled - cellStart) - 1), col + i, row);
+      }
+    }
+    m_transport.flush();
+  }
+
+  // Sparkline, one cell per level in 0..8
+  void printSparkline(uint8_t col, uint8_t row, const uint8_t* levels, uint8_t count) {
+    for (uint8_t i = 0; i < count && col + i < COLS; i++) {
+      uint8_t level = levels[i];
+      if (level == 0) {
+        writeCell(LCD_CHAR_BLANK, col + i, row);
+      } else if (level >= 8) {
+        writeCell(LCD_CHAR_FULL_BLOCK, col + i, row);
+      } else {
+        placeGlyph(static_cast<GlyphId>(GLYPH_SPARK_1 + level - 1), col + i, row);
+      }
+    }
+    m_transport.flush();
   }
 
   // Set cursor position
   void setCursor(uint8_t col, uint8_t row) {
-    lcd.setCursor(col, row);
+    m_transport.setCursor(col, row);
+    m_transport.flush();
   }
 
   // Optional: control backlight
   void backlight() {
-    lcd.backlight();
+    m_transport.setBacklight(true);
+    m_transport.flush();
   }
 
   void noBacklight() {
-    lcd.noBacklight();
+    m_transport.setBacklight(false);
+    m_transport.flush();
   }
 
+  // Bus statistics from the batched transport
+  const LcdTransport& transport() const { return m_transport; }
+  const GlyphManager& glyphs() const { return m_glyphs; }
+
 private:
-  LiquidCrystal_I2C lcd;
+  WireLcdBus m_bus;
+  LcdTransport m_transport;
+  GlyphManager m_glyphs;
+  char m_frame[ROWS][COLS];   // Text shadow for sleep snapshots
+
+  void writeCell(uint8_t value, uint8_t col, uint8_t row) {
+    m_glyphs.releaseCells(col, row, 1);
+    m_transport.setCursor(col, row);
+    m_transport.data(value);
+    if (row < ROWS && col < COLS) {
+      m_frame[row][col] = static_cast<char>(value);
+    }
+  }
+
+  void placeGlyph(GlyphId glyph, uint8_t col, uint8_t row) {
+    m_glyphs.place(glyph, col, row);
+    if (row < ROWS && col < COLS) {
+      m_frame[row][col] = GlyphManager::fallbackChar(glyph);
+    }
+  }
+
+  // A glyph cell the manager blanked when its slot was evicted
+  static void cellBlanked(void* context, uint8_t col, uint8_t row) {
+    SimpleLCDPanel* panel = static_cast<SimpleLCDPanel*>(context);
+    if (row < ROWS && col < COLS) {
+      panel->m_frame[row][col] = LCD_CHAR_BLANK;
+    }
+  }
+
+  void shadow(const char* text, size_t len, uint8_t col, uint8_t row) {
+    if (row >= ROWS) return;
+    for (size_t i = 0; i < len && col + i < COLS; i++) {
+      m_frame[row][col + i] = text[i];
+    }
+  }
 };
 
+// The fitted panel (see DisplayLayout.h)
+typedef SimpleLCDPanel<LCD_PANEL_COLS, LCD_PANEL_ROWS> SimpleLCD;
+
 #endif
@@ -0,0 +1,131 @@
+#include "SleepManager.h"
+#include <driver/gpio.h>
+#include <driver/rtc_io.h>
+#include "Controller.h"
+#include "FlightRecorder.h"
+
+// Snapshot kept in RTC slow memory across deep sleep (zeroed on power-on)
+RTC_DATA_ATTR static uint8_t s_snapshotBuffer[UI_SNAPSHOT_ENCODED_SIZE];
+RTC_DATA_ATTR static uint8_t s_snapshotLength = 0;
+RTC_DATA_ATTR static uint32_t s_deepSleepCount = 0;
+
+// Initialize static instance pointer to nullptr
+SleepManager* SleepManager::m_instance = nullptr;
+
+SleepManager::SleepManager()
+  : m_mode(SLEEP_MODE_NONE), m_idleTimeoutMs(DEFAULT_IDLE_TIMEOUT_MS),
+    m_lastActivityMs(0), m_wakeCause(ESP_SLEEP_WAKEUP_UNDEFINED), m_sleepCount(0) {
+}
+
+SleepManager* SleepManager::getInstance() {
+  if (m_instance == nullptr) {
+    m_instance = new SleepManager();
+  }
+  return m_instance;
+}
+
+/**
+ * @brief Configures the sleep policy and records why the chip woke up
+ * @param mode Sleep depth used after the timeout
+ * @param idleTimeoutMs Time without input before sleeping
+ */
+void SleepManager::initialize(SleepMode mode, uint32_t idleTimeoutMs) {
+  m_mode = mode;
+  m_idleTimeoutMs = idleTimeoutMs;
+  m_wakeCause = esp_sleep_get_wakeup_cause();
+  m_sleepCount = s_deepSleepCount;
+  m_lastActivityMs = millis();
+
+  // Wake pins are still routed to the RTC mux; hand them back to the GPIO matrix
+  if (wokeFromDeepSleep()) {
+    rtc_gpio_deinit(static_cast<gpio_num_t>(Controller::getButtonPin(Controller::BUTTON_SELECT1)));
+    rtc_gpio_deinit(static_cast<gpio_num_t>(Controller::getButtonPin(Controller::BUTTON_SELECT2)));
+  }
+}
+
+/**
+ * @brief Returns the snapshot taken before deep sleep, if this boot is a wake from it
+ * @param snapshot Receives the restored UI state
+ * @return true if a valid snapshot was restored
+ */
+bool SleepManager::consumeSnapshot(UiSnapshot& snapshot) {
+  bool ok = wokeFromDeepSleep() &&
+            decodeUiSnapshot(s_snapshotBuffer, s_snapshotLength, snapshot);
+
+  // One-shot: a later reset must not resume stale state
+  s_snapshotLength = 0;
+  return ok;
+}
+
+bool SleepManager::wokeFromDeepSleep() const {
+  return m_wakeCause == ESP_SLEEP_WAKEUP_EXT0 || m_wakeCause == ESP_SLEEP_WAKEUP_EXT1;
+}
+
+/**
+ * @brief Restarts the inactivity timer (called on every input event)
+ */
+void SleepManager::noteActivity() {
+  m_lastActivityMs = millis();
+}
+
+bool SleepManager::isIdle() const {
+  return m_mode != SLEEP_MODE_NONE && (millis() - m_lastActivityMs) >= m_idleTimeoutMs;
+}
+
+/**
+ * @brief Enters the configured sleep mode
+ * @param snapshot UI state to restore after a deep sleep wake
+ */
+void SleepManager::sleep(const UiSnapshot& snapshot) {
+  FlightRecorder::record(FLIGHT_SLEEP, m_mode);
+  if (m_mode == SLEEP_MODE_LIGHT) {
+    Serial.println("Entering light sleep");
+    Serial.flush();
+
+    configureLightSleepWakeup();
+    esp_light_sleep_start();
+
+    m_wakeCause = esp_sleep_get_wakeup_cause();
+    m_sleepCount++;
+    noteActivity();
+    Serial.println("Woke from light sleep");
+  } else if (m_mode == SLEEP_MODE_DEEP) {
+    s_snapshotLength = encodeUiSnapshot(snapshot, s_snapshotBuffer, sizeof(s_snapshotBuffer));
+    s_deepSleepCount++;
+
+    Serial.println("Entering deep sleep");
+    Serial.flush();
+
+    configureDeepSleepWakeup();
+    esp_deep_sleep_start();
+  }
+}
+
+// Private helper methods
+void SleepManager::configureLightSleepWakeup() {
+  // GPIO wake works on any pin in light sleep; buttons are active low. The
+  // Controller keeps these armed for automatic light sleep too, so they are
+  // left enabled after waking.
+  for (int i = 0; i < Controller::BUTTON_COUNT; i++) {
+    gpio_wakeup_enable(static_cast<gpio_num_t>(Controller::getButtonPin(i)), GPIO_INTR_LOW_LEVEL);
+  }
+  esp_sleep_enable_gpio_wakeup();
+}
+
+void SleepManager::configureDeepSleepWakeup() {
+  // The ESP32's EXT1 source can only wake when ALL pins are low (or ANY is
+  // high), which does not fit active-low buttons. Use EXT0 for SELECT1 and
+  // a single-pin EXT1 mask for SELECT2.
+  gpio_num_t select1 = static_cast<gpio_num_t>(Controller::getButtonPin(Controller::BUTTON_SELECT1));
+  gpio_num_t select2 = static_cast<gpio_num_t>(Controller::getButtonPin(Controller::BUTTON_SELECT2));
+
+  // Keep the RTC pull-ups alive while the digital domain is off
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+  rtc_gpio_pullup_en(select1);
+  rtc_gpio_pulldown_dis(select1);
+  rtc_gpio_pullup_en(select2);
+  rtc_gpio_pulldown_dis(select2);
+
+  esp_sleep_enable_ext0_wakeup(select1, 0);
+  esp_sleep_enable_ext1_wakeup(1ULL << select2, ESP_EXT1_WAKEUP_ALL_LOW);
+}
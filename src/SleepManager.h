@@ -0,0 +1,61 @@
+#ifndef SLEEP_MANAGER_H
+#define SLEEP_MANAGER_H
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include "UiSnapshot.h"
+
+// Sleep depth used after the inactivity timeout
+enum SleepMode {
+  SLEEP_MODE_NONE,    // Never sleep
+  SLEEP_MODE_LIGHT,   // RAM and tasks retained, wakes on any button
+  SLEEP_MODE_DEEP     // Resume through setup() from the RTC-memory snapshot
+};
+
+/**
+ * Puts the system to sleep after a period without input and restores the UI
+ * on wake. Before deep sleep the caller's UiSnapshot is kept in RTC slow
+ * memory; setup() picks it up with consumeSnapshot() and skips the full
+ * display init.
+ */
+class SleepManager {
+private:
+  // Singleton instance
+  static SleepManager* m_instance;
+
+  SleepMode m_mode;
+  uint32_t m_idleTimeoutMs;
+  volatile uint32_t m_lastActivityMs;
+  esp_sleep_wakeup_cause_t m_wakeCause;
+  uint32_t m_sleepCount;
+
+  SleepManager();
+
+  void configureLightSleepWakeup();
+  void configureDeepSleepWakeup();
+
+public:
+  // Defaults
+  static const uint32_t DEFAULT_IDLE_TIMEOUT_MS = 60000;
+
+  static SleepManager* getInstance();
+
+  // Reads the wake cause; call once early in setup()
+  void initialize(SleepMode mode = SLEEP_MODE_DEEP, uint32_t idleTimeoutMs = DEFAULT_IDLE_TIMEOUT_MS);
+
+  // Restores the snapshot saved before deep sleep (one-shot)
+  bool consumeSnapshot(UiSnapshot& snapshot);
+  bool wokeFromDeepSleep() const;
+  esp_sleep_wakeup_cause_t getWakeCause() const { return m_wakeCause; }
+
+  // Inactivity tracking
+  void noteActivity();
+  bool isIdle() const;
+  SleepMode getMode() const { return m_mode; }
+  uint32_t getSleepCount() const { return m_sleepCount; }
+
+  // Sleeps now; deep sleep never returns, light sleep returns after wake
+  void sleep(const UiSnapshot& snapshot);
+};
+
+#endif // SLEEP_MANAGER_H
@@ -0,0 +1,137 @@
+#include "StackMonitor.h"
+#include "Synchronization.h"
+
+// Initialize static instance pointer to nullptr
+StackMonitor* StackMonitor::m_instance = nullptr;
+
+StackMonitor::StackMonitor() : m_entryCount(0) {
+  m_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+StackMonitor* StackMonitor::getInstance() {
+  if (m_instance == nullptr) {
+    m_instance = new StackMonitor();
+  }
+  return m_instance;
+}
+
+/**
+ * @brief Adds a task to the profile
+ * @param name Display name (must outlive the monitor)
+ * @param handle Task to sample, or nullptr for a self-reporting transient task
+ * @param stackSize Configured stack size in bytes
+ * @param configKey TaskConfig.h define holding the size
+ * @return Entry index, or -1 if the table is full
+ */
+int StackMonitor::registerTask(const char* name, TaskHandle_t handle, uint32_t stackSize,
+                               const char* configKey) {
+  int index = -1;
+  portENTER_CRITICAL(&m_lock);
+  if (m_entryCount < MAX_ENTRIES) {
+    index = m_entryCount;
+    Entry& entry = m_entries[index];
+    entry.name = name;
+    entry.configKey = configKey;
+    entry.handle = handle;
+    entry.stackSize = stackSize;
+    entry.minFree = stackSize;
+    entry.samples = 0;
+    entry.warned = false;
+    m_entryCount++;
+  }
+  portEXIT_CRITICAL(&m_lock);
+  return index;
+}
+
+/**
+ * @brief Samples the high-water mark of every registered task
+ */
+void StackMonitor::sample() {
+  Synchronization* sync = Synchronization::getInstance();
+
+  for (int i = 0; i < m_entryCount; i++) {
+    Entry& entry = m_entries[i];
+    if (entry.handle == nullptr) continue;
+
+    // ESP-IDF reports the high-water mark in bytes (StackType_t is uint8_t)
+    record(entry, uxTaskGetStackHighWaterMark(entry.handle));
+
+    if (entry.minFree < STACK_WARNING_BYTES && !entry.warned) {
+      sync->safePrintf("WARNING: Low stack space in %s (%u bytes free)\n",
+                       entry.name, (unsigned)entry.minFree);
+      entry.warned = true;
+    }
+  }
+}
+
+/**
+ * @brief Records the calling task's high-water mark
+ * @param configKey Key of the entry the calling task belongs to
+ */
+void StackMonitor::sampleCurrentTask(const char* configKey) {
+  uint32_t freeBytes = uxTaskGetStackHighWaterMark(nullptr);
+  for (int i = 0; i < m_entryCount; i++) {
+    if (strcmp(m_entries[i].configKey, configKey) == 0) {
+      record(m_entries[i], freeBytes);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Computes a stack size with headroom for a measured peak
+ * @param peakBytes Deepest stack use observed
+ * @return Recommended size in bytes
+ */
+uint32_t StackMonitor::recommendedSize(uint32_t peakBytes) {
+  uint32_t margin = peakBytes * STACK_MARGIN_PERCENT / 100;
+  if (margin < STACK_MARGIN_MIN_BYTES) {
+    margin = STACK_MARGIN_MIN_BYTES;
+  }
+  uint32_t size = peakBytes + margin;
+  return (size + STACK_ROUND_BYTES - 1) / STACK_ROUND_BYTES * STACK_ROUND_BYTES;
+}
+
+/**
+ * @brief Prints measured peaks, recommendations and TaskConfig.h replacements
+ */
+void StackMonitor::printReport() {
+  Synchronization* sync = Synchronization::getInstance();
+  int32_t totalSaving = 0;
+
+  sync->safePrintf("=== Stack usage (bytes) ===\n");
+  sync->safePrintf("  %-12s %6s %6s %6s %6s\n", "Task", "Size", "Peak", "Free", "Rec.");
+  for (int i = 0; i < m_entryCount; i++) {
+    const Entry& entry = m_entries[i];
+    if (entry.samples == 0) {
+      sync->safePrintf("  %-12s %6u %6s\n", entry.name, (unsigned)entry.stackSize, "-");
+      continue;
+    }
+    uint32_t peak = entry.stackSize - entry.minFree;
+    uint32_t recommended = recommendedSize(peak);
+    totalSaving += static_cast<int32_t>(entry.stackSize) - static_cast<int32_t>(recommended);
+    sync->safePrintf("  %-12s %6u %6u %6u %6u\n", entry.name, (unsigned)entry.stackSize,
+                     (unsigned)peak, (unsigned)entry.minFree, (unsigned)recommended);
+  }
+  sync->safePrintf("Applying the recommendations changes stack RAM by %ld bytes\n",
+                   (long)-totalSaving);
+
+  // Paste-ready block for TaskConfig.h (tasks fixed by the core are skipped)
+  sync->safePrintf("Suggested TaskConfig.h values:\n");
+  for (int i = 0; i < m_entryCount; i++) {
+    const Entry& entry = m_entries[i];
+    if (entry.samples == 0 || strcmp(entry.configKey, "TASK_LOOP_STACK") == 0) continue;
+    sync->safePrintf("#define %-24s %u\n", entry.configKey,
+                     (unsigned)recommendedSize(entry.stackSize - entry.minFree));
+  }
+}
+
+// Private helper methods
+void StackMonitor::record(Entry& entry, uint32_t freeBytes) {
+  portENTER_CRITICAL(&m_lock);
+  if (freeBytes < entry.minFree) {
+    entry.minFree = freeBytes;
+  }
+  entry.samples++;
+  portEXIT_CRITICAL(&m_lock);
+}
@@ -0,0 +1,64 @@
+#ifndef STACK_MONITOR_H
+#define STACK_MONITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "TaskConfig.h"
+
+/**
+ * Runtime stack profiler.
+ *
+ * Tracks the high-water mark (minimum free stack) of every registered task
+ * and turns the measured peak into a recommended stack size: peak plus
+ * STACK_MARGIN_PERCENT (at least STACK_MARGIN_MIN_BYTES), rounded up to
+ * STACK_ROUND_BYTES. The report prints the recommendations as TaskConfig.h
+ * defines so they can be pasted back into the central configuration.
+ *
+ * Transient tasks (boot stages) cannot be sampled after they exit, so they
+ * record their own high-water mark with sampleCurrentTask() before deleting
+ * themselves.
+ */
+class StackMonitor {
+public:
+  static const int MAX_ENTRIES = 8;
+
+  static StackMonitor* getInstance();
+
+  // Adds a task; handle may be nullptr for transient tasks that self-report
+  int registerTask(const char* name, TaskHandle_t handle, uint32_t stackSize, const char* configKey);
+
+  // Samples every registered task; warns about tasks below STACK_WARNING_BYTES
+  void sample();
+
+  // Records the calling task's high-water mark into the entry with this key
+  void sampleCurrentTask(const char* configKey);
+
+  // Recommended size for a measured peak
+  static uint32_t recommendedSize(uint32_t peakBytes);
+
+  void printReport();
+
+private:
+  struct Entry {
+    const char* name;
+    const char* configKey;
+    TaskHandle_t handle;
+    uint32_t stackSize;
+    uint32_t minFree;     // Lowest free stack seen, in bytes
+    uint32_t samples;
+    bool warned;
+  };
+
+  static StackMonitor* m_instance;
+
+  Entry m_entries[MAX_ENTRIES];
+  int m_entryCount;
+  portMUX_TYPE m_lock;
+
+  StackMonitor();
+
+  void record(Entry& entry, uint32_t freeBytes);
+};
+
+#endif // STACK_MONITOR_H
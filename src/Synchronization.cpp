@@ -1,4 +1,5 @@
 #include "Synchronization.h"
+#include "Trace.h"
 #include <stdarg.h>
 
 // Initialize static instance pointer to nullptr
@@ -89,7 +90,7 @@ void Synchronization::cleanup() {
 
 // Mutex operations for display access
 bool Synchronization::acquireDisplayMutex(TickType_t timeout) {
-  return m_displayMutex != nullptr && xSemaphoreTake(m_displayMutex, timeout) == pdTRUE;
+  return m_displayMutex != nullptr && TRACE_TAKE(m_displayMutex, timeout, TRACE_MUTEX_SYNC_DISPLAY) == pdTRUE;
 }
 
 void Synchronization::releaseDisplayMutex() {
@@ -100,7 +101,7 @@ void Synchronization::releaseDisplayMutex() {
 
 // Mutex operations for state access
 bool Synchronization::acquireStateMutex(TickType_t timeout) {
-  return m_stateMutex != nullptr && xSemaphoreTake(m_stateMutex, timeout) == pdTRUE;
+  return m_stateMutex != nullptr && TRACE_TAKE(m_stateMutex, timeout, TRACE_MUTEX_SYNC_STATE) == pdTRUE;
 }
 
 void Synchronization::releaseStateMutex() {
@@ -111,7 +112,7 @@ void Synchronization::releaseStateMutex() {
 
 // Mutex operations for serial port access
 bool Synchronization::acquireSerialMutex(TickType_t timeout) {
-  return m_serialMutex != nullptr && xSemaphoreTake(m_serialMutex, timeout) == pdTRUE;
+  return m_serialMutex != nullptr && TRACE_TAKE(m_serialMutex, timeout, TRACE_MUTEX_SYNC_SERIAL) == pdTRUE;
 }
 
 void Synchronization::releaseSerialMutex() {
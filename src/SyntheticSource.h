@@ -0,0 +1,153 @@
+#ifndef SYNTHETIC_SOURCE_H
+#define SYNTHETIC_SOURCE_H
+
+#include <math.h>
+#include "SensorSource.h"
+
+enum SyntheticShape {
+  SHAPE_SINE,
+  SHAPE_TRIANGLE,
+  SHAPE_SQUARE,
+  SHAPE_RAMP
+};
+
+// Waveform of one synthetic channel, in raw counts
+struct SyntheticWaveform {
+  SyntheticShape shape;
+  float periodMs;
+  uint16_t amplitude;    // Peak deviation from the midpoint
+  uint16_t midpoint;
+  uint16_t noise;        // Peak uniform noise added to every sample
+
+  SyntheticWaveform()
+    : shape(SHAPE_SINE), periodMs(1000.0f), amplitude(1000), midpoint(2048), noise(0) {}
+  SyntheticWaveform(SyntheticShape s, float period, uint16_t amp, uint16_t mid, uint16_t n = 0)
+    : shape(s), periodMs(period), amplitude(amp), midpoint(mid), noise(n) {}
+};
+
+/**
+ * Waveform generator standing in for the ADC.
+ *
+ * With a clock (microseconds) it produces samples at the configured rate in
+ * real time, so the pipeline sees the same batching as with DMA. Without a
+ * clock every read() returns a full batch, which drives host benchmarks as
+ * fast as the pipeline can consume. Pure C++: no Arduino or IDF dependency.
+ */
+class SyntheticSource : public SensorSource {
+public:
+  typedef uint32_t (*MicrosClock)();
+
+  static const uint8_t MAX_CHANNELS = 8;
+
+  explicit SyntheticSource(MicrosClock clock = nullptr)
+    : m_clock(clock), m_channelCount(0), m_sampleRateHz(0), m_next(0),
+      m_lastUs(0), m_pendingFraction(0), m_backlog(0), m_noiseState(0x2545F491u) {
+    for (uint8_t i = 0; i < MAX_CHANNELS; i++) {
+      m_phase[i] = 0.0f;
+    }
+  }
+
+  // Waveform for a channel slot (index into the begin() channel list)
+  void setWaveform(uint8_t slot, const SyntheticWaveform& waveform) {
+    if (slot < MAX_CHANNELS) m_waveforms[slot] = waveform;
+  }
+
+  bool begin(const uint8_t* channels, uint8_t channelCount, uint32_t sampleRateHz) override {
+    if (channelCount == 0 || channelCount > MAX_CHANNELS || sampleRateHz == 0) return false;
+    for (uint8_t i = 0; i < channelCount; i++) {
+      m_channels[i] = channels[i];
+    }
+    m_channelCount = channelCount;
+    m_sampleRateHz = sampleRateHz;
+    for (uint8_t i = 0; i < MAX_CHANNELS; i++) {
+      m_phase[i] = 0.0f;
+    }
+    m_next = 0;
+    m_pendingFraction = 0;
+    m_backlog = 0;
+    m_lastUs = m_clock ? m_clock() : 0;
+    return true;
+  }
+
+  void end() override {
+    m_channelCount = 0;
+  }
+
+  size_t read(SensorSample* out, size_t maxSamples) override {
+    if (m_channelCount == 0) return 0;
+
+    size_t due = maxSamples;
+    if (m_clock != nullptr) {
+      // Samples converted since the last read, carrying the remainder
+      uint32_t now = m_clock();
+      uint64_t scaled = static_cast<uint64_t>(now - m_lastUs) * m_sampleRateHz + m_pendingFraction;
+      m_lastUs = now;
+      m_backlog += scaled / 1000000;
+      m_pendingFraction = static_cast<uint32_t>(scaled % 1000000);
+      if (m_backlog < due) due = static_cast<size_t>(m_backlog);
+      m_backlog -= due;
+    }
+
+    for (size_t i = 0; i < due; i++) {
+      out[i].channel = m_channels[m_next];
+      out[i].raw = generate(m_next);
+      if (++m_next == m_channelCount) m_next = 0;
+    }
+    return due;
+  }
+
+private:
+  MicrosClock m_clock;
+  uint8_t m_channels[MAX_CHANNELS];
+  SyntheticWaveform m_waveforms[MAX_CHANNELS];
+  uint8_t m_channelCount;
+  uint32_t m_sampleRateHz;
+  uint8_t m_next;               // Channel slot of the next sample (round-robin like the ADC pattern)
+  float m_phase[MAX_CHANNELS];  // 0..1 within the waveform period
+  uint32_t m_lastUs;
+  uint32_t m_pendingFraction;
+  uint64_t m_backlog;           // Samples converted but not read yet
+  uint32_t m_noiseState;
+
+  uint16_t generate(uint8_t slot) {
+    const SyntheticWaveform& wave = m_waveforms[slot];
+    float phase = m_phase[slot];
+
+    // Each channel is sampled once per pattern round
+    float roundMs = 1000.0f * m_channelCount / m_sampleRateHz;
+    m_phase[slot] += roundMs / wave.periodMs;
+    if (m_phase[slot] >= 1.0f) m_phase[slot] -= floorf(m_phase[slot]);
+
+    float unit;
+    switch (wave.shape) {
+      case SHAPE_TRIANGLE:
+        unit = phase < 0.5f ? 4.0f * phase - 1.0f : 3.0f - 4.0f * phase;
+        break;
+      case SHAPE_SQUARE:
+        unit = phase < 0.5f ? 1.0f : -1.0f;
+        break;
+      case SHAPE_RAMP:
+        unit = 2.0f * phase - 1.0f;
+        break;
+      case SHAPE_SINE:
+      default:
+        unit = sinf(6.2831853f * phase);
+        break;
+    }
+
+    int32_t value = wave.midpoint + static_cast<int32_t>(unit * wave.amplitude);
+    if (wave.noise > 0) {
+      // xorshift32: cheap, deterministic noise
+      m_noiseState ^= m_noiseState << 13;
+      m_noiseState ^= m_noiseState >> 17;
+      m_noiseState ^= m_noiseState << 5;
+      value += static_cast<int32_t>(m_noiseState % (2u * wave.noise + 1)) - wave.noise;
+    }
+
+    if (value < 0) value = 0;
+    if (value > maxRaw()) value = maxRaw();
+    return static_cast<uint16_t>(value);
+  }
+};
+
+#endif // SYNTHETIC_SOURCE_H
@@ -0,0 +1,55 @@
+#ifndef TASK_CONFIG_H
+#define TASK_CONFIG_H
+
+// Central task configuration. Stack sizes are in bytes (ESP-IDF convention).
+//
+// The StackMonitor report prints a replacement block for the sizes below,
+// computed from measured peaks plus a safety margin; scripts/stack_usage.py
+// prints the static frame sizes of each task's entry points at build time.
+
+// UI executor: controller, view loops, RTC update and status coroutines, plus
+// TaskLink, tunable callbacks, the sensor pipeline and history and the trace
+// exporter. Several of these format with printf (newlib's vfprintf frame is
+// over 1 KB on its own), so 2048 left no margin; replace with the StackMonitor
+// recommendation once a build has run through an import and a trace export
+#define TASK_UI_NAME              "UI"
+#define TASK_UI_STACK             4096
+#define TASK_UI_PRIORITY          2
+
+// Bus worker: display renders and RTC reads
+#define TASK_I2C_NAME             "I2C"
+#define TASK_I2C_STACK            2048
+#define TASK_I2C_PRIORITY         1
+
+// Load generator executor (LOAD_TEST builds only); below the UI so it competes
+// like a real producer instead of starving the controller
+#define TASK_LOAD_NAME            "Load"
+#define TASK_LOAD_STACK           2048
+#define TASK_LOAD_PRIORITY        1
+
+// Input and view timing: defaults of the runtime tunables (Tunables.h)
+#define INPUT_DEBOUNCE_MS         50     // A button must hold its level this long
+#define INPUT_POLL_MS             10     // Scan period while a button or the encoder is active
+#define VIEW_OLED_INTERVAL_MS     250    // Minimum time between OLED frames
+#define VIEW_LCD_INTERVAL_MS      500    // Minimum time between LCD frames
+
+// Short-lived boot stage workers (device init, including display begin())
+#define TASK_BOOT_STAGE_STACK     4096
+#define TASK_BOOT_STAGE_PRIORITY  2
+
+// Arduino loop task (fixed by the core; monitored only)
+#define TASK_LOOP_NAME            "loopTask"
+#ifdef ARDUINO_LOOP_STACK_SIZE
+#define TASK_LOOP_STACK           ARDUINO_LOOP_STACK_SIZE
+#else
+#define TASK_LOOP_STACK           8192
+#endif
+
+// Stack profiling: report period and recommendation policy (sampled by the status check)
+#define STACK_MONITOR_REPORT_MS   60000
+#define STACK_WARNING_BYTES       128    // Warn when a task has less free stack than this
+#define STACK_MARGIN_PERCENT      25     // Headroom over the measured peak
+#define STACK_MARGIN_MIN_BYTES    512    // Never less than this (interrupt frames, untested paths)
+#define STACK_ROUND_BYTES         256
+
+#endif // TASK_CONFIG_H
@@ -0,0 +1,132 @@
+#include "TaskLink.h"
+
+/**
+ * @brief Constructor - idle until initialize()
+ */
+TaskLink::TaskLink() : m_endpoint(m_io, m_store), m_running(false) {
+}
+
+/**
+ * @brief Binds the link to the Model's task list, the tunables and a UART
+ * @param model Model owning the TaskManager and reminders
+ * @param port UART to serve (its buffers should be RX_BUFFER_SIZE/TX_BUFFER_SIZE)
+ * @return true
+ */
+bool TaskLink::initialize(Model& model, HardwareSerial& port) {
+  m_store.setModel(&model);
+  m_io.setPort(&port);
+  m_endpoint.setTunables(Tunables::getInstance());
+  return true;
+}
+
+bool TaskLink::start(ExecutorTask& executor) {
+  if (m_running) {
+    return false;
+  }
+
+  m_running = true;
+  executor.spawn(*this);
+  return true;
+}
+
+/**
+ * @brief Ends the coroutine; an import in progress is rolled back
+ */
+void TaskLink::stop() {
+  m_running = false;
+  m_endpoint.abort();
+}
+
+/**
+ * @brief Transfer loop coroutine
+ * Yields after every frame while a transfer runs, polls slowly when idle.
+ */
+void TaskLink::step() {
+  CO_BEGIN();
+
+  while (m_running) {
+    if (m_endpoint.poll(coNow())) {
+      CO_YIELD();
+    } else {
+      CO_DELAY(IDLE_POLL_MS);
+    }
+  }
+
+  CO_END();
+}
+
+size_t TaskLink::SerialIo::read(uint8_t* data, size_t max) {
+  size_t count = 0;
+  while (count < max && m_port->available() > 0) {
+    data[count++] = static_cast<uint8_t>(m_port->read());
+  }
+  return count;
+}
+
+size_t TaskLink::SerialIo::write(const uint8_t* data, size_t length) {
+  return m_port->write(data, length);
+}
+
+size_t TaskLink::SerialIo::writable() {
+  int room = m_port->availableForWrite();
+  return room > 0 ? static_cast<size_t>(room) : 0;
+}
+
+bool TaskLink::ManagerStore::beginImport(bool replace) {
+  TaskManager& tasks = m_model->getTaskManager();
+  m_batch = tasks.beginBatch();
+  if (m_batch == NO_BATCH) return false;
+  if (replace && !tasks.reset(m_batch)) {
+    abortImport();
+    return false;
+  }
+  return true;
+}
+
+bool TaskLink::ManagerStore::importTask(const TaskLinkRecord& record) {
+  // Decoded record -> task slot, no intermediate copies beyond the Task itself
+  Task task(record.title, record.priority, record.category);
+  task.isComplete = record.complete;
+  task.dueTime = record.dueTime;
+  return m_model->getTaskManager().addTask(task, m_batch);
+}
+
+bool TaskLink::ManagerStore::commitImport() {
+  // A batch left open would refuse every later edit
+  if (!m_model->getTaskManager().commitBatch(m_batch)) {
+    abortImport();
+    return false;
+  }
+  m_batch = NO_BATCH;
+
+  // Ids were reassigned: reminders follow the imported due times
+  m_model->syncTaskReminders();
+  return true;
+}
+
+void TaskLink::ManagerStore::abortImport() {
+  m_model->getTaskManager().rollbackBatch(m_batch);
+  m_batch = NO_BATCH;
+}
+
+bool TaskLink::ManagerStore::beginExport(uint32_t& version, uint16_t& count) {
+  TaskSnapshot snapshot(m_model->getTaskManager());
+  version = snapshot.getVersion();
+  count = snapshot.getTaskCount();
+  return true;
+}
+
+bool TaskLink::ManagerStore::exportTask(uint32_t version, uint16_t index, TaskLinkRecord& record) {
+  TaskSnapshot snapshot(m_model->getTaskManager());
+  const Task* task = snapshot.getTaskByIndex(index);
+  if (snapshot.getVersion() != version || task == nullptr) return false;
+
+  record.id = task->id;
+  record.priority = task->priority;
+  record.category = task->category;
+  record.complete = task->isComplete;
+  record.dueTime = task->dueTime;
+  strncpy(record.title, task->title, TaskLinkRecord::TITLE_SIZE - 1);
+  record.title[TaskLinkRecord::TITLE_SIZE - 1] = '\0';
+  return true;
+}
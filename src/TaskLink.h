@@ -0,0 +1,75 @@
+#ifndef TASK_LINK_H
+#define TASK_LINK_H
+
+#include <Arduino.h>
+#include "Coroutine.h"
+#include "ExecutorTask.h"
+#include "Model.h"
+#include "TaskLinkEndpoint.h"
+
+/**
+ * Serves TaskLink transfers on a UART from a coroutine on the UI executor.
+ *
+ * Each step handles one frame at most, then yields, so button handling and
+ * renders interleave with a transfer of any size. An import is one
+ * TaskManager batch: views keep showing the old list until it commits.
+ * Log output may share the port; the host skips it between frames.
+ */
+class TaskLink : public Coroutine {
+public:
+  // UART buffers must hold the receive window and one outgoing frame
+  static const size_t RX_BUFFER_SIZE = 1024;
+  static const size_t TX_BUFFER_SIZE = 1024;
+  static const uint32_t IDLE_POLL_MS = 50;
+
+  TaskLink();
+
+  bool initialize(Model& model, HardwareSerial& port);
+  bool start(ExecutorTask& executor);
+  void stop();
+
+  // Statistics
+  uint32_t getImportedCount() const { return m_endpoint.getImportedCount(); }
+  uint32_t getExportedCount() const { return m_endpoint.getExportedCount(); }
+  uint32_t getFrameErrors() const { return m_endpoint.getFrameErrors(); }
+  uint32_t getFailedTransfers() const { return m_endpoint.getFailedTransfers(); }
+
+protected:
+  void step() override;
+
+private:
+  // Non-blocking UART access
+  class SerialIo : public TaskLinkIo {
+  public:
+    SerialIo() : m_port(nullptr) {}
+    void setPort(HardwareSerial* port) { m_port = port; }
+    size_t read(uint8_t* data, size_t max) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    size_t writable() override;
+  private:
+    HardwareSerial* m_port;
+  };
+
+  // Imports as one TaskManager batch; exports from per-record snapshots
+  class ManagerStore : public TaskLinkStore {
+  public:
+    ManagerStore() : m_model(nullptr), m_batch(NO_BATCH) {}
+    void setModel(Model* model) { m_model = model; }
+    bool beginImport(bool replace) override;
+    bool importTask(const TaskLinkRecord& record) override;
+    bool commitImport() override;
+    void abortImport() override;
+    bool beginExport(uint32_t& version, uint16_t& count) override;
+    bool exportTask(uint32_t version, uint16_t index, TaskLinkRecord& record) override;
+  private:
+    Model* m_model;
+    TaskBatch m_batch;    // Open import; UI edits meanwhile are refused
+  };
+
+  SerialIo m_io;
+  ManagerStore m_store;
+  TaskLinkEndpoint m_endpoint;
+  bool m_running;
+};
+
+#endif // TASK_LINK_H
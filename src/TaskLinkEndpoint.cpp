@@ -0,0 +1,320 @@
+#include "TaskLinkEndpoint.h"
+
+/**
+ * @brief Constructor
+ * @param io Byte stream to the host
+ * @param store Task list to serve
+ */
+TaskLinkEndpoint::TaskLinkEndpoint(TaskLinkIo& io, TaskLinkStore& store)
+  : m_io(io), m_store(store), m_tunables(nullptr), m_state(STATE_IDLE), m_lastActivity(0),
+    m_rxPos(0), m_rxLength(0), m_txSeq(0), m_rxSeq(0), m_txCredits(0),
+    m_transferCount(0), m_exportCount(0), m_exportVersion(0),
+    m_imported(0), m_exported(0), m_failures(0) {
+}
+
+/**
+ * @brief Handles one received frame and sends one TASKS frame if possible
+ * @param nowMs Current time, for the transfer timeout
+ * @return true if anything was received or sent
+ */
+bool TaskLinkEndpoint::poll(uint32_t nowMs) {
+  bool busy = false;
+  if (receiveFrame()) {
+    m_lastActivity = nowMs;
+    handleFrame(m_framer.frame());
+    busy = true;
+  }
+
+  if (m_state == STATE_EXPORTING && sendTasks()) {
+    m_lastActivity = nowMs;
+    busy = true;
+  }
+
+  if (m_state != STATE_IDLE && nowMs - m_lastActivity > TIMEOUT_MS) {
+    fail(TASKLINK_ERR_TIMEOUT);
+  }
+  return busy || m_rxPos < m_rxLength;
+}
+
+/**
+ * @brief Drops the current transfer; an open import is rolled back
+ */
+void TaskLinkEndpoint::abort() {
+  if (m_state == STATE_IMPORTING) {
+    m_store.abortImport();
+  }
+  m_state = STATE_IDLE;
+}
+
+// Private helper methods
+bool TaskLinkEndpoint::receiveFrame() {
+  while (true) {
+    if (m_rxPos == m_rxLength) {
+      m_rxPos = 0;
+      m_rxLength = m_io.read(m_rx, sizeof(m_rx));
+      if (m_rxLength == 0) return false;
+    }
+    // Stop at a frame boundary: the rest waits for the next poll
+    while (m_rxPos < m_rxLength) {
+      if (m_framer.push(m_rx[m_rxPos++])) return true;
+    }
+  }
+}
+
+void TaskLinkEndpoint::handleFrame(const TaskLinkFrame& frame) {
+  switch (frame.type) {
+    case TASKLINK_IMPORT_BEGIN:
+      handleImportBegin(frame);
+      break;
+    case TASKLINK_TASKS:
+      handleTasks(frame);
+      break;
+    case TASKLINK_IMPORT_END:
+      handleImportEnd();
+      break;
+    case TASKLINK_EXPORT_REQUEST:
+      handleExportRequest(frame);
+      break;
+    case TASKLINK_CREDIT:
+      if (m_state == STATE_EXPORTING && frame.length >= 1) {
+        m_txCredits = static_cast<uint8_t>(m_txCredits + frame.payload[0]);
+      }
+      break;
+    case TASKLINK_ERROR:
+      // The host gave up
+      abort();
+      break;
+    case TASKLINK_TUNE_LIST:
+    case TASKLINK_TUNE_GET:
+    case TASKLINK_TUNE_SET:
+    case TASKLINK_TUNE_SAVE:
+      handleTune(frame);
+      break;
+    default:
+      fail(TASKLINK_ERR_STATE);
+      break;
+  }
+}
+
+void TaskLinkEndpoint::handleImportBegin(const TaskLinkFrame& frame) {
+  if (m_state != STATE_IDLE) {
+    fail(TASKLINK_ERR_STATE);
+    return;
+  }
+  bool replace = frame.length >= 1 && (frame.payload[0] & TASKLINK_IMPORT_REPLACE) != 0;
+  if (!m_store.beginImport(replace)) {
+    fail(TASKLINK_ERR_BUSY);
+    return;
+  }
+
+  m_state = STATE_IMPORTING;
+  m_rxSeq = static_cast<uint8_t>(frame.seq + 1);
+  m_transferCount = 0;
+  sendCredit(RECEIVE_WINDOW);
+}
+
+void TaskLinkEndpoint::handleTasks(const TaskLinkFrame& frame) {
+  // Frames the host had in flight when an import failed: answering each one
+  // would leave stale errors queued for its next request
+  if (m_state == STATE_IDLE) return;
+  if (m_state != STATE_IMPORTING) {
+    fail(TASKLINK_ERR_STATE);
+    return;
+  }
+  if (frame.seq != m_rxSeq) {
+    fail(TASKLINK_ERR_SEQUENCE);
+    return;
+  }
+  m_rxSeq++;
+
+  // Records are decoded straight from the frame into the store
+  if (frame.length < 1) {
+    fail(TASKLINK_ERR_MALFORMED);
+    return;
+  }
+  uint8_t count = frame.payload[0];
+  size_t offset = 1;
+  for (uint8_t i = 0; i < count; i++) {
+    size_t used = taskLinkUnpackRecord(frame.payload + offset, frame.length - offset, m_record);
+    if (used == 0) {
+      fail(TASKLINK_ERR_MALFORMED);
+      return;
+    }
+    offset += used;
+    if (!m_store.importTask(m_record)) {
+      fail(TASKLINK_ERR_FULL);
+      return;
+    }
+    m_transferCount++;
+  }
+  sendCredit(1);
+}
+
+void TaskLinkEndpoint::handleImportEnd() {
+  if (m_state != STATE_IMPORTING) {
+    fail(TASKLINK_ERR_STATE);
+    return;
+  }
+  m_state = STATE_IDLE;
+  if (!m_store.commitImport()) {
+    m_failures++;
+    uint8_t status = TASKLINK_ERR_BUSY;
+    send(TASKLINK_ERROR, &status, 1);
+    return;
+  }
+
+  m_imported += m_transferCount;
+  uint8_t payload[3];
+  payload[0] = TASKLINK_OK;
+  taskLinkPut16(payload + 1, m_transferCount);
+  send(TASKLINK_ACK, payload, sizeof(payload));
+}
+
+void TaskLinkEndpoint::handleExportRequest(const TaskLinkFrame& frame) {
+  if (m_state != STATE_IDLE) {
+    fail(TASKLINK_ERR_STATE);
+    return;
+  }
+  if (!m_store.beginExport(m_exportVersion, m_exportCount)) {
+    fail(TASKLINK_ERR_BUSY);
+    return;
+  }
+
+  m_state = STATE_EXPORTING;
+  m_txCredits = frame.length >= 1 ? frame.payload[0] : 1;
+  m_transferCount = 0;
+
+  uint8_t payload[6];
+  taskLinkPut16(payload, m_exportCount);
+  taskLinkPut32(payload + 2, m_exportVersion);
+  send(TASKLINK_EXPORT_BEGIN, payload, sizeof(payload));
+}
+
+bool TaskLinkEndpoint::sendTasks() {
+  if (m_transferCount == m_exportCount) {
+    // Everything sent: finish once the transmit buffer has room
+    if (m_io.writable() < TaskLinkFramer::HEADER_SIZE + 2 + TaskLinkFramer::CRC_SIZE) return false;
+    uint8_t payload[2];
+    taskLinkPut16(payload, m_exportCount);
+    send(TASKLINK_EXPORT_END, payload, sizeof(payload));
+    m_exported += m_exportCount;
+    m_state = STATE_IDLE;
+    return true;
+  }
+
+  if (m_txCredits == 0 || m_io.writable() < TaskLinkFramer::MAX_FRAME) return false;
+
+  // Pack records into the payload area of the transmit buffer, then frame it
+  uint8_t* payload = m_tx + TaskLinkFramer::HEADER_SIZE;
+  size_t length = 1;
+  uint8_t count = 0;
+  while (m_transferCount < m_exportCount && count < 255) {
+    if (!m_store.exportTask(m_exportVersion, m_transferCount, m_record)) {
+      fail(TASKLINK_ERR_CHANGED);
+      return true;
+    }
+    size_t used = taskLinkPackRecord(m_record, payload + length, TaskLinkFrame::MAX_PAYLOAD - length);
+    if (used == 0) break;
+    length += used;
+    count++;
+    m_transferCount++;
+  }
+  payload[0] = count;
+
+  m_txCredits--;
+  send(TASKLINK_TASKS, payload, length);
+  return true;
+}
+
+/**
+ * @brief Answers a TUNE_* request; errors do not disturb a transfer in progress
+ */
+void TaskLinkEndpoint::handleTune(const TaskLinkFrame& frame) {
+  if (m_tunables == nullptr) {
+    reject(TASKLINK_ERR_STATE);
+    return;
+  }
+
+  switch (frame.type) {
+    case TASKLINK_TUNE_LIST:
+      sendTunableList(frame.length >= 1 ? frame.payload[0] : 0);
+      break;
+    case TASKLINK_TUNE_GET:
+      if (frame.length < 1 || frame.payload[0] >= TUNE_COUNT) {
+        reject(TASKLINK_ERR_RANGE);
+        return;
+      }
+      sendTunableValue(frame.payload[0]);
+      break;
+    case TASKLINK_TUNE_SET:
+      if (frame.length < 5) {
+        reject(TASKLINK_ERR_MALFORMED);
+        return;
+      }
+      if (!m_tunables->set(frame.payload[0], static_cast<int32_t>(taskLinkGet32(frame.payload + 1)))) {
+        reject(TASKLINK_ERR_RANGE);
+        return;
+      }
+      sendTunableValue(frame.payload[0]);
+      break;
+    case TASKLINK_TUNE_SAVE: {
+      bool erase = frame.length >= 1 && (frame.payload[0] & TASKLINK_TUNE_ERASE) != 0;
+      uint8_t status = (erase ? m_tunables->erase() : m_tunables->save()) ? TASKLINK_OK : TASKLINK_ERR_BUSY;
+      send(TASKLINK_ACK, &status, 1);
+      break;
+    }
+  }
+}
+
+void TaskLinkEndpoint::sendTunableList(uint8_t first) {
+  uint8_t* payload = m_tx + TaskLinkFramer::HEADER_SIZE;
+  size_t length = 2;
+  uint8_t count = 0;
+  for (uint8_t id = first; id < TUNE_COUNT; id++) {
+    const TunableDef& def = Tunables::getDef(id);
+    TaskLinkTunable tunable;
+    tunable.id = id;
+    tunable.type = def.type;
+    tunable.min = def.min;
+    tunable.max = def.max;
+    tunable.def = def.def;
+    tunable.value = m_tunables->get(id);
+    strncpy(tunable.name, def.name, TaskLinkTunable::NAME_SIZE - 1);
+    tunable.name[TaskLinkTunable::NAME_SIZE - 1] = '\0';
+
+    size_t used = taskLinkPackTunable(tunable, payload + length, TaskLinkFrame::MAX_PAYLOAD - length);
+    if (used == 0) break;
+    length += used;
+    count++;
+  }
+  payload[0] = TUNE_COUNT;
+  payload[1] = count;
+  send(TASKLINK_TUNE_LIST, payload, length);
+}
+
+void TaskLinkEndpoint::sendTunableValue(uint8_t id) {
+  uint8_t payload[5];
+  payload[0] = id;
+  taskLinkPut32(payload + 1, static_cast<uint32_t>(m_tunables->get(id)));
+  send(TASKLINK_TUNE_VALUE, payload, sizeof(payload));
+}
+
+void TaskLinkEndpoint::send(uint8_t type, const uint8_t* payload, size_t length) {
+  size_t size = TaskLinkFramer::encode(type, m_txSeq++, payload, length, m_tx);
+  m_io.write(m_tx, size);
+}
+
+void TaskLinkEndpoint::sendCredit(uint8_t credits) {
+  send(TASKLINK_CREDIT, &credits, 1);
+}
+
+// Refuses one request without ending the transfer in progress
+void TaskLinkEndpoint::reject(uint8_t status) {
+  send(TASKLINK_ERROR, &status, 1);
+}
+
+void TaskLinkEndpoint::fail(uint8_t status) {
+  abort();
+  m_failures++;
+  send(TASKLINK_ERROR, &status, 1);
+}
@@ -0,0 +1,119 @@
+#ifndef TASK_LINK_ENDPOINT_H
+#define TASK_LINK_ENDPOINT_H
+
+#include "TaskLinkProtocol.h"
+#include "Tunables.h"
+
+// Byte stream the endpoint talks over; both calls must not block
+class TaskLinkIo {
+public:
+  virtual ~TaskLinkIo() {}
+
+  virtual size_t read(uint8_t* data, size_t max) = 0;
+  virtual size_t write(const uint8_t* data, size_t length) = 0;
+
+  // Bytes write() accepts without blocking
+  virtual size_t writable() = 0;
+};
+
+// Task list the endpoint imports into and exports from
+class TaskLinkStore {
+public:
+  virtual ~TaskLinkStore() {}
+
+  // Import: tasks are invisible to readers until commitImport()
+  virtual bool beginImport(bool replace) = 0;
+  virtual bool importTask(const TaskLinkRecord& record) = 0;
+  virtual bool commitImport() = 0;
+  virtual void abortImport() = 0;
+
+  // Export: one consistent version; exportTask() fails once it changed
+  virtual bool beginExport(uint32_t& version, uint16_t& count) = 0;
+  virtual bool exportTask(uint32_t version, uint16_t index, TaskLinkRecord& record) = 0;
+};
+
+/**
+ * Device end of TaskLink: serves imports and exports for a TaskLinkStore.
+ *
+ * poll() handles at most one received frame and sends at most one TASKS
+ * frame, so a transfer of any size advances in short, bounded steps. The
+ * peer is paced by credits: it may only have RECEIVE_WINDOW TASKS frames in
+ * flight, which the UART buffer must hold. Exports wait for room in the
+ * transmit buffer instead of blocking in write(). TUNE_* requests are
+ * answered in any state once setTunables() attached a registry.
+ *
+ * Pure C++: the host tool runs the same endpoint over a pty.
+ */
+class TaskLinkEndpoint {
+public:
+  static const uint8_t RECEIVE_WINDOW = 2;
+  static const uint32_t TIMEOUT_MS = 5000;
+
+  TaskLinkEndpoint(TaskLinkIo& io, TaskLinkStore& store);
+
+  // Serves TUNE_* requests from this registry (nullptr: refused)
+  void setTunables(Tunables* tunables) { m_tunables = tunables; }
+
+  // Advances the protocol; returns true if there was any work (call again soon)
+  bool poll(uint32_t nowMs);
+
+  // Drops a transfer in progress (an import is rolled back)
+  void abort();
+
+  bool isIdle() const { return m_state == STATE_IDLE; }
+  uint32_t getImportedCount() const { return m_imported; }
+  uint32_t getExportedCount() const { return m_exported; }
+  uint32_t getFrameErrors() const { return m_framer.getErrorCount(); }
+  uint32_t getFailedTransfers() const { return m_failures; }
+
+private:
+  enum State {
+    STATE_IDLE,
+    STATE_IMPORTING,
+    STATE_EXPORTING
+  };
+
+  TaskLinkIo& m_io;
+  TaskLinkStore& m_store;
+  Tunables* m_tunables;
+  TaskLinkFramer m_framer;
+  State m_state;
+  uint32_t m_lastActivity;
+
+  // Received bytes not yet fed to the framer
+  uint8_t m_rx[64];
+  size_t m_rxPos;
+  size_t m_rxLength;
+
+  uint8_t m_txSeq;
+  uint8_t m_rxSeq;          // Expected sequence of the next TASKS frame
+  uint8_t m_txCredits;      // TASKS frames the peer will accept
+  uint8_t m_tx[TaskLinkFramer::MAX_FRAME];
+  TaskLinkRecord m_record;
+
+  // Transfer progress
+  uint16_t m_transferCount;
+  uint16_t m_exportCount;
+  uint32_t m_exportVersion;
+
+  uint32_t m_imported;
+  uint32_t m_exported;
+  uint32_t m_failures;
+
+  bool receiveFrame();
+  void handleFrame(const TaskLinkFrame& frame);
+  void handleImportBegin(const TaskLinkFrame& frame);
+  void handleTasks(const TaskLinkFrame& frame);
+  void handleImportEnd();
+  void handleExportRequest(const TaskLinkFrame& frame);
+  bool sendTasks();
+  void handleTune(const TaskLinkFrame& frame);
+  void sendTunableList(uint8_t first);
+  void sendTunableValue(uint8_t id);
+  void reject(uint8_t status);
+  void send(uint8_t type, const uint8_t* payload, size_t length);
+  void sendCredit(uint8_t credits);
+  void fail(uint8_t status);
+};
+
+#endif // TASK_LINK_ENDPOINT_H
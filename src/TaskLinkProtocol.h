@@ -0,0 +1,296 @@
+#ifndef TASK_LINK_PROTOCOL_H
+#define TASK_LINK_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Crc16.h"
+
+/**
+ * TaskLink: binary task transfer over a byte stream (UART, pty).
+ *
+ * Frame:  0xA5 | type | seq | length (LE16) | payload | CRC-16/CCITT (LE16)
+ * The CRC covers type through payload. Receivers hunt for 0xA5 and drop
+ * anything that does not check out, so log text sharing the port is skipped.
+ *
+ * Import (host -> device):
+ *   IMPORT_BEGIN{flags}  ->  CREDIT{window}
+ *   TASKS{n, records} while credits last; each processed frame -> CREDIT{1}
+ *   IMPORT_END{count}    ->  ACK{status, stored}
+ * Export (device -> host):
+ *   EXPORT_REQUEST{window}  ->  EXPORT_BEGIN{count, version}
+ *   TASKS while credits last; the host returns CREDIT{1} per frame
+ *   EXPORT_END{count}
+ * Either side may answer with ERROR{code}, which ends the transfer. TASKS
+ * still in flight after a failed import are dropped without a reply.
+ * TASKS frames of a transfer carry consecutive sequence numbers.
+ * Tunables (host -> device, one reply each, also during a transfer):
+ *   TUNE_LIST{first}      ->  TUNE_LIST{total, count, tunables from first}
+ *   TUNE_GET{id}          ->  TUNE_VALUE{id, value}
+ *   TUNE_SET{id, value}   ->  TUNE_VALUE{id, value} or ERROR{RANGE}
+ *   TUNE_SAVE{flags}      ->  ACK{status}
+ * Values are signed LE32; a TUNE_* ERROR leaves any transfer running.
+ * TRACE and TRACE_NAMES (device -> host, unsolicited) carry the event
+ * trace of TRACE_ENABLE builds (TraceFormat.h); transfers ignore them.
+ *
+ * Pure C++ (shared with the host tool in tools/).
+ */
+
+enum TaskLinkType {
+  TASKLINK_EXPORT_REQUEST = 0x01,
+  TASKLINK_EXPORT_BEGIN = 0x02,
+  TASKLINK_EXPORT_END = 0x03,
+  TASKLINK_IMPORT_BEGIN = 0x04,
+  TASKLINK_IMPORT_END = 0x05,
+  TASKLINK_TASKS = 0x10,
+  TASKLINK_CREDIT = 0x20,
+  TASKLINK_ACK = 0x21,
+  TASKLINK_ERROR = 0x22,
+  TASKLINK_TUNE_LIST = 0x28,
+  TASKLINK_TUNE_GET = 0x29,
+  TASKLINK_TUNE_SET = 0x2A,
+  TASKLINK_TUNE_VALUE = 0x2B,
+  TASKLINK_TUNE_SAVE = 0x2C,
+  TASKLINK_TRACE = 0x30,
+  TASKLINK_TRACE_NAMES = 0x31
+};
+
+enum TaskLinkStatus {
+  TASKLINK_OK = 0,
+  TASKLINK_ERR_STATE,       // Message not valid in the current state
+  TASKLINK_ERR_BUSY,        // The task list could not be locked
+  TASKLINK_ERR_FULL,        // No room for more tasks
+  TASKLINK_ERR_CHANGED,     // The task list changed during an export
+  TASKLINK_ERR_SEQUENCE,    // A TASKS frame was lost
+  TASKLINK_ERR_TIMEOUT,     // The peer went quiet mid-transfer
+  TASKLINK_ERR_MALFORMED,   // Payload does not parse
+  TASKLINK_ERR_RANGE        // Unknown tunable or value out of bounds
+};
+
+// IMPORT_BEGIN flags
+static const uint8_t TASKLINK_IMPORT_REPLACE = 0x01;   // Clear the list first
+
+// TUNE_SAVE flags
+static const uint8_t TASKLINK_TUNE_ERASE = 0x01;       // Forget saved values, back to defaults
+
+// One task on the wire
+struct TaskLinkRecord {
+  static const size_t TITLE_SIZE = 32;
+
+  uint16_t id;
+  uint8_t priority;
+  uint8_t category;
+  bool complete;
+  uint32_t dueTime;
+  char title[TITLE_SIZE];
+
+  TaskLinkRecord() : id(0), priority(3), category(0), complete(false), dueTime(0) {
+    title[0] = '\0';
+  }
+};
+
+// Little-endian field access
+inline void taskLinkPut16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline void taskLinkPut32(uint8_t* out, uint32_t value) {
+  taskLinkPut16(out, static_cast<uint16_t>(value));
+  taskLinkPut16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+inline uint16_t taskLinkGet16(const uint8_t* in) {
+  return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline uint32_t taskLinkGet32(const uint8_t* in) {
+  return taskLinkGet16(in) | (static_cast<uint32_t>(taskLinkGet16(in + 2)) << 16);
+}
+
+// Packed record: id, priority, category, flags, dueTime, title length, title
+static const size_t TASKLINK_RECORD_HEADER = 10;
+
+// Appends a record; returns its size, or 0 if it does not fit in space
+inline size_t taskLinkPackRecord(const TaskLinkRecord& record, uint8_t* out, size_t space) {
+  size_t titleLength = strnlen(record.title, TaskLinkRecord::TITLE_SIZE - 1);
+  size_t size = TASKLINK_RECORD_HEADER + titleLength;
+  if (size > space) return 0;
+
+  taskLinkPut16(out, record.id);
+  out[2] = record.priority;
+  out[3] = record.category;
+  out[4] = record.complete ? 0x01 : 0x00;
+  taskLinkPut32(out + 5, record.dueTime);
+  out[9] = static_cast<uint8_t>(titleLength);
+  memcpy(out + TASKLINK_RECORD_HEADER, record.title, titleLength);
+  return size;
+}
+
+// Decodes a record in place; returns the bytes consumed, or 0 if malformed
+inline size_t taskLinkUnpackRecord(const uint8_t* in, size_t length, TaskLinkRecord& record) {
+  if (length < TASKLINK_RECORD_HEADER) return 0;
+  size_t titleLength = in[9];
+  if (titleLength >= TaskLinkRecord::TITLE_SIZE || TASKLINK_RECORD_HEADER + titleLength > length) {
+    return 0;
+  }
+
+  record.id = taskLinkGet16(in);
+  record.priority = in[2];
+  record.category = in[3];
+  record.complete = (in[4] & 0x01) != 0;
+  record.dueTime = taskLinkGet32(in + 5);
+  memcpy(record.title, in + TASKLINK_RECORD_HEADER, titleLength);
+  record.title[titleLength] = '\0';
+  return TASKLINK_RECORD_HEADER + titleLength;
+}
+
+// One tunable on the wire (see Tunables.h)
+struct TaskLinkTunable {
+  static const size_t NAME_SIZE = 16;
+
+  uint8_t id;
+  uint8_t type;
+  int32_t min;
+  int32_t max;
+  int32_t def;
+  int32_t value;
+  char name[NAME_SIZE];
+
+  TaskLinkTunable() : id(0), type(0), min(0), max(0), def(0), value(0) {
+    name[0] = '\0';
+  }
+};
+
+// Packed tunable: id, type, min, max, default, value, name length, name
+static const size_t TASKLINK_TUNABLE_HEADER = 19;
+
+// Appends a tunable; returns its size, or 0 if it does not fit in space
+inline size_t taskLinkPackTunable(const TaskLinkTunable& tunable, uint8_t* out, size_t space) {
+  size_t nameLength = strnlen(tunable.name, TaskLinkTunable::NAME_SIZE - 1);
+  size_t size = TASKLINK_TUNABLE_HEADER + nameLength;
+  if (size > space) return 0;
+
+  out[0] = tunable.id;
+  out[1] = tunable.type;
+  taskLinkPut32(out + 2, static_cast<uint32_t>(tunable.min));
+  taskLinkPut32(out + 6, static_cast<uint32_t>(tunable.max));
+  taskLinkPut32(out + 10, static_cast<uint32_t>(tunable.def));
+  taskLinkPut32(out + 14, static_cast<uint32_t>(tunable.value));
+  out[18] = static_cast<uint8_t>(nameLength);
+  memcpy(out + TASKLINK_TUNABLE_HEADER, tunable.name, nameLength);
+  return size;
+}
+
+// Decodes a tunable; returns the bytes consumed, or 0 if malformed
+inline size_t taskLinkUnpackTunable(const uint8_t* in, size_t length, TaskLinkTunable& tunable) {
+  if (length < TASKLINK_TUNABLE_HEADER) return 0;
+  size_t nameLength = in[18];
+  if (nameLength >= TaskLinkTunable::NAME_SIZE || TASKLINK_TUNABLE_HEADER + nameLength > length) {
+    return 0;
+  }
+
+  tunable.id = in[0];
+  tunable.type = in[1];
+  tunable.min = static_cast<int32_t>(taskLinkGet32(in + 2));
+  tunable.max = static_cast<int32_t>(taskLinkGet32(in + 6));
+  tunable.def = static_cast<int32_t>(taskLinkGet32(in + 10));
+  tunable.value = static_cast<int32_t>(taskLinkGet32(in + 14));
+  memcpy(tunable.name, in + TASKLINK_TUNABLE_HEADER, nameLength);
+  tunable.name[nameLength] = '\0';
+  return TASKLINK_TUNABLE_HEADER + nameLength;
+}
+
+struct TaskLinkFrame {
+  static const size_t MAX_PAYLOAD = 256;
+
+  uint8_t type;
+  uint8_t seq;
+  uint16_t length;
+  uint8_t payload[MAX_PAYLOAD];
+};
+
+/**
+ * Frame encoder (static) and incremental decoder.
+ */
+class TaskLinkFramer {
+public:
+  static const uint8_t SOF = 0xA5;
+  static const size_t HEADER_SIZE = 5;
+  static const size_t CRC_SIZE = 2;
+  static const size_t MAX_FRAME = HEADER_SIZE + TaskLinkFrame::MAX_PAYLOAD + CRC_SIZE;
+
+  TaskLinkFramer() : m_size(0), m_errors(0) {}
+
+  // Writes a frame into out (MAX_FRAME bytes); returns its size (0 if the payload is too long).
+  // The payload may already be in place at out + HEADER_SIZE.
+  static size_t encode(uint8_t type, uint8_t seq, const uint8_t* payload, size_t length, uint8_t* out) {
+    if (length > TaskLinkFrame::MAX_PAYLOAD) return 0;
+    if (length > 0 && payload != out + HEADER_SIZE) memmove(out + HEADER_SIZE, payload, length);
+    out[0] = SOF;
+    out[1] = type;
+    out[2] = seq;
+    taskLinkPut16(out + 3, static_cast<uint16_t>(length));
+    uint16_t crc = crc16Ccitt(out + 1, HEADER_SIZE - 1 + length);
+    taskLinkPut16(out + HEADER_SIZE + length, crc);
+    return HEADER_SIZE + length + CRC_SIZE;
+  }
+
+  // Feeds one byte; returns true when it completes a valid frame (see frame())
+  bool push(uint8_t byte) {
+    if (m_size == 0 && byte != SOF) return false;   // Between frames: skip noise
+    m_buffer[m_size++] = byte;
+
+    while (m_size > 0) {
+      if (m_size >= HEADER_SIZE && taskLinkGet16(m_buffer + 3) > TaskLinkFrame::MAX_PAYLOAD) {
+        resync();
+        continue;
+      }
+      if (m_size < HEADER_SIZE || m_size < frameSize()) return false;
+
+      size_t length = taskLinkGet16(m_buffer + 3);
+      uint16_t crc = crc16Ccitt(m_buffer + 1, HEADER_SIZE - 1 + length);
+      if (crc != taskLinkGet16(m_buffer + HEADER_SIZE + length)) {
+        resync();
+        continue;
+      }
+
+      m_frame.type = m_buffer[1];
+      m_frame.seq = m_buffer[2];
+      m_frame.length = static_cast<uint16_t>(length);
+      memcpy(m_frame.payload, m_buffer + HEADER_SIZE, length);
+
+      // Bytes after it (only left over from a resync) start the next frame
+      size_t used = HEADER_SIZE + length + CRC_SIZE;
+      memmove(m_buffer, m_buffer + used, m_size - used);
+      m_size -= used;
+      return true;
+    }
+    return false;
+  }
+
+  const TaskLinkFrame& frame() const { return m_frame; }
+  uint32_t getErrorCount() const { return m_errors; }
+  void reset() { m_size = 0; }
+
+private:
+  uint8_t m_buffer[MAX_FRAME];
+  size_t m_size;
+  TaskLinkFrame m_frame;
+  uint32_t m_errors;
+
+  size_t frameSize() const {
+    return HEADER_SIZE + taskLinkGet16(m_buffer + 3) + CRC_SIZE;
+  }
+
+  // Bad frame: restart at the next SOF already received, if any
+  void resync() {
+    m_errors++;
+    size_t next = 1;
+    while (next < m_size && m_buffer[next] != SOF) next++;
+    memmove(m_buffer, m_buffer + next, m_size - next);
+    m_size -= next;
+  }
+};
+
+#endif // TASK_LINK_PROTOCOL_H
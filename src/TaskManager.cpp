@@ -4,109 +4,242 @@
 const char* CATEGORY_NAMES[] = {"Work", "Personal", "Shopping", "Other"};
 const char* PRIORITY_NAMES[] = {"", "Low", "Low+", "Med", "High", "Critical"};
 
-TaskManager::TaskManager() : taskCount(0), nextId(1), filterActive(false), filteredCount(0) {
+TaskManager::TaskManager()
+    : current(&tables[0]), nextId(1), writeMutex(nullptr),
+      batchTable(nullptr), batchToken(NO_BATCH), lastBatch(NO_BATCH), batchNextId(1),
+      batchEntryCount(0), batchHoles(0) {
+    for (uint8_t i = 0; i < TABLE_VERSIONS; i++) {
+        refCounts[i] = 0;
+    }
+    snapshotMux = portMUX_INITIALIZER_UNLOCKED;
+    writeMutex = xSemaphoreCreateMutex();
+}
+
+TaskManager::~TaskManager() {
+    if (writeMutex) vSemaphoreDelete(writeMutex);
+}
+
+bool TaskManager::addTask(const char* title, uint8_t priority, uint8_t category, TaskBatch batch) {
+    if (title == nullptr) {
+        return false;
+    }
+    return addTask(Task(title, priority, category), batch);
 }
 
-bool TaskManager::addTask(const char* title, uint8_t priority, uint8_t category) {
-    if (taskCount >= MAX_TASKS || title == nullptr || strlen(title) == 0) {
+bool TaskManager::addTask(const Task& task, TaskBatch batch) {
+    if (strlen(task.title) == 0) {
         return false;
     }
-    
-    // Validate inputs
-    if (priority < 1 || priority > 5) priority = 3;
-    if (category > 3) category = 0;
-    
-    // Create new task
-    Task& newTask = tasks[taskCount];
-    strncpy(newTask.title, title, 31);
+
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
+    if (table->taskCount >= MAX_TASKS && inBatch(table) && batchHoles > 0) {
+        compactBatch();
+    }
+    if (table->taskCount >= MAX_TASKS) {
+        abortWrite();
+        return false;
+    }
+
+    // Create new task, validating inputs
+    Task& newTask = table->tasks[table->taskCount];
+    newTask = task;
     newTask.title[31] = '\0';
-    newTask.priority = priority;
-    newTask.category = category;
-    newTask.isComplete = false;
+    if (newTask.priority < 1 || newTask.priority > 5) newTask.priority = 3;
+    if (newTask.category > 3) newTask.category = 0;
     newTask.id = nextId++;
-    
-    taskCount++;
-    rebuildFilteredList();
+    if (inBatch(table)) {
+        BatchEntry& entry = batchEntries[batchEntryCount++];
+        entry.id = newTask.id;
+        entry.index = table->taskCount;
+    } else {
+        searchIndex.insert(newTask.id, newTask.title);
+        table->buckets.link(table->taskCount, TaskBuckets::bucketOf(newTask));
+    }
+
+    table->taskCount++;
+    publish(table);
     return true;
 }
 
-bool TaskManager::deleteTask(uint16_t taskId) {
-    uint8_t index = findTaskIndex(taskId);
-    if (index >= taskCount) return false;
-    
+bool TaskManager::deleteTask(uint16_t taskId, TaskBatch batch) {
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
+
+    uint16_t index = locate(table, taskId);
+    if (index >= table->taskCount) {
+        abortWrite();
+        return false;
+    }
+
+    if (inBatch(table)) {
+        // Leave a hole; commitBatch() compacts once
+        batchEntries[findBatchEntry(taskId)].index = NO_INDEX;
+        table->tasks[index].id = 0;
+        batchHoles++;
+        publish(table);
+        return true;
+    }
+
+    table->buckets.unlink(index, TaskBuckets::bucketOf(table->tasks[index]));
+
     // Shift all tasks after this one back
-    for (uint8_t i = index; i < taskCount - 1; i++) {
-        tasks[i] = tasks[i + 1];
+    for (uint16_t i = index; i < table->taskCount - 1; i++) {
+        table->tasks[i] = table->tasks[i + 1];
     }
-    
-    taskCount--;
-    rebuildFilteredList();
+    table->buckets.closeGap(index, table->taskCount);
+
+    searchIndex.remove(taskId);
+    table->taskCount--;
+    publish(table);
     return true;
 }
 
-bool TaskManager::toggleTaskComplete(uint16_t taskId) {
-    Task* task = getTask(taskId);
-    if (task == nullptr) return false;
-    
-    task->isComplete = !task->isComplete;
-    rebuildFilteredList();
+bool TaskManager::toggleTaskComplete(uint16_t taskId, TaskBatch batch) {
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
+
+    uint16_t index = locate(table, taskId);
+    if (index >= table->taskCount) {
+        abortWrite();
+        return false;
+    }
+
+    // A batch rebuilds the buckets at commit
+    Task& task = table->tasks[index];
+    if (!inBatch(table)) table->buckets.unlink(index, TaskBuckets::bucketOf(task));
+    task.isComplete = !task.isComplete;
+    if (!inBatch(table)) table->buckets.link(index, TaskBuckets::bucketOf(task));
+    publish(table);
     return true;
 }
 
-bool TaskManager::editTask(uint16_t taskId, const char* newTitle, 
-                          uint8_t newPriority, uint8_t newCategory) {
-    Task* task = getTask(taskId);
-    if (task == nullptr) return false;
-    
+bool TaskManager::editTask(uint16_t taskId, const char* newTitle,
+                          uint8_t newPriority, uint8_t newCategory, TaskBatch batch) {
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
+
+    uint16_t index = locate(table, taskId);
+    if (index >= table->taskCount) {
+        abortWrite();
+        return false;
+    }
+
+    Task& task = table->tasks[index];
     if (newTitle != nullptr) {
-        strncpy(task->title, newTitle, 31);
-        task->title[31] = '\0';
+        strncpy(task.title, newTitle, 31);
+        task.title[31] = '\0';
+        if (!inBatch(table)) searchIndex.update(taskId, task.title);
     }
-    
-    if (newPriority >= 1 && newPriority <= 5) {
-        task->priority = newPriority;
+
+    if (newPriority >= 1 && newPriority <= 5 && newPriority != task.priority) {
+        if (!inBatch(table)) table->buckets.unlink(index, TaskBuckets::bucketOf(task));
+        task.priority = newPriority;
+        if (!inBatch(table)) table->buckets.link(index, TaskBuckets::bucketOf(task));
     }
-    
+
     if (newCategory <= 3) {
-        task->category = newCategory;
+        task.category = newCategory;
     }
-    
-    rebuildFilteredList();
+
+    publish(table);
     return true;
 }
 
-Task* TaskManager::getTask(uint16_t taskId) {
-    uint8_t index = findTaskIndex(taskId);
-    return (index < taskCount) ? &tasks[index] : nullptr;
-}
+bool TaskManager::setTaskDueTime(uint16_t taskId, uint32_t dueTime, TaskBatch batch) {
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
 
-Task* TaskManager::getTaskByIndex(uint8_t index) {
-    if (filterActive) {
-        return (index < filteredCount) ? &tasks[filteredIndices[index]] : nullptr;
-    } else {
-        return (index < taskCount) ? &tasks[index] : nullptr;
+    uint16_t index = locate(table, taskId);
+    if (index >= table->taskCount) {
+        abortWrite();
+        return false;
     }
+
+    table->tasks[index].dueTime = dueTime;
+    publish(table);
+    return true;
 }
 
-uint8_t TaskManager::getCompletedCount() const {
-    uint8_t completed = 0;
-    for (uint8_t i = 0; i < taskCount; i++) {
-        if (tasks[i].isComplete) completed++;
-    }
-    return completed;
+bool TaskManager::getTask(uint16_t taskId, Task& task) {
+    TaskSnapshot snapshot(*this);
+    const Task* found = snapshot.getTask(taskId);
+    if (found == nullptr) return false;
+
+    task = *found;
+    return true;
+}
+
+bool TaskManager::getTaskByIndex(uint16_t index, Task& task) {
+    TaskSnapshot snapshot(*this);
+    const Task* found = snapshot.getTaskByIndex(index);
+    if (found == nullptr) return false;
+
+    task = *found;
+    return true;
+}
+
+uint16_t TaskManager::getTaskCount() {
+    TaskSnapshot snapshot(*this);
+    return snapshot.getTaskCount();
 }
 
-uint8_t TaskManager::getCompletionPercentage() const {
-    if (taskCount == 0) return 0;
-    return (getCompletedCount() * 100) / taskCount;
+uint16_t TaskManager::getCompletedCount() {
+    TaskSnapshot snapshot(*this);
+    return snapshot.getCompletedCount();
 }
 
-void TaskManager::sortTasks(SortBy sortType) {
-    // Simple bubble sort (fine for 30 items)
-    for (uint8_t i = 0; i < taskCount - 1; i++) {
-        for (uint8_t j = 0; j < taskCount - i - 1; j++) {
+uint8_t TaskManager::getCompletionPercentage() {
+    TaskSnapshot snapshot(*this);
+    if (snapshot.getTaskCount() == 0) return 0;
+    return static_cast<uint8_t>((snapshot.getCompletedCount() * 100UL) / snapshot.getTaskCount());
+}
+
+uint32_t TaskManager::getVersion() {
+    TaskSnapshot snapshot(*this);
+    return snapshot.getVersion();
+}
+
+bool TaskManager::getNextTask(Task& task) {
+    TaskSnapshot snapshot(*this);
+    const Task* next = snapshot.getNextTask();
+    if (next == nullptr) return false;
+
+    task = *next;
+    return true;
+}
+
+uint16_t TaskManager::getPriorityCount(uint8_t priority, bool complete) {
+    TaskSnapshot snapshot(*this);
+    return snapshot.getPriorityCount(priority, complete);
+}
+
+size_t TaskManager::searchTasks(const char* query, TaskSearchMode mode,
+                                TaskSearchResult* results, size_t maxResults) {
+    if (writeMutex == nullptr || !xSemaphoreTake(writeMutex, pdMS_TO_TICKS(WRITE_TIMEOUT_MS))) {
+        return 0;
+    }
+
+    size_t found = searchIndex.search(query, mode, results, maxResults);
+    xSemaphoreGive(writeMutex);
+    return found;
+}
+
+bool TaskManager::sortTasks(SortBy sortType, TaskBatch batch) {
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
+    if (inBatch(table)) {
+        // Sorting moves tasks: drop the holes first, re-map afterwards
+        compactBatch();
+    }
+
+    // Simple bubble sort (fine for 30 items); readers keep the unsorted version
+    Task* tasks = table->tasks;
+    uint16_t taskCount = table->taskCount;
+    for (uint16_t i = 0; i + 1 < taskCount; i++) {
+        for (uint16_t j = 0; j < taskCount - i - 1; j++) {
             bool shouldSwap = false;
-            
+
             switch (sortType) {
                 case SORT_BY_PRIORITY:
                     shouldSwap = tasks[j].priority < tasks[j + 1].priority;
@@ -120,13 +253,21 @@ void TaskManager::sortTasks(SortBy sortType) {
                 default:
                     shouldSwap = false;
             }
-            
+
             if (shouldSwap) {
-                swapTasks(j, j + 1);
+                swapTasks(*table, j, j + 1);
             }
         }
     }
-    rebuildFilteredList();
+    if (inBatch(table)) {
+        for (uint16_t i = 0; i < taskCount; i++) {
+            batchEntries[findBatchEntry(tasks[i].id)].index = i;
+        }
+    } else {
+        table->buckets.rebuild(tasks, taskCount);
+    }
+    publish(table);
+    return true;
 }
 
 const char* TaskManager::getCategoryName(uint8_t category) {
@@ -137,43 +278,404 @@ const char* TaskManager::getPriorityName(uint8_t priority) {
     return (priority >= 1 && priority <= 5) ? PRIORITY_NAMES[priority] : "Unknown";
 }
 
-// Private helper methods
-uint8_t TaskManager::findTaskIndex(uint16_t taskId) {
-    for (uint8_t i = 0; i < taskCount; i++) {
-        if (tasks[i].id == taskId) return i;
+bool TaskManager::reset(TaskBatch batch) {
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
+
+    table->taskCount = 0;
+    table->filterActive = false;
+    table->buckets.clear();
+    nextId = 1;
+    if (inBatch(table)) {
+        batchEntryCount = 0;
+        batchHoles = 0;
+    } else {
+        searchIndex.clear();
     }
-    return MAX_TASKS; // Invalid index
+    publish(table);
+    return true;
 }
 
-void TaskManager::rebuildFilteredList() {
-    // For now, just show all tasks (filtering logic can be added later)
-    filteredCount = taskCount;
-    for (uint8_t i = 0; i < taskCount; i++) {
-        filteredIndices[i] = i;
+TaskBatch TaskManager::beginBatch() {
+    // Refused while another batch is open
+    TaskTable* table = beginWrite(NO_BATCH);
+    if (table == nullptr) return NO_BATCH;
+
+    batchTable = table;
+    if (++lastBatch == NO_BATCH) lastBatch++;
+    batchToken = lastBatch;
+    batchNextId = nextId;
+    batchHoles = 0;
+
+    // Tasks are created in id order, but sorting may have reordered them
+    batchEntryCount = table->taskCount;
+    for (uint16_t i = 0; i < table->taskCount; i++) {
+        batchEntries[i].id = table->tasks[i].id;
+        batchEntries[i].index = i;
+    }
+    for (uint16_t i = 1; i < batchEntryCount; i++) {
+        BatchEntry entry = batchEntries[i];
+        uint16_t j = i;
+        while (j > 0 && batchEntries[j - 1].id > entry.id) {
+            batchEntries[j] = batchEntries[j - 1];
+            j--;
+        }
+        batchEntries[j] = entry;
     }
+
+    // The lock is taken per operation, so the batch can stay open across
+    // yields without stalling other tasks' writers
+    xSemaphoreGive(writeMutex);
+    return batchToken;
 }
 
-void TaskManager::swapTasks(uint8_t i, uint8_t j) {
-    Task temp = tasks[i];
-    tasks[i] = tasks[j];
-    tasks[j] = temp;
+bool TaskManager::commitBatch(TaskBatch batch) {
+    if (batch == NO_BATCH) return false;
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return false;
+
+    compactBatch();
+    indexBatch();
+    batchTable = nullptr;
+    batchToken = NO_BATCH;
+    publish(table);
+    return true;
 }
 
-void TaskManager::reset() {
-    taskCount = 0;
-    nextId = 1;
-    filterActive = false;
-    filteredCount = 0;
+void TaskManager::rollbackBatch(TaskBatch batch) {
+    if (batch == NO_BATCH) return;
+    TaskTable* table = beginWrite(batch);
+    if (table == nullptr) return;
+
+    // The batch table was never published and the search index never touched
+    batchTable = nullptr;
+    batchToken = NO_BATCH;
+    nextId = batchNextId;
+    abortWrite();
 }
+
 std::vector<Task> TaskManager::getAllTasks() {
     std::vector<Task> allTasks;
     // Use filtered or unfiltered depending on your UI
     // Here, return all visible tasks based on current filter:
-    for (uint8_t i = 0; i < filteredCount; i++) {
-        Task* t = getTaskByIndex(i);
-        if (t != nullptr) {
-            allTasks.push_back(*t);  // copy Task
-        }
+    TaskSnapshot snapshot(*this);
+    for (uint16_t i = 0; ; i++) {
+        const Task* t = snapshot.getTaskByIndex(i);
+        if (t == nullptr) break;
+        allTasks.push_back(*t);  // copy Task
     }
     return allTasks;
 }
+
+// Private helper methods
+const TaskTable* TaskManager::acquire() {
+    // Loading the pointer and counting the reference must not be split by a
+    // writer looking for a free table
+    portENTER_CRITICAL(&snapshotMux);
+    TaskTable* table = current;
+    refCounts[table - tables]++;
+    portEXIT_CRITICAL(&snapshotMux);
+    return table;
+}
+
+void TaskManager::release(const TaskTable* table) {
+    portENTER_CRITICAL(&snapshotMux);
+    refCounts[table - tables]--;
+    portEXIT_CRITICAL(&snapshotMux);
+}
+
+TaskTable* TaskManager::beginWrite(TaskBatch batch) {
+    if (writeMutex == nullptr || !xSemaphoreTake(writeMutex, pdMS_TO_TICKS(WRITE_TIMEOUT_MS))) {
+        Serial.println("TaskManager: write lock timeout");
+        return nullptr;
+    }
+
+    // While a batch is open only its token writes, to the batch table. Any
+    // other write is refused at once, whichever task or coroutine makes it.
+    if (batchTable != nullptr || batch != NO_BATCH) {
+        if (batchTable != nullptr && batch == batchToken) return batchTable;
+        Serial.println(batchTable != nullptr ? "TaskManager: batch open, write refused"
+                                             : "TaskManager: batch no longer open");
+        xSemaphoreGive(writeMutex);
+        return nullptr;
+    }
+
+    // A table that is neither published nor pinned by a snapshot. There are
+    // more tables than concurrent readers, so waiting is the rare case.
+    TickType_t start = xTaskGetTickCount();
+    while (true) {
+        TaskTable* table = nullptr;
+        portENTER_CRITICAL(&snapshotMux);
+        for (uint8_t i = 0; i < TABLE_VERSIONS; i++) {
+            if (&tables[i] != current && refCounts[i] == 0) {
+                table = &tables[i];
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&snapshotMux);
+
+        if (table != nullptr) {
+            // Only published tables can be pinned, so the copy needs no lock
+            copyTable(*table, *current);
+            return table;
+        }
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(WRITE_TIMEOUT_MS)) {
+            Serial.println("TaskManager: no free table (snapshots held too long)");
+            xSemaphoreGive(writeMutex);
+            return nullptr;
+        }
+        vTaskDelay(1);
+    }
+}
+
+void TaskManager::publish(TaskTable* table) {
+    // A batch publishes once, from commitBatch(); its operations only unlock
+    if (inBatch(table)) {
+        xSemaphoreGive(writeMutex);
+        return;
+    }
+
+    rebuildFilteredList(*table);
+    table->version = current->version + 1;
+
+    // Readers switch to the new version from their next snapshot on
+    portENTER_CRITICAL(&snapshotMux);
+    current = table;
+    portEXIT_CRITICAL(&snapshotMux);
+
+    xSemaphoreGive(writeMutex);
+}
+
+void TaskManager::abortWrite() {
+    // The private copy was never published: it is free again (a batch keeps
+    // its table until commit or rollback)
+    xSemaphoreGive(writeMutex);
+}
+
+uint16_t TaskManager::locate(const TaskTable* table, uint16_t taskId) const {
+    if (!inBatch(table)) return table->findTaskIndex(taskId);
+
+    uint16_t entry = findBatchEntry(taskId);
+    return (entry < batchEntryCount && batchEntries[entry].index != NO_INDEX)
+        ? batchEntries[entry].index : MAX_TASKS;
+}
+
+uint16_t TaskManager::findBatchEntry(uint16_t taskId) const {
+    // Binary search of the id-ordered batch entries
+    uint16_t low = 0;
+    uint16_t high = batchEntryCount;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (batchEntries[mid].id < taskId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return (low < batchEntryCount && batchEntries[low].id == taskId) ? low : batchEntryCount;
+}
+
+void TaskManager::compactBatch() {
+    if (batchHoles == 0) return;
+
+    // One pass over the tasks, re-pointing each moved task's entry
+    TaskTable& table = *batchTable;
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < table.taskCount; i++) {
+        if (table.tasks[i].id == 0) continue;
+        if (kept != i) {
+            table.tasks[kept] = table.tasks[i];
+            batchEntries[findBatchEntry(table.tasks[kept].id)].index = kept;
+        }
+        kept++;
+    }
+    table.taskCount = kept;
+
+    // And one over the entries, dropping the deleted ones
+    uint16_t entries = 0;
+    for (uint16_t i = 0; i < batchEntryCount; i++) {
+        if (batchEntries[i].index != NO_INDEX) {
+            batchEntries[entries++] = batchEntries[i];
+        }
+    }
+    batchEntryCount = entries;
+    batchHoles = 0;
+}
+
+void TaskManager::indexBatch() {
+    searchIndex.clear();
+    for (uint16_t i = 0; i < batchTable->taskCount; i++) {
+        const Task& task = batchTable->tasks[i];
+        searchIndex.append(task.id, task.title);
+    }
+    batchTable->buckets.rebuild(batchTable->tasks, batchTable->taskCount);
+}
+
+void TaskManager::copyTable(TaskTable& to, const TaskTable& from) {
+    // Only the live part of the arrays; rebuildFilteredList() redoes the rest
+    for (uint16_t i = 0; i < from.taskCount; i++) {
+        to.tasks[i] = from.tasks[i];
+    }
+    to.taskCount = from.taskCount;
+    to.buckets.copyFrom(from.buckets, from.taskCount);
+    to.filterActive = from.filterActive;
+    to.filteredCount = 0;
+    to.version = from.version;
+}
+
+void TaskManager::rebuildFilteredList(TaskTable& table) {
+    // For now, just show all tasks (filtering logic can be added later)
+    table.filteredCount = table.taskCount;
+    for (uint16_t i = 0; i < table.taskCount; i++) {
+        table.filteredIndices[i] = i;
+    }
+}
+
+void TaskManager::swapTasks(TaskTable& table, uint16_t i, uint16_t j) {
+    Task temp = table.tasks[i];
+    table.tasks[i] = table.tasks[j];
+    table.tasks[j] = temp;
+}
+
+uint16_t TaskTable::findTaskIndex(uint16_t taskId) const {
+    for (uint16_t i = 0; i < taskCount; i++) {
+        if (tasks[i].id == taskId) return i;
+    }
+    return MAX_TASKS; // Invalid index
+}
+
+uint16_t TaskTable::getCompletedCount() const {
+    uint16_t completed = 0;
+    for (uint8_t b = TaskBuckets::PRIORITY_LEVELS; b < TaskBuckets::BUCKET_COUNT; b++) {
+        completed += buckets.counts[b];
+    }
+    return completed;
+}
+
+void TaskBuckets::clear() {
+    for (uint8_t b = 0; b < BUCKET_COUNT; b++) {
+        heads[b] = NONE;
+        tails[b] = NONE;
+        counts[b] = 0;
+    }
+    mask = 0;
+}
+
+void TaskBuckets::link(uint16_t index, uint8_t bucket) {
+    next[index] = NONE;
+    prev[index] = tails[bucket];
+    if (tails[bucket] != NONE) {
+        next[tails[bucket]] = index;
+    } else {
+        heads[bucket] = index;
+    }
+    tails[bucket] = index;
+    counts[bucket]++;
+    mask |= 1u << bucket;
+}
+
+void TaskBuckets::unlink(uint16_t index, uint8_t bucket) {
+    if (prev[index] != NONE) {
+        next[prev[index]] = next[index];
+    } else {
+        heads[bucket] = next[index];
+    }
+    if (next[index] != NONE) {
+        prev[next[index]] = prev[index];
+    } else {
+        tails[bucket] = prev[index];
+    }
+    if (--counts[bucket] == 0) mask &= ~(1u << bucket);
+}
+
+void TaskBuckets::closeGap(uint16_t index, uint16_t taskCount) {
+    // The removed task is already unlinked: move the later links down and
+    // renumber every link that pointed past it
+    for (uint16_t i = index; i + 1 < taskCount; i++) {
+        next[i] = next[i + 1];
+        prev[i] = prev[i + 1];
+    }
+    for (uint16_t i = 0; i + 1 < taskCount; i++) {
+        if (next[i] != NONE && next[i] > index) next[i]--;
+        if (prev[i] != NONE && prev[i] > index) prev[i]--;
+    }
+    for (uint8_t b = 0; b < BUCKET_COUNT; b++) {
+        if (heads[b] != NONE && heads[b] > index) heads[b]--;
+        if (tails[b] != NONE && tails[b] > index) tails[b]--;
+    }
+}
+
+void TaskBuckets::rebuild(const Task* tasks, uint16_t taskCount) {
+    clear();
+    for (uint16_t i = 0; i < taskCount; i++) {
+        link(i, bucketOf(tasks[i]));
+    }
+}
+
+void TaskBuckets::copyFrom(const TaskBuckets& from, uint16_t taskCount) {
+    for (uint8_t b = 0; b < BUCKET_COUNT; b++) {
+        heads[b] = from.heads[b];
+        tails[b] = from.tails[b];
+        counts[b] = from.counts[b];
+    }
+    mask = from.mask;
+    for (uint16_t i = 0; i < taskCount; i++) {
+        next[i] = from.next[i];
+        prev[i] = from.prev[i];
+    }
+}
+
+uint16_t TaskBuckets::firstOf(uint16_t bits) const {
+    bits &= mask;
+    if (bits == 0) return NONE;
+    return heads[31 - __builtin_clz(bits)];
+}
+
+TaskSnapshot::TaskSnapshot(TaskManager& owner) : manager(owner), table(owner.acquire()) {
+}
+
+TaskSnapshot::~TaskSnapshot() {
+    manager.release(table);
+}
+
+const Task* TaskSnapshot::getTask(uint16_t taskId) const {
+    uint16_t index = table->findTaskIndex(taskId);
+    return (index < table->taskCount) ? &table->tasks[index] : nullptr;
+}
+
+const Task* TaskSnapshot::getTaskByIndex(uint16_t index) const {
+    if (table->filterActive) {
+        return (index < table->filteredCount) ? &table->tasks[table->filteredIndices[index]] : nullptr;
+    } else {
+        return (index < table->taskCount) ? &table->tasks[index] : nullptr;
+    }
+}
+
+const Task* TaskSnapshot::getNextTask() const {
+    uint16_t index = table->buckets.firstOf(TaskBuckets::OPEN_MASK);
+    return (index != TaskBuckets::NONE) ? &table->tasks[index] : nullptr;
+}
+
+uint16_t TaskSnapshot::getTopTasks(const Task** tasks, uint16_t maxTasks) const {
+    // Open buckets from the highest priority down, each in queue order
+    const TaskBuckets& buckets = table->buckets;
+    uint16_t found = 0;
+    uint16_t bits = buckets.mask & TaskBuckets::OPEN_MASK;
+    while (bits != 0 && found < maxTasks) {
+        uint8_t bucket = 31 - __builtin_clz(bits);
+        bits &= ~(1u << bucket);
+        for (uint16_t i = buckets.heads[bucket]; i != TaskBuckets::NONE && found < maxTasks;
+             i = buckets.next[i]) {
+            tasks[found++] = &table->tasks[i];
+        }
+    }
+    return found;
+}
+
+uint16_t TaskSnapshot::getPriorityCount(uint8_t priority, bool complete) const {
+    if (priority < 1 || priority > TaskBuckets::PRIORITY_LEVELS) return 0;
+    Task probe;
+    probe.priority = priority;
+    probe.isComplete = complete;
+    return table->buckets.counts[TaskBuckets::bucketOf(probe)];
+}
@@ -2,7 +2,16 @@
 #define TASKMANAGER_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <vector>
+#include "TaskSearchIndex.h"
+
+// Task capacity; boards with more RAM (or host builds) may raise it
+#ifndef TASKMANAGER_MAX_TASKS
+#define TASKMANAGER_MAX_TASKS 30
+#endif
 
 // Task data structure
 struct Task {
@@ -11,14 +20,15 @@ struct Task {
     bool isComplete;          // true/false
     uint8_t category;         // 0-3 (Work, Personal, Shopping, Other)
     uint16_t id;              // Unique task ID
+    uint32_t dueTime;         // Unix time of the reminder (0 = none)
     
     // Constructor for easy task creation
-    Task() : priority(3), isComplete(false), category(0), id(0) {
+    Task() : priority(3), isComplete(false), category(0), id(0), dueTime(0) {
         title[0] = '\0';
     }
     
     Task(const char* taskTitle, uint8_t taskPriority = 3, uint8_t taskCategory = 0) 
-        : priority(taskPriority), isComplete(false), category(taskCategory), id(0) {
+        : priority(taskPriority), isComplete(false), category(taskCategory), id(0), dueTime(0) {
         strncpy(title, taskTitle, 31);
         title[31] = '\0';
     }
@@ -40,27 +50,140 @@ enum SortBy {
     SORT_BY_CREATION_ORDER
 };
 
+// Names an open batch (TaskManager::beginBatch()); writes that pass it go to
+// the batch, writes without it are refused while it is open
+typedef uint16_t TaskBatch;
+const TaskBatch NO_BATCH = 0;
+
+class TaskSnapshot;
+
+/*
+ * Tasks of one table queued by priority and completion: an intrusive, doubly
+ * linked list per bucket, threaded through the task indices, and a bitmask of
+ * the non-empty buckets. The most urgent open task is one bit scan away and
+ * per-bucket counts are kept, so nothing has to sort the storage to answer.
+ * Within a bucket, tasks are in the order they entered it.
+ */
+struct TaskBuckets {
+    static const uint8_t PRIORITY_LEVELS = 5;
+    static const uint8_t BUCKET_COUNT = PRIORITY_LEVELS * 2;    // Open ones, then complete ones
+    static const uint16_t OPEN_MASK = (1u << PRIORITY_LEVELS) - 1;
+    static const uint16_t NONE = 0xFFFF;
+    
+    uint16_t heads[BUCKET_COUNT];
+    uint16_t tails[BUCKET_COUNT];
+    uint16_t counts[BUCKET_COUNT];
+    uint16_t mask;                          // Bit b set: bucket b is non-empty
+    uint16_t next[TASKMANAGER_MAX_TASKS];   // Links, indexed like the tasks
+    uint16_t prev[TASKMANAGER_MAX_TASKS];
+    
+    TaskBuckets() { clear(); }
+    
+    static uint8_t bucketOf(const Task& task) {
+        return (task.isComplete ? PRIORITY_LEVELS : 0) + task.priority - 1;
+    }
+    
+    void clear();
+    void link(uint16_t index, uint8_t bucket);      // Appends at the tail
+    void unlink(uint16_t index, uint8_t bucket);
+    void closeGap(uint16_t index, uint16_t taskCount);   // Tasks after index moved down one
+    void rebuild(const Task* tasks, uint16_t taskCount);
+    void copyFrom(const TaskBuckets& from, uint16_t taskCount);
+    
+    // Head of the highest non-empty bucket in bits, or NONE
+    uint16_t firstOf(uint16_t bits) const;
+};
+
+// One published version of the task list; never modified once published
+struct TaskTable {
+    static const uint16_t MAX_TASKS = TASKMANAGER_MAX_TASKS;
+    
+    Task tasks[MAX_TASKS];
+    uint16_t taskCount;
+    
+    // Filtering state
+    bool filterActive;
+    uint16_t filteredIndices[MAX_TASKS];
+    uint16_t filteredCount;
+    
+    TaskBuckets buckets;
+    
+    uint32_t version;         // Increments with every published edit
+    
+    TaskTable() : taskCount(0), filterActive(false), filteredCount(0), version(0) {}
+    
+    uint16_t findTaskIndex(uint16_t taskId) const;
+    uint16_t getCompletedCount() const;
+};
+
+/*
+ * Task list shared by the controller (writer) and the views (readers).
+ *
+ * Copy-on-write: an edit copies the current table into a free one, changes the
+ * copy and publishes it with a single pointer store. Readers pin the version
+ * they started with through a TaskSnapshot, so rendering never waits for an
+ * edit and never sees a half-applied one (a half-sorted array, a shifted
+ * delete). A table is reused only once no snapshot refers to it.
+ *
+ * Writers are serialized by a mutex; snapshots only take a short critical
+ * section to bump a reference count. Not for ISRs.
+ */
 class TaskManager {
 public:
+    static const uint16_t MAX_TASKS = TaskTable::MAX_TASKS;
+    
+    // Published table, one per live snapshot, and one being edited
+    static const uint8_t TABLE_VERSIONS = 4;
+    static const uint32_t WRITE_TIMEOUT_MS = 100;
+
     TaskManager();
+    ~TaskManager();
     std::vector<Task> getAllTasks();
 
-    // Core task operations
-    bool addTask(const char* title, uint8_t priority = 3, uint8_t category = 0);
-    bool deleteTask(uint16_t taskId);
-    bool toggleTaskComplete(uint16_t taskId);
+    // Core task operations (false if invalid or no table was free in time)
+    // The batch argument is only for writes inside a batch (see below)
+    bool addTask(const char* title, uint8_t priority = 3, uint8_t category = 0,
+                 TaskBatch batch = NO_BATCH);
+    bool addTask(const Task& task, TaskBatch batch = NO_BATCH);   // Keeps every field but the id (imports)
+    bool deleteTask(uint16_t taskId, TaskBatch batch = NO_BATCH);
+    bool toggleTaskComplete(uint16_t taskId, TaskBatch batch = NO_BATCH);
     bool editTask(uint16_t taskId, const char* newTitle = nullptr, 
-                  uint8_t newPriority = 0, uint8_t newCategory = 255);
+                  uint8_t newPriority = 0, uint8_t newCategory = 255,
+                  TaskBatch batch = NO_BATCH);
+    bool setTaskDueTime(uint16_t taskId, uint32_t dueTime, TaskBatch batch = NO_BATCH);
+    
+    // Task retrieval (copies from the current version; use a TaskSnapshot to
+    // read several tasks consistently)
+    bool getTask(uint16_t taskId, Task& task);
+    bool getTaskByIndex(uint16_t index, Task& task);
+    uint16_t getTaskCount();
+    uint16_t getCompletedCount();
+    uint8_t getCompletionPercentage();
+    uint32_t getVersion();
     
-    // Task retrieval
-    Task* getTask(uint16_t taskId);
-    Task* getTaskByIndex(uint8_t index);
-    uint8_t getTaskCount() const { return taskCount; }
-    uint8_t getCompletedCount() const;
-    uint8_t getCompletionPercentage() const;
+    // Priority queries, O(1) from the buckets of the current version
+    bool getNextTask(Task& task);     // Most urgent open task; false if none
+    uint16_t getPriorityCount(uint8_t priority, bool complete = false);
+    
+    // Batches: the core operations given the token from beginBatch() work on
+    // one private copy. Deletes leave holes that are compacted once, and the
+    // filtered list and search index are rebuilt once, at commit. Readers see
+    // nothing until then. The write lock is held per operation, not for the
+    // whole batch, so a batch may stay open across yields; meanwhile writes
+    // without the token fail at once instead of joining it or waiting, even
+    // from the task that opened it.
+    TaskBatch beginBatch();           // NO_BATCH if a batch is already open
+    bool commitBatch(TaskBatch batch);
+    void rollbackBatch(TaskBatch batch);
+    bool isBatchOpen() const { return batchTable != nullptr; }
+    
+    // Title search, best matches first; returns how many were found.
+    // Waits for an edit in progress (the index is writer state).
+    size_t searchTasks(const char* query, TaskSearchMode mode,
+                       TaskSearchResult* results, size_t maxResults);
     
     // Filtering and sorting
-    void sortTasks(SortBy sortType);
+    bool sortTasks(SortBy sortType, TaskBatch batch = NO_BATCH);
 
     
     // Category helpers
@@ -69,23 +192,93 @@ public:
     
     // Debug and utilities
     void printAllTasks();
-    void reset();
+    bool reset(TaskBatch batch = NO_BATCH);
     
 private:
-    static const uint8_t MAX_TASKS = 30;
-    Task tasks[MAX_TASKS];
-    uint8_t taskCount;
-    uint16_t nextId;
+    friend class TaskSnapshot;
     
-    // Filtering state
-    bool filterActive;
-    uint8_t filteredIndices[MAX_TASKS];
-    uint8_t filteredCount;
+    TaskTable tables[TABLE_VERSIONS];
+    uint8_t refCounts[TABLE_VERSIONS];
+    TaskTable* volatile current;
+    uint16_t nextId;              // Writer state, guarded by writeMutex
+    TaskSearchIndex<MAX_TASKS> searchIndex;
+    
+    SemaphoreHandle_t writeMutex;
+    portMUX_TYPE snapshotMux;
+    
+    // Open batch: its table, token and task lookup by id
+    struct BatchEntry {
+        uint16_t id;
+        uint16_t index;           // NO_INDEX once deleted
+    };
+    static const uint16_t NO_INDEX = 0xFFFF;
+    TaskTable* batchTable;
+    TaskBatch batchToken;         // NO_BATCH when none is open
+    TaskBatch lastBatch;          // Tokens count up, skipping NO_BATCH
+    uint16_t batchNextId;         // Restored by rollbackBatch()
+    BatchEntry batchEntries[MAX_TASKS];   // Sorted by id: tasks are appended in id order
+    uint16_t batchEntryCount;
+    uint16_t batchHoles;
+    
+    // Snapshot reference counting
+    const TaskTable* acquire();
+    void release(const TaskTable* table);
+    
+    // Copy-on-write editing: beginWrite() returns a private copy of the
+    // current table, or the batch table for its token (writeMutex held either
+    // way); publish() or abortWrite() ends the edit
+    TaskTable* beginWrite(TaskBatch batch);
+    void publish(TaskTable* table);
+    void abortWrite();
+    
+    // Batch helpers
+    bool inBatch(const TaskTable* table) const { return table == batchTable; }
+    uint16_t locate(const TaskTable* table, uint16_t taskId) const;
+    uint16_t findBatchEntry(uint16_t taskId) const;
+    void compactBatch();
+    void indexBatch();
     
     // Helper methods
-    uint8_t findTaskIndex(uint16_t taskId);
-    void rebuildFilteredList();
-    void swapTasks(uint8_t i, uint8_t j);
+    static void copyTable(TaskTable& to, const TaskTable& from);
+    static void rebuildFilteredList(TaskTable& table);
+    static void swapTasks(TaskTable& table, uint16_t i, uint16_t j);
+    
+    // Snapshots hold references; copying the manager would break them
+    TaskManager(const TaskManager&);
+    TaskManager& operator=(const TaskManager&);
+};
+
+/*
+ * Read-only view of one task list version, kept alive while in scope:
+ *
+ *   TaskSnapshot snapshot(manager);
+ *   for (uint16_t i = 0; i < snapshot.getTaskCount(); i++) draw(*snapshot.getTaskByIndex(i));
+ *   const Task* next = snapshot.getNextTask();
+ *
+ * Keep snapshots short-lived: each one pins a table an edit cannot reuse.
+ */
+class TaskSnapshot {
+public:
+    explicit TaskSnapshot(TaskManager& manager);
+    ~TaskSnapshot();
+    
+    const Task* getTask(uint16_t taskId) const;
+    const Task* getTaskByIndex(uint16_t index) const;
+    uint16_t getTaskCount() const { return table->taskCount; }
+    uint16_t getCompletedCount() const { return table->getCompletedCount(); }
+    uint32_t getVersion() const { return table->version; }
+    
+    // Open tasks by priority (highest first), without sorting the storage
+    const Task* getNextTask() const;
+    uint16_t getTopTasks(const Task** tasks, uint16_t maxTasks) const;
+    uint16_t getPriorityCount(uint8_t priority, bool complete = false) const;
+    
+private:
+    TaskManager& manager;
+    const TaskTable* table;
+    
+    TaskSnapshot(const TaskSnapshot&);
+    TaskSnapshot& operator=(const TaskSnapshot&);
 };
 
 #endif
\ No newline at end of file
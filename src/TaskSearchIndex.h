@@ -0,0 +1,288 @@
+#ifndef TASK_SEARCH_INDEX_H
+#define TASK_SEARCH_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+
+// Where a query may match inside a title
+enum TaskSearchMode {
+  SEARCH_PREFIX,      // At the start of a word
+  SEARCH_SUBSTRING    // Anywhere
+};
+
+struct TaskSearchResult {
+  uint16_t id;
+  uint16_t score;     // Higher is better
+};
+
+/**
+ * Trigram index over task titles, maintained incrementally.
+ *
+ * Titles are normalized (lowercase, each run of non-alphanumerics becomes one
+ * space, a leading space marks the first word), so " buy milk" yields the
+ * trigrams " bu", "buy", "uy ", "y m", ... A word-prefix query is then a
+ * substring query for " query".
+ *
+ * Every distinct trigram of a title links one entry into a hashed posting
+ * list. Entries live in a fixed block per title slot, so insert/remove never
+ * allocate and touch at most TRIGRAMS_PER_TITLE lists. A query walks the
+ * posting list of its rarest trigram and confirms each candidate against the
+ * stored normalized title, so hash collisions cost time, never results.
+ * Queries shorter than a trigram scan the stored titles.
+ *
+ * Ranking: whole-title match, then title prefix, then word prefix, then any
+ * substring; ties go to the earlier match, then to the shorter title.
+ *
+ * Keyed by task id; pure C++ and unsynchronized: the owner serializes access.
+ */
+template <uint16_t CAPACITY, size_t TITLE_SIZE = 32>
+class TaskSearchIndex {
+public:
+  static const size_t TEXT_SIZE = TITLE_SIZE + 1;              // Leading space + title
+  static const size_t TRIGRAMS_PER_TITLE = TEXT_SIZE - 3;      // Of TEXT_SIZE - 1 characters
+  static const uint32_t ENTRY_COUNT = static_cast<uint32_t>(CAPACITY) * TRIGRAMS_PER_TITLE;
+  static const uint16_t NO_SLOT = 0xFFFF;
+
+  TaskSearchIndex() { clear(); }
+
+  void clear() {
+    for (uint32_t i = 0; i < BUCKETS; i++) {
+      m_heads[i] = NO_ENTRY;
+      m_bucketSizes[i] = 0;
+    }
+    for (uint16_t i = 0; i < CAPACITY; i++) {
+      m_ids[i] = 0;
+      m_trigramCounts[i] = 0;
+    }
+    m_count = 0;
+  }
+
+  // Indexes a title under a task id (ids are non-zero)
+  bool insert(uint16_t id, const char* title) {
+    if (id == 0 || title == nullptr || findSlot(id) != NO_SLOT) return false;
+    uint16_t slot = findSlot(0);
+    if (slot == NO_SLOT) return false;
+
+    m_ids[slot] = id;
+    m_count++;
+    link(slot, title);
+    return true;
+  }
+
+  // Bulk rebuild after clear(): fills the slots in order without the
+  // duplicate and free-slot scans of insert(), so n titles cost O(n)
+  bool append(uint16_t id, const char* title) {
+    if (m_count >= CAPACITY || m_ids[m_count] != 0) return insert(id, title);
+    if (id == 0 || title == nullptr) return false;
+
+    uint16_t slot = m_count++;
+    m_ids[slot] = id;
+    link(slot, title);
+    return true;
+  }
+
+  // Re-indexes a task whose title changed
+  bool update(uint16_t id, const char* title) {
+    uint16_t slot = findSlot(id);
+    if (slot == NO_SLOT || id == 0 || title == nullptr) return false;
+    unlink(slot);
+    link(slot, title);
+    return true;
+  }
+
+  bool remove(uint16_t id) {
+    uint16_t slot = findSlot(id);
+    if (slot == NO_SLOT || id == 0) return false;
+    unlink(slot);
+    m_ids[slot] = 0;
+    m_count--;
+    return true;
+  }
+
+  // Fills results best first; returns how many were found (at most maxResults)
+  size_t search(const char* query, TaskSearchMode mode,
+                TaskSearchResult* results, size_t maxResults) const {
+    if (query == nullptr || results == nullptr || maxResults == 0) return 0;
+
+    // A word prefix is the substring " query" of the normalized title
+    char pattern[TEXT_SIZE * 2];
+    size_t length = normalize(query, pattern, sizeof(pattern), mode == SEARCH_PREFIX);
+    size_t start = (mode == SEARCH_PREFIX) ? 1 : 0;
+    if (length <= start || length >= TEXT_SIZE) return 0;   // Empty, or longer than any title
+
+    size_t found = 0;
+    if (length < 3) {
+      for (uint16_t slot = 0; slot < CAPACITY; slot++) {
+        if (m_ids[slot] != 0) consider(slot, pattern, length, start, results, maxResults, found);
+      }
+      return found;
+    }
+
+    // Walk the shortest posting list among the pattern's trigrams
+    uint32_t bucket = hash(pattern);
+    for (size_t i = 1; i + 3 <= length; i++) {
+      uint32_t candidate = hash(pattern + i);
+      if (m_bucketSizes[candidate] < m_bucketSizes[bucket]) bucket = candidate;
+    }
+    for (EntryIndex e = m_heads[bucket]; e != NO_ENTRY; e = m_entries[e].next) {
+      consider(static_cast<uint16_t>(e / TRIGRAMS_PER_TITLE), pattern, length, start,
+               results, maxResults, found);
+    }
+    return found;
+  }
+
+  uint16_t size() const { return m_count; }
+  static size_t getMemoryBytes() { return sizeof(TaskSearchIndex); }
+
+private:
+  // About four postings per bucket when every title is full
+  static constexpr uint32_t bucketCount(uint32_t n, uint32_t target) {
+    return n >= target ? n : bucketCount(n * 2, target);
+  }
+  static const uint32_t BUCKETS = bucketCount(64, ENTRY_COUNT / 4);
+
+  // 16-bit links while the entry table allows it
+  typedef typename std::conditional<(ENTRY_COUNT < 0xFFFF), uint16_t, uint32_t>::type EntryIndex;
+  static const EntryIndex NO_ENTRY = static_cast<EntryIndex>(~static_cast<EntryIndex>(0));
+
+  typedef typename std::conditional<(BUCKETS <= 0x10000), uint16_t, uint32_t>::type BucketIndex;
+
+  struct Entry {
+    EntryIndex next;
+    EntryIndex prev;     // NO_ENTRY at the head of a bucket
+    BucketIndex bucket;
+  };
+
+  Entry m_entries[ENTRY_COUNT];
+  EntryIndex m_heads[BUCKETS];
+  uint16_t m_bucketSizes[BUCKETS];
+  char m_texts[CAPACITY][TEXT_SIZE];
+  uint16_t m_ids[CAPACITY];             // 0: slot free
+  uint8_t m_trigramCounts[CAPACITY];
+  uint16_t m_count;
+
+  static_assert(CAPACITY < NO_SLOT, "TaskSearchIndex capacity must fit 16-bit slots");
+  static_assert(TITLE_SIZE >= 4 && TITLE_SIZE < 255, "TaskSearchIndex title size out of range");
+
+  static char fold(char c) {
+    if (c >= 'A' && c <= 'Z') return static_cast<char>(c - 'A' + 'a');
+    if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || (c & 0x80)) return c;
+    return ' ';
+  }
+
+  // Lowercases and collapses separators; a leading space is kept only if requested
+  static size_t normalize(const char* in, char* out, size_t size, bool leadingSpace) {
+    size_t length = 0;
+    if (leadingSpace) out[length++] = ' ';
+    for (; *in != '\0' && length + 1 < size; in++) {
+      char c = fold(*in);
+      if (c == ' ' && (length == 0 || out[length - 1] == ' ')) continue;
+      out[length++] = c;
+    }
+    // Separators only matter between words
+    size_t keep = leadingSpace ? 1 : 0;
+    while (length > keep && out[length - 1] == ' ') length--;
+    out[length] = '\0';
+    return length;
+  }
+
+  static uint32_t hash(const char* trigram) {
+    uint32_t h = static_cast<uint8_t>(trigram[0]);
+    h = h * 0x01000193u ^ static_cast<uint8_t>(trigram[1]);
+    h = h * 0x01000193u ^ static_cast<uint8_t>(trigram[2]);
+    return (h ^ (h >> 15)) & (BUCKETS - 1);
+  }
+
+  uint16_t findSlot(uint16_t id) const {
+    for (uint16_t slot = 0; slot < CAPACITY; slot++) {
+      if (m_ids[slot] == id) return slot;
+    }
+    return NO_SLOT;
+  }
+
+  void link(uint16_t slot, const char* title) {
+    char* text = m_texts[slot];
+    size_t length = normalize(title, text, TEXT_SIZE, true);
+
+    uint8_t count = 0;
+    for (size_t i = 0; i + 3 <= length; i++) {
+      BucketIndex bucket = static_cast<BucketIndex>(hash(text + i));
+
+      // One posting per distinct trigram hash
+      bool seen = false;
+      EntryIndex base = static_cast<EntryIndex>(slot * TRIGRAMS_PER_TITLE);
+      for (uint8_t k = 0; k < count && !seen; k++) {
+        seen = m_entries[base + k].bucket == bucket;
+      }
+      if (seen) continue;
+
+      EntryIndex e = static_cast<EntryIndex>(base + count++);
+      Entry& entry = m_entries[e];
+      entry.bucket = bucket;
+      entry.prev = NO_ENTRY;
+      entry.next = m_heads[bucket];
+      if (entry.next != NO_ENTRY) m_entries[entry.next].prev = e;
+      m_heads[bucket] = e;
+      m_bucketSizes[bucket]++;
+    }
+    m_trigramCounts[slot] = count;
+  }
+
+  void unlink(uint16_t slot) {
+    EntryIndex base = static_cast<EntryIndex>(slot * TRIGRAMS_PER_TITLE);
+    for (uint8_t k = 0; k < m_trigramCounts[slot]; k++) {
+      Entry& entry = m_entries[base + k];
+      if (entry.prev != NO_ENTRY) {
+        m_entries[entry.prev].next = entry.next;
+      } else {
+        m_heads[entry.bucket] = entry.next;
+      }
+      if (entry.next != NO_ENTRY) m_entries[entry.next].prev = entry.prev;
+      m_bucketSizes[entry.bucket]--;
+    }
+    m_trigramCounts[slot] = 0;
+    m_texts[slot][0] = '\0';
+  }
+
+  // Confirms a candidate and keeps it if it ranks among the best maxResults
+  void consider(uint16_t slot, const char* pattern, size_t length, size_t start,
+                TaskSearchResult* results, size_t maxResults, size_t& found) const {
+    const char* text = m_texts[slot];
+    const char* match = strstr(text, pattern);
+    if (match == nullptr) return;
+
+    // Positions in the title, without the leading space
+    size_t textLength = strlen(text) - 1;
+    size_t position = static_cast<size_t>(match - text) + start - 1;
+    size_t queryLength = length - start;
+
+    uint16_t kind;
+    if (position == 0 && queryLength == textLength) {
+      kind = 3;
+    } else if (position == 0) {
+      kind = 2;
+    } else if (text[position] == ' ') {
+      kind = 1;
+    } else {
+      kind = 0;
+    }
+    uint16_t score = static_cast<uint16_t>((kind << 10) |
+                                           ((31 - (position < 31 ? position : 31)) << 5) |
+                                           (31 - (textLength < 31 ? textLength : 31)));
+
+    // Insertion into the sorted result list
+    size_t i = (found < maxResults) ? found++ : maxResults;
+    while (i > 0 && results[i - 1].score < score) {
+      if (i < maxResults) results[i] = results[i - 1];
+      i--;
+    }
+    if (i < maxResults) {
+      results[i].id = m_ids[slot];
+      results[i].score = score;
+    }
+  }
+};
+
+#endif // TASK_SEARCH_INDEX_H
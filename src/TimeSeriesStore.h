@@ -0,0 +1,279 @@
+#ifndef TIME_SERIES_STORE_H
+#define TIME_SERIES_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * Compressed time-series ring (Gorilla-style).
+ *
+ * Records are a timestamp (seconds) plus CHANNELS integer values. They are
+ * packed into fixed-size blocks; the first record of a block is stored raw in
+ * the block header and the rest as bit-packed codes:
+ *   - timestamp: zigzag delta-of-delta, so a steady cadence costs 1 bit
+ *   - each value: zigzag delta from the previous record, so an unchanged
+ *     value costs 1 bit and small drifts a few bits
+ * Codes use a unary bucket prefix: 0 | 10+n1 | 110+n2 | 1110+n3 | 1111+32.
+ *
+ * When every block is used the oldest is recycled. Each block header keeps its
+ * time span, so range queries skip whole blocks without decoding them.
+ * Pure C++ and unsynchronized: the owner serializes access.
+ */
+template <size_t CHANNELS, size_t BLOCK_BYTES = 256, size_t BLOCK_COUNT = 16>
+class TimeSeriesStore {
+public:
+  // Receives each record of a query, oldest first
+  typedef void (*Visitor)(void* context, uint32_t time, const int32_t* values);
+
+  TimeSeriesStore() { clear(); }
+
+  void clear() {
+    m_head = 0;
+    m_used = 0;
+    m_samples = 0;
+    m_blocksDecoded = 0;
+  }
+
+  // Appends a record; time must be later than the newest record
+  bool append(uint32_t time, const int32_t* values) {
+    if (m_used > 0 && time <= m_blocks[newestIndex()].endTime) {
+      return false;
+    }
+
+    if (m_used == 0 || !appendToBlock(m_blocks[newestIndex()], time, values)) {
+      startBlock(time, values);
+    }
+    m_samples++;
+    return true;
+  }
+
+  // Visits every record with from <= time <= to; returns the number visited
+  size_t query(uint32_t from, uint32_t to, Visitor visitor, void* context) const {
+    size_t visited = 0;
+    for (size_t i = 0; i < m_used; i++) {
+      const Block& block = m_blocks[blockIndex(i)];
+      if (block.endTime < from) continue;     // Entirely before the range
+      if (block.startTime > to) break;        // This and all newer blocks are after it
+      m_blocksDecoded++;
+      visited += decodeBlock(block, from, to, visitor, context);
+    }
+    return visited;
+  }
+
+  // Visits the records of the last seconds (relative to the newest record)
+  size_t queryLast(uint32_t seconds, Visitor visitor, void* context) const {
+    if (m_used == 0) return 0;
+    uint32_t newest = getNewestTime();
+    uint32_t from = newest > seconds ? newest - seconds : 0;
+    return query(from, newest, visitor, context);
+  }
+
+  bool isEmpty() const { return m_used == 0; }
+  uint32_t getOldestTime() const { return m_used ? m_blocks[blockIndex(0)].startTime : 0; }
+  uint32_t getNewestTime() const { return m_used ? m_blocks[newestIndex()].endTime : 0; }
+
+  // Statistics
+  size_t getRecordCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < m_used; i++) count += m_blocks[blockIndex(i)].count;
+    return count;
+  }
+  uint32_t getAppendCount() const { return m_samples; }
+  size_t getBlocksUsed() const { return m_used; }
+  uint32_t getBlocksDecoded() const { return m_blocksDecoded; }   // By queries; skipped blocks are not
+
+  // Compressed bytes in use, headers included
+  size_t getBytesUsed() const {
+    size_t bytes = 0;
+    for (size_t i = 0; i < m_used; i++) {
+      bytes += sizeof(Block) - BLOCK_BYTES + (m_blocks[blockIndex(i)].bitCount + 7) / 8;
+    }
+    return bytes;
+  }
+
+  static size_t getCapacityBytes() { return sizeof(Block) * BLOCK_COUNT; }
+
+private:
+  struct Block {
+    uint32_t startTime;
+    uint32_t endTime;
+    int32_t firstValues[CHANNELS];
+    uint16_t count;
+    uint16_t bitCount;
+    uint8_t data[BLOCK_BYTES];
+  };
+
+  // Encoder state of the newest block
+  struct WriterState {
+    uint32_t prevTime;
+    uint32_t prevDelta;
+    int32_t prevValues[CHANNELS];
+  };
+
+  static const uint32_t MAX_BITS = BLOCK_BYTES * 8;
+
+  Block m_blocks[BLOCK_COUNT];
+  WriterState m_writer;
+  size_t m_head;      // Index of the oldest block
+  size_t m_used;
+  uint32_t m_samples;
+  mutable uint32_t m_blocksDecoded;
+
+  static_assert(BLOCK_BYTES * 8 < 0xFFFF, "Block bit count must fit 16 bits");
+  static_assert(BLOCK_COUNT > 0, "TimeSeriesStore needs at least one block");
+
+  size_t blockIndex(size_t age) const { return (m_head + age) % BLOCK_COUNT; }
+  size_t newestIndex() const { return blockIndex(m_used - 1); }
+
+  static uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  }
+  static int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+  }
+
+  // Bucket widths after the 0 / 10 / 110 / 1110 / 1111 prefixes
+  static uint8_t bucketBits(uint32_t zz, const uint8_t* widths) {
+    if (zz == 0) return 1;
+    if (zz < (1u << widths[0])) return 2 + widths[0];
+    if (zz < (1u << widths[1])) return 3 + widths[1];
+    if (zz < (1u << widths[2])) return 4 + widths[2];
+    return 4 + 32;
+  }
+
+  static const uint8_t* timeWidths() { static const uint8_t w[3] = { 7, 9, 12 }; return w; }
+  static const uint8_t* valueWidths() { static const uint8_t w[3] = { 4, 8, 12 }; return w; }
+
+  static void writeBits(uint8_t* data, uint16_t& pos, uint32_t bits, uint8_t count) {
+    for (int8_t i = count - 1; i >= 0; i--) {
+      uint8_t mask = static_cast<uint8_t>(0x80 >> (pos & 7));
+      if ((bits >> i) & 1) {
+        data[pos >> 3] |= mask;
+      } else {
+        data[pos >> 3] &= static_cast<uint8_t>(~mask);
+      }
+      pos++;
+    }
+  }
+
+  static uint32_t readBits(const uint8_t* data, uint16_t& pos, uint8_t count) {
+    uint32_t bits = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      bits = (bits << 1) | ((data[pos >> 3] >> (7 - (pos & 7))) & 1);
+      pos++;
+    }
+    return bits;
+  }
+
+  static void encode(uint8_t* data, uint16_t& pos, uint32_t zz, const uint8_t* widths) {
+    if (zz == 0) {
+      writeBits(data, pos, 0x0, 1);
+    } else if (zz < (1u << widths[0])) {
+      writeBits(data, pos, 0x2, 2);
+      writeBits(data, pos, zz, widths[0]);
+    } else if (zz < (1u << widths[1])) {
+      writeBits(data, pos, 0x6, 3);
+      writeBits(data, pos, zz, widths[1]);
+    } else if (zz < (1u << widths[2])) {
+      writeBits(data, pos, 0xE, 4);
+      writeBits(data, pos, zz, widths[2]);
+    } else {
+      writeBits(data, pos, 0xF, 4);
+      writeBits(data, pos, zz, 32);
+    }
+  }
+
+  static uint32_t decode(const uint8_t* data, uint16_t& pos, const uint8_t* widths) {
+    uint8_t prefix = 0;
+    while (prefix < 4 && readBits(data, pos, 1)) prefix++;
+    switch (prefix) {
+      case 0: return 0;
+      case 1: return readBits(data, pos, widths[0]);
+      case 2: return readBits(data, pos, widths[1]);
+      case 3: return readBits(data, pos, widths[2]);
+      default: return readBits(data, pos, 32);
+    }
+  }
+
+  void startBlock(uint32_t time, const int32_t* values) {
+    size_t index;
+    if (m_used < BLOCK_COUNT) {
+      index = blockIndex(m_used);
+      m_used++;
+    } else {
+      // Recycle the oldest block
+      index = m_head;
+      m_head = (m_head + 1) % BLOCK_COUNT;
+    }
+
+    Block& block = m_blocks[index];
+    block.startTime = time;
+    block.endTime = time;
+    memcpy(block.firstValues, values, sizeof(block.firstValues));
+    block.count = 1;
+    block.bitCount = 0;
+
+    m_writer.prevTime = time;
+    m_writer.prevDelta = 0;
+    memcpy(m_writer.prevValues, values, sizeof(m_writer.prevValues));
+  }
+
+  // Encodes a record after the block's last one; false if it does not fit
+  bool appendToBlock(Block& block, uint32_t time, const int32_t* values) {
+    if (block.count == 0xFFFF) return false;
+
+    uint32_t delta = time - m_writer.prevTime;
+    uint32_t timeCode = zigzag(static_cast<int32_t>(delta - m_writer.prevDelta));
+    uint32_t valueCodes[CHANNELS];
+
+    uint32_t bits = bucketBits(timeCode, timeWidths());
+    for (size_t c = 0; c < CHANNELS; c++) {
+      valueCodes[c] = zigzag(static_cast<int32_t>(
+          static_cast<uint32_t>(values[c]) - static_cast<uint32_t>(m_writer.prevValues[c])));
+      bits += bucketBits(valueCodes[c], valueWidths());
+    }
+    if (block.bitCount + bits > MAX_BITS) return false;
+
+    encode(block.data, block.bitCount, timeCode, timeWidths());
+    for (size_t c = 0; c < CHANNELS; c++) {
+      encode(block.data, block.bitCount, valueCodes[c], valueWidths());
+    }
+    block.endTime = time;
+    block.count++;
+
+    m_writer.prevTime = time;
+    m_writer.prevDelta = delta;
+    memcpy(m_writer.prevValues, values, sizeof(m_writer.prevValues));
+    return true;
+  }
+
+  size_t decodeBlock(const Block& block, uint32_t from, uint32_t to,
+                     Visitor visitor, void* context) const {
+    int32_t values[CHANNELS];
+    memcpy(values, block.firstValues, sizeof(values));
+    uint32_t time = block.startTime;
+    uint32_t delta = 0;
+    uint16_t pos = 0;
+    size_t visited = 0;
+
+    for (uint16_t i = 0; i < block.count; i++) {
+      if (i > 0) {
+        delta += static_cast<uint32_t>(unzigzag(decode(block.data, pos, timeWidths())));
+        time += delta;
+        for (size_t c = 0; c < CHANNELS; c++) {
+          values[c] = static_cast<int32_t>(static_cast<uint32_t>(values[c]) +
+                                           static_cast<uint32_t>(unzigzag(decode(block.data, pos, valueWidths()))));
+        }
+      }
+      if (time > to) break;
+      if (time >= from) {
+        visitor(context, time, values);
+        visited++;
+      }
+    }
+    return visited;
+  }
+};
+
+#endif // TIME_SERIES_STORE_H
@@ -0,0 +1,180 @@
+#include "TimerWheel.h"
+
+/**
+ * @brief Constructor - an empty wheel at time 0
+ */
+TimerWheel::TimerWheel() : m_now(0), m_pending(0) {
+  for (unsigned level = 0; level < LEVELS; level++) {
+    for (uint32_t slot = 0; slot < SLOTS; slot++) {
+      m_slots[level][slot] = nullptr;
+    }
+  }
+}
+
+/**
+ * @brief Jumps to a new current time without firing anything
+ * Pending timers are re-placed relative to it; expired ones fire on the next tick.
+ * @param now New current time
+ */
+void TimerWheel::reset(uint32_t now) {
+  TimerNode* list = detachAll();
+
+  m_now = now;
+  while (list != nullptr) {
+    TimerNode* node = list;
+    list = list->next;
+    schedule(*node, node->expires);
+  }
+}
+
+/**
+ * @brief Arms a timer, replacing any pending expiry
+ * @param node Timer to arm
+ * @param expires Expiry in ticks
+ */
+void TimerWheel::schedule(TimerNode& node, uint32_t expires) {
+  if (node.isPending()) {
+    unlink(node);
+  }
+  // Never into the bucket being fired: a past expiry fires on the next tick
+  if (static_cast<int32_t>(expires - m_now) <= 0) {
+    expires = m_now + 1;
+  }
+  node.expires = expires;
+  place(node);
+}
+
+/**
+ * @brief Disarms a timer; idle timers are ignored
+ * @param node Timer to cancel
+ */
+void TimerWheel::cancel(TimerNode& node) {
+  if (node.isPending()) {
+    unlink(node);
+  }
+}
+
+/**
+ * @brief Advances to now, one tick at a time
+ * A jump of a full RANGE or more (e.g. the RTC was set) re-places every timer
+ * instead of walking every tick.
+ * @param now Current time in ticks
+ * @return Number of callbacks run
+ */
+size_t TimerWheel::advance(uint32_t now) {
+  int32_t gap = static_cast<int32_t>(now - m_now);
+  if (gap <= 0) return 0;
+  if (static_cast<uint32_t>(gap) >= RANGE) {
+    return rebuild(now);
+  }
+
+  size_t fired = 0;
+  while (m_now != now) {
+    fired += tick();
+  }
+  return fired;
+}
+
+// Private helper methods
+void TimerWheel::place(TimerNode& node) {
+  uint32_t delta = node.expires - m_now;
+  unsigned level = 0;
+  while (level < LEVELS - 1 && delta >= (1u << (SLOT_BITS * (level + 1)))) {
+    level++;
+  }
+
+  // Beyond the range: park in the top bucket that is redistributed last
+  uint32_t expires = (delta >= RANGE) ? m_now + RANGE - 1 : node.expires;
+  uint32_t slot = (expires >> (SLOT_BITS * level)) & SLOT_MASK;
+
+  TimerNode** head = &m_slots[level][slot];
+  node.next = *head;
+  if (node.next != nullptr) node.next->pprev = &node.next;
+  node.pprev = head;
+  *head = &node;
+  m_pending++;
+}
+
+void TimerWheel::unlink(TimerNode& node) {
+  *node.pprev = node.next;
+  if (node.next != nullptr) node.next->pprev = node.pprev;
+  node.next = nullptr;
+  node.pprev = nullptr;
+  m_pending--;
+}
+
+void TimerWheel::cascade(unsigned level, uint32_t slot) {
+  TimerNode* list = m_slots[level][slot];
+  while (list != nullptr) {
+    TimerNode* node = list;
+    list = list->next;
+    unlink(*node);
+    place(*node);   // Lands in a lower level (or the current level-0 bucket)
+  }
+}
+
+size_t TimerWheel::fire(TimerNode& node) {
+  unlink(node);
+  if (node.callback == nullptr) return 0;
+
+  uint32_t next = node.callback(&node, m_now, node.context);
+  if (next != 0) {
+    schedule(node, next);
+  }
+  return 1;
+}
+
+size_t TimerWheel::tick() {
+  m_now++;
+
+  // Redistribute the higher-level buckets whose span starts now
+  for (unsigned level = 1; level < LEVELS; level++) {
+    if ((m_now & ((1u << (SLOT_BITS * level)) - 1)) != 0) break;
+    cascade(level, (m_now >> (SLOT_BITS * level)) & SLOT_MASK);
+  }
+
+  // Everything in the current level-0 bucket expires now. Re-armed timers
+  // land at least one tick ahead, so this loop cannot revisit them.
+  TimerNode** head = &m_slots[0][m_now & SLOT_MASK];
+  size_t fired = 0;
+  while (*head != nullptr) {
+    fired += fire(**head);
+  }
+  return fired;
+}
+
+TimerNode* TimerWheel::detachAll() {
+  // Unlinked nodes are chained through next for the caller to re-place
+  TimerNode* list = nullptr;
+  for (unsigned level = 0; level < LEVELS; level++) {
+    for (uint32_t slot = 0; slot < SLOTS; slot++) {
+      while (m_slots[level][slot] != nullptr) {
+        TimerNode* node = m_slots[level][slot];
+        unlink(*node);
+        node->next = list;
+        list = node;
+      }
+    }
+  }
+  return list;
+}
+
+size_t TimerWheel::rebuild(uint32_t now) {
+  TimerNode* list = detachAll();
+
+  m_now = now;
+  size_t fired = 0;
+  while (list != nullptr) {
+    TimerNode* node = list;
+    list = list->next;
+    node->next = nullptr;
+    if (static_cast<int32_t>(node->expires - now) <= 0) {
+      // Already due: run it now (fire() expects a linked node)
+      place(*node);
+      fired += fire(*node);
+    } else {
+      place(*node);
+    }
+  }
+  return fired;
+}
@@ -0,0 +1,81 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Intrusive timer: embed it in the object that owns the deadline.
+ * The callback runs when the wheel reaches the expiry; it returns the next
+ * expiry to re-arm the timer (periodic actions) or 0 to leave it idle.
+ */
+struct TimerNode {
+  typedef uint32_t (*Callback)(TimerNode* node, uint32_t now, void* context);
+
+  TimerNode* next;
+  TimerNode** pprev;   // Link that points at this node; nullptr when idle
+  uint32_t expires;
+  Callback callback;
+  void* context;
+
+  TimerNode() : next(nullptr), pprev(nullptr), expires(0), callback(nullptr), context(nullptr) {}
+  TimerNode(Callback cb, void* ctx)
+    : next(nullptr), pprev(nullptr), expires(0), callback(cb), context(ctx) {}
+
+  bool isPending() const { return pprev != nullptr; }
+};
+
+/**
+ * Hashed hierarchical timer wheel.
+ *
+ * LEVELS wheels of SLOTS buckets each; level n buckets span SLOTS^n ticks.
+ * A timer goes straight into the bucket of its expiry at the coarsest level
+ * it needs, so schedule() and cancel() are O(1). Each tick fires one
+ * level-0 bucket; every SLOTS ticks one higher-level bucket is redistributed
+ * downwards. The work per tick is therefore constant plus the timers that
+ * actually expire, however many thousands are pending.
+ *
+ * The tick unit is the caller's (seconds for the RTC clock). Expiries further
+ * out than RANGE ticks wait in the top level and are redistributed until they
+ * come into range. Pure C++ and unsynchronized: the owner serializes access.
+ */
+class TimerWheel {
+public:
+  static const unsigned SLOT_BITS = 6;
+  static const uint32_t SLOTS = 1u << SLOT_BITS;
+  static const unsigned LEVELS = 4;
+  static const uint32_t RANGE = 1u << (SLOT_BITS * LEVELS);   // ~194 days of seconds
+
+  TimerWheel();
+
+  // Sets the current time; pending timers are kept and re-placed
+  void reset(uint32_t now);
+
+  // Arms (or re-arms) a timer; an expiry not after the current time fires on the next tick
+  void schedule(TimerNode& node, uint32_t expires);
+  void cancel(TimerNode& node);
+
+  // Moves time forward, firing every timer that expires on the way; returns the number fired.
+  // Time never moves backwards: an earlier now is ignored.
+  size_t advance(uint32_t now);
+
+  uint32_t getTime() const { return m_now; }
+  size_t getPendingCount() const { return m_pending; }
+
+private:
+  static const uint32_t SLOT_MASK = SLOTS - 1;
+
+  TimerNode* m_slots[LEVELS][SLOTS];
+  uint32_t m_now;
+  size_t m_pending;
+
+  void place(TimerNode& node);
+  void unlink(TimerNode& node);
+  void cascade(unsigned level, uint32_t slot);
+  size_t fire(TimerNode& node);
+  size_t tick();
+  TimerNode* detachAll();
+  size_t rebuild(uint32_t now);
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,212 @@
+#include "Trace.h"
+
+#ifdef TRACE_ENABLE
+
+#include <string.h>
+#include <esp_ipc.h>
+#include <esp_timer.h>
+#include "ExecutorTask.h"
+
+TraceRing g_traceRings[portNUM_PROCESSORS];
+
+// Named tracks, appended by traceRegisterTrack() and read by the exporter
+struct TraceTrack {
+  uint8_t id;
+  uint16_t arg;
+  const char* name;
+};
+
+static const uint8_t MAX_TRACE_TRACKS = 16;
+static TraceTrack s_tracks[MAX_TRACE_TRACKS];
+static uint8_t s_trackCount = 0;
+static portMUX_TYPE s_trackLock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Names a track for the exporter
+ * Tracks of one id are numbered from 0 in registration order; past
+ * MAX_TRACE_TRACKS they are still numbered but left unnamed.
+ * @param id TRACE_ID_TASK or TRACE_ID_RENDER
+ * @param name Static string shown for the track
+ * @return The arg to record with this track's BEGIN/END
+ */
+uint16_t traceRegisterTrack(uint8_t id, const char* name) {
+  static uint16_t unnamed = 0;
+  uint16_t arg = 0;
+
+  portENTER_CRITICAL(&s_trackLock);
+  for (uint8_t i = 0; i < s_trackCount; i++) {
+    if (s_tracks[i].id == id) arg++;
+  }
+  if (s_trackCount < MAX_TRACE_TRACKS) {
+    TraceTrack& track = s_tracks[s_trackCount];
+    track.id = id;
+    track.arg = arg;
+    track.name = name;
+    __atomic_store_n(&s_trackCount, s_trackCount + 1, __ATOMIC_RELEASE);
+  } else {
+    arg = static_cast<uint16_t>(arg + ++unnamed);
+  }
+  portEXIT_CRITICAL(&s_trackLock);
+  return arg;
+}
+
+/**
+ * @brief Pairs CCOUNT of the calling core with esp_timer time (run on each core via IPC)
+ */
+static void writeSync(void*) {
+  uint32_t us = static_cast<uint32_t>(esp_timer_get_time());
+  traceRecord(TRACE_TYPE_SYNC, static_cast<uint8_t>(us >> 16), static_cast<uint16_t>(us));
+}
+
+/**
+ * @brief Constructor - nothing is sent until start()
+ */
+TraceExporter::TraceExporter()
+  : m_port(nullptr), m_sent(0), m_lostTotal(0), m_seq(0), m_nextNames(0) {
+  memset(m_tail, 0, sizeof(m_tail));
+}
+
+/**
+ * @brief Starts streaming; records written before this are sent as far as the rings still hold them
+ * @param port UART to stream on (shared with TaskLink, which ignores trace frames)
+ * @param executor Executor to run the exporter on
+ * @return false if already started
+ */
+bool TraceExporter::start(HardwareSerial& port, ExecutorTask& executor) {
+  if (m_port != nullptr) {
+    Serial.println("Trace exporter already running");
+    return false;
+  }
+
+  m_port = &port;
+  executor.spawn(*this);
+  return true;
+}
+
+/**
+ * @brief Export loop coroutine
+ * A pass sends no more than the UART can take without blocking; whatever is
+ * left waits for the next pass, and the rings absorb bursts in between.
+ */
+void TraceExporter::step() {
+  CO_BEGIN();
+  m_nextNames = coNow();
+
+  while (true) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      esp_ipc_call(core, writeSync, nullptr);
+    }
+
+    if (static_cast<int32_t>(coNow() - m_nextNames) >= 0 && sendNames()) {
+      m_nextNames = coNow() + NAMES_PERIOD_MS;
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      while (sendRecords(core)) {
+      }
+    }
+    CO_DELAY(PERIOD_MS);
+  }
+  CO_END();
+}
+
+/**
+ * @brief Sends the oldest unsent records of one core in a TASKLINK_TRACE frame
+ * @param core Ring to drain
+ * @return true if a frame went out and more records may be waiting
+ */
+bool TraceExporter::sendRecords(int core) {
+  TraceRing& ring = g_traceRings[core];
+  uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+  uint32_t tail = m_tail[core];
+  uint32_t lost = 0;
+
+  // Lapped since the last pass: the oldest records are gone
+  if (head - tail > TraceRing::SIZE) {
+    lost = head - TraceRing::SIZE - tail;
+    tail = head - TraceRing::SIZE;
+  }
+
+  uint32_t count = head - tail;
+  if (count == 0) return false;
+  if (count > RECORDS_PER_FRAME) count = RECORDS_PER_FRAME;
+
+  size_t length = TRACE_FRAME_HEADER + count * TRACE_RECORD_SIZE;
+  int room = m_port->availableForWrite();
+  if (room < 0 || static_cast<size_t>(room) < length + TaskLinkFramer::HEADER_SIZE + TaskLinkFramer::CRC_SIZE) {
+    return false;
+  }
+
+  uint8_t* out = m_payload + TRACE_FRAME_HEADER;
+  for (uint32_t i = 0; i < count; i++) {
+    tracePackRecord(ring.records[(tail + i) & TraceRing::MASK], out + i * TRACE_RECORD_SIZE);
+  }
+
+  // A writer may have lapped the copy meanwhile; the slot it is filling now
+  // (index head) is suspect as well, so keep only indices above head - SIZE
+  uint32_t after = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+  uint32_t torn = after + 1 - TraceRing::SIZE - tail;
+  if (static_cast<int32_t>(torn) > 0) {
+    if (torn > count) torn = count;
+    memmove(out, out + torn * TRACE_RECORD_SIZE, (count - torn) * TRACE_RECORD_SIZE);
+    lost += torn;
+  }
+
+  m_tail[core] = tail + count;
+  m_lostTotal += lost;
+
+  uint32_t kept = count - (static_cast<int32_t>(torn) > 0 ? torn : 0);
+  m_payload[0] = static_cast<uint8_t>(core);
+  m_payload[1] = 0;
+  taskLinkPut16(m_payload + 2, static_cast<uint16_t>(lost > 0xFFFF ? 0xFFFF : lost));
+  taskLinkPut32(m_payload + 4, static_cast<uint32_t>(esp_timer_get_time()));
+  sendFrame(TASKLINK_TRACE, TRACE_FRAME_HEADER + kept * TRACE_RECORD_SIZE);
+  m_sent += kept;
+  return true;
+}
+
+/**
+ * @brief Sends the names of all registered tracks in TASKLINK_TRACE_NAMES frames
+ * @return false if the UART had no room (retried on the next pass)
+ */
+bool TraceExporter::sendNames() {
+  uint8_t count = __atomic_load_n(&s_trackCount, __ATOMIC_ACQUIRE);
+  size_t length = 0;
+
+  for (uint8_t i = 0; i <= count; i++) {
+    size_t nameLength = i < count ? strnlen(s_tracks[i].name, TRACE_NAME_MAX) : 0;
+    size_t entry = 4 + nameLength;
+
+    // Flush before the entry that does not fit, and after the last one
+    if (length > 0 && (i == count || length + entry > TaskLinkFrame::MAX_PAYLOAD)) {
+      int room = m_port->availableForWrite();
+      if (room < 0 || static_cast<size_t>(room) < length + TaskLinkFramer::HEADER_SIZE + TaskLinkFramer::CRC_SIZE) {
+        return false;
+      }
+      sendFrame(TASKLINK_TRACE_NAMES, length);
+      length = 0;
+    }
+    if (i == count) break;
+
+    uint8_t* out = m_payload + length;
+    out[0] = s_tracks[i].id;
+    taskLinkPut16(out + 1, s_tracks[i].arg);
+    out[3] = static_cast<uint8_t>(nameLength);
+    memcpy(out + 4, s_tracks[i].name, nameLength);
+    length += entry;
+  }
+  return true;
+}
+
+/**
+ * @brief Frames m_payload and writes it to the UART
+ * @param type TaskLinkType of the frame
+ * @param length Payload bytes
+ * @return true if the whole frame was written
+ */
+bool TraceExporter::sendFrame(uint8_t type, size_t length) {
+  size_t size = TaskLinkFramer::encode(type, m_seq++, m_payload, length, m_frame);
+  return size > 0 && m_port->write(m_frame, size) == size;
+}
+
+#endif // TRACE_ENABLE
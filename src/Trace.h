@@ -0,0 +1,140 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "TraceFormat.h"
+#include "FlightRecorder.h"
+
+/**
+ * Low-overhead event tracing (build with -DTRACE_ENABLE).
+ *
+ * Each core appends 8-byte records to its own ring: the CCOUNT timestamp
+ * and a slot are taken with interrupts masked for a few instructions, so
+ * recording is safe from tasks and ISRs on either core and costs tens of
+ * cycles. Rings overwrite their oldest records; TraceExporter streams them
+ * as TaskLink frames on the console UART and tools/tracedump.cpp turns a
+ * capture into Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * Without TRACE_ENABLE every macro compiles to nothing (TRACE_TAKE to
+ * flightTake(), which only logs timeouts), so call sites stay in release builds.
+ *
+ *   TRACE_BEGIN(TRACE_ID_RENDER, m_traceTrack);
+ *   ...
+ *   TRACE_END(TRACE_ID_RENDER, m_traceTrack);
+ *   if (TRACE_TAKE(m_stateMutex, pdMS_TO_TICKS(100), TRACE_MUTEX_MODEL_STATE)) { ... }
+ */
+
+#ifdef TRACE_ENABLE
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <hal/cpu_hal.h>
+#include "Coroutine.h"
+#include "TaskLinkProtocol.h"
+
+class ExecutorTask;
+
+// Records per core (power of two); 8 bytes each
+#ifndef TRACE_RING_RECORDS
+#define TRACE_RING_RECORDS 1024
+#endif
+
+struct TraceRing {
+  static const uint32_t SIZE = TRACE_RING_RECORDS;
+  static const uint32_t MASK = SIZE - 1;
+  static_assert((SIZE & MASK) == 0, "TRACE_RING_RECORDS must be a power of two");
+
+  TraceRecord records[SIZE];
+  uint32_t head;   // Records written since boot; published after the record
+};
+
+extern TraceRing g_traceRings[portNUM_PROCESSORS];
+
+// Appends one record to the ring of the calling core (task or ISR context)
+static inline __attribute__((always_inline)) void traceRecord(uint8_t type, uint8_t id, uint16_t arg) {
+  uint32_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+  TraceRing& ring = g_traceRings[xPortGetCoreID()];
+  uint32_t head = ring.head;
+  TraceRecord& record = ring.records[head & TraceRing::MASK];
+  record.cycles = cpu_hal_get_cycle_count();
+  record.type = type;
+  record.id = id;
+  record.arg = arg;
+  __atomic_store_n(&ring.head, head + 1, __ATOMIC_RELEASE);
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+// flightTake() that records a MUTEX span only when it has to wait
+static inline bool traceTake(SemaphoreHandle_t mutex, TickType_t timeout, uint16_t traceMutex) {
+  if (xSemaphoreTake(mutex, 0) == pdTRUE) return true;
+  if (timeout == 0) return false;
+
+  traceRecord(TRACE_TYPE_BEGIN, TRACE_ID_MUTEX, traceMutex);
+  bool taken = flightTake(mutex, timeout, static_cast<uint8_t>(traceMutex));
+  traceRecord(TRACE_TYPE_END, TRACE_ID_MUTEX,
+              static_cast<uint16_t>(traceMutex | (taken ? 0 : TRACE_MUTEX_TIMED_OUT)));
+  return taken;
+}
+
+// Names a track of TRACE_ID_TASK or TRACE_ID_RENDER; returns the arg to record for it
+uint16_t traceRegisterTrack(uint8_t id, const char* name);
+
+#define TRACE_BEGIN(id, arg) traceRecord(TRACE_TYPE_BEGIN, (id), (arg))
+#define TRACE_END(id, arg) traceRecord(TRACE_TYPE_END, (id), (arg))
+#define TRACE_INSTANT(id, arg) traceRecord(TRACE_TYPE_INSTANT, (id), (arg))
+#define TRACE_TAKE(mutex, timeout, traceMutex) traceTake((mutex), (timeout), (traceMutex))
+#define TRACE_REGISTER_TRACK(id, name) traceRegisterTrack((id), (name))
+
+/**
+ * Streams the rings to a UART as TASKLINK_TRACE frames, from a coroutine.
+ *
+ * Every pass first writes a SYNC record on each core (the other core via
+ * IPC), then sends whatever fits in the UART's free transmit space. Track
+ * names go out at the start and every NAMES_PERIOD_MS, so a host that
+ * attaches late still gets them.
+ */
+class TraceExporter : public Coroutine {
+public:
+  static const uint32_t PERIOD_MS = 20;
+  static const uint32_t NAMES_PERIOD_MS = 5000;
+  static const size_t RECORDS_PER_FRAME =
+      (TaskLinkFrame::MAX_PAYLOAD - TRACE_FRAME_HEADER) / TRACE_RECORD_SIZE;
+
+  TraceExporter();
+
+  bool start(HardwareSerial& port, ExecutorTask& executor);
+
+  uint32_t getSentCount() const { return m_sent; }
+  uint32_t getLostCount() const { return m_lostTotal; }
+
+protected:
+  void step() override;
+
+private:
+  HardwareSerial* m_port;
+  uint32_t m_tail[portNUM_PROCESSORS];
+  uint32_t m_sent;
+  uint32_t m_lostTotal;
+  uint8_t m_seq;
+  CoTime m_nextNames;
+
+  // Kept off the executor's stack
+  uint8_t m_payload[TaskLinkFrame::MAX_PAYLOAD];
+  uint8_t m_frame[TaskLinkFramer::MAX_FRAME];
+
+  bool sendRecords(int core);
+  bool sendNames();
+  bool sendFrame(uint8_t type, size_t length);
+};
+
+#else
+
+#define TRACE_BEGIN(id, arg) do {} while (0)
+#define TRACE_END(id, arg) do {} while (0)
+#define TRACE_INSTANT(id, arg) do {} while (0)
+#define TRACE_TAKE(mutex, timeout, traceMutex) flightTake((mutex), (timeout), (traceMutex))
+#define TRACE_REGISTER_TRACK(id, name) static_cast<uint16_t>(0)
+
+#endif // TRACE_ENABLE
+
+#endif // TRACE_H
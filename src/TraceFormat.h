@@ -0,0 +1,95 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Trace records and their export frames (see Trace.h for the recorder).
+ *
+ * A record is 8 bytes: CCOUNT of the core that wrote it (LE32), type, id,
+ * arg (LE16). Records travel in TaskLink frames on the console UART:
+ *
+ *   TASKLINK_TRACE:        core, 0, lost (LE16), syncUs (LE32), records...
+ *   TASKLINK_TRACE_NAMES:  { id, arg (LE16), length, name[length] }...
+ *
+ * CCOUNT runs at the current CPU clock (which DFS changes) and stops in
+ * light sleep, so each core's ring also carries SYNC records pairing its
+ * CCOUNT with esp_timer time; readers interpolate between consecutive
+ * SYNCs. A SYNC holds microseconds 0..23 in (id, arg); bits 24..31 come
+ * from syncUs of the frame it arrived in. `lost` counts records of that
+ * core overwritten before they could be sent.
+ *
+ * Pure C++ (shared with the host tool in tools/).
+ */
+
+enum TraceType {
+  TRACE_TYPE_BEGIN = 1,
+  TRACE_TYPE_END = 2,
+  TRACE_TYPE_INSTANT = 3,
+  TRACE_TYPE_SYNC = 4
+};
+
+// What a record describes; arg is per id
+enum TraceId {
+  TRACE_ID_TASK = 1,     // Span: executor pass or bus job; arg = registered track
+  TRACE_ID_MUTEX = 2,    // Span: blocked on a mutex; arg = TraceMutex, END arg bit 15 = timed out
+  TRACE_ID_INPUT = 3,    // Instant: input event queued; arg = event | source << 8
+  TRACE_ID_BUTTON = 4,   // Instant: button edge interrupt; arg = GPIO
+  TRACE_ID_RENDER = 5,   // Span: view render job; arg = registered track
+  TRACE_ID_I2C = 6       // Span: I2C transfer; arg = bytes
+};
+
+// Mutexes whose contended waits are traced
+enum TraceMutex {
+  TRACE_MUTEX_MODEL_STATE,
+  TRACE_MUTEX_MODEL_TIME,
+  TRACE_MUTEX_MODEL_SENSOR,
+  TRACE_MUTEX_MODEL_SCHEDULER,
+  TRACE_MUTEX_MODEL_DISPLAY,
+  TRACE_MUTEX_SYNC_DISPLAY,
+  TRACE_MUTEX_SYNC_STATE,
+  TRACE_MUTEX_SYNC_SERIAL,
+  TRACE_MUTEX_COUNT
+};
+
+static const uint16_t TRACE_MUTEX_TIMED_OUT = 0x8000;
+
+inline const char* traceMutexName(uint16_t mutex) {
+  static const char* const names[TRACE_MUTEX_COUNT] = {
+    "Model state", "Model time", "Model sensor", "Model scheduler", "Model display",
+    "Sync display", "Sync state", "Sync serial"
+  };
+  return mutex < TRACE_MUTEX_COUNT ? names[mutex] : "mutex";
+}
+
+struct TraceRecord {
+  uint32_t cycles;
+  uint8_t type;
+  uint8_t id;
+  uint16_t arg;
+};
+
+static const size_t TRACE_RECORD_SIZE = 8;
+static const size_t TRACE_FRAME_HEADER = 8;
+static const size_t TRACE_NAME_MAX = 23;
+
+inline void tracePackRecord(const TraceRecord& record, uint8_t* out) {
+  out[0] = static_cast<uint8_t>(record.cycles);
+  out[1] = static_cast<uint8_t>(record.cycles >> 8);
+  out[2] = static_cast<uint8_t>(record.cycles >> 16);
+  out[3] = static_cast<uint8_t>(record.cycles >> 24);
+  out[4] = record.type;
+  out[5] = record.id;
+  out[6] = static_cast<uint8_t>(record.arg);
+  out[7] = static_cast<uint8_t>(record.arg >> 8);
+}
+
+inline void traceUnpackRecord(const uint8_t* in, TraceRecord& record) {
+  record.cycles = in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+  record.type = in[4];
+  record.id = in[5];
+  record.arg = static_cast<uint16_t>(in[6] | (in[7] << 8));
+}
+
+#endif // TRACE_FORMAT_H
@@ -0,0 +1,38 @@
+#include "TunableNvs.h"
+
+/**
+ * @brief Reads a saved value
+ * @return false if the namespace or key does not exist
+ */
+bool NvsTunableStorage::load(const char* name, int32_t& value) {
+  if (!m_prefs.begin(NAMESPACE, true)) return false;
+
+  bool found = m_prefs.isKey(name);
+  if (found) {
+    value = m_prefs.getInt(name);
+  }
+  m_prefs.end();
+  return found;
+}
+
+bool NvsTunableStorage::store(const char* name, int32_t value) {
+  if (!m_prefs.begin(NAMESPACE, false)) {
+    Serial.println("Failed to open tunables namespace");
+    return false;
+  }
+
+  bool ok = m_prefs.putInt(name, value) == sizeof(int32_t);
+  m_prefs.end();
+  return ok;
+}
+
+bool NvsTunableStorage::erase() {
+  if (!m_prefs.begin(NAMESPACE, false)) {
+    Serial.println("Failed to open tunables namespace");
+    return false;
+  }
+
+  bool ok = m_prefs.clear();
+  m_prefs.end();
+  return ok;
+}
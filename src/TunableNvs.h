@@ -0,0 +1,25 @@
+#ifndef TUNABLE_NVS_H
+#define TUNABLE_NVS_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "Tunables.h"
+
+/**
+ * Saved tunables in NVS, one int32 key per tunable name in their own
+ * namespace. Each call opens and closes the namespace, so nothing is held
+ * between the rare save() calls.
+ */
+class NvsTunableStorage : public TunableStorage {
+public:
+  static constexpr const char* NAMESPACE = "tunables";
+
+  bool load(const char* name, int32_t& value) override;
+  bool store(const char* name, int32_t value) override;
+  bool erase() override;
+
+private:
+  Preferences m_prefs;
+};
+
+#endif // TUNABLE_NVS_H
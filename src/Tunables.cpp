@@ -0,0 +1,127 @@
+#include "Tunables.h"
+#include <string.h>
+#include "TaskConfig.h"
+
+// Indexed by TunableId. Priorities stay below the IDF system tasks (esp_timer runs at 22).
+static const TunableDef s_defs[TUNE_COUNT] = {
+  { "debounce_ms",  TUNABLE_MS,       5,  500,  INPUT_DEBOUNCE_MS },
+  { "poll_ms",      TUNABLE_MS,       1,  100,  INPUT_POLL_MS },
+  { "oled_ms",      TUNABLE_MS,       20, 5000, VIEW_OLED_INTERVAL_MS },
+  { "lcd_ms",       TUNABLE_MS,       20, 5000, VIEW_LCD_INTERVAL_MS },
+  { "ui_priority",  TUNABLE_PRIORITY, 1,  20,   TASK_UI_PRIORITY },
+  { "i2c_priority", TUNABLE_PRIORITY, 1,  20,   TASK_I2C_PRIORITY }
+};
+
+// Initialize static instance pointer to nullptr
+Tunables* Tunables::m_instance = nullptr;
+
+Tunables::Tunables() : m_storage(nullptr), m_watcherCount(0) {
+  for (uint8_t i = 0; i < TUNE_COUNT; i++) {
+    m_values[i] = s_defs[i].def;
+  }
+}
+
+Tunables* Tunables::getInstance() {
+  if (m_instance == nullptr) {
+    m_instance = new Tunables();
+  }
+  return m_instance;
+}
+
+/**
+ * @brief Attaches storage and applies the values saved in it
+ * Saved values outside the current bounds are ignored.
+ * @param storage Where save() writes, or nullptr to keep every change volatile
+ */
+void Tunables::begin(TunableStorage* storage) {
+  m_storage = storage;
+  if (m_storage == nullptr) return;
+
+  for (uint8_t i = 0; i < TUNE_COUNT; i++) {
+    int32_t value;
+    if (m_storage->load(s_defs[i].name, value) && value >= s_defs[i].min && value <= s_defs[i].max) {
+      m_values[i] = value;
+    }
+  }
+}
+
+const TunableDef& Tunables::getDef(uint8_t id) {
+  return s_defs[id < TUNE_COUNT ? id : 0];
+}
+
+/**
+ * @brief Applies a new value and calls the tunable's watchers
+ * @param id TunableId
+ * @param value New value, within the tunable's bounds
+ * @return false if the id is unknown or the value out of bounds
+ */
+bool Tunables::set(uint8_t id, int32_t value) {
+  if (id >= TUNE_COUNT || value < s_defs[id].min || value > s_defs[id].max) {
+    return false;
+  }
+  if (m_values[id] != value) {
+    m_values[id] = value;
+    notify(id);
+  }
+  return true;
+}
+
+/**
+ * @brief Registers a change callback and calls it with the current value
+ * @param id TunableId
+ * @param callback Applies a value to the owning component
+ * @param context Passed to callback
+ * @return false if the id is unknown or the watcher table is full
+ */
+bool Tunables::watch(uint8_t id, TunableCallback callback, void* context) {
+  if (id >= TUNE_COUNT || callback == nullptr || m_watcherCount >= MAX_WATCHERS) {
+    return false;
+  }
+  Watcher& watcher = m_watchers[m_watcherCount++];
+  watcher.id = id;
+  watcher.callback = callback;
+  watcher.context = context;
+  callback(context, m_values[id]);
+  return true;
+}
+
+/**
+ * @brief Writes every current value to storage
+ * @return false without storage or if a write failed
+ */
+bool Tunables::save() {
+  if (m_storage == nullptr) return false;
+
+  bool ok = true;
+  for (uint8_t i = 0; i < TUNE_COUNT; i++) {
+    ok = m_storage->store(s_defs[i].name, m_values[i]) && ok;
+  }
+  return ok;
+}
+
+/**
+ * @brief Clears the saved values and returns every tunable to its default
+ * @return false if the storage could not be cleared (defaults are restored anyway)
+ */
+bool Tunables::erase() {
+  bool ok = m_storage == nullptr || m_storage->erase();
+  for (uint8_t i = 0; i < TUNE_COUNT; i++) {
+    set(i, s_defs[i].def);
+  }
+  return ok;
+}
+
+uint8_t Tunables::find(const char* name) {
+  for (uint8_t i = 0; i < TUNE_COUNT; i++) {
+    if (strcmp(s_defs[i].name, name) == 0) return i;
+  }
+  return TUNE_COUNT;
+}
+
+void Tunables::notify(uint8_t id) {
+  for (uint8_t i = 0; i < m_watcherCount; i++) {
+    if (m_watchers[i].id == id) {
+      m_watchers[i].callback(m_watchers[i].context, m_values[id]);
+    }
+  }
+}
@@ -0,0 +1,107 @@
+#ifndef TUNABLES_H
+#define TUNABLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Runtime tunables: typed, bounded parameters that used to be compile-time
+ * constants, so a running unit can be tuned (and swept) without a reflash.
+ *
+ * Each tunable has a fixed id, a name, bounds and a default (from
+ * TaskConfig.h). Owning components watch() the ones they use: the callback
+ * runs once at registration with the current value and again on every
+ * change, and applies it live. Values come from the host over TaskLink
+ * (TUNE_* frames) and are only persisted on an explicit save().
+ *
+ * Register watchers during setup(); set() is meant for a single task (the
+ * UI executor, where TaskLink runs), and callbacks run in that task.
+ *
+ * Pure C++ (shared with the host tool in tools/); storage is injected.
+ */
+
+enum TunableId {
+  TUNE_DEBOUNCE_MS,       // Controller: button debounce
+  TUNE_POLL_MS,           // Controller: scan period while input is active
+  TUNE_OLED_INTERVAL_MS,  // OLED view: minimum time between frames
+  TUNE_LCD_INTERVAL_MS,   // LCD view: minimum time between frames
+  TUNE_UI_PRIORITY,       // UI executor task priority
+  TUNE_I2C_PRIORITY,      // Bus worker task priority
+  TUNE_COUNT
+};
+
+// How a value is shown and what it means; all values are int32 on the wire
+enum TunableType {
+  TUNABLE_INT,
+  TUNABLE_BOOL,
+  TUNABLE_MS,
+  TUNABLE_PRIORITY
+};
+
+struct TunableDef {
+  const char* name;       // At most TUNABLE_NAME_MAX characters (NVS key limit)
+  uint8_t type;
+  int32_t min;
+  int32_t max;
+  int32_t def;
+};
+
+static const size_t TUNABLE_NAME_MAX = 15;
+
+// Persistent storage for saved values (NVS on the target)
+class TunableStorage {
+public:
+  virtual ~TunableStorage() {}
+
+  virtual bool load(const char* name, int32_t& value) = 0;
+  virtual bool store(const char* name, int32_t value) = 0;
+  virtual bool erase() = 0;
+};
+
+typedef void (*TunableCallback)(void* context, int32_t value);
+
+class Tunables {
+public:
+  static const uint8_t MAX_WATCHERS = 8;
+
+  static Tunables* getInstance();
+
+  // Loads saved values (storage may be nullptr: defaults only, nothing persists)
+  void begin(TunableStorage* storage);
+
+  static const TunableDef& getDef(uint8_t id);
+  int32_t get(uint8_t id) const { return id < TUNE_COUNT ? m_values[id] : 0; }
+
+  // Applies a value and notifies its watchers; false if the id or value is out of range
+  bool set(uint8_t id, int32_t value);
+
+  // Calls callback with the current value now and after every change
+  bool watch(uint8_t id, TunableCallback callback, void* context);
+
+  // Persists every value; erase() forgets them and restores the defaults
+  bool save();
+  bool erase();
+
+  // Id of a tunable by name, TUNE_COUNT if unknown
+  static uint8_t find(const char* name);
+
+private:
+  struct Watcher {
+    uint8_t id;
+    TunableCallback callback;
+    void* context;
+  };
+
+  static Tunables* m_instance;
+
+  TunableStorage* m_storage;
+  volatile int32_t m_values[TUNE_COUNT];
+  Watcher m_watchers[MAX_WATCHERS];
+  uint8_t m_watcherCount;
+
+  Tunables();
+
+  void notify(uint8_t id);
+};
+
+#endif // TUNABLES_H
@@ -0,0 +1,70 @@
+#include "UiSnapshot.h"
+#include <string.h>
+#include "Crc16.h"
+
+// Format header
+static const uint8_t SNAPSHOT_MAGIC_0 = 'U';
+static const uint8_t SNAPSHOT_MAGIC_1 = 'I';
+static const uint8_t SNAPSHOT_VERSION = 1;
+static const uint8_t SNAPSHOT_PAYLOAD_SIZE = UI_SNAPSHOT_ENCODED_SIZE - 6;
+
+/**
+ * @brief Serializes a snapshot in a fixed little-endian layout
+ * @param snapshot Snapshot to encode
+ * @param buffer Output buffer
+ * @param capacity Size of the output buffer
+ * @return Number of bytes written, or 0 if the buffer is too small
+ */
+size_t encodeUiSnapshot(const UiSnapshot& snapshot, uint8_t* buffer, size_t capacity) {
+  if (buffer == nullptr || capacity < UI_SNAPSHOT_ENCODED_SIZE) return 0;
+
+  size_t pos = 0;
+  buffer[pos++] = SNAPSHOT_MAGIC_0;
+  buffer[pos++] = SNAPSHOT_MAGIC_1;
+  buffer[pos++] = SNAPSHOT_VERSION;
+  buffer[pos++] = SNAPSHOT_PAYLOAD_SIZE;
+
+  buffer[pos++] = snapshot.state;
+  buffer[pos++] = snapshot.menuIndex;
+  for (int shift = 0; shift < 32; shift += 8) {
+    buffer[pos++] = static_cast<uint8_t>(snapshot.unixTime >> shift);
+  }
+
+  memcpy(&buffer[pos], snapshot.lcdFrame, sizeof(snapshot.lcdFrame));
+  pos += sizeof(snapshot.lcdFrame);
+
+  uint16_t crc = crc16Ccitt(buffer, pos);
+  buffer[pos++] = static_cast<uint8_t>(crc);
+  buffer[pos++] = static_cast<uint8_t>(crc >> 8);
+  return pos;
+}
+
+/**
+ * @brief Parses an encoded snapshot
+ * @param buffer Encoded bytes
+ * @param length Number of encoded bytes
+ * @param snapshot Receives the decoded snapshot (untouched on failure)
+ * @return true if the header and CRC are valid
+ */
+bool decodeUiSnapshot(const uint8_t* buffer, size_t length, UiSnapshot& snapshot) {
+  if (buffer == nullptr || length < UI_SNAPSHOT_ENCODED_SIZE) return false;
+
+  if (buffer[0] != SNAPSHOT_MAGIC_0 || buffer[1] != SNAPSHOT_MAGIC_1 ||
+      buffer[2] != SNAPSHOT_VERSION || buffer[3] != SNAPSHOT_PAYLOAD_SIZE) {
+    return false;
+  }
+
+  const size_t crcPos = UI_SNAPSHOT_ENCODED_SIZE - 2;
+  uint16_t stored = buffer[crcPos] | (buffer[crcPos + 1] << 8);
+  if (crc16Ccitt(buffer, crcPos) != stored) return false;
+
+  size_t pos = 4;
+  snapshot.state = buffer[pos++];
+  snapshot.menuIndex = buffer[pos++];
+  snapshot.unixTime = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    snapshot.unixTime |= static_cast<uint32_t>(buffer[pos++]) << shift;
+  }
+  memcpy(snapshot.lcdFrame, &buffer[pos], sizeof(snapshot.lcdFrame));
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef UI_SNAPSHOT_H
+#define UI_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DisplayLayout.h"
+
+// LCD text frame captured with the snapshot (the fitted panel)
+#define UI_SNAPSHOT_LCD_COLS LCD_PANEL_COLS
+#define UI_SNAPSHOT_LCD_ROWS LCD_PANEL_ROWS
+
+// Encoded size: header (4) + model (6) + frame (COLS x ROWS) + CRC (2)
+#define UI_SNAPSHOT_ENCODED_SIZE (12 + UI_SNAPSHOT_LCD_COLS * UI_SNAPSHOT_LCD_ROWS)
+
+/**
+ * UI state kept across deep sleep: the Model fields the views render from
+ * and the text last written to the LCD. Plain data so it can be encoded and
+ * verified on the host.
+ */
+struct UiSnapshot {
+  uint8_t state;                 // SystemState
+  uint8_t menuIndex;
+  uint32_t unixTime;             // Model time when the snapshot was taken
+  char lcdFrame[UI_SNAPSHOT_LCD_ROWS][UI_SNAPSHOT_LCD_COLS];
+};
+
+// Serializes a snapshot; returns bytes written, or 0 if capacity is too small
+size_t encodeUiSnapshot(const UiSnapshot& snapshot, uint8_t* buffer, size_t capacity);
+
+// Parses and verifies (magic, version, length, CRC) an encoded snapshot
+bool decodeUiSnapshot(const uint8_t* buffer, size_t length, UiSnapshot& snapshot);
+
+#endif // UI_SNAPSHOT_H
@@ -1,22 +1,36 @@
 #include "View.h"
+#include "BootSequencer.h"
+#include "PowerManager.h"
+#include "Trace.h"
 
-View::View(const char* taskName, uint32_t updateInterval)
-  : m_model(nullptr), m_taskHandle(nullptr), m_running(false),
-    m_taskName(taskName), m_updateInterval(updateInterval) {
+View::View(const char* taskName, uint32_t updateInterval, BusJobFunction renderJob)
+  : m_model(nullptr), m_bus(nullptr), m_running(false),
+    m_taskName(taskName), m_updateInterval(updateInterval), m_warmStart(false),
+    m_renderJob(renderJob), m_renderOk(false), m_lastState(STATE_MENU), m_renderState(STATE_MENU),
+    m_renderStateChanged(false), m_forceUpdate(true), m_firstFrame(true),
+    m_graphSequence(0), m_frameCount(0), m_traceTrack(0) {
   m_model = Model::getInstance();
 }
 
-View::~View() {
-  stop();
-}
-
-bool View::initialize() {
+/**
+ * @brief Checks that the model exists before a view initializes its display
+ * @return true if the model is available
+ */
+bool View::checkModel() {
   if (m_model == nullptr) {
     Serial.println("Model not available for view");
     return false;
   }
-  
-  if (!initializeDisplay()) {
+  return true;
+}
+
+/**
+ * @brief Logs the outcome of display initialization
+ * @param ok Whether the display initialized
+ * @return ok
+ */
+bool View::reportInitialized(bool ok) {
+  if (!ok) {
     Serial.print("Failed to initialize display for ");
     Serial.println(m_taskName);
     return false;
@@ -27,89 +41,97 @@ bool View::initialize() {
   return true;
 }
 
-bool View::start() {
-  if (m_taskHandle != nullptr) {
+bool View::start(ExecutorTask& executor, BusWorker& bus) {
+  if (m_running) {
     Serial.print(m_taskName);
-    Serial.println(" task already running");
+    Serial.println(" already running");
     return false;
   }
   
   m_running = true;
+  m_bus = &bus;
+  m_traceTrack = TRACE_REGISTER_TRACK(TRACE_ID_RENDER, m_taskName);
+  executor.spawn(*this);
   
-  BaseType_t result = xTaskCreate(
-    taskWrapper,
-    m_taskName,
-    2048,
-    this,
-    1, // Lower priority than controller
-    &m_taskHandle
-  );
-  
-  return result == pdPASS;
-}
-
-void View::stop() {
-  m_running = false;
-  
-  if (m_taskHandle != nullptr) {
-    vTaskDelete(m_taskHandle);
-    m_taskHandle = nullptr;
-  }
-  
-  cleanup();
-}
-
-void View::taskWrapper(void* pvParameters) {
-  View* view = static_cast<View*>(pvParameters);
-  view->displayTask();
+  // Wake on model changes instead of polling at the update interval
+  m_model->addChangeListener(&m_changed);
+  return true;
 }
 
-void View::displayTask() {
+/**
+ * @brief Display loop coroutine
+ * Rendering runs on the bus worker so I2C transfers never stall the executor
+ */
+void View::step() {
+  CO_BEGIN();
   Serial.print(m_taskName);
-  Serial.println(" task started");
-  
-  SystemState lastState = STATE_MENU;
-  bool forceUpdate = true;
+  Serial.println(" started");
   
   while (m_running) {
-    SystemState currentState = m_model->getCurrentState();
-    bool stateChanged = m_model->hasStateChanged();
+    m_renderState = m_model->getCurrentState();
+    m_renderStateChanged = m_model->hasStateChanged();
     
-    // Update display if state changed or forced
-    if (stateChanged || forceUpdate || currentState != lastState) {
-      if (m_model->acquireDisplayMutex(pdMS_TO_TICKS(100))) {
-        renderDisplay();
-        m_model->releaseDisplayMutex();
+    // Update display if state changed, forced, or the graph has new samples
+    if (m_renderStateChanged || m_forceUpdate || m_renderState != m_lastState ||
+        graphHasNewSamples()) {
+      m_renderDone.reset();
+      if (m_bus->submit(m_renderJob, this, &m_renderDone, &m_renderOk)) {
+        CO_AWAIT(m_renderDone.poll(this));
         
-        if (stateChanged) {
-          m_model->clearStateChanged();
+        if (m_renderOk) {
+          m_frameCount++;
+          if (m_firstFrame) {
+            BootTimeline::getInstance()->markFirstFrame(m_taskName);
+            m_firstFrame = false;
+          }
+          
+          if (m_renderStateChanged) {
+            m_model->clearStateChanged();
+          }
+          
+          m_lastState = m_renderState;
+          m_forceUpdate = false;
         }
-        
-        lastState = currentState;
-        forceUpdate = false;
       }
     }
     
-    vTaskDelay(pdMS_TO_TICKS(m_updateInterval));
+    // Rate-limit renders while active; when idle, sleep until the model changes
+    CO_DELAY(m_updateInterval);
+    if (!PowerManager::getInstance()->isBoosted()) {
+      CO_AWAIT_TIMEOUT(m_changed.poll(this), IDLE_REFRESH_MS);
+    }
   }
+  
+  CO_END();
 }
 
-void View::renderMenuState() {
-  // Default implementation - to be overridden
-  Serial.println("Default menu render");
+/**
+ * @brief Checks for sensor readings the graph screen has not drawn
+ * @return true if the graph is shown and its channel has newer readings
+ */
+bool View::graphHasNewSamples() {
+  return m_renderState == STATE_GRAPH &&
+         m_model->getSensorSequence(m_model->getGraphChannel()) != m_graphSequence;
 }
 
-void View::renderSettingsState() {
-  // Default implementation - to be overridden
-  Serial.println("Default settings render");
+/**
+ * @brief Starts a render job: takes the display mutex and enters render power mode
+ * @return false if the display mutex was not available
+ */
+bool View::beginRenderJob() {
+  if (!m_model->acquireDisplayMutex(pdMS_TO_TICKS(100))) {
+    return false;
+  }
+  PowerManager::getInstance()->beginRender();
+  TRACE_BEGIN(TRACE_ID_RENDER, m_traceTrack);
+  return true;
 }
 
-void View::renderAboutState() {
-  // Default implementation - to be overridden
-  Serial.println("Default about render");
+/**
+ * @brief Ends a render job started by beginRenderJob()
+ */
+void View::endRenderJob() {
+  TRACE_END(TRACE_ID_RENDER, m_traceTrack);
+  PowerManager::getInstance()->endRender();
+  m_model->releaseDisplayMutex();
 }
-
-void View::renderConfirmExitState() {
-  // Default implementation - to be overridden
-  Serial.println("Default confirm exit render");
-}
\ No newline at end of file
@@ -3,42 +3,139 @@
 
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 #include "Model.h"
+#include "Coroutine.h"
+#include "ExecutorTask.h"
+#include "BusWorker.h"
+#include "DisplayLayout.h"
 
-class View {
+/**
+ * Display loop shared by all views: waits for model changes and submits a
+ * render job to the bus worker. Per-view behaviour comes from ViewBase below,
+ * so nothing here is virtual beyond the Coroutine step.
+ */
+class View : public Coroutine {
 protected:
   Model* m_model;
-  TaskHandle_t m_taskHandle;
+  BusWorker* m_bus;
   bool m_running;
   const char* m_taskName;
   uint32_t m_updateInterval; // in milliseconds
+  bool m_warmStart;          // Resuming from deep sleep; panel kept its config
+  BusJobFunction m_renderJob;
   
-  // Static task wrapper - must be implemented by derived classes
-  static void taskWrapper(void* pvParameters);
+  // Safety refresh while idle; changes arrive through m_changed
+  static const uint32_t IDLE_REFRESH_MS = 5000;
   
-  // Virtual methods to be implemented by derived classes
-  virtual bool initializeDisplay() = 0;
-  virtual void renderDisplay() = 0;
-  virtual void cleanup() {}
+  // Coroutine state (locals do not survive suspension points)
+  CoSignal m_changed;
+  CoSignal m_renderDone;
+  volatile bool m_renderOk;
+  SystemState m_lastState;
+  SystemState m_renderState;
+  bool m_renderStateChanged;
+  bool m_forceUpdate;
+  bool m_firstFrame;
   
-  // Task loop
-  virtual void displayTask();
+  // Newest sensor reading the graph screen has drawn (written by the render job)
+  volatile uint32_t m_graphSequence;
+  
+  // Frames rendered since start()
+  volatile uint32_t m_frameCount;
+  
+  // Trace track of this view's render jobs (TRACE_ENABLE builds)
+  uint16_t m_traceTrack;
+  
+  View(const char* taskName, uint32_t updateInterval, BusJobFunction renderJob);
+  
+  // Whether the graph screen is up and has readings it has not drawn yet
+  bool graphHasNewSamples();
+  
+  // Shared halves of initialize() and the render job
+  bool checkModel();
+  bool reportInitialized(bool ok);
+  bool beginRenderJob();
+  void endRenderJob();
+  
+  // Display loop, run as a coroutine on the UI executor
+  void step() override;
 
 public:
-  View(const char* taskName, uint32_t updateInterval = 250);
-  virtual ~View();
-  
-  // Common interface
-  virtual bool initialize();
-  virtual bool start();
-  virtual void stop();
-  
-  // Display state management
-  virtual void renderMenuState();
-  virtual void renderSettingsState();
-  virtual void renderAboutState();
-  virtual void renderConfirmExitState();
+  bool start(ExecutorTask& executor, BusWorker& bus);
+  
+  // Resume path after deep sleep (set before initialize())
+  void setWarmStart(bool warmStart) { m_warmStart = warmStart; }
+  
+  // Minimum time between frames; applies from the next frame
+  void setUpdateInterval(uint32_t updateInterval) { m_updateInterval = updateInterval; }
+  
+  uint32_t getFrameCount() const { return m_frameCount; }
+};
+
+/**
+ * Static polymorphism over View (CRTP). Derived provides, non-virtual:
+ *
+ *   bool initializeDisplay();
+ *   void cleanup();
+ *   bool beginFrame(SystemState state);   // false skips the frame
+ *   void renderMenuState(); renderSettingsState(); renderAboutState();
+ *   void renderConfirmExitState(); renderGraphState();
+ *
+ * The state switch is instantiated per view, so each render call is direct
+ * and can be inlined. Geometry is the PanelGeometry the view draws on.
+ */
+template <typename Derived, typename Geometry>
+class ViewBase : public View {
+public:
+  typedef Geometry Panel;
+  
+  bool initialize() {
+    if (!checkModel()) return false;
+    return reportInitialized(derived().initializeDisplay());
+  }
+  
+  void stop() {
+    m_running = false;
+    derived().cleanup();
+  }
+
+protected:
+  ViewBase(const char* taskName, uint32_t updateInterval)
+    : View(taskName, updateInterval, &ViewBase::renderJob) {}
+  
+  Derived& derived() { return *static_cast<Derived*>(this); }
+  
+  // Bus worker job: draws and flushes one frame under the display mutex
+  static bool renderJob(void* context) {
+    ViewBase* view = static_cast<ViewBase*>(static_cast<View*>(context));
+    if (!view->beginRenderJob()) return false;
+    view->render();
+    view->endRenderJob();
+    return true;
+  }
+  
+  void render() {
+    SystemState state = m_model->getCurrentState();
+    if (!derived().beginFrame(state)) return;
+    
+    switch (state) {
+      case STATE_MENU:
+        derived().renderMenuState();
+        break;
+      case STATE_SETTINGS:
+        derived().renderSettingsState();
+        break;
+      case STATE_ABOUT:
+        derived().renderAboutState();
+        break;
+      case STATE_CONFIRM_EXIT:
+        derived().renderConfirmExitState();
+        break;
+      case STATE_GRAPH:
+        derived().renderGraphState();
+        break;
+    }
+  }
 };
 
 #endif // VIEW_H
\ No newline at end of file
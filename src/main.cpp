@@ -7,6 +7,34 @@
 #include "OLEDView.h"
 #include "LCDView.h"
 #include "Synchronization.h"
+#include "BootSequencer.h"
+#include "SleepManager.h"
+#include "PowerManager.h"
+#include "ExecutorTask.h"
+#include "BusWorker.h"
+#include "TaskConfig.h"
+#include "StackMonitor.h"
+#include "SensorPipeline.h"
+#include "TaskLink.h"
+#include "FlightRecorder.h"
+#include "Tunables.h"
+#include "TunableNvs.h"
+#ifdef SENSOR_SYNTHETIC
+#include "SyntheticSource.h"
+#else
+#include "AdcDmaSource.h"
+#endif
+#ifdef LOAD_TEST
+#include "LoadGenerator.h"
+#endif
+#ifdef TRACE_ENABLE
+#include "Trace.h"
+#endif
+
+// Components live in static storage; nothing is allocated per event or frame
+static Controller s_controller;
+static OLEDView s_oledView;
+static LCDView s_lcdView;
 
 // Global system components
 Model* g_model = nullptr;
@@ -15,8 +43,69 @@ OLEDView* g_oledView = nullptr;
 LCDView* g_lcdView = nullptr;
 Synchronization* g_sync = nullptr;
 
- // Real-Time Clock instance
-RTC_DS1307 rtc;
+// Boot orchestration (outlives its stage tasks)
+BootSequencer g_boot;
+
+// Runtime tasks: every UI activity is a coroutine on one executor; blocking
+// I2C work (renders, RTC reads) runs on the bus worker
+ExecutorTask g_uiExecutor(TASK_UI_NAME, TASK_UI_STACK, TASK_UI_PRIORITY);
+BusWorker g_busWorker(TASK_I2C_NAME, TASK_I2C_STACK, TASK_I2C_PRIORITY);
+
+// Saved tunables (written only by an explicit TUNE_SAVE from the host)
+static NvsTunableStorage s_tunableStorage;
+
+// Sensors: ADC1_CH6 (GPIO34) and ADC1_CH7 (GPIO35), input-only pins with no pull-ups
+static const uint8_t SENSOR_CHANNELS[] = { 6, 7 };
+#ifdef SENSOR_SYNTHETIC
+static SyntheticSource s_sensorSource([]() -> uint32_t { return micros(); });
+#else
+static AdcDmaSource s_sensorSource;
+#endif
+SensorPipeline g_sensors;
+
+// Task import/export over the console UART
+TaskLink g_taskLink;
+
+#ifdef TRACE_ENABLE
+// Event trace stream on the same UART (tools/tracedump.cpp)
+TraceExporter g_traceExporter;
+#endif
+
+#ifdef LOAD_TEST
+// Load test: synthetic input from its own task, reported on the console when done.
+// Profile from build flags, e.g. -DLOAD_TEST -DLOAD_TEST_PATTERN=LOAD_BURST
+#ifndef LOAD_TEST_PATTERN
+#define LOAD_TEST_PATTERN LOAD_SUSTAINED
+#endif
+#ifndef LOAD_TEST_RATE_HZ
+#define LOAD_TEST_RATE_HZ 200
+#endif
+#ifndef LOAD_TEST_BURST_SIZE
+#define LOAD_TEST_BURST_SIZE 32
+#endif
+#ifndef LOAD_TEST_BURST_PERIOD_MS
+#define LOAD_TEST_BURST_PERIOD_MS 500
+#endif
+#ifndef LOAD_TEST_DURATION_MS
+#define LOAD_TEST_DURATION_MS 20000
+#endif
+#ifndef LOAD_TEST_SEED
+#define LOAD_TEST_SEED 1
+#endif
+
+ExecutorTask g_loadExecutor(TASK_LOAD_NAME, TASK_LOAD_STACK, TASK_LOAD_PRIORITY);
+static LoadGenerator s_loadGenerator([]() -> uint32_t { return micros(); });
+static uint32_t s_loadFramesAtStart = 0;
+static bool s_loadReported = false;
+
+void startLoadTest();
+void reportLoadTest();
+#endif
+
+// Sleep/resume
+SleepManager* g_sleep = nullptr;
+UiSnapshot g_resumeSnapshot;
+bool g_resumed = false;
 
 // System status
 bool g_systemInitialized = false;
@@ -26,28 +115,110 @@ bool initializeHardware();
 bool initializeComponents();
 bool startTasks();
 void cleanup();
-void systemStatusTask(void* pvParameters);
+void enterSleep();
+
+/**
+ * Refreshes the Model clock from the RTC once a second.
+ */
+class RtcUpdateCoroutine : public Coroutine {
+private:
+  CoSignal m_done;
+  CoTime m_nextUpdate;
+  
+  static bool readRtc(void*) {
+    Model::getInstance()->updateTime();
+    return true;
+  }
+  
+protected:
+  void step() override {
+    CO_BEGIN();
+    m_nextUpdate = coNow();
+    while (true) {
+      m_done.reset();
+      if (g_busWorker.submit(readRtc, nullptr, &m_done)) {
+        CO_AWAIT(m_done.poll(this));
+      }
+      m_nextUpdate += 1000; // update every second
+      CO_DELAY_UNTIL(m_nextUpdate);
+    }
+    CO_END();
+  }
+};
+
+/**
+ * Periodic health checks (formerly the SystemStatus task).
+ */
+class SystemStatusCoroutine : public Coroutine {
+private:
+  CoTime m_nextCheck;
+  CoTime m_nextStackReport;
+  
+protected:
+  void step() override;
+};
+
+/**
+ * Records the published sensor readings into the Model history once per period.
+ */
+class SensorHistoryCoroutine : public Coroutine {
+private:
+  CoTime m_nextRecord;
+  
+protected:
+  void step() override {
+    CO_BEGIN();
+    m_nextRecord = coNow();
+    while (true) {
+      m_nextRecord += Model::SENSOR_HISTORY_PERIOD_S * 1000;
+      CO_DELAY_UNTIL(m_nextRecord);
+      g_model->recordSensorHistory();
+    }
+    CO_END();
+  }
+};
+
+RtcUpdateCoroutine g_rtcUpdate;
+SensorHistoryCoroutine g_sensorHistory;
+SystemStatusCoroutine g_systemStatus;
 
 void setup() {
+  // TaskLink frames need more buffering than the console defaults
+  Serial.setRxBufferSize(TaskLink::RX_BUFFER_SIZE);
+  Serial.setTxBufferSize(TaskLink::TX_BUFFER_SIZE);
   Serial.begin(115200);
+  BootTimeline::getInstance()->begin();
   Serial.println("=== ESP32 Menu System Starting ===");
   
-  // Initialize hardware
-  if (!initializeHardware()) {
-    Serial.println("Hardware initialization failed!");
-    return;
+  // Events of the previous boot survive in RTC memory; print them before logging this one
+  FlightRecorder::getInstance()->begin(Serial);
+  
+  // Saved tunables replace the TaskConfig.h defaults before anything reads them
+  Tunables::getInstance()->begin(&s_tunableStorage);
+  
+  // A wake from deep sleep resumes the saved UI instead of a cold start
+  g_sleep = SleepManager::getInstance();
+  g_sleep->initialize(SLEEP_MODE_DEEP);
+  g_resumed = g_sleep->consumeSnapshot(g_resumeSnapshot);
+  if (g_resumed) {
+    Serial.println("Resuming from deep sleep");
   }
   
-  // MVC component initialization
+  // Hardware and MVC component initialization
   if (!initializeComponents()) {
     Serial.println("Component initialization failed!");
+    FlightRecorder::record(FLIGHT_FATAL, FLIGHT_FATAL_INIT);
     cleanup();
     return;
   }
   
+  // Boot report is printed once every view has rendered
+  BootTimeline::getInstance()->expectFrames(2);
+  
   // FreeRTOS task creation
   if (!startTasks()) {
     Serial.println("Task startup failed!");
+    FlightRecorder::record(FLIGHT_FATAL, FLIGHT_FATAL_TASKS);
     cleanup();
     return;
   }
@@ -58,15 +229,17 @@ void setup() {
     Serial.println("=== System Ready ===");
   } else {
     Serial.println("System startup timeout!");
+    FlightRecorder::record(FLIGHT_FATAL, FLIGHT_FATAL_READY_TIMEOUT);
     cleanup();
   }
 
-  if (!rtc.begin()) {
+  // The Model probed the RTC during boot; don't probe it a second time
+  if (!g_model->isRTCAvailable()) {
     Serial.println("Couldn't find RTC");
+    FlightRecorder::record(FLIGHT_FATAL, FLIGHT_FATAL_NO_RTC);
     Serial.flush();
     abort();
-}
-
+  }
 }
 
 void loop() {
@@ -75,14 +248,60 @@ void loop() {
   if (g_systemInitialized) {
     // System running normally
     vTaskDelay(pdMS_TO_TICKS(1000));
+    FlightRecorder::getInstance()->sampleHeap();
     
     // Optional: Print system status periodically
     static unsigned long lastStatus = 0;
     if (millis() - lastStatus > 30000) { // Every 30 seconds
       g_sync->safePrintf("System uptime: %lu ms, Free heap: %d bytes\n", 
                          millis(), ESP.getFreeHeap());
+      g_sync->safePrintf("Input events: pool high-water %u/%u, %lu dropped\n",
+                         (unsigned)g_controller->getEventHighWater(),
+                         (unsigned)g_controller->getEventPoolSize(),
+                         (unsigned long)g_controller->getEventsDropped());
+      
+      PowerMetrics power = PowerManager::getInstance()->getMetrics();
+      g_sync->safePrintf("Power: %lu interactions, wake latency %lu/%lu/%lu us (last/avg/max), "
+                         "%.1f%% at max clock, ~%.2f mJ per interaction\n",
+                         (unsigned long)power.interactions,
+                         (unsigned long)power.wakeLatencyLastUs,
+                         (unsigned long)power.wakeLatencyAvgUs,
+                         (unsigned long)power.wakeLatencyMaxUs,
+                         power.uptimeUs ? 100.0 * power.boostedUs / power.uptimeUs : 0.0,
+                         power.energyPerInteractionMj);
+      g_sync->safePrintf("Sensors: %lu samples in %lu drains, %lu published, %lu overruns\n",
+                         (unsigned long)g_sensors.getSampleCount(),
+                         (unsigned long)g_sensors.getDrainCount(),
+                         (unsigned long)g_sensors.getPublishCount(),
+                         (unsigned long)g_sensors.getOverrunCount());
+      size_t historyRecords, historyBytes;
+      g_model->getSensorHistoryStats(historyRecords, historyBytes);
+      g_sync->safePrintf("Sensor history: %u records in %u bytes\n",
+                         (unsigned)historyRecords, (unsigned)historyBytes);
+      g_sync->safePrintf("TaskLink: %lu imported, %lu exported, %lu frame errors, %lu failed transfers\n",
+                         (unsigned long)g_taskLink.getImportedCount(),
+                         (unsigned long)g_taskLink.getExportedCount(),
+                         (unsigned long)g_taskLink.getFrameErrors(),
+                         (unsigned long)g_taskLink.getFailedTransfers());
       lastStatus = millis();
     }
+    
+#ifdef LOAD_TEST
+    reportLoadTest();
+#endif
+    
+    // Check for shutdown signal (handled here: cleanup() stops the UI executor)
+    if (g_sync->getCurrentBits() & SYSTEM_SHUTDOWN_BIT) {
+      g_sync->safePrintln("Shutdown signal received, cleaning up...");
+      g_systemInitialized = false;
+      cleanup();
+      return;
+    }
+    
+    // Sleep after a period without input
+    if (g_sleep->isIdle()) {
+      enterSleep();
+    }
   } else {
     // System failed to initialize
     delay(1000);
@@ -106,39 +325,54 @@ bool initializeHardware() {
 bool initializeComponents() {
   Serial.println("Initializing software components...");
   
-  // Initialize synchronization first
+  // Construct singletons and components up front so stages never race on creation
   g_sync = Synchronization::getInstance();
-  if (!g_sync->initialize()) {
-    Serial.println("Synchronization initialization failed");
-    return false;
-  }
-  
-  // Initialize model
   g_model = Model::getInstance();
+  g_controller = &s_controller;
+  g_oledView = &s_oledView;
+  g_lcdView = &s_lcdView;
   
-  if (!g_model->initialize()) {
-    Serial.println("Model initialization failed");
-    return false;
+  // Panels kept their configuration through deep sleep; skip their init sequences
+  if (g_resumed) {
+    g_oledView->setWarmStart(true);
+    g_lcdView->setWarmStart(true);
+    g_lcdView->setResumeFrame(g_resumeSnapshot);
   }
   
-  // Initialize controller
-  g_controller = new Controller();
-  if (!g_controller->initialize()) {
-    Serial.println("Controller initialization failed");
-    return false;
-  }
+  // Boot stage workers report their own stack peak before exiting
+  StackMonitor::getInstance()->registerTask("boot stage", nullptr, TASK_BOOT_STAGE_STACK,
+                                            "TASK_BOOT_STAGE_STACK");
+  
+  // Independent devices come up concurrently once the bus is ready
+  int i2c = g_boot.addStage("I2C", [](void*) { return initializeHardware(); });
+  g_boot.addStage("Sync", [](void*) { return g_sync->initialize(); });
+  int model = g_boot.addStage("Model/RTC", [](void*) { return g_model->initialize(); },
+                              nullptr, BOOT_DEP(i2c));
+  g_boot.addStage("Controller", [](void*) { return g_controller->initialize(); },
+                  nullptr, BOOT_DEP(model));
+  int oled = g_boot.addStage("OLED", [](void*) { return g_oledView->initialize(); },
+                             nullptr, BOOT_DEP(i2c));
+  // The SSD1306 driver runs the bus at 400 kHz during its transfers, which
+  // would shorten the LCD's clock-timed init waits if both shared the bus
+  g_boot.addStage("LCD", [](void*) { return g_lcdView->initialize(); },
+                  nullptr, BOOT_DEP(oled));
+  // The UI works without sensors, so this stage is optional
+  g_boot.addStage("Sensors", [](void*) {
+    return g_sensors.initialize(s_sensorSource, SENSOR_CHANNELS, sizeof(SENSOR_CHANNELS));
+  }, nullptr, 0, false);
   
-  // Initialize views
-  g_oledView = new OLEDView();
-  if (!g_oledView->initialize()) {
-    Serial.println("OLED View initialization failed");
+  if (!g_boot.run(pdMS_TO_TICKS(5000))) {
     return false;
   }
   
-  g_lcdView = new LCDView();
-  if (!g_lcdView->initialize()) {
-    Serial.println("LCD View initialization failed");
-    return false;
+  // Frequency scaling starts once boot no longer needs full speed
+  PowerManager::getInstance()->initialize();
+  
+  // Views render the restored state on their first frame. The time comes
+  // from the RTC, which kept counting while asleep (setup() stops without one)
+  if (g_resumed) {
+    g_model->restoreState(static_cast<SystemState>(g_resumeSnapshot.state),
+                          g_resumeSnapshot.menuIndex);
   }
   
   Serial.println("All components initialized successfully");
@@ -148,51 +382,86 @@ bool initializeComponents() {
 bool startTasks() {
   Serial.println("Starting tasks...");
   
-  // Start controller task
-  if (!g_controller->start()) {
-    Serial.println("Failed to start controller task");
+  if (!g_busWorker.start()) {
+    Serial.println("Failed to start bus worker");
+    return false;
+  }
+  
+  // Coroutines are spawned before the executor starts
+#ifdef LOAD_TEST
+  g_controller->setEventObserver([](void* context, const InputEvent& event) {
+    if (event.source == EVENT_SOURCE_LOAD) {
+      static_cast<LoadGenerator*>(context)->recordHandled(event.timestampUs);
+    }
+  }, &s_loadGenerator);
+#endif
+  if (!g_controller->start(g_uiExecutor)) {
+    Serial.println("Failed to start controller");
     return false;
   }
-  g_sync->notifyControllerReady();
   
-  // Start view tasks
-  if (!g_oledView->start()) {
-    Serial.println("Failed to start OLED task");
+  if (!g_oledView->start(g_uiExecutor, g_busWorker)) {
+    Serial.println("Failed to start OLED view");
     return false;
   }
   
-  if (!g_lcdView->start()) {
-    Serial.println("Failed to start LCD task");
+  if (!g_lcdView->start(g_uiExecutor, g_busWorker)) {
+    Serial.println("Failed to start LCD view");
     return false;
   }
+  
+  g_uiExecutor.spawn(g_systemStatus);
+  g_uiExecutor.spawn(g_rtcUpdate);
+  
+  g_taskLink.initialize(*g_model, Serial);
+  g_taskLink.start(g_uiExecutor);
+#ifdef TRACE_ENABLE
+  g_traceExporter.start(Serial, g_uiExecutor);
+#endif
+  
+  // Without a source (optional boot stage failed) the pipeline stays idle
+  // Boot counts as idle: conversions run in bursts until the first interaction
+  g_sensors.setIdle(true);
+  if (g_sensors.start(g_uiExecutor)) {
+    g_uiExecutor.spawn(g_sensorHistory);
+    PowerManager::getInstance()->setIdleObserver([](void*, bool idle) {
+      g_sensors.setIdle(idle);
+    }, nullptr);
+  } else {
+    Serial.println("Sensors not started");
+  }
+  
+  // Apply tunables now and on every change (callbacks run on the UI executor)
+  Tunables* tunables = Tunables::getInstance();
+  tunables->watch(TUNE_OLED_INTERVAL_MS, [](void*, int32_t value) {
+    g_oledView->setUpdateInterval(static_cast<uint32_t>(value));
+  }, nullptr);
+  tunables->watch(TUNE_LCD_INTERVAL_MS, [](void*, int32_t value) {
+    g_lcdView->setUpdateInterval(static_cast<uint32_t>(value));
+  }, nullptr);
+  tunables->watch(TUNE_UI_PRIORITY, [](void*, int32_t value) {
+    g_uiExecutor.setPriority(static_cast<UBaseType_t>(value));
+  }, nullptr);
+  tunables->watch(TUNE_I2C_PRIORITY, [](void*, int32_t value) {
+    g_busWorker.setPriority(static_cast<UBaseType_t>(value));
+  }, nullptr);
+  
+  if (!g_uiExecutor.start()) {
+    Serial.println("Failed to start UI executor");
+    return false;
+  }
+  g_sync->notifyControllerReady();
   g_sync->notifyDisplayReady();
   
-  // Create system status monitoring task
-  xTaskCreate(
-    systemStatusTask,
-    "SystemStatus",
-    1024,
-    nullptr,
-    1,
-    nullptr
-  );
-
-  // Create RTC update task
-  xTaskCreate(
-    [](void*) {
-      Model* model = Model::getInstance();
-      TickType_t lastWake = xTaskGetTickCount();
-      for (;;) {
-        model->updateTime();
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000)); // update every second
-      }
-    },
-    "RTC_Update",
-    2048, // stack size
-    nullptr,
-    1,    // priority
-    nullptr
-  );
+#ifdef LOAD_TEST
+  startLoadTest();
+#endif
+  
+  // Profile every long-lived task (setup() runs on the Arduino loop task)
+  StackMonitor* stacks = StackMonitor::getInstance();
+  stacks->registerTask(TASK_UI_NAME, g_uiExecutor.getTaskHandle(), TASK_UI_STACK, "TASK_UI_STACK");
+  stacks->registerTask(TASK_I2C_NAME, g_busWorker.getTaskHandle(), TASK_I2C_STACK, "TASK_I2C_STACK");
+  stacks->registerTask(TASK_LOOP_NAME, xTaskGetCurrentTaskHandle(), TASK_LOOP_STACK, "TASK_LOOP_STACK");
 
   Serial.println("All tasks started successfully");
   return true;
@@ -202,22 +471,28 @@ bool startTasks() {
 void cleanup() {
   Serial.println("Cleaning up system...");
   
+  // Stop the runtime tasks first so no coroutine or job touches stopped components
+  g_uiExecutor.stop();
+#ifdef LOAD_TEST
+  g_loadExecutor.stop();
+#endif
+  g_busWorker.stop();
+  g_sensors.stop();
+  g_taskLink.stop();
+  
   // Stop and cleanup components
   if (g_controller != nullptr) {
     g_controller->stop();
-    delete g_controller;
     g_controller = nullptr;
   }
   
   if (g_oledView != nullptr) {
     g_oledView->stop();
-    delete g_oledView;
     g_oledView = nullptr;
   }
   
   if (g_lcdView != nullptr) {
     g_lcdView->stop();
-    delete g_lcdView;
     g_lcdView = nullptr;
   }
   
@@ -234,17 +509,55 @@ void cleanup() {
   Serial.println("Cleanup complete");
 }
 
-void systemStatusTask(void* pvParameters) {
-  TickType_t lastWakeTime = xTaskGetTickCount();
-  const TickType_t frequency = pdMS_TO_TICKS(10000); // 10 seconds
+/**
+ * Snapshots the UI, blanks the panels and sleeps. Light sleep returns here
+ * on wake; deep sleep resumes through setup().
+ */
+void enterSleep() {
+  UiSnapshot snapshot;
+  snapshot.state = static_cast<uint8_t>(g_model->getCurrentState());
+  snapshot.menuIndex = static_cast<uint8_t>(g_model->getMenuIndex());
+  snapshot.unixTime = g_model->getTime().unixtime();
+  
+  // Hold the display mutex so no render is mid-transfer when the clocks stop
+  if (!g_model->acquireDisplayMutex(pdMS_TO_TICKS(500))) {
+    return;
+  }
+  
+  g_lcdView->captureFrame(snapshot);
+  g_oledView->setDisplayPower(false);
+  g_lcdView->setDisplayPower(false);
+  
+  // Continuous conversion holds the APB clock; stop it for the sleep
+  g_sensors.suspend();
+  g_sleep->sleep(snapshot);
+  if (!g_sensors.isIdle()) {
+    // While idle the pipeline restarts the source for its next burst itself
+    g_sensors.resume();
+  }
+  
+  // Light sleep wake
+  g_oledView->setDisplayPower(true);
+  g_lcdView->setDisplayPower(true);
+  g_model->releaseDisplayMutex();
+}
+
+/**
+ * @brief Health check coroutine, runs every 10 seconds
+ */
+void SystemStatusCoroutine::step() {
+  CO_BEGIN();
+  m_nextCheck = coNow();
+  m_nextStackReport = coNow() + STACK_MONITOR_REPORT_MS;
   
   while (true) {
     // Monitor system health
     if (g_systemInitialized) {
-      // Check for any error conditions
-      UBaseType_t highWaterMark = uxTaskGetStackHighWaterMark(nullptr);
-      if (highWaterMark < 100) { // Less than 100 bytes free
-        g_sync->safePrintln("WARNING: Low stack space in system status task");
+      // Stack high-water marks of every task, with a periodic sizing report
+      StackMonitor::getInstance()->sample();
+      if (static_cast<int32_t>(coNow() - m_nextStackReport) >= 0) {
+        StackMonitor::getInstance()->printReport();
+        m_nextStackReport += STACK_MONITOR_REPORT_MS;
       }
       
       // Monitor message queue
@@ -252,16 +565,67 @@ void systemStatusTask(void* pvParameters) {
       if (messageCount > 8) { // Queue getting full
         g_sync->safePrintf("WARNING: Message queue filling up (%d messages)\n", messageCount);
       }
-      
-      // Check for shutdown signal
-      EventBits_t bits = g_sync->getCurrentBits();
-      if (bits & SYSTEM_SHUTDOWN_BIT) {
-        g_sync->safePrintln("Shutdown signal received, cleaning up...");
-        cleanup();
-        g_systemInitialized = false;
-      }
     }
     
-    vTaskDelayUntil(&lastWakeTime, frequency);
+    m_nextCheck += 10000; // 10 seconds
+    CO_DELAY_UNTIL(m_nextCheck);
+  }
+  
+  CO_END();
+}
+
+#ifdef LOAD_TEST
+/**
+ * @brief Starts the load generator on its own executor, next to the real tasks
+ */
+void startLoadTest() {
+  // Sustained and burst loads alternate down/up; the random walk also changes screens
+  static const int mix[] = { EVENT_DOWN, EVENT_UP, EVENT_SELECT1, EVENT_SELECT2, EVENT_LEFT };
+  
+  LoadProfile profile;
+  profile.pattern = LOAD_TEST_PATTERN;
+  profile.rateHz = LOAD_TEST_RATE_HZ;
+  profile.burstSize = LOAD_TEST_BURST_SIZE;
+  profile.burstPeriodMs = LOAD_TEST_BURST_PERIOD_MS;
+  profile.durationMs = LOAD_TEST_DURATION_MS;
+  profile.seed = LOAD_TEST_SEED;   // Fixed, so runs are comparable
+  
+  s_loadGenerator.setEventMix(mix, sizeof(mix) / sizeof(mix[0]));
+  if (!s_loadGenerator.begin(profile, [](void* context, int event, uint32_t) {
+        return static_cast<Controller*>(context)->postEvent(static_cast<SystemEvent>(event),
+                                                            EVENT_SOURCE_LOAD);
+      }, g_controller)) {
+    Serial.println("Load test profile rejected");
+    return;
+  }
+  
+  g_controller->resetEventHighWater();
+  s_loadFramesAtStart = g_oledView->getFrameCount() + g_lcdView->getFrameCount();
+  g_loadExecutor.spawn(s_loadGenerator);
+  if (!g_loadExecutor.start()) {
+    Serial.println("Failed to start load generator");
+    return;
   }
-}
\ No newline at end of file
+  StackMonitor::getInstance()->registerTask(TASK_LOAD_NAME, g_loadExecutor.getTaskHandle(),
+                                            TASK_LOAD_STACK, "TASK_LOAD_STACK");
+  Serial.println("Load test started");
+}
+
+/**
+ * @brief Prints the load test report once the generator has finished
+ */
+void reportLoadTest() {
+  if (s_loadReported || !s_loadGenerator.isFinished()) return;
+  s_loadReported = true;
+  
+  LoadReport report;
+  s_loadGenerator.getReport(report);
+  report.frames = g_oledView->getFrameCount() + g_lcdView->getFrameCount() - s_loadFramesAtStart;
+  report.queueHighWater = g_controller->getEventHighWater();
+  report.queueCapacity = g_controller->getEventPoolSize();
+  
+  char line[256];
+  report.format(line, sizeof(line));
+  g_sync->safePrintln(line);
+}
+#endif
@@ -0,0 +1,41 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+/**
+ * Minimal checks for the host tests in this directory.
+ *
+ * A failed CHECK prints its location and the test carries on, so one run
+ * reports every broken case; hostTestResult() turns the count into the
+ * exit status that run_tests.sh looks at.
+ */
+
+static int g_hostTestFailures = 0;
+
+#define CHECK(cond)                                                         \
+  do {                                                                      \
+    if (!(cond)) {                                                          \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      g_hostTestFailures++;                                                 \
+    }                                                                       \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                          \
+  do {                                                                      \
+    long long a_ = static_cast<long long>(actual);                          \
+    long long e_ = static_cast<long long>(expected);                        \
+    if (a_ != e_) {                                                         \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",     \
+              __FILE__, __LINE__, #actual, #expected, a_, e_);              \
+      g_hostTestFailures++;                                                 \
+    }                                                                       \
+  } while (0)
+
+// Prints the verdict; returns the process exit status
+static inline int hostTestResult(const char* name) {
+  printf("%s: %s\n", name, g_hostTestFailures == 0 ? "ok" : "FAILED");
+  return g_hostTestFailures == 0 ? 0 : 1;
+}
+
+#endif // HOST_TEST_H
@@ -0,0 +1,59 @@
+/*
+ * Host stand-in for the parts of Arduino.h that the host-tested sources use
+ * (TaskManager, FlightRecorder, SimpleLCD). Only what those sources call is
+ * provided.
+ */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+// Placement attributes: code and data stay where the host puts them, except
+// that RTC_NOINIT data is gathered in one section, so a test can carry it
+// across a simulated reset (__start_rtc_noinit .. __stop_rtc_noinit)
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR __attribute__((section("rtc_noinit")))
+
+// Console output goes to stdout; define HostSerial Serial; in one test source
+struct HostSerial {
+  void print(const char* text) { fputs(text, stdout); }
+  void println(const char* text) { puts(text); }
+};
+extern HostSerial Serial;
+
+// Text sink with Arduino's print/println/printf; subclasses implement write()
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const uint8_t* data, size_t size) = 0;
+
+  size_t print(const char* text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+  size_t println(const char* text) { return print(text) + print("\r\n"); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return write(reinterpret_cast<const uint8_t*>(buffer),
+                 static_cast<size_t>(length) < sizeof(buffer) ? length : sizeof(buffer) - 1);
+  }
+};
+
+// The test that uses them defines these: uint32_t millis() { ... } and HostEsp ESP;
+uint32_t millis();
+void delay(uint32_t ms);
+
+struct HostEsp {
+  uint32_t minFreeHeap;
+  uint32_t getMinFreeHeap() const { return minFreeHeap; }
+};
+extern HostEsp ESP;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,40 @@
+/*
+ * Host stand-in for Wire.h: a bus that keeps every byte written, so a test
+ * can replay what a device would have received. Define TwoWire Wire; in the
+ * test source.
+ */
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class TwoWire {
+public:
+  std::vector<uint8_t> bytes;     // Every byte of every transmission, in order
+  uint32_t transmissions;
+
+  TwoWire() : transmissions(0), m_address(0) {}
+
+  void beginTransmission(uint8_t address) { m_address = address; }
+
+  size_t write(const uint8_t* data, size_t length) {
+    bytes.insert(bytes.end(), data, data + length);
+    return length;
+  }
+
+  uint8_t endTransmission() {
+    transmissions++;
+    return 0;
+  }
+
+  uint32_t getClock() const { return 400000; }
+  uint8_t lastAddress() const { return m_address; }
+
+private:
+  uint8_t m_address;
+};
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,83 @@
+/*
+ * Host stand-in for the FreeRTOS primitives the host-tested sources use,
+ * mapped onto the C++ standard library so ThreadSanitizer understands them:
+ *   - a mutex semaphore is a std::mutex, taken with a polled timeout (the
+ *     clocklock behind std::timed_mutex is invisible to GCC 12's TSan);
+ *   - a portMUX critical section is a std::mutex;
+ *   - the task handle identifies the calling thread;
+ *   - ticks are milliseconds of std::chrono::steady_clock.
+ */
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define portTICK_PERIOD_MS 1
+
+// Critical sections: assigning the initializer leaves the mutex in place,
+// which is all the sources do with it
+struct portMUX_TYPE {
+  std::mutex lock;
+
+  portMUX_TYPE() {}
+  portMUX_TYPE(const portMUX_TYPE&) {}
+  portMUX_TYPE& operator=(const portMUX_TYPE&) { return *this; }
+};
+#define portMUX_INITIALIZER_UNLOCKED (portMUX_TYPE())
+#define portENTER_CRITICAL(mux) ((mux)->lock.lock())
+#define portEXIT_CRITICAL(mux) ((mux)->lock.unlock())
+#define portENTER_CRITICAL_SAFE(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux) portEXIT_CRITICAL(mux)
+
+typedef std::mutex* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::mutex; }
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  if (ticks == portMAX_DELAY) {
+    semaphore->lock();
+    return pdTRUE;
+  }
+  std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks);
+  while (!semaphore->try_lock()) {
+    if (std::chrono::steady_clock::now() >= deadline) return pdFALSE;
+    std::this_thread::sleep_for(std::chrono::microseconds(20));
+  }
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  semaphore->unlock();
+  return pdTRUE;
+}
+
+inline TickType_t xTaskGetTickCount() {
+  return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+// One distinct handle per thread
+typedef void* TaskHandle_t;
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static thread_local char handle;
+  return &handle;
+}
+
+#endif // HOST_FREERTOS_H
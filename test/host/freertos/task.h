@@ -0,0 +1,2 @@
+// Host stand-in: the primitives live in FreeRTOS.h
+#include "FreeRTOS.h"
@@ -0,0 +1,69 @@
+#!/bin/bash
+# Builds and runs the host tests with g++ (Linux).
+#
+# Usage: test/run_tests.sh [name...]     (default: every test)
+#
+# Tests are plain programs: each prints "<name>: ok" and exits 0 on success.
+# They build with ASan/UBSan unless their entry below chooses a sanitizer;
+# set SANITIZE= to build without. Binaries go to test/build/.
+
+cd "$(dirname "$0")" || exit 1
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++11 -O1 -g -Wall -Wextra -I../src"
+SANITIZE=${SANITIZE--fsanitize=address,undefined -fno-sanitize-recover=undefined}
+
+# name[:variant] | extra sources | extra flags (a -fsanitize flag replaces $SANITIZE)
+# A variant builds name.cpp again with other flags
+TESTS='
+test_coroutine|../src/Coroutine.cpp|-pthread
+test_fixed_pool||
+test_flight_recorder|../src/FlightRecorder.cpp|-Ihost -pthread
+test_flight_recorder:tsan|../src/FlightRecorder.cpp|-Ihost -pthread -fsanitize=thread
+test_glyph_manager|../src/GlyphManager.cpp|-Ihost
+test_lcd_transport||
+test_load_generator|../src/LoadGenerator.cpp ../src/Coroutine.cpp|
+test_quadrature||
+test_sensor_chain||
+test_signal_filters||
+test_task_buckets|../src/TaskManager.cpp|-Ihost
+test_task_buckets:1000|../src/TaskManager.cpp|-Ihost -DTASKMANAGER_MAX_TASKS=1000
+test_task_search|../src/TaskManager.cpp|-Ihost
+test_task_manager_stress|../src/TaskManager.cpp|-Ihost -pthread -fsanitize=thread
+test_time_series||
+test_timer_wheel|../src/TimerWheel.cpp|
+test_tracedump||
+test_tunables|../src/Tunables.cpp ../src/TaskLinkEndpoint.cpp|
+test_ui_snapshot|../src/UiSnapshot.cpp|
+test_ui_snapshot:20x4|../src/UiSnapshot.cpp|-DLCD_PANEL_COLS=20 -DLCD_PANEL_ROWS=4
+'
+
+mkdir -p build
+failed=0
+ran=0
+while IFS='|' read -r name sources flags; do
+  [ -z "$name" ] && continue
+  source=${name%%:*}
+  binary=build/${name/:/-}
+  if [ $# -gt 0 ] && ! [[ " $* " == *" $source "* ]]; then continue; fi
+  sanitize=$SANITIZE
+  [[ "$flags" == *-fsanitize* ]] && sanitize=
+  ran=$((ran + 1))
+  if ! $CXX $CXXFLAGS $sanitize $flags "$source.cpp" $sources -o "$binary"; then
+    echo "$name: BUILD FAILED"
+    failed=$((failed + 1))
+  elif ! "$binary"; then
+    failed=$((failed + 1))
+  fi
+done <<< "$TESTS"
+
+# Scripted tests drive the host tools end to end
+for script in test_*.sh; do
+  [ -e "$script" ] || continue
+  name=${script%.sh}
+  if [ $# -gt 0 ] && ! [[ " $* " == *" $name "* ]]; then continue; fi
+  ran=$((ran + 1))
+  bash "$script" || failed=$((failed + 1))
+done
+
+echo "$((ran - failed)) of $ran passed"
+[ $failed -eq 0 ]
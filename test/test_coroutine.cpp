@@ -0,0 +1,287 @@
+/*
+ * CoExecutor with a simulated clock, and with a producer thread setting a
+ * signal while the executor runs (the target's other core or an ISR), and
+ * Coroutine::restart() on a suspended and on a finished coroutine.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -Wall -Wextra -pthread -I../src test_coroutine.cpp ../src/Coroutine.cpp -o test_coroutine
+ */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "HostTest.h"
+#include "Coroutine.h"
+
+class Blinker : public Coroutine {
+public:
+  Blinker() : m_count(0), m_next(0) {}
+  int m_count;
+  CoTime m_times[3];
+
+protected:
+  void step() override {
+    CO_BEGIN();
+    m_next = coNow();
+    while (m_count < 3) {
+      m_times[m_count++] = coNow();
+      m_next += 100;
+      CO_DELAY_UNTIL(m_next);
+    }
+    CO_END();
+  }
+
+private:
+  CoTime m_next;
+};
+
+class Waiter : public Coroutine {
+public:
+  explicit Waiter(CoSignal& signal) : m_signalled(0), m_timeouts(0), m_signal(signal) {}
+  int m_signalled;
+  int m_timeouts;
+
+protected:
+  void step() override {
+    CO_BEGIN();
+    while (true) {
+      CO_AWAIT_TIMEOUT(m_signal.poll(this), 250);
+      if (coTimedOut()) {
+        m_timeouts++;
+      } else {
+        m_signalled++;
+      }
+    }
+    CO_END();
+  }
+
+private:
+  CoSignal& m_signal;
+};
+
+class Consumer : public Coroutine {
+public:
+  explicit Consumer(CoQueue<int, 4>& queue) : m_sum(0), m_count(0), m_queue(queue), m_item(0) {}
+  int m_sum;
+  int m_count;
+
+protected:
+  void step() override {
+    CO_BEGIN();
+    while (true) {
+      CO_AWAIT(m_queue.pop(m_item, this));
+      m_sum += m_item;
+      m_count++;
+    }
+    CO_END();
+  }
+
+private:
+  CoQueue<int, 4>& m_queue;
+  int m_item;
+};
+
+static void countWake(void* context, bool) {
+  ++*static_cast<int*>(context);
+}
+
+static void testSimulatedClock() {
+  CoExecutor executor;
+  int wakes = 0;
+  executor.setWakeHook(countWake, &wakes);
+
+  Blinker blinker;
+  CoSignal signal;
+  Waiter waiter(signal);
+  CoQueue<int, 4> queue;
+  Consumer consumer(queue);
+  executor.spawn(blinker);
+  executor.spawn(waiter);
+  executor.spawn(consumer);
+
+  // First pass runs everything; the next deadline is the blinker's
+  CHECK_EQ(executor.runOnce(1000), 100);
+  CHECK_EQ(blinker.m_count, 1);
+
+  // Waiting only on a deadline: not stepped early
+  CHECK_EQ(executor.runOnce(1050), 50);
+  CHECK_EQ(blinker.m_count, 1);
+
+  // A signal wakes the executor and the waiter on the next pass
+  signal.set();
+  CHECK_EQ(wakes, 1);
+  executor.runOnce(1060);
+  CHECK_EQ(waiter.m_signalled, 1);
+
+  // Queue items arrive in order; a full queue drops
+  for (int i = 1; i <= 5; i++) queue.push(i);
+  CHECK_EQ(queue.getDropCount(), 1);
+  executor.runOnce(1070);
+  CHECK_EQ(consumer.m_count, 4);
+  CHECK_EQ(consumer.m_sum, 1 + 2 + 3 + 4);
+
+  // Drift-free period, then the blinker finishes and is unlinked
+  for (CoTime t = 1100; t <= 1400; t += 10) executor.runOnce(t);
+  CHECK_EQ(blinker.m_count, 3);
+  CHECK_EQ(blinker.m_times[1], 1100);
+  CHECK_EQ(blinker.m_times[2], 1200);
+  CHECK(blinker.isDone());
+  CHECK_EQ(executor.getCoroutineCount(), 2);
+
+  // The waiter's await timed out once without a signal (armed at 1060)
+  CHECK_EQ(waiter.m_timeouts, 1);
+
+  // Deadlines survive the 32-bit clock wrap
+  CoExecutor wrapped;
+  Blinker late;
+  wrapped.spawn(late);
+  wrapped.runOnce(0xFFFFFFF0u);
+  CHECK_EQ(wrapped.runOnce(0xFFFFFFF0u + 50), 50);
+  wrapped.runOnce(0xFFFFFFF0u + 100);
+  CHECK_EQ(late.m_count, 2);
+}
+
+/**
+ * The executor thread blocks like ExecutorTask between passes; a producer
+ * thread sets the signal and waits for the coroutine to see it. A notify
+ * that is lost between passes leaves the untimed await hanging.
+ */
+class Counter : public Coroutine {
+public:
+  explicit Counter(CoSignal& signal) : m_seen(0), m_signal(signal) {}
+  std::atomic<uint32_t> m_seen;
+
+protected:
+  void step() override {
+    CO_BEGIN();
+    while (true) {
+      CO_AWAIT(m_signal.poll(this));
+      m_seen++;
+    }
+    CO_END();
+  }
+
+private:
+  CoSignal& m_signal;
+};
+
+struct ThreadExecutor {
+  CoExecutor executor;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool woken = false;
+  std::atomic<bool> stop;
+
+  ThreadExecutor() : stop(false) {
+    executor.setWakeHook(hook, this);
+  }
+
+  static void hook(void* context, bool) {
+    ThreadExecutor* self = static_cast<ThreadExecutor*>(context);
+    std::lock_guard<std::mutex> guard(self->mutex);
+    self->woken = true;
+    self->wake.notify_one();
+  }
+
+  void run() {
+    while (!stop) {
+      uint32_t wait = executor.runOnce(0);
+      if (wait == 0) continue;
+      std::unique_lock<std::mutex> guard(mutex);
+      wake.wait(guard, [this] { return woken || stop; });
+      woken = false;
+    }
+  }
+};
+
+// Waits for a flag: with a timeout on its first run, without one after
+class Restartable : public Coroutine {
+public:
+  Restartable() : m_runs(0), m_timeouts(0), m_flag(false) {}
+  int m_runs;
+  int m_timeouts;
+  bool m_flag;
+
+  void again() { restart(); }
+
+protected:
+  void step() override {
+    CO_BEGIN();
+    m_runs++;
+    if (m_runs == 1) {
+      CO_AWAIT_TIMEOUT(m_flag, 50);
+      if (coTimedOut()) m_timeouts++;
+    } else {
+      CO_AWAIT(m_flag);
+    }
+    CO_END();
+  }
+};
+
+static void testRestart() {
+  CoExecutor executor;
+  Restartable co;
+  executor.spawn(co);
+  CHECK_EQ(executor.runOnce(0), 50);
+  CHECK_EQ(co.m_runs, 1);
+
+  // Restarted in its timed wait: runs from the top on the next pass, and
+  // the old deadline no longer counts
+  co.again();
+  CHECK_EQ(executor.runOnce(10), CO_FOREVER);
+  CHECK_EQ(co.m_runs, 2);
+  CHECK_EQ(executor.runOnce(100), CO_FOREVER);
+  CHECK_EQ(co.m_timeouts, 0);
+  co.m_flag = true;
+  executor.notify();
+  executor.runOnce(120);
+  CHECK(co.isDone());
+  CHECK_EQ(executor.getCoroutineCount(), 0);
+  if (executor.getCoroutineCount() != 0) return;  // Spawning it twice would loop
+
+  // Restarted after finishing, and spawned again
+  co.again();
+  CHECK(!co.isDone());
+  executor.spawn(co);
+  executor.runOnce(130);
+  CHECK_EQ(co.m_runs, 3);
+  CHECK(co.isDone());
+  CHECK_EQ(executor.getCoroutineCount(), 0);
+}
+
+static void testNotifyFromAnotherThread() {
+  static const uint32_t ROUNDS = 200000;
+  ThreadExecutor host;
+  CoSignal signal;
+  Counter counter(signal);
+  host.executor.spawn(counter);
+  std::thread thread(&ThreadExecutor::run, &host);
+
+  uint32_t lost = 0;
+  for (uint32_t i = 1; i <= ROUNDS && lost == 0; i++) {
+    signal.set();
+    std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (counter.m_seen.load() < i) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        fprintf(stderr, "signal %u not seen within 1 s\n", i);
+        lost++;
+        break;
+      }
+    }
+  }
+  CHECK_EQ(lost, 0);
+
+  host.stop = true;
+  ThreadExecutor::hook(&host, false);
+  thread.join();
+}
+
+int main() {
+  testSimulatedClock();
+  testRestart();
+  testNotifyFromAnotherThread();
+  return hostTestResult("test_coroutine");
+}
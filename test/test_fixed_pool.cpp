@@ -0,0 +1,238 @@
+/*
+ * FixedPool: exhaustion and the failure count, high-water mark and its
+ * reset, LIFO reuse, create()/destroy() constructing and destroying in
+ * place (arguments forwarded, alignment kept), foreign, misaligned and
+ * double releases refused without touching the free list, balanced locking,
+ * and random allocate/release against a reference set.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_fixed_pool.cpp -o test_fixed_pool
+ */
+#include <stdlib.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "HostTest.h"
+#include "FixedPool.h"
+
+static int s_alive;
+static int s_destroyed;
+
+// Counts constructions and destructions; takes a move-only argument
+struct Tracked {
+  int value;
+  std::unique_ptr<int> owned;
+  unsigned char padding[5];
+
+  Tracked(int v, std::unique_ptr<int> p) : value(v), owned(std::move(p)) {
+    s_alive++;
+  }
+  ~Tracked() {
+    s_alive--;
+    s_destroyed++;
+  }
+};
+
+struct alignas(16) Wide {
+  uint8_t tag;
+};
+
+// Lock policy that checks every lock() is paired with an unlock()
+struct CountingLock {
+  static int depth;
+  static int locks;
+  void lock() {
+    CHECK_EQ(depth, 0);
+    depth++;
+    locks++;
+  }
+  void unlock() {
+    CHECK_EQ(depth, 1);
+    depth--;
+  }
+};
+int CountingLock::depth;
+int CountingLock::locks;
+
+static void testExhaustion() {
+  static const size_t N = 6;
+  FixedPool<Tracked, N> pool;
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < N; i++) {
+    void* block = pool.allocate();
+    CHECK(block != nullptr);
+    CHECK(pool.owns(block));
+    for (size_t j = 0; j < blocks.size(); j++) CHECK(blocks[j] != block);
+    blocks.push_back(block);
+    CHECK_EQ(pool.getInUse(), i + 1);
+  }
+
+  // Exhausted: every further attempt fails and is counted
+  CHECK(pool.allocate() == nullptr);
+  CHECK(pool.allocate() == nullptr);
+  CHECK_EQ(pool.getFailureCount(), 2);
+  CHECK_EQ(pool.getInUse(), N);
+  CHECK_EQ(pool.getHighWater(), N);
+
+  // LIFO: the last block released is the next one handed out
+  CHECK(pool.release(blocks[1]));
+  CHECK(pool.release(blocks[4]));
+  CHECK_EQ(pool.getInUse(), N - 2);
+  CHECK(pool.allocate() == blocks[4]);
+  CHECK(pool.allocate() == blocks[1]);
+  CHECK(pool.allocate() == nullptr);
+  CHECK_EQ(pool.getFailureCount(), 3);
+
+  // The high-water mark holds until reset, then restarts from the current use
+  for (size_t i = 0; i < N; i++) CHECK(pool.release(blocks[i]));
+  CHECK_EQ(pool.getInUse(), 0);
+  CHECK_EQ(pool.getHighWater(), N);
+  pool.resetHighWater();
+  CHECK_EQ(pool.getHighWater(), 0);
+  void* a = pool.allocate();
+  void* b = pool.allocate();
+  CHECK(pool.release(a));
+  CHECK_EQ(pool.getHighWater(), 2);
+  pool.resetHighWater();
+  CHECK_EQ(pool.getHighWater(), 1);
+  CHECK(pool.release(b));
+  CHECK(pool.release(nullptr));
+  CHECK_EQ(pool.getBadReleaseCount(), 0);
+}
+
+static void testCreateDestroy() {
+  FixedPool<Tracked, 3> pool;
+  Tracked* first = pool.create(7, std::unique_ptr<int>(new int(70)));
+  Tracked* second = pool.create(8, std::unique_ptr<int>(new int(80)));
+  CHECK(first != nullptr && second != nullptr);
+  CHECK_EQ(s_alive, 2);
+  CHECK_EQ(first->value, 7);
+  CHECK_EQ(*second->owned, 80);
+
+  Tracked* third = pool.create(9, std::unique_ptr<int>());
+  // Exhausted: nothing constructed, and the argument is not consumed
+  std::unique_ptr<int> kept(new int(100));
+  CHECK(pool.create(10, std::move(kept)) == nullptr);
+  CHECK(kept && *kept == 100);
+  CHECK_EQ(s_alive, 3);
+  CHECK_EQ(pool.getFailureCount(), 1);
+
+  // destroy() runs the destructor (ASan reports the owned int if not) once
+  CHECK(pool.destroy(second));
+  CHECK_EQ(s_alive, 2);
+  CHECK(!pool.destroy(second));
+  CHECK_EQ(s_alive, 2);
+  CHECK_EQ(s_destroyed, 1);
+  CHECK_EQ(pool.getBadReleaseCount(), 1);
+  CHECK(pool.destroy(nullptr));
+  CHECK(pool.create(11, std::unique_ptr<int>(new int(110))) == second);
+  CHECK(pool.destroy(first));
+  CHECK(pool.destroy(second));
+  CHECK(pool.destroy(third));
+  CHECK_EQ(s_alive, 0);
+  CHECK_EQ(pool.getInUse(), 0);
+
+  // Blocks keep the type's alignment
+  FixedPool<Wide, 5> wide;
+  for (int i = 0; i < 5; i++) {
+    Wide* block = wide.create();
+    CHECK(block != nullptr);
+    CHECK_EQ(reinterpret_cast<uintptr_t>(block) % 16, 0);
+  }
+}
+
+static void testBadReleases() {
+  static const size_t N = 4;
+  FixedPool<Tracked, N> pool;
+  void* blocks[N];
+  for (size_t i = 0; i < N; i++) blocks[i] = pool.allocate();
+  CHECK(pool.release(blocks[2]));
+
+  // Foreign, inside a block, already released: refused, pool unchanged
+  Tracked outside(1, std::unique_ptr<int>());
+  FixedPool<Tracked, N> other;
+  void* foreign = other.allocate();
+  CHECK(!pool.owns(&outside));
+  CHECK(!pool.release(&outside));
+  CHECK(!pool.release(foreign));
+  CHECK(!pool.release(static_cast<unsigned char*>(blocks[1]) + 1));
+  CHECK(!pool.release(static_cast<unsigned char*>(blocks[3]) + sizeof(Tracked) - 1));
+  CHECK(!pool.release(blocks[2]));
+  CHECK(!pool.destroy(&outside));
+  CHECK(!pool.destroy(static_cast<Tracked*>(blocks[2])));
+  CHECK_EQ(s_alive, 1);
+  CHECK_EQ(pool.getBadReleaseCount(), 7);
+  CHECK_EQ(pool.getInUse(), N - 1);
+  CHECK_EQ(other.getInUse(), 1);
+
+  // The free list is intact: exactly the one free block comes back, once
+  CHECK(pool.allocate() == blocks[2]);
+  CHECK(pool.allocate() == nullptr);
+  for (size_t i = 0; i < N; i++) CHECK(pool.release(blocks[i]));
+  std::set<void*> again;
+  for (size_t i = 0; i < N; i++) again.insert(pool.allocate());
+  CHECK_EQ(again.size(), N);
+  CHECK(again.count(nullptr) == 0);
+  CHECK(other.release(foreign));
+}
+
+static void testLocking() {
+  FixedPool<int, 4, CountingLock> pool;
+  int* a = pool.create(1);
+  int* b = pool.create(2);
+  CHECK(pool.release(a));
+  CHECK(!pool.release(a));
+  CHECK(pool.destroy(b));
+  CHECK(!pool.destroy(b));
+  for (int i = 0; i < 5; i++) pool.allocate();
+  CHECK_EQ(CountingLock::depth, 0);
+  CHECK(CountingLock::locks >= 11);
+}
+
+static void testRandom() {
+  static const size_t N = 37;
+  FixedPool<uint64_t, N> pool;
+  std::vector<uint64_t*> live;
+  size_t highWater = 0;
+  uint32_t failures = 0;
+  srand(9);
+  for (int op = 0; op < 200000; op++) {
+    if (rand() % 2 == 0) {
+      uint64_t* block = pool.create(static_cast<uint64_t>(op));
+      if (live.size() == N) {
+        CHECK(block == nullptr);
+        failures++;
+      } else {
+        CHECK(block != nullptr);
+        if (block == nullptr) break;
+        live.push_back(block);
+      }
+    } else if (!live.empty()) {
+      size_t pick = rand() % live.size();
+      CHECK(pool.destroy(live[pick]));
+      live[pick] = live.back();
+      live.pop_back();
+    }
+    if (live.size() > highWater) highWater = live.size();
+    if (op % 50000 == 0) {
+      pool.resetHighWater();
+      highWater = live.size();
+    }
+    CHECK_EQ(pool.getInUse(), live.size());
+  }
+  CHECK_EQ(pool.getHighWater(), highWater);
+  CHECK_EQ(pool.getFailureCount(), failures);
+  CHECK(failures > 0);
+  std::set<uint64_t*> distinct(live.begin(), live.end());
+  CHECK_EQ(distinct.size(), live.size());
+}
+
+int main() {
+  testExhaustion();
+  testCreateDestroy();
+  testBadReleases();
+  testLocking();
+  testRandom();
+  return hostTestResult("test_fixed_pool");
+}
@@ -0,0 +1,274 @@
+/*
+ * FlightRecorder across simulated resets: each boot runs in a forked child
+ * that starts with the RTC_NOINIT section the previous boot left behind
+ * (garbage at power-on) and fresh everything else, as a reset does. Checks
+ * the dump of the previous boot under each reset reason, nothing printed
+ * after power-on or a deep-sleep wake, the ring wrapping with concurrent
+ * writers, header validation, records before begin() dropped, flightTake()
+ * logging only waits that time out, and heap lows in HEAP_STEP_BYTES steps.
+ * run_tests.sh also builds it with ThreadSanitizer for the concurrent writers.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -pthread -Ihost -I../src test_flight_recorder.cpp ../src/FlightRecorder.cpp -o test_flight_recorder
+ */
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "HostTest.h"
+#include "FlightRecorder.h"
+#include "TraceFormat.h"
+#include <esp_system.h>
+
+HostSerial Serial;
+HostEsp ESP;
+
+static uint32_t s_millis;
+static esp_reset_reason_t s_reason;
+
+uint32_t millis() {
+  return s_millis;
+}
+
+esp_reset_reason_t esp_reset_reason() {
+  return s_reason;
+}
+
+// What survives a reset: the RTC_NOINIT section (see host/Arduino.h)
+extern "C" char __start_rtc_noinit[];
+extern "C" char __stop_rtc_noinit[];
+
+// Shared with the boot children
+struct Board {
+  char rtc[16384];
+  char output[65536];
+  size_t outputLength;
+};
+static Board* s_board;
+
+class BoardPrint : public Print {
+public:
+  size_t write(const uint8_t* data, size_t size) override {
+    size_t room = sizeof(s_board->output) - 1 - s_board->outputLength;
+    if (size > room) size = room;
+    memcpy(s_board->output + s_board->outputLength, data, size);
+    s_board->outputLength += size;
+    return size;
+  }
+};
+
+typedef void (*BootBody)(Print& out);
+
+/**
+ * Boots once with the given reset reason and returns what was printed,
+ * one entry per line without line endings
+ */
+static std::vector<std::string> boot(esp_reset_reason_t reason, BootBody body) {
+  size_t rtcSize = __stop_rtc_noinit - __start_rtc_noinit;
+  CHECK(rtcSize <= sizeof(s_board->rtc));
+  s_board->outputLength = 0;
+
+  fflush(stdout);
+  int failures = g_hostTestFailures;
+  pid_t child = fork();
+  if (child == 0) {
+    memcpy(__start_rtc_noinit, s_board->rtc, rtcSize);
+    s_reason = reason;
+    s_millis = 0;
+    ESP.minFreeHeap = 200000;
+    BoardPrint out;
+    body(out);
+    memcpy(s_board->rtc, __start_rtc_noinit, rtcSize);
+    fflush(stdout);
+    // exit(), not _exit(): a sanitizer that found something fails the boot
+    exit(g_hostTestFailures == failures ? 0 : 1);
+  }
+  int status = 0;
+  CHECK(child > 0 && waitpid(child, &status, 0) == child);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  std::vector<std::string> lines;
+  std::string text(s_board->output, s_board->outputLength);
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = text.find('\n', start);
+    if (end == std::string::npos) end = text.size();
+    std::string line = text.substr(start, end - start);
+    if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+    lines.push_back(line);
+    start = end + 1;
+  }
+  return lines;
+}
+
+// A dump line as printRange() writes it
+static std::string entry(uint32_t ms, const char* type, const char* detail) {
+  char line[128];
+  snprintf(line, sizeof(line), "  %8lu ms  %-7s %s", (unsigned long)ms, type, detail);
+  return line;
+}
+
+static void checkLines(const std::vector<std::string>& lines, const std::vector<std::string>& expected, int line) {
+  bool same = lines == expected;
+  if (!same) {
+    fprintf(stderr, "test_flight_recorder.cpp:%d: output differs\n--- got\n", line);
+    for (size_t i = 0; i < lines.size(); i++) fprintf(stderr, "%s\n", lines[i].c_str());
+    fprintf(stderr, "--- expected\n");
+    for (size_t i = 0; i < expected.size(); i++) fprintf(stderr, "%s\n", expected[i].c_str());
+  }
+  CHECK(same);
+}
+#define CHECK_LINES(lines, expected) checkLines((lines), (expected), __LINE__)
+
+// ---- Boots ----
+
+static void firstBoot(Print& out) {
+  FlightRecorder* recorder = FlightRecorder::getInstance();
+  s_millis = 5;
+  recorder->begin(out);
+  recorder->begin(out);                           // Once per boot
+
+  s_millis = 10;
+  FlightRecorder::record(FLIGHT_STATE, 0, 1);
+  s_millis = 20;
+  FlightRecorder::record(FLIGHT_INPUT, 3, 1);
+
+  // Only a wait that times out is logged
+  SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  s_millis = 30;
+  CHECK(flightTake(mutex, pdMS_TO_TICKS(5), TRACE_MUTEX_MODEL_TIME));
+  CHECK(!flightTake(mutex, 0, TRACE_MUTEX_MODEL_STATE));
+  CHECK(!flightTake(mutex, pdMS_TO_TICKS(5), TRACE_MUTEX_SYNC_DISPLAY));
+  xSemaphoreGive(mutex);
+  vSemaphoreDelete(mutex);
+
+  // Heap lows: less than a step below the last one logged is not news
+  s_millis = 40;
+  ESP.minFreeHeap = 200000 - FlightRecorder::HEAP_STEP_BYTES + 1;
+  recorder->sampleHeap();
+  ESP.minFreeHeap = 198000;
+  recorder->sampleHeap();
+
+  s_millis = 50;
+  FlightRecorder::record(FLIGHT_FATAL, FLIGHT_FATAL_NO_RTC);
+}
+
+static const int WRITERS = 4;
+static const int WRITES = 20000;
+
+static void busyBoot(Print& out) {
+  FlightRecorder::getInstance()->begin(out);
+
+  // Four writers started together wrap the ring many times over
+  std::atomic<bool> go(false);
+  std::vector<std::thread> writers;
+  for (int w = 0; w < WRITERS; w++) {
+    writers.push_back(std::thread([w, &go]() {
+      while (!go) {}
+      for (int i = 0; i < WRITES; i++) FlightRecorder::record(FLIGHT_INPUT, static_cast<uint8_t>(w), i);
+    }));
+  }
+  go = true;
+  for (size_t w = 0; w < writers.size(); w++) writers[w].join();
+}
+
+static void sleepBoot(Print& out) {
+  FlightRecorder::record(FLIGHT_STATE, 9, 9);     // Before begin(): dropped
+  FlightRecorder::getInstance()->begin(out);
+  s_millis = 70;
+  FlightRecorder::record(FLIGHT_SLEEP, 1);
+}
+
+static void wakeBoot(Print& out) {
+  FlightRecorder::getInstance()->begin(out);
+  s_millis = 80;
+  FlightRecorder::record(FLIGHT_STATE, 2, 3);
+  FlightRecorder::record(99, 7, 8);               // Unknown type
+}
+
+static void plainBoot(Print& out) {
+  FlightRecorder::getInstance()->begin(out);
+}
+
+static void testBoots() {
+  // Power-on: RTC memory holds garbage, which is not taken for a log
+  srand(3);
+  for (size_t i = 0; i < sizeof(s_board->rtc); i++) s_board->rtc[i] = static_cast<char>(rand());
+  CHECK(boot(ESP_RST_POWERON, firstBoot).empty());
+
+  // A panic: the first boot's events in order
+  std::vector<std::string> expected;
+  expected.push_back("=== Flight recorder: boot 1 ended in a panic reset ===");
+  expected.push_back(entry(5, "boot", "power-on reset, boot 1"));
+  expected.push_back(entry(5, "heap", "200000 bytes free"));
+  expected.push_back(entry(10, "state", "0 -> 1"));
+  expected.push_back(entry(20, "input", "event 3 from source 1"));
+  expected.push_back(entry(30, "lock", "Sync display after 5 ms"));
+  expected.push_back(entry(40, "heap", "198000 bytes free"));
+  expected.push_back(entry(50, "fatal", "no RTC"));
+  expected.push_back("=== End of flight recorder ===");
+  CHECK_LINES(boot(ESP_RST_PANIC, busyBoot), expected);
+
+  // A watchdog reset after the busy boot: what is left of its 80002 events
+  std::vector<std::string> lines = boot(ESP_RST_TASK_WDT, sleepBoot);
+  CHECK_EQ(lines.size(), 1 + 1 + FlightRecorder::RECORDS + 1);
+  if (lines.size() == 3 + FlightRecorder::RECORDS) {
+    CHECK(lines[0] == "=== Flight recorder: boot 2 ended in a task watchdog reset ===");
+    char overwritten[64];
+    snprintf(overwritten, sizeof(overwritten), "  (%u older events overwritten)",
+             (unsigned)(2 + WRITERS * WRITES - FlightRecorder::RECORDS));
+    CHECK(lines[1] == overwritten);
+
+    // The newest RECORDS writes: of each writer that still has any, the
+    // tail of its sequence, in order and none torn or lost
+    int last[WRITERS] = { -1, -1, -1, -1 };
+    for (size_t i = 2; i < lines.size() - 1; i++) {
+      unsigned writer, sequence;
+      char tail;
+      CHECK(sscanf(lines[i].c_str(), "  0 ms  input   event %u from source %u%c", &writer, &sequence, &tail) == 2);
+      CHECK(writer < WRITERS);
+      if (writer >= WRITERS) continue;
+      if (last[writer] >= 0) CHECK_EQ(sequence, last[writer] + 1);
+      last[writer] = sequence;
+    }
+    for (int w = 0; w < WRITERS; w++) CHECK(last[w] == -1 || last[w] == WRITES - 1);
+  }
+
+  // Waking from deep sleep prints nothing; the next reset shows that boot only
+  CHECK(boot(ESP_RST_DEEPSLEEP, wakeBoot).empty());
+  expected.clear();
+  expected.push_back("=== Flight recorder: boot 4 ended in a software reset ===");
+  expected.push_back(entry(0, "boot", "deep sleep reset, boot 4"));
+  expected.push_back(entry(0, "heap", "200000 bytes free"));
+  expected.push_back(entry(80, "state", "2 -> 3"));
+  expected.push_back(entry(80, "?", "7 8"));
+  expected.push_back("=== End of flight recorder ===");
+  CHECK_LINES(boot(ESP_RST_SW, plainBoot), expected);
+
+  // A header that fails its check starts a new log, counting boots from 1
+  static const size_t HEAD_OFFSET = 4;
+  s_board->rtc[HEAD_OFFSET] ^= 1;
+  expected.clear();
+  expected.push_back("Flight recorder: no valid log, starting a new one");
+  CHECK_LINES(boot(ESP_RST_EXT, plainBoot), expected);
+  expected.clear();
+  expected.push_back("=== Flight recorder: boot 1 ended in a brownout reset ===");
+  expected.push_back(entry(0, "boot", "external reset, boot 1"));
+  expected.push_back(entry(0, "heap", "200000 bytes free"));
+  expected.push_back("=== End of flight recorder ===");
+  CHECK_LINES(boot(ESP_RST_BROWNOUT, plainBoot), expected);
+}
+
+int main() {
+  s_board = static_cast<Board*>(mmap(nullptr, sizeof(Board), PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  CHECK(s_board != MAP_FAILED);
+  if (s_board == MAP_FAILED) return hostTestResult("test_flight_recorder");
+  testBoots();
+  return hostTestResult("test_flight_recorder");
+}
@@ -0,0 +1,433 @@
+/*
+ * GlyphManager and the SimpleLCD text shadow against an HD44780 model fed
+ * the PCF8574 byte stream: a glyph is uploaded only when it gets a new
+ * slot, hits and uploads are counted, the victim is the least recently used
+ * slot off screen, else on screen, never one the current frame placed, the
+ * fallback character is written when every slot is pinned, and cells left
+ * showing an evicted slot are blanked and reported. Random placements, text
+ * and clears must leave every cell showing what was last put there; the
+ * panel's shadow (what a sleep snapshot restores) must match the screen.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -Ihost -I../src test_glyph_manager.cpp ../src/GlyphManager.cpp -o test_glyph_manager
+ */
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "HostTest.h"
+#include "GlyphManager.h"
+#include "SimpleLCD.h"
+
+TwoWire Wire;
+
+/**
+ * HD44780 in 4-bit mode behind a PCF8574: a nibble is taken on the falling
+ * edge of EN, two make a byte. Models DDRAM, CGRAM and the address counter.
+ */
+class Hd44780 {
+public:
+  uint8_t ddram[128];
+  uint8_t cgram[64];
+  uint32_t cgramWrites;
+
+  Hd44780() : cgramWrites(0), m_address(0), m_cgram(false), m_previous(0), m_half(0), m_high(0) {
+    memset(ddram, LCD_CHAR_BLANK, sizeof(ddram));
+    memset(cgram, 0, sizeof(cgram));
+  }
+
+  void feed(const uint8_t* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      if ((m_previous & LCD_PCF_EN) && !(bytes[i] & LCD_PCF_EN)) {
+        if (m_half == 0) {
+          m_high = m_previous & 0xF0;
+          m_half = 1;
+        } else {
+          latch(static_cast<uint8_t>(m_high | (m_previous >> 4)), (m_previous & LCD_PCF_RS) != 0);
+          m_half = 0;
+        }
+      }
+      m_previous = bytes[i];
+    }
+  }
+
+  uint8_t code(uint8_t col, uint8_t row) const {
+    static const uint8_t rowOffsets[] = { 0x00, 0x40, 0x14, 0x54 };
+    return ddram[col + rowOffsets[row]];
+  }
+
+  // What a cell looks like: its ROM character, or "#" and the 8 CGRAM rows
+  std::string look(uint8_t col, uint8_t row) const {
+    uint8_t value = code(col, row);
+    if (value >= GlyphManager::SLOT_COUNT) return std::string(1, static_cast<char>(value));
+    return "#" + std::string(reinterpret_cast<const char*>(cgram + value * 8), 8);
+  }
+
+private:
+  uint8_t m_address;
+  bool m_cgram;
+  uint8_t m_previous;
+  int m_half;
+  uint8_t m_high;
+
+  void latch(uint8_t value, bool data) {
+    if (data) {
+      if (m_cgram) {
+        cgram[m_address & 0x3F] = value;
+        cgramWrites++;
+      } else {
+        ddram[m_address & 0x7F] = value;
+      }
+      m_address++;
+    } else if (value & 0x80) {
+      m_address = value & 0x7F;
+      m_cgram = false;
+    } else if (value & 0x40) {
+      m_address = value & 0x3F;
+      m_cgram = true;
+    } else if (value == 0x01) {
+      memset(ddram, LCD_CHAR_BLANK, sizeof(ddram));
+      m_address = 0;
+      m_cgram = false;
+    }
+  }
+};
+
+class ModelBus : public LcdBus {
+public:
+  Hd44780& lcd;
+
+  explicit ModelBus(Hd44780& model) : lcd(model) {}
+
+  bool write(uint8_t address, const uint8_t* data, size_t len) override {
+    CHECK_EQ(address, 0x27);
+    lcd.feed(data, len);
+    return true;
+  }
+  size_t maxTransfer() const override { return 32; }
+  uint32_t byteTimeNs() const override { return 22500; }
+};
+
+static std::string s_patterns[GLYPH_COUNT];
+
+static std::string glyphLook(GlyphId glyph) {
+  return s_patterns[glyph];
+}
+
+/**
+ * A manager on a cols x rows screen, with what each cell should show: the
+ * glyph's pattern, its fallback character, text, or blank once the blank
+ * observer reported the cell
+ */
+struct Rig {
+  Hd44780 lcd;
+  ModelBus bus;
+  LcdTransport transport;
+  GlyphManager glyphs;
+  uint8_t cols, rows;
+  std::vector<std::string> intended;
+  int blanked;
+  int placed;
+
+  Rig(uint8_t c, uint8_t r)
+    : bus(lcd), transport(bus, 0x27), glyphs(transport, c, r), cols(c), rows(r),
+      intended(c * r, std::string(1, ' ')), blanked(0), placed(0) {
+    glyphs.setBlankObserver(&Rig::onBlank, this);
+  }
+
+  static void onBlank(void* context, uint8_t col, uint8_t row) {
+    Rig* rig = static_cast<Rig*>(context);
+    CHECK(col < rig->cols && row < rig->rows);
+    rig->intended[row * rig->cols + col] = std::string(1, ' ');
+    rig->blanked++;
+  }
+
+  bool place(GlyphId glyph, uint8_t col, uint8_t row) {
+    bool ok = glyphs.place(glyph, col, row);
+    transport.flush();
+    intended[row * cols + col] = ok ? glyphLook(glyph) : std::string(1, GlyphManager::fallbackChar(glyph));
+    if (ok) placed++;
+    return ok;
+  }
+
+  // Text within the row (past the end, DDRAM runs on into another row)
+  void text(const char* chars, uint8_t col, uint8_t row) {
+    size_t length = strlen(chars);
+    if (length > static_cast<size_t>(cols - col)) length = cols - col;
+    glyphs.releaseCells(col, row, static_cast<uint8_t>(length));
+    transport.setCursor(col, row);
+    transport.write(chars, length);
+    transport.flush();
+    for (size_t i = 0; i < length && col + i < cols; i++) intended[row * cols + col + i] = std::string(1, chars[i]);
+  }
+
+  void clear() {
+    transport.clear();
+    transport.flush();
+    glyphs.releaseAll();
+    for (size_t i = 0; i < intended.size(); i++) intended[i] = std::string(1, ' ');
+  }
+
+  bool screenAsIntended() const {
+    for (uint8_t row = 0; row < rows; row++) {
+      for (uint8_t col = 0; col < cols; col++) {
+        if (lcd.look(col, row) != intended[row * cols + col]) {
+          fprintf(stderr, "cell %u,%u differs\n", col, row);
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+// The patterns as uploaded, one glyph per fresh manager
+static void learnPatterns() {
+  for (int g = 0; g < GLYPH_COUNT; g++) {
+    Hd44780 lcd;
+    ModelBus bus(lcd);
+    LcdTransport transport(bus, 0x27);
+    GlyphManager glyphs(transport, 16, 2);
+    CHECK(glyphs.place(static_cast<GlyphId>(g), 0, 0));
+    transport.flush();
+    s_patterns[g] = lcd.look(0, 0);
+    CHECK_EQ(s_patterns[g].size(), 9);
+    for (int other = 0; other < g; other++) CHECK(s_patterns[other] != s_patterns[g]);
+  }
+}
+
+static void testUploads() {
+  Rig rig(16, 2);
+  rig.glyphs.beginFrame();
+  CHECK(rig.place(GLYPH_CHECK, 0, 0));
+  CHECK_EQ(rig.glyphs.getUploadCount(), 1);
+  CHECK_EQ(rig.lcd.cgramWrites, 8);
+
+  // Resident: the same slot, no CGRAM traffic, in this frame or later ones
+  CHECK(rig.place(GLYPH_CHECK, 1, 0));
+  rig.glyphs.beginFrame();
+  CHECK(rig.place(GLYPH_CHECK, 2, 1));
+  CHECK_EQ(rig.glyphs.getUploadCount(), 1);
+  CHECK_EQ(rig.glyphs.getHitCount(), 2);
+  CHECK_EQ(rig.lcd.cgramWrites, 8);
+  CHECK_EQ(rig.lcd.code(0, 0), rig.lcd.code(2, 1));
+
+  // Out-of-range requests touch nothing
+  CHECK(!rig.glyphs.place(GLYPH_CHECK, 16, 0));
+  CHECK(!rig.glyphs.place(GLYPH_CHECK, 0, 2));
+  CHECK(!rig.glyphs.place(GLYPH_COUNT, 0, 0));
+  CHECK_EQ(rig.glyphs.getHitCount(), 2);
+  CHECK(rig.screenAsIntended());
+
+  // After reset() CGRAM is unknown: the glyph is uploaded again
+  rig.glyphs.reset();
+  CHECK(rig.place(GLYPH_CHECK, 3, 0));
+  CHECK_EQ(rig.glyphs.getUploadCount(), 2);
+  CHECK_EQ(rig.lcd.cgramWrites, 16);
+}
+
+static void testLru() {
+  Rig rig(16, 2);
+  uint8_t slotOf[GLYPH_COUNT];
+
+  // Frame 1: glyphs 0-7 fill the slots, all on screen
+  rig.glyphs.beginFrame();
+  for (uint8_t g = 0; g < GlyphManager::SLOT_COUNT; g++) {
+    CHECK(rig.place(static_cast<GlyphId>(g), g, 0));
+    slotOf[g] = rig.lcd.code(g, 0);
+  }
+  CHECK_EQ(rig.glyphs.getUploadCount(), 8);
+
+  // Frame 2: text covers glyphs 2 and 5. Slots off screen go first, oldest first
+  rig.glyphs.beginFrame();
+  rig.text("x", 2, 0);
+  rig.text("y", 5, 0);
+  CHECK(rig.place(GLYPH_SPARK_5, 0, 1));
+  CHECK_EQ(rig.lcd.code(0, 1), slotOf[2]);
+  CHECK(rig.place(GLYPH_SPARK_6, 1, 1));
+  CHECK_EQ(rig.lcd.code(1, 1), slotOf[5]);
+  CHECK_EQ(rig.blanked, 0);
+
+  // Then the least recently used slot on screen; its cell is blanked
+  CHECK(rig.place(GLYPH_SPARK_7, 2, 1));
+  CHECK_EQ(rig.lcd.code(2, 1), slotOf[0]);
+  CHECK_EQ(rig.blanked, 1);
+  CHECK(rig.place(GLYPH_CHECK, 3, 1));
+  CHECK_EQ(rig.lcd.code(3, 1), slotOf[1]);
+  CHECK_EQ(rig.blanked, 2);
+  CHECK_EQ(rig.glyphs.getEvictionCount(), 4);
+  CHECK(rig.screenAsIntended());
+
+  // Frame 3: a hit on glyph 3 makes it the most recent and pins it
+  rig.glyphs.beginFrame();
+  CHECK(rig.place(static_cast<GlyphId>(3), 4, 1));
+  CHECK(rig.place(GLYPH_ARROW_UP, 5, 1));
+  CHECK_EQ(rig.lcd.code(5, 1), slotOf[4]);
+  CHECK(rig.place(GLYPH_ARROW_DOWN, 6, 1));
+  CHECK_EQ(rig.lcd.code(6, 1), slotOf[6]);
+  CHECK(rig.place(GLYPH_ARROW_RIGHT, 7, 1));
+  CHECK_EQ(rig.lcd.code(7, 1), slotOf[7]);
+  CHECK(rig.place(static_cast<GlyphId>(0), 8, 1));
+  CHECK_EQ(rig.lcd.code(8, 1), slotOf[2]);     // SPARK_5, placed first in frame 2
+  CHECK_EQ(rig.blanked, 6);
+  CHECK(rig.screenAsIntended());
+}
+
+static void testPinned() {
+  Rig rig(16, 2);
+
+  // A slot used this frame is pinned even after text covered its cell
+  rig.glyphs.beginFrame();
+  CHECK(rig.place(static_cast<GlyphId>(0), 0, 0));
+  rig.text("a", 0, 0);
+  for (uint8_t g = 1; g < GlyphManager::SLOT_COUNT; g++) CHECK(rig.place(static_cast<GlyphId>(g), g, 0));
+
+  // Every slot pinned: the fallback character, nothing evicted
+  CHECK(!rig.place(GLYPH_CHECK, 8, 0));
+  CHECK(!rig.place(GLYPH_ARROW_UP, 9, 0));
+  CHECK_EQ(rig.lcd.code(8, 0), GlyphManager::fallbackChar(GLYPH_CHECK));
+  CHECK_EQ(rig.glyphs.getEvictionCount(), 0);
+  CHECK_EQ(rig.glyphs.getUploadCount(), 8);
+  CHECK(rig.screenAsIntended());
+
+  // The next frame may evict again, the off-screen slot first
+  rig.glyphs.beginFrame();
+  CHECK(rig.place(GLYPH_CHECK, 8, 0));
+  CHECK_EQ(rig.glyphs.getEvictionCount(), 1);
+  CHECK_EQ(rig.blanked, 0);
+  CHECK(rig.screenAsIntended());
+}
+
+static void testRandom() {
+  static const uint8_t SIZES[][2] = { { 16, 2 }, { 20, 4 } };
+  srand(7);
+  for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+    Rig rig(SIZES[s][0], SIZES[s][1]);
+    int fallbacks = 0;
+    for (int op = 0; op < 4000; op++) {
+      uint8_t col = static_cast<uint8_t>(rand() % rig.cols);
+      uint8_t row = static_cast<uint8_t>(rand() % rig.rows);
+      int kind = rand() % 40;
+      if (kind < 4) {
+        rig.glyphs.beginFrame();
+      } else if (kind < 30) {
+        if (!rig.place(static_cast<GlyphId>(rand() % GLYPH_COUNT), col, row)) fallbacks++;
+      } else if (kind < 39) {
+        char chars[6] = "abcde";
+        chars[1 + rand() % 4] = '\0';
+        rig.text(chars, col, row);
+      } else {
+        rig.clear();
+      }
+      if (!rig.screenAsIntended()) {
+        CHECK(false);
+        break;
+      }
+    }
+    CHECK(fallbacks > 0);
+    CHECK(rig.blanked > 0);
+    CHECK_EQ(rig.glyphs.getHitCount() + rig.glyphs.getUploadCount(), static_cast<uint32_t>(rig.placed));
+    CHECK_EQ(rig.lcd.cgramWrites, 8 * rig.glyphs.getUploadCount());
+    CHECK(rig.glyphs.getEvictionCount() + GlyphManager::SLOT_COUNT >= rig.glyphs.getUploadCount());
+  }
+}
+
+// ---- SimpleLCD: the shadow a sleep snapshot restores ----
+
+template <uint8_t C, uint8_t R>
+static bool shadowMatchesScreen(const SimpleLCDPanel<C, R>& panel, Hd44780& lcd) {
+  lcd.feed(Wire.bytes.data(), Wire.bytes.size());
+  Wire.bytes.clear();
+  char frame[R][C];
+  panel.copyFrame(frame);
+  for (uint8_t row = 0; row < R; row++) {
+    for (uint8_t col = 0; col < C; col++) {
+      std::string look = lcd.look(col, row);
+      char expected = look[0];
+      if (look.size() > 1) {
+        // A glyph cell is shadowed by the glyph's stand-in
+        expected = '?';
+        for (int g = 0; g < GLYPH_COUNT; g++) {
+          if (look == s_patterns[g]) expected = GlyphManager::fallbackChar(static_cast<GlyphId>(g));
+        }
+      }
+      if (frame[row][col] != expected) {
+        fprintf(stderr, "shadow %u,%u is '%c', screen shows '%c'\n", col, row, frame[row][col], expected);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <uint8_t C, uint8_t R>
+static void testPanel(unsigned seed) {
+  Wire.bytes.clear();
+  Hd44780 lcd;
+  SimpleLCDPanel<C, R> panel;
+  panel.clear();
+
+  // Seven sparkline steps and a check fill the slots in one frame
+  static const uint8_t LEVELS[] = { 1, 2, 3, 4, 5, 6, 7 };
+  panel.beginFrame();
+  panel.printSparkline(0, 0, LEVELS, 7);
+  panel.printGlyph(GLYPH_CHECK, 8, 0);
+  CHECK(shadowMatchesScreen(panel, lcd));
+
+  // A bar cell next frame evicts the oldest step; its cell is blank on screen and in the shadow
+  panel.beginFrame();
+  panel.printBar(0, R - 1, 3, 7, 15);
+  CHECK(shadowMatchesScreen(panel, lcd));
+  CHECK_EQ(lcd.code(0, 0), LCD_CHAR_BLANK);
+  CHECK_EQ(panel.glyphs().getEvictionCount(), 1);
+
+  // Random frames of text, bars and sparklines
+  srand(seed);
+  for (int op = 0; op < 1500; op++) {
+    uint8_t col = static_cast<uint8_t>(rand() % C);
+    uint8_t row = static_cast<uint8_t>(rand() % R);
+    switch (rand() % 8) {
+      case 0:
+        panel.beginFrame();
+        break;
+      case 1:
+        panel.print("ok", col < C - 2 ? col : C - 2, row);
+        break;
+      case 2:
+        panel.printBar(col, row, static_cast<uint8_t>(1 + rand() % 5), rand() % 100, 100);
+        break;
+      case 3:
+      case 4: {
+        uint8_t levels[6];
+        for (int i = 0; i < 6; i++) levels[i] = static_cast<uint8_t>(rand() % 9);
+        panel.printSparkline(col, row, levels, 6);
+        break;
+      }
+      case 5:
+        panel.printGlyph(static_cast<GlyphId>(GLYPH_CHECK + rand() % 4), col, row);
+        break;
+      case 6:
+        panel.printPadded("line", col, row);
+        break;
+      default:
+        if (rand() % 20 == 0) panel.clear();
+        break;
+    }
+    if (!shadowMatchesScreen(panel, lcd)) {
+      CHECK(false);
+      break;
+    }
+  }
+  CHECK(panel.glyphs().getEvictionCount() > 10);
+}
+
+int main() {
+  learnPatterns();
+  testUploads();
+  testLru();
+  testPinned();
+  testRandom();
+  testPanel<16, 2>(11);
+  testPanel<20, 4>(12);
+  return hostTestResult("test_glyph_manager");
+}
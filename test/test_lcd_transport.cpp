@@ -0,0 +1,201 @@
+/*
+ * LcdTransport against a mock I2C bus that counts transactions and decodes
+ * the PCF8574 byte stream the way an HD44780 in 4-bit mode latches it.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -Wall -Wextra -I../src test_lcd_transport.cpp -o test_lcd_transport
+ */
+#include <string.h>
+#include <vector>
+
+#include "HostTest.h"
+#include "LcdTransport.h"
+
+// One instruction or character as the controller received it
+struct Latched {
+  uint8_t value;
+  bool data;            // RS high
+  uint64_t busNs;       // Bus time until the next nibble is latched
+};
+
+/**
+ * Records every byte written and replays them through an HD44780 model:
+ * a nibble is taken on the falling edge of EN, two nibbles make a byte.
+ */
+class MockBus : public LcdBus {
+public:
+  MockBus(uint32_t byteNs, size_t maxTransfer)
+    : m_byteNs(byteNs), m_maxTransfer(maxTransfer), m_transactions(0), m_fail(false) {}
+
+  bool write(uint8_t address, const uint8_t* data, size_t len) override {
+    CHECK_EQ(address, 0x27);
+    CHECK(len <= m_maxTransfer);
+    m_transactions++;
+    m_bytes.insert(m_bytes.end(), data, data + len);
+    return !m_fail;
+  }
+
+  size_t maxTransfer() const override { return m_maxTransfer; }
+  uint32_t byteTimeNs() const override { return m_byteNs; }
+
+  // Latched instructions, after resetNibbles lone nibbles of the 8-bit reset
+  std::vector<Latched> decode(size_t resetNibbles = 0) const {
+    std::vector<Latched> out;
+    uint8_t previous = 0;
+    int half = 0;
+    uint8_t high = 0;
+    uint64_t sinceLatch = 0;
+    for (size_t i = 0; i < m_bytes.size(); i++) {
+      uint8_t byte = m_bytes[i];
+      sinceLatch += m_byteNs;
+      if ((previous & LCD_PCF_EN) && !(byte & LCD_PCF_EN)) {
+        uint8_t nibble = previous & 0xF0;
+        // The wait after an instruction lasts until the next nibble is taken
+        if (!out.empty() && (half == 0 || resetNibbles > 0)) out.back().busNs = sinceLatch;
+        if (resetNibbles > 0) {
+          resetNibbles--;
+          Latched latched = { nibble, false, 0 };
+          out.push_back(latched);
+          sinceLatch = 0;
+        } else if (half == 0) {
+          high = nibble;
+          half = 1;
+        } else {
+          Latched latched = { static_cast<uint8_t>(high | (nibble >> 4)), (previous & LCD_PCF_RS) != 0, 0 };
+          out.push_back(latched);
+          half = 0;
+          sinceLatch = 0;
+        }
+      }
+      previous = byte;
+    }
+    CHECK_EQ(half, 0);
+    return out;
+  }
+
+  uint32_t m_byteNs;
+  size_t m_maxTransfer;
+  uint32_t m_transactions;
+  bool m_fail;
+  std::vector<uint8_t> m_bytes;
+};
+
+// 100 kHz and 400 kHz: 9 clocks per byte
+static const uint32_t BYTE_NS_100K = 90000;
+static const uint32_t BYTE_NS_400K = 22500;
+
+static void testLineIsOneTransaction(uint32_t byteNs, size_t expectedBytes) {
+  MockBus bus(byteNs, 128);
+  LcdTransport lcd(bus, 0x27);
+  lcd.setCursor(0, 1);
+  lcd.write("0123456789ABCDEF");
+  CHECK(lcd.flush());
+
+  // LiquidCrystal_I2C needs 6 transactions per instruction for the same line
+  CHECK_EQ(bus.m_transactions, 1);
+  CHECK_EQ(bus.m_bytes.size(), expectedBytes);
+  CHECK_EQ(lcd.getTransactionCount(), 1);
+  CHECK_EQ(lcd.getBytesSent(), expectedBytes);
+
+  std::vector<Latched> latched = bus.decode();
+  CHECK_EQ(latched.size(), 17);
+  if (latched.size() != 17) return;
+  CHECK_EQ(latched[0].value, 0x80 | 0x40);
+  CHECK(!latched[0].data);
+  for (int i = 0; i < 16; i++) {
+    CHECK_EQ(latched[i + 1].value, "0123456789ABCDEF"[i]);
+    CHECK(latched[i + 1].data);
+  }
+  // Every instruction but the last is followed by at least its execution time
+  for (size_t i = 0; i + 1 < latched.size(); i++) {
+    CHECK(latched[i].busNs >= LCD_EXEC_TIME_US * 1000ull);
+  }
+}
+
+static void testClearIsPadded(uint32_t byteNs) {
+  MockBus bus(byteNs, 128);
+  LcdTransport lcd(bus, 0x27);
+  lcd.clear();
+  lcd.data('x');
+  CHECK(lcd.flush());
+
+  std::vector<Latched> latched = bus.decode();
+  CHECK_EQ(latched.size(), 2);
+  if (latched.size() != 2) return;
+  CHECK_EQ(latched[0].value, 0x01);
+  CHECK(latched[0].busNs >= LCD_CLEAR_TIME_US * 1000ull);
+  // Padded by no more than the two bytes that carry the next nibble
+  CHECK(latched[0].busNs <= LCD_CLEAR_TIME_US * 1000ull + 2ull * byteNs);
+}
+
+static void testChunksAtMaxTransfer() {
+  MockBus whole(BYTE_NS_400K, 128);
+  MockBus chunked(BYTE_NS_400K, 32);
+  LcdTransport a(whole, 0x27);
+  LcdTransport b(chunked, 0x27);
+  const char* text = "The quick brown fox jumps";
+  a.write(text);
+  b.write(text);
+  CHECK(a.flush());
+  CHECK(b.flush());
+
+  // Same stream, split at the bus limit
+  CHECK(whole.m_bytes == chunked.m_bytes);
+  CHECK_EQ(chunked.m_transactions, (chunked.m_bytes.size() + 31) / 32);
+  CHECK_EQ(chunked.decode().size(), strlen(text));
+}
+
+static void testBacklightAndReset() {
+  MockBus bus(BYTE_NS_100K, 128);
+  LcdTransport lcd(bus, 0x27);
+  lcd.setBacklight(true);
+  lcd.nibble(0x30, 4100);
+  lcd.nibble(0x20, LCD_EXEC_TIME_US);
+  lcd.command(0x28);
+  lcd.flush();
+  for (size_t i = 0; i < bus.m_bytes.size(); i++) {
+    CHECK(bus.m_bytes[i] & LCD_PCF_BACKLIGHT);
+  }
+
+  // The 8-bit reset nibbles latch alone and keep their 4.1 ms wait
+  std::vector<Latched> latched = bus.decode(2);
+  CHECK_EQ(latched.size(), 3);
+  if (latched.size() == 3) {
+    CHECK_EQ(latched[0].value, 0x30);
+    CHECK(latched[0].busNs >= 4100000ull);
+    CHECK_EQ(latched[1].value, 0x20);
+    CHECK_EQ(latched[2].value, 0x28);
+  }
+
+  size_t before = bus.m_bytes.size();
+  lcd.setBacklight(false);
+  lcd.flush();
+  CHECK_EQ(bus.m_bytes.size(), before + 1);
+  CHECK_EQ(bus.m_bytes.back() & LCD_PCF_BACKLIGHT, 0);
+  CHECK(!lcd.isBacklightOn());
+}
+
+static void testNakIsCounted() {
+  MockBus bus(BYTE_NS_100K, 128);
+  LcdTransport lcd(bus, 0x27);
+  bus.m_fail = true;
+  lcd.write("x");
+  CHECK(!lcd.flush());
+  CHECK_EQ(lcd.getErrorCount(), 1);
+
+  // Nothing queued: no transaction
+  CHECK(lcd.flush());
+  CHECK_EQ(bus.m_transactions, 1);
+}
+
+int main() {
+  // 4 bytes per instruction at 100 kHz; one idle byte more at 400 kHz
+  testLineIsOneTransaction(BYTE_NS_100K, 17 * 4);
+  testLineIsOneTransaction(BYTE_NS_400K, 17 * 5);
+  testClearIsPadded(BYTE_NS_100K);
+  testClearIsPadded(BYTE_NS_400K);
+  testChunksAtMaxTransfer();
+  testBacklightAndReset();
+  testNakIsCounted();
+  return hostTestResult("test_lcd_transport");
+}
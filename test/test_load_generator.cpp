@@ -0,0 +1,357 @@
+/*
+ * LoadGenerator on a simulated clock: LatencyHistogram percentiles against
+ * the exact ones of the same samples (random spreads, bucket edges, the full
+ * 32-bit range, empty), events posted and dropped for sustained, burst and
+ * random-walk profiles, latency fed back through recordHandled(), runs that
+ * cross the microsecond clock's wrap, re-arming, the longest run allowed
+ * (an hour, across the wrap) and longer ones refused, and the one-line report.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_load_generator.cpp ../src/LoadGenerator.cpp ../src/Coroutine.cpp -o test_load_generator
+ */
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "HostTest.h"
+#include "LoadGenerator.h"
+
+// The exact value the histogram estimates: the sample at rank ceil(n * p / 100)
+static uint32_t exactPercentile(std::vector<uint32_t> samples, uint8_t percent) {
+  std::sort(samples.begin(), samples.end());
+  size_t rank = (samples.size() * percent + 99) / 100;
+  if (rank == 0) rank = 1;
+  return samples[rank - 1];
+}
+
+static void checkHistogram(const std::vector<uint32_t>& samples) {
+  LatencyHistogram histogram;
+  for (size_t i = 0; i < samples.size(); i++) histogram.record(samples[i]);
+  CHECK_EQ(histogram.getCount(), samples.size());
+  CHECK_EQ(histogram.getMax(), *std::max_element(samples.begin(), samples.end()));
+
+  static const uint8_t PERCENTS[] = { 0, 1, 10, 50, 90, 99, 100 };
+  uint32_t previous = 0;
+  for (size_t p = 0; p < sizeof(PERCENTS) / sizeof(PERCENTS[0]); p++) {
+    uint32_t exact = exactPercentile(samples, PERCENTS[p]);
+    uint32_t estimate = histogram.percentile(PERCENTS[p]);
+
+    // Never below the exact value, over by at most a quarter of it
+    uint64_t bound = static_cast<uint64_t>(exact) + exact / LatencyHistogram::SUB_BUCKETS + 1;
+    if (estimate < exact || estimate > bound) {
+      fprintf(stderr, "p%u of %u samples: %u, exact %u\n", PERCENTS[p], (unsigned)samples.size(),
+              (unsigned)estimate, (unsigned)exact);
+      CHECK(estimate >= exact && estimate <= bound);
+    }
+    CHECK(estimate >= previous);
+    previous = estimate;
+  }
+  CHECK_EQ(histogram.percentile(100), histogram.getMax());
+  CHECK_EQ(histogram.percentile(200), histogram.getMax());
+}
+
+static void testHistogram() {
+  LatencyHistogram empty;
+  CHECK_EQ(empty.percentile(50), 0);
+  CHECK_EQ(empty.getCount(), 0);
+
+  // Log-normal spreads around 10 us .. 100 ms, as queueing latencies look
+  srand(11);
+  for (int run = 0; run < 200; run++) {
+    std::vector<uint32_t> samples;
+    double median = pow(10.0, 1 + run % 5);
+    size_t count = 1 + rand() % 2000;
+    for (size_t i = 0; i < count; i++) {
+      double u1 = (rand() + 1.0) / (RAND_MAX + 2.0), u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+      double normal = sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+      samples.push_back(static_cast<uint32_t>(median * exp(normal)));
+    }
+    checkHistogram(samples);
+  }
+
+  // Every bucket edge: each power of two and the values around its quarters
+  std::vector<uint32_t> edges;
+  for (uint32_t v = 0; v < 16; v++) edges.push_back(v);
+  for (int exponent = 2; exponent < 32; exponent++) {
+    for (uint32_t quarter = 4; quarter < 8; quarter++) {
+      uint64_t start = static_cast<uint64_t>(quarter) << (exponent - 2);
+      edges.push_back(static_cast<uint32_t>(start - 1));
+      edges.push_back(static_cast<uint32_t>(start));
+    }
+  }
+  edges.push_back(0xFFFFFFFFu);
+  for (size_t i = 0; i < edges.size(); i++) checkHistogram(std::vector<uint32_t>(1, edges[i]));
+  checkHistogram(edges);
+
+  // reset() forgets everything
+  LatencyHistogram histogram;
+  histogram.record(0xFFFFFFFFu);
+  histogram.reset();
+  histogram.record(7);
+  CHECK_EQ(histogram.getMax(), 7);
+  CHECK_EQ(histogram.percentile(100), 7);
+}
+
+// ---- Generator on a simulated clock ----
+
+static uint32_t fakeUs;
+
+static uint32_t fakeMicros() {
+  return fakeUs;
+}
+
+// A consumer with a bounded queue, drained every drainMs
+struct Sink {
+  std::vector<std::pair<int, uint32_t> > queue;
+  std::vector<int> events;
+  size_t capacity;
+
+  explicit Sink(size_t queueCapacity) : capacity(queueCapacity) {}
+
+  static bool post(void* context, int event, uint32_t postedUs) {
+    Sink* self = static_cast<Sink*>(context);
+    self->events.push_back(event);
+    if (self->queue.size() >= self->capacity) return false;
+    self->queue.push_back(std::make_pair(event, postedUs));
+    return true;
+  }
+
+  void drain(LoadGenerator& load) {
+    for (size_t i = 0; i < queue.size(); i++) load.recordHandled(queue[i].second);
+    queue.clear();
+  }
+};
+
+static const int MIX[] = { 10, 20, 30, 40 };
+
+/**
+ * Runs the executor every millisecond from startUs until the generator
+ * finishes; the sink is drained every drainMs, each event taking
+ * latencyUs from post to handled.
+ */
+static void run(LoadGenerator& load, Sink& sink, uint32_t startUs, uint32_t drainMs, uint32_t latencyUs) {
+  CoExecutor executor;
+  executor.spawn(load);
+  fakeUs = startUs;
+  for (uint32_t ms = 0; !load.isFinished() && ms < 100000; ms++) {
+    fakeUs = startUs + ms * 1000;
+    executor.runOnce(startUs / 1000 + ms);
+    if (ms % drainMs == drainMs - 1) {
+      fakeUs += latencyUs;
+      sink.drain(load);
+    }
+  }
+  fakeUs += latencyUs;
+  sink.drain(load);
+  CHECK(load.isFinished());
+  CHECK_EQ(executor.getCoroutineCount(), 0);
+}
+
+static void testSustained() {
+  LoadGenerator load(fakeMicros);
+  CHECK(load.setEventMix(MIX, 4));
+  LoadProfile profile;
+  profile.rateHz = 2000;
+  profile.durationMs = 500;
+  Sink sink(1000);
+  CHECK(load.begin(profile, Sink::post, &sink));
+  CHECK(!load.begin(profile, Sink::post, &sink));     // Already armed
+  run(load, sink, 5000000, 10, 300);
+
+  // The rate holds to the last millisecond; two events per executor pass
+  LoadReport report;
+  load.getReport(report);
+  CHECK_EQ(report.posted, 2000 * 499 / 1000);
+  CHECK_EQ(report.dropped, 0);
+  CHECK_EQ(report.handled, report.posted);
+  CHECK_EQ(report.elapsedMs, 500);
+  CHECK_EQ(sink.events.size(), report.posted);
+
+  // Alternating the first two codes only
+  for (size_t i = 0; i < sink.events.size(); i++) {
+    CHECK(sink.events[i] == 10 || sink.events[i] == 20);
+    if (i > 0) CHECK(sink.events[i] != sink.events[i - 1]);
+  }
+
+  // Each event waited for the next drain (up to 10 ms) plus the handling time
+  CHECK(report.latencyP50Us >= 300 && report.latencyP50Us <= 10300);
+  CHECK(report.latencyMaxUs >= 9300 && report.latencyMaxUs <= 10300);
+  CHECK(report.latencyP99Us <= report.latencyMaxUs);
+}
+
+static void testBurstDrops() {
+  LoadGenerator load(fakeMicros);
+  CHECK(load.setEventMix(MIX, 2));
+  LoadProfile profile;
+  profile.pattern = LOAD_BURST;
+  profile.burstSize = 25;
+  profile.burstPeriodMs = 100;
+  profile.durationMs = 1000;
+  Sink sink(10);
+  CHECK(load.begin(profile, Sink::post, &sink));
+
+  // Starting 300 ms before the microsecond clock wraps
+  run(load, sink, 0xFFFFFFFFu - 300000, 50, 0);
+
+  // One burst at the start of each period; the 10-slot queue keeps 10 of 25
+  LoadReport report;
+  load.getReport(report);
+  CHECK_EQ(report.posted, 10 * 25);
+  CHECK_EQ(report.dropped, 10 * 15);
+  CHECK_EQ(report.handled, 10 * 10);
+  CHECK_EQ(report.elapsedMs, 1000);
+
+  // Re-armed after it finished, with a fresh report
+  Sink quiet(100);
+  profile.burstSize = 5;
+  CHECK(load.begin(profile, Sink::post, &quiet));
+  load.getReport(report);
+  CHECK_EQ(report.posted, 0);
+  CHECK_EQ(report.latencyMaxUs, 0);
+  run(load, quiet, 1000, 100, 0);
+  load.getReport(report);
+  CHECK_EQ(report.posted, 50);
+  CHECK_EQ(report.dropped, 0);
+}
+
+static void testRandomWalk() {
+  LoadProfile profile;
+  profile.pattern = LOAD_RANDOM_WALK;
+  profile.rateHz = 1000;
+  profile.durationMs = 400;
+  profile.seed = 42;
+
+  std::vector<int> first;
+  for (int repeat = 0; repeat < 2; repeat++) {
+    LoadGenerator load(fakeMicros);
+    CHECK(load.setEventMix(MIX, 4));
+    Sink sink(1000);
+    CHECK(load.begin(profile, Sink::post, &sink));
+    run(load, sink, 0, 1, 0);
+    CHECK_EQ(sink.events.size(), 399);
+
+    // Every code of the mix turns up, none more than twice its share
+    int counts[4] = { 0 };
+    for (size_t i = 0; i < sink.events.size(); i++) {
+      int code = sink.events[i] / 10 - 1;
+      CHECK(code >= 0 && code < 4);
+      if (code >= 0 && code < 4) counts[code]++;
+    }
+    for (int c = 0; c < 4; c++) CHECK(counts[c] > 0 && counts[c] < 200);
+
+    // The same seed gives the same walk
+    if (repeat == 0) {
+      first = sink.events;
+    } else {
+      CHECK(sink.events == first);
+    }
+  }
+}
+
+static void testLongRun() {
+  LoadGenerator load(fakeMicros);
+  CHECK(load.setEventMix(MIX, 2));
+  Sink sink(10);
+  LoadProfile profile;
+  profile.rateHz = 1;
+
+  // Past 71 minutes the run could not be timed on the microsecond clock
+  profile.durationMs = LoadGenerator::MAX_DURATION_MS + 1;
+  CHECK(!load.begin(profile, Sink::post, &sink));
+  profile.durationMs = 0xFFFFFFFFu;
+  CHECK(!load.begin(profile, Sink::post, &sink));
+  profile.pattern = LOAD_BURST;
+  profile.durationMs = 1000;
+  profile.burstPeriodMs = LoadGenerator::MAX_DURATION_MS + 1;
+  CHECK(!load.begin(profile, Sink::post, &sink));
+
+  // The longest run lasts its full hour, starting ten minutes before the wrap
+  profile.pattern = LOAD_SUSTAINED;
+  profile.durationMs = LoadGenerator::MAX_DURATION_MS;
+  CHECK(load.begin(profile, Sink::post, &sink));
+  CoExecutor executor;
+  executor.spawn(load);
+  uint32_t startUs = 0xFFFFFFFFu - 600000000u;
+  for (uint32_t ms = 0; !load.isFinished() && ms < 2 * LoadGenerator::MAX_DURATION_MS; ms += 250) {
+    fakeUs = startUs + ms * 1000;
+    executor.runOnce(ms);
+    sink.drain(load);
+  }
+  CHECK(load.isFinished());
+  LoadReport report;
+  load.getReport(report);
+  CHECK(report.elapsedMs >= LoadGenerator::MAX_DURATION_MS && report.elapsedMs < LoadGenerator::MAX_DURATION_MS + 1000);
+  CHECK_EQ(report.posted, LoadGenerator::MAX_DURATION_MS / 1000 - 1);
+  CHECK_EQ(report.handled, report.posted);
+}
+
+static void testBadInput() {
+  LoadGenerator load(fakeMicros);
+  Sink sink(10);
+  LoadProfile profile;
+  CHECK(!load.begin(profile, Sink::post, &sink));     // No event mix yet
+  CHECK(!load.setEventMix(MIX, 0));
+  int many[LoadGenerator::MAX_EVENT_MIX + 1] = { 0 };
+  CHECK(!load.setEventMix(many, LoadGenerator::MAX_EVENT_MIX + 1));
+  CHECK(load.setEventMix(MIX, 1));
+  CHECK(!load.begin(profile, nullptr, &sink));
+
+  profile.rateHz = 0;
+  CHECK(!load.begin(profile, Sink::post, &sink));
+  profile.pattern = LOAD_BURST;
+  profile.burstPeriodMs = 0;
+  CHECK(!load.begin(profile, Sink::post, &sink));
+  profile.burstPeriodMs = 100;
+  profile.burstSize = 0;
+  CHECK(!load.begin(profile, Sink::post, &sink));
+
+  // Nothing armed: an empty report
+  LoadReport report;
+  load.getReport(report);
+  CHECK_EQ(report.elapsedMs, 0);
+  CHECK_EQ(report.latencyP50Us, 0);
+}
+
+static void testFormat() {
+  LoadReport report;
+  report.elapsedMs = 2000;
+  report.posted = 1000;
+  report.handled = 900;
+  report.dropped = 100;
+  report.frames = 8;
+  report.queueHighWater = 10;
+  report.queueCapacity = 10;
+  report.latencyP50Us = 120;
+  report.latencyP90Us = 900;
+  report.latencyP99Us = 4000;
+  report.latencyMaxUs = 5100;
+
+  char line[256];
+  int length = report.format(line, sizeof(line));
+  CHECK_EQ(length, (int)strlen(line));
+  CHECK(strcmp(line, "Load: 1000 posted, 900 handled (450/s), 100 dropped, queue high-water 10/10, "
+                     "8 frames in 2000 ms, latency p50/p90/p99/max 120/900/4000/5100 us") == 0);
+
+  // Truncated like snprintf, still reporting the full length
+  char shortLine[16];
+  CHECK_EQ(report.format(shortLine, sizeof(shortLine)), length);
+  CHECK_EQ(strlen(shortLine), sizeof(shortLine) - 1);
+
+  // No time elapsed: no rate rather than a division by zero
+  report.clear();
+  CHECK(report.format(line, sizeof(line)) > 0);
+  CHECK(strstr(line, "(0/s)") != nullptr);
+}
+
+int main() {
+  testHistogram();
+  testSustained();
+  testBurstDrops();
+  testRandomWalk();
+  testLongRun();
+  testBadInput();
+  testFormat();
+  return hostTestResult("test_load_generator");
+}
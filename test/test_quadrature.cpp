@@ -0,0 +1,321 @@
+/*
+ * QuadratureDecoder on synthetic A/B traces: contact bounce shorter than the
+ * glitch filter never reaches the count, bounce that gets through still nets
+ * out, samples where both inputs changed are counted as missed and recovered
+ * by DetentAccumulator::settle() at rest, and quadratureCounterDelta() across
+ * the PCNT counter's wrap at +/-limit, end to end with periodic scans, and
+ * quadratureSelectSlot() moving one occupied slot per detent of a
+ * multi-detent scan in either direction.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_quadrature.cpp -o test_quadrature
+ */
+#include <stdlib.h>
+#include <vector>
+
+#include "HostTest.h"
+#include "QuadratureDecoder.h"
+
+// A/B levels (A in bit 1) one step apart, counting up from the detent at 11
+static const uint8_t PHASES[4] = { 3, 1, 0, 2 };
+
+struct Trace {
+  std::vector<uint8_t> samples;
+  int phase;
+
+  Trace() : phase(0) {}
+
+  void hold(int count) {
+    for (int i = 0; i < count; i++) samples.push_back(PHASES[phase]);
+  }
+
+  /**
+   * Moves steps (signed), holding each position for holdSamples. Before
+   * each edge the contact bounces: bounces pulses of bounceSamples on the
+   * new level, separated by the old level for the same time.
+   */
+  void move(int steps, int holdSamples, int bounces = 0, int bounceSamples = 1) {
+    int direction = steps > 0 ? 1 : 3;
+    for (int s = 0; s < abs(steps); s++) {
+      int next = (phase + direction) % 4;
+      for (int b = 0; b < bounces; b++) {
+        for (int i = 0; i < bounceSamples; i++) samples.push_back(PHASES[next]);
+        for (int i = 0; i < bounceSamples; i++) samples.push_back(PHASES[phase]);
+      }
+      phase = next;
+      hold(holdSamples);
+    }
+  }
+};
+
+struct Decoded {
+  int steps;
+  int reversals;    // Steps against the direction of the previous one
+};
+
+static Decoded decode(QuadratureDecoder& decoder, const Trace& trace) {
+  Decoded result = { 0, 0 };
+  int last = 0;
+  for (size_t i = 0; i < trace.samples.size(); i++) {
+    uint8_t levels = trace.samples[i];
+    int step = decoder.sample((levels & 2) != 0, (levels & 1) != 0);
+    if (step != 0 && last != 0 && step != last) result.reversals++;
+    if (step != 0) last = step;
+    result.steps += step;
+  }
+  return result;
+}
+
+static void testBounce() {
+  for (int filter = 0; filter <= 4; filter++) {
+    for (int width = 1; width <= 3; width++) {
+      // Ten detents up, three down, each edge bouncing three times
+      Trace trace;
+      trace.hold(10);
+      trace.move(40, filter + 3, 3, width);
+      trace.move(-12, filter + 3, 3, width);
+
+      QuadratureDecoder decoder(static_cast<uint8_t>(filter));
+      Decoded decoded = decode(decoder, trace);
+      CHECK_EQ(decoded.steps, 28);
+      CHECK_EQ(decoder.getMissedSteps(), 0);
+
+      // Pulses no longer than the filter never count; longer ones count
+      // both ways. Reversals beyond the one real change of direction are bounce.
+      if (width <= filter) {
+        CHECK_EQ(decoded.reversals, 1);
+      } else {
+        CHECK(decoded.reversals > 1);
+      }
+    }
+  }
+
+  // The filter delays an accepted edge by its length, and no more
+  QuadratureDecoder decoder(3);
+  CHECK_EQ(decoder.sample(false, true), 0);
+  CHECK_EQ(decoder.sample(false, true), 0);
+  CHECK_EQ(decoder.sample(false, true), 0);
+  CHECK_EQ(decoder.sample(false, true), 1);
+  CHECK_EQ(decoder.getState(), 1);
+}
+
+static void testDoubleEdges() {
+  // Both inputs changing between two samples cannot be decoded
+  QuadratureDecoder decoder;
+  CHECK_EQ(decoder.sample(false, false), 0);
+  CHECK_EQ(decoder.getMissedSteps(), 1);
+  CHECK_EQ(decoder.getState(), 0);
+  CHECK_EQ(decoder.sample(true, false), 1);     // Decoding resumes from there
+
+  // One double edge per detent (sampled too slowly): each detent decodes
+  // to two steps instead of four, and every miss is counted
+  Trace trace;
+  trace.hold(5);
+  int skipped = 0;
+  for (int d = 0; d < 6; d++) {
+    trace.move(1, 4);
+    trace.phase = (trace.phase + 2) % 4;      // Both inputs change at once
+    skipped++;
+    trace.hold(4);
+    trace.move(1, 4);
+    trace.hold(20);
+  }
+  QuadratureDecoder slow;
+  Decoded decoded = decode(slow, trace);
+  CHECK_EQ(slow.getMissedSteps(), skipped);
+  CHECK_EQ(decoded.steps, 6 * 2);
+
+  // At rest, settle() rounds a partial detent: 3 of 4 steps is a detent,
+  // 2 of 4 is ambiguous and dropped, and nothing carries into the next turn
+  DetentAccumulator detents;
+  CHECK_EQ(detents.add(3), 0);
+  CHECK_EQ(detents.settle(), 1);
+  CHECK_EQ(detents.getRemainder(), 0);
+  CHECK_EQ(detents.add(-3), 0);
+  CHECK_EQ(detents.settle(), -1);
+  CHECK_EQ(detents.add(2), 0);
+  CHECK_EQ(detents.settle(), 0);
+  CHECK_EQ(detents.add(9), 2);
+  CHECK_EQ(detents.settle(), 0);
+  CHECK_EQ(detents.add(-4), -1);
+}
+
+// The PCNT counter: counts steps and resets to zero on reaching +/-limit
+struct Counter {
+  int16_t value;
+  int16_t limit;
+
+  explicit Counter(int16_t counterLimit) : value(0), limit(counterLimit) {}
+
+  void step(int direction) {
+    value = static_cast<int16_t>(value + direction);
+    if (value >= limit || value <= -limit) value = 0;
+  }
+
+  // Many steps at once: each time the count reaches a limit it restarts at 0
+  void move(int steps) {
+    int direction = steps > 0 ? 1 : -1;
+    int left = abs(steps);
+    while (left > 0) {
+      int room = limit - direction * value;
+      if (left < room) {
+        value = static_cast<int16_t>(value + direction * left);
+        return;
+      }
+      left -= room;
+      value = 0;
+    }
+  }
+};
+
+static void testCounterWrap() {
+  static const int16_t LIMITS[] = { 40, 10000, 32767 };
+  srand(5);
+  for (size_t l = 0; l < sizeof(LIMITS) / sizeof(LIMITS[0]); l++) {
+    int16_t limit = LIMITS[l];
+    Counter counter(limit);
+    int64_t moved = 0, summed = 0;
+    for (int read = 0; read < 20000; read++) {
+      // Anything under limit/2 between two reads, often across the wrap
+      int steps = rand() % (limit / 2);
+      int direction = (rand() % 3 == 0) ? -1 : 1;
+      int16_t previous = counter.value;
+      Counter stepped = counter;
+      counter.move(direction * steps);
+      if (limit == 40) {
+        for (int s = 0; s < steps; s++) stepped.step(direction);
+        CHECK_EQ(stepped.value, counter.value);
+      }
+      int32_t delta = quadratureCounterDelta(counter.value, previous, limit);
+      CHECK_EQ(delta, direction * steps);
+      moved += direction * steps;
+      summed += delta;
+    }
+    CHECK_EQ(summed, moved);
+  }
+
+  // A fine grid of readings and moves at the RotaryEncoder's limit, edges included
+  static const int16_t LIMIT = 10000;
+  for (int previous = -LIMIT + 1; previous < LIMIT; previous += (abs(previous) > LIMIT - 20 ? 1 : 37)) {
+    for (int steps = -LIMIT / 2 + 1; steps < LIMIT / 2; steps += (abs(steps) > LIMIT / 2 - 20 ? 1 : 11)) {
+      Counter counter(LIMIT);
+      counter.value = static_cast<int16_t>(previous);
+      counter.move(steps);
+      CHECK_EQ(quadratureCounterDelta(counter.value, static_cast<int16_t>(previous), LIMIT), steps);
+    }
+  }
+}
+
+static void testEndToEnd() {
+  // A fast spin through a small counter: decoder -> wrapping counter ->
+  // scans every 40 samples -> detents, as RotaryEncoder::readDetents() does
+  Trace trace;
+  trace.hold(10);
+  trace.move(50 * 4, 3, 2, 1);
+  trace.move(-7 * 4, 3, 2, 1);
+  trace.move(2, 3);
+  trace.move(-2, 3);
+  trace.hold(50);
+
+  QuadratureDecoder decoder(1);
+  DetentAccumulator detents;
+  Counter counter(40);
+  int16_t last = 0;
+  int total = 0;
+  for (size_t i = 0; i < trace.samples.size(); i++) {
+    uint8_t levels = trace.samples[i];
+    int step = decoder.sample((levels & 2) != 0, (levels & 1) != 0);
+    if (step != 0) counter.step(step);
+    if (i % 40 == 39) {
+      total += detents.add(quadratureCounterDelta(counter.value, last, counter.limit));
+      last = counter.value;
+    }
+  }
+  total += detents.add(quadratureCounterDelta(counter.value, last, counter.limit));
+  total += detents.settle();
+  CHECK_EQ(total, 43);
+  CHECK_EQ(decoder.getMissedSteps(), 0);
+}
+
+// Sensor slots with readings, as a bit mask
+struct Occupancy {
+  unsigned mask;
+  bool operator()(int slot) const { return (mask >> slot) & 1; }
+};
+
+// The occupied slots in order; from an empty slot the first detent goes
+// to the nearest occupied one in the direction of the turn
+static int selectReference(int current, int detents, int count, unsigned mask) {
+  std::vector<int> occupied;
+  for (int slot = 0; slot < count; slot++) {
+    if ((mask >> slot) & 1) occupied.push_back(slot);
+  }
+  int n = static_cast<int>(occupied.size());
+  if (n == 0 || detents == 0) return current;
+  int index = -1;
+  for (int i = 0; i < n; i++) {
+    if (occupied[i] == current) index = i;
+  }
+  if (index < 0) {
+    if (detents > 0) {
+      index = 0;
+      while (index < n && occupied[index] < current) index++;
+      index %= n;
+      detents--;
+    } else {
+      index = n - 1;
+      while (index >= 0 && occupied[index] > current) index--;
+      index = (index + n) % n;
+      detents++;
+    }
+  }
+  return occupied[((index + detents) % n + n) % n];
+}
+
+static void testSelectSlot() {
+  // The graph's four sensor slots, readings in 0, 1 and 3
+  Occupancy three = { 0x0B };
+  CHECK_EQ(quadratureSelectSlot(0, 1, 4, three), 1);
+  CHECK_EQ(quadratureSelectSlot(0, 2, 4, three), 3);
+  CHECK_EQ(quadratureSelectSlot(0, 3, 4, three), 0);
+  CHECK_EQ(quadratureSelectSlot(0, -1, 4, three), 3);
+  CHECK_EQ(quadratureSelectSlot(0, -5, 4, three), 1);
+  CHECK_EQ(quadratureSelectSlot(1, -9, 4, three), 1);
+  CHECK_EQ(quadratureSelectSlot(1, 0, 4, three), 1);
+
+  // A turn of four detents over four slots lands four slots on, not in place
+  Occupancy all = { 0x0F };
+  CHECK_EQ(quadratureSelectSlot(2, 4, 4, all), 2);
+  CHECK_EQ(quadratureSelectSlot(2, 3, 4, all), 1);
+  CHECK_EQ(quadratureSelectSlot(2, -6, 4, all), 0);
+
+  // Nothing else to go to
+  Occupancy none = { 0 };
+  CHECK_EQ(quadratureSelectSlot(2, 7, 4, none), 2);
+  CHECK_EQ(quadratureSelectSlot(2, -7, 4, none), 2);
+  Occupancy own = { 0x04 };
+  CHECK_EQ(quadratureSelectSlot(2, -3, 4, own), 2);
+
+  // Every occupancy, start and turn of up to +/-20 detents, over a few ring sizes
+  for (int count = 1; count <= 6; count++) {
+    for (unsigned mask = 0; mask < (1u << count); mask++) {
+      Occupancy occupancy = { mask };
+      for (int current = 0; current < count; current++) {
+        for (int detents = -20; detents <= 20; detents++) {
+          int selected = quadratureSelectSlot(current, detents, count, occupancy);
+          CHECK(selected >= 0 && selected < count);
+          CHECK_EQ(selected, selectReference(current, detents, count, mask));
+        }
+      }
+    }
+  }
+}
+
+int main() {
+  testBounce();
+  testDoubleEdges();
+  testCounterWrap();
+  testEndToEnd();
+  testSelectSlot();
+  return hostTestResult("test_quadrature");
+}
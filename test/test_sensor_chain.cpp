@@ -0,0 +1,173 @@
+/*
+ * SyntheticSource driving the SensorPipeline channel chain (decimator,
+ * median, exponential smoothing) on the host: the source's batching against
+ * a simulated clock, the stop/start cycle the idle bursts rely on, the chain
+ * output, and the chain's throughput in samples/s.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_sensor_chain.cpp -o test_sensor_chain
+ */
+#include <chrono>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "SignalFilters.h"
+#include "SyntheticSource.h"
+
+static uint32_t s_nowUs = 0;
+static uint32_t fakeMicros() { return s_nowUs; }
+
+static const uint8_t CHANNELS[] = { 6, 7 };
+
+// One pipeline channel, with the SensorPipeline filter settings
+struct Chain {
+  Decimator<uint16_t> decimator;
+  MedianFilter<uint16_t, 3> median;
+  ExponentialFilter<uint16_t, 2> smoothing;
+  uint32_t outputs;
+  uint16_t last;
+
+  explicit Chain(uint16_t decimation) : decimator(decimation), outputs(0), last(0) {}
+
+  void feed(uint16_t raw) {
+    uint16_t value;
+    if (decimator.process(raw, value)) {
+      last = smoothing.process(median.process(value));
+      outputs++;
+    }
+  }
+};
+
+// Drains a clocked source the way SensorPipeline::drain() does; returns the samples read
+static size_t drain(SyntheticSource& source, Chain* chains) {
+  SensorSample batch[128];
+  size_t total = 0;
+  while (true) {
+    size_t count = source.read(batch, 128);
+    for (size_t i = 0; i < count; i++) {
+      chains[batch[i].channel == CHANNELS[0] ? 0 : 1].feed(batch[i].raw);
+    }
+    total += count;
+    if (count < 128) break;
+  }
+  return total;
+}
+
+static void testUnclockedBatches() {
+  SyntheticSource source;
+  CHECK(source.begin(CHANNELS, 2, 20000));
+  SensorSample batch[9];
+  CHECK_EQ(source.read(batch, 9), 9);
+  // Round-robin over the pattern, like the ADC controller
+  for (int i = 0; i < 9; i++) {
+    CHECK_EQ(batch[i].channel, CHANNELS[i % 2]);
+  }
+
+  uint8_t none = 0;
+  CHECK(!source.begin(&none, 0, 20000));
+  CHECK(!source.begin(CHANNELS, 2, 0));
+}
+
+static void testClockedRate() {
+  s_nowUs = 1000;
+  SyntheticSource source(fakeMicros);
+  CHECK(source.begin(CHANNELS, 2, 20000));
+  Chain chains[2] = { Chain(200), Chain(200) };
+
+  // 20 kHz: 2000 samples per 100 ms drain interval, none between
+  s_nowUs += 100000;
+  CHECK_EQ(drain(source, chains), 2000);
+  CHECK_EQ(drain(source, chains), 0);
+
+  // Fractions carry over: 7 us at a time is 0.14 samples, never dropped
+  size_t total = 0;
+  for (int i = 0; i < 1000; i++) {
+    s_nowUs += 7;
+    total += drain(source, chains);
+  }
+  CHECK_EQ(total, 140);
+
+  // The 32-bit microsecond clock wraps after ~71 minutes
+  s_nowUs = 0xFFFFFF00u;
+  CHECK(source.begin(CHANNELS, 2, 20000));
+  s_nowUs += 50000;
+  CHECK_EQ(drain(source, chains), 1000);
+}
+
+static void testIdleBurst() {
+  s_nowUs = 0;
+  SyntheticSource source(fakeMicros);
+  CHECK(source.begin(CHANNELS, 2, 20000));
+  Chain chains[2] = { Chain(200), Chain(200) };
+
+  // Stopped between bursts: time passing converts nothing
+  source.end();
+  s_nowUs += 10000000;
+  CHECK_EQ(drain(source, chains), 0);
+
+  // A burst of one 100 ms drain interval after restarting gives five
+  // decimated values per channel, not the 10 s that passed while stopped
+  CHECK(source.begin(CHANNELS, 2, 20000));
+  s_nowUs += 100000;
+  CHECK_EQ(drain(source, chains), 2000);
+  CHECK_EQ(chains[0].outputs, 5);
+  CHECK_EQ(chains[1].outputs, 5);
+  CHECK_EQ(source.getOverrunCount(), 0);
+}
+
+static void testChainOutput() {
+  SyntheticSource source;
+  source.setWaveform(0, SyntheticWaveform(SHAPE_SINE, 10.0f, 1500, 2048, 200));
+  source.setWaveform(1, SyntheticWaveform(SHAPE_SQUARE, 10000.0f, 500, 1000));
+  CHECK(source.begin(CHANNELS, 2, 20000));
+  Chain chains[2] = { Chain(200), Chain(200) };
+
+  // 10 ms sine, noisy: every decimation window holds whole periods, so the
+  // chain settles on the midpoint
+  SensorSample batch[128];
+  for (int i = 0; i < 200; i++) {
+    size_t count = source.read(batch, 128);
+    for (size_t j = 0; j < count; j++) {
+      chains[j % 2].feed(batch[j].raw);
+    }
+  }
+  CHECK_EQ(chains[0].outputs, 200 * 128 / 2 / 200);
+  CHECK(abs(static_cast<int>(chains[0].last) - 2048) <= 10);
+
+  // 10 s square, first half high: still settled on the high level
+  CHECK_EQ(chains[1].last, 1500);
+}
+
+static void benchmarkChain() {
+  SyntheticSource source;
+  source.setWaveform(0, SyntheticWaveform(SHAPE_SINE, 50.0f, 1500, 2048, 50));
+  source.setWaveform(1, SyntheticWaveform(SHAPE_TRIANGLE, 200.0f, 800, 1200, 50));
+  CHECK(source.begin(CHANNELS, 2, 20000));
+  Chain chains[2] = { Chain(200), Chain(200) };
+
+  static const size_t SAMPLES = 4000000;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  // Unclocked, every read is a full batch
+  SensorSample batch[128];
+  size_t total = 0;
+  while (total < SAMPLES) {
+    size_t count = source.read(batch, 128);
+    for (size_t i = 0; i < count; i++) {
+      chains[i % 2].feed(batch[i].raw);
+    }
+    total += count;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CHECK_EQ(chains[0].outputs + chains[1].outputs, total / 200);
+  printf("source + chain: %.1f M samples/s (%.0fx a 20 kHz ADC)\n",
+         total / seconds / 1e6, total / seconds / 20000);
+}
+
+int main() {
+  testUnclockedBatches();
+  testClockedRate();
+  testIdleBurst();
+  testChainOutput();
+  benchmarkChain();
+  return hostTestResult("test_sensor_chain");
+}
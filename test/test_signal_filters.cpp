@@ -0,0 +1,160 @@
+/*
+ * SignalFilters against straightforward reference implementations, block
+ * versus per-sample processing, and biquad steady state and priming.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -Wall -Wextra -I../src test_signal_filters.cpp -o test_signal_filters
+ */
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "HostTest.h"
+#include "SignalFilters.h"
+#include "SyntheticSource.h"
+
+// Noisy sine with spikes, the kind of input the sensor path sees
+static std::vector<int16_t> makeInput(size_t count) {
+  SyntheticSource source;
+  uint8_t channel = 0;
+  source.setWaveform(0, SyntheticWaveform(SHAPE_SINE, 5.0f, 1500, 2048, 100));
+  source.begin(&channel, 1, 1000);
+  std::vector<SensorSample> samples(count);
+  source.read(&samples[0], count);
+  std::vector<int16_t> input(count);
+  for (size_t i = 0; i < count; i++) {
+    input[i] = static_cast<int16_t>(samples[i].raw);
+    if (i % 37 == 0) input[i] = 4095;
+  }
+  return input;
+}
+
+static void testMovingAverage() {
+  std::vector<int16_t> input = makeInput(500);
+  MovingAverage<int16_t, 8> average;
+  for (size_t i = 0; i < input.size(); i++) {
+    size_t first = i >= 7 ? i - 7 : 0;
+    long sum = 0;
+    for (size_t j = first; j <= i; j++) sum += input[j];
+    CHECK_EQ(average.process(input[i]), sum / static_cast<long>(i - first + 1));
+  }
+}
+
+static void testMedian() {
+  std::vector<int16_t> input = makeInput(500);
+  MedianFilter<int16_t, 5> median;
+  for (size_t i = 0; i < input.size(); i++) {
+    size_t first = i >= 4 ? i - 4 : 0;
+    std::vector<int16_t> window(input.begin() + first, input.begin() + i + 1);
+    std::sort(window.begin(), window.end());
+    CHECK_EQ(median.process(input[i]), window[window.size() / 2]);
+  }
+
+  // A lone spike never reaches the output of a 3-tap median
+  MedianFilter<uint16_t, 3> spikes;
+  uint16_t values[] = { 100, 100, 4095, 100, 100, 0, 100 };
+  for (size_t i = 0; i < 7; i++) {
+    CHECK_EQ(spikes.process(values[i]), 100);
+  }
+}
+
+static void testExponential() {
+  // The first sample initializes; a step then converges to within one LSB
+  ExponentialFilter<uint16_t, 2> smooth;
+  CHECK_EQ(smooth.process(1000), 1000);
+  CHECK_EQ(smooth.process(2000), 1250);
+  uint16_t value = 0;
+  for (int i = 0; i < 100; i++) value = smooth.process(1001);
+  CHECK(abs(value - 1001) <= 1);
+  smooth.reset();
+  CHECK_EQ(smooth.process(7), 7);
+}
+
+static void testBlockMatchesSamples() {
+  std::vector<int16_t> input = makeInput(300);
+  std::vector<int16_t> block(input);
+
+  BiquadCascade<int16_t, 2> a, b;
+  a.setCoefficients(BiquadCoefficients::lowPass(1000.0f, 50.0f));
+  b.setCoefficients(BiquadCoefficients::lowPass(1000.0f, 50.0f));
+  b.process(&block[0], &block[0], block.size());   // In place
+  for (size_t i = 0; i < input.size(); i++) {
+    CHECK_EQ(block[i], a.process(input[i]));
+  }
+
+  Decimator<int16_t> decimator(10);
+  std::vector<int16_t> out(input.size());
+  size_t written = decimator.process(&input[0], &out[0], input.size());
+  CHECK_EQ(written, 30);
+  long sum = 0;
+  for (size_t i = 10; i < 20; i++) sum += input[i];
+  CHECK_EQ(out[1], (sum + 5) / 10);
+}
+
+// Settling error from output rounding (the dead band in the BiquadCascade comment)
+static int deadBand(const BiquadCoefficients& c) {
+  return (1 << (BiquadCoefficients::FRAC - 1)) / ((1 << BiquadCoefficients::FRAC) + c.a1 + c.a2) + 1;
+}
+
+static void testBiquadDc() {
+  // Unity gain at DC for a low-pass, none for a high-pass, once settled
+  BiquadCoefficients lowCoefficients = BiquadCoefficients::lowPass(1000.0f, 100.0f);
+  BiquadCoefficients highCoefficients = BiquadCoefficients::highPass(1000.0f, 100.0f);
+  BiquadCascade<int16_t> lowPass;
+  BiquadCascade<int16_t> highPass;
+  lowPass.setCoefficients(lowCoefficients);
+  highPass.setCoefficients(highCoefficients);
+  int16_t low = 0, high = 0;
+  for (int i = 0; i < 2000; i++) {
+    low = lowPass.process(1000);
+    high = highPass.process(1000);
+  }
+  CHECK(deadBand(lowCoefficients) <= 3);
+  CHECK(abs(low - 1000) <= deadBand(lowCoefficients));
+  CHECK(abs(high) <= deadBand(highCoefficients));
+
+  // An overshooting design saturates instead of wrapping
+  BiquadCascade<int16_t> loud;
+  BiquadCoefficients gain;
+  gain.b0 = 4 << BiquadCoefficients::FRAC;
+  loud.setCoefficients(gain);
+  CHECK_EQ(loud.process(20000), 32767);
+  CHECK_EQ(loud.process(-20000), -32768);
+}
+
+static void testBiquadPrime() {
+  // Primed at x, a constant input x continues without a transient
+  BiquadCascade<int16_t, 2> lowPass;
+  lowPass.setCoefficients(BiquadCoefficients::lowPass(1000.0f, 20.0f));
+  lowPass.prime(1000);
+  for (int i = 0; i < 200; i++) {
+    CHECK(abs(lowPass.process(1000) - 1000) <= 1);
+  }
+
+  // A high-pass settles at 0 for a constant input, so that is where it primes
+  BiquadCascade<int16_t, 2> highPass;
+  highPass.setCoefficients(BiquadCoefficients::highPass(1000.0f, 20.0f));
+  highPass.prime(1000);
+  for (int i = 0; i < 200; i++) {
+    CHECK(abs(highPass.process(1000)) <= 1);
+  }
+
+  // Mixed cascade: the low-pass section passes x on, the high-pass removes it
+  BiquadCascade<int16_t, 2> bandPass;
+  bandPass.setCoefficients(0, BiquadCoefficients::lowPass(1000.0f, 100.0f));
+  bandPass.setCoefficients(1, BiquadCoefficients::highPass(1000.0f, 10.0f));
+  bandPass.prime(-500);
+  for (int i = 0; i < 200; i++) {
+    CHECK(abs(bandPass.process(-500)) <= 1);
+  }
+}
+
+int main() {
+  testMovingAverage();
+  testMedian();
+  testExponential();
+  testBlockMatchesSamples();
+  testBiquadDc();
+  testBiquadPrime();
+  return hostTestResult("test_signal_filters");
+}
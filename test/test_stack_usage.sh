@@ -0,0 +1,121 @@
+#!/bin/bash
+# scripts/stack_usage.py: every TASK_ENTRY_POINTS entry names a function
+# that exists in src/, and is found in real GCC -fstack-usage output for
+# definitions of the same shape (plain members, CRTP statics, members of
+# class templates instantiated twice, where the deeper frame is reported).
+#
+# Run: test/test_stack_usage.sh (run_tests.sh runs it too)
+
+cd "$(dirname "$0")" || exit 1
+CXX=${CXX:-g++}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+mkdir -p "$work/build/src"
+
+python3 - "$work" <<'EOF' || exit 1
+import os
+import re
+import sys
+
+sys.path.insert(0, "../scripts")
+import stack_usage
+
+work = sys.argv[1]
+failures = 0
+
+
+def fail(message):
+    global failures
+    print("test_stack_usage: " + message, file=sys.stderr)
+    failures += 1
+
+
+entries = [e for points in stack_usage.TASK_ENTRY_POINTS.values() for e in points]
+
+# Each entry is defined in src/: out of class, or in the body of its class
+sources = {}
+for name in os.listdir("../src"):
+    with open(os.path.join("../src", name)) as source:
+        sources[name] = source.read()
+for entry in entries:
+    cls, method = entry.split("::")
+    defined = re.compile(r"\b%s\s*(<[^;{}()]*>)?\s*::\s*%s\s*\(" % (cls, method))
+    declared = re.compile(r"\bclass\s+%s\b[^;]*?\{(.*?)\n\};" % cls, re.S)
+    in_body = re.compile(r"^[ \t]*[\w:<>*& \t]+\b%s\([^;(){}]*\)\s*(const\s*)?(override\s*)?\{"
+                         % method, re.M)
+    bodies = [m.group(1) for text in sources.values() for m in declared.finditer(text)]
+    if not any(defined.search(text) for text in sources.values()) and \
+            not any(in_body.search(body) for body in bodies):
+        fail("%s is not defined in src/" % entry)
+
+# A translation unit with the same shapes; template members get a bigger
+# frame in the second instantiation
+templates = {"ViewBase": 2, "BasicOLEDView": 1, "BasicLCDView": 1}
+classes = {}
+for entry in entries:
+    cls, method = entry.split("::")
+    classes.setdefault(cls, []).append(method)
+lines = ["struct PanelA {}; struct PanelB {};"]
+for cls, methods in sorted(classes.items()):
+    params = templates.get(cls, 0)
+    if params:
+        names = ["P%d" % i for i in range(params)]
+        lines.append("template <%s> struct %s {" % (", ".join("typename " + n for n in names), cls))
+        for method in methods:
+            lines.append("  static bool %s(void* context);" % method)
+        lines.append("};")
+        for method in methods:
+            lines.append("template <%s> bool %s<%s>::%s(void* context) {"
+                         % (", ".join("typename " + n for n in names), cls, ", ".join(names), method))
+            lines.append("  volatile char frame[64 + 64 * sizeof(P0)]; frame[0] = 1; return context != 0; }")
+        for panel in ("PanelA", "PanelB"):
+            lines.append("template struct %s<%s>;" % (cls, ", ".join([panel] * params)))
+    else:
+        lines.append("struct %s {" % cls)
+        for method in methods:
+            lines.append("  void %s(int value);" % method)
+        lines.append("};")
+        for method in methods:
+            lines.append("void %s::%s(int value) { volatile char frame[48]; frame[0] = value; }" % (cls, method))
+with open(os.path.join(work, "sample.cpp"), "w") as sample:
+    sample.write("\n".join(lines) + "\n")
+sys.exit(1 if failures else 0)
+EOF
+
+# Compile where the .su lands in the build tree, as PlatformIO does
+(cd "$work/build/src" && $CXX -std=gnu++11 -O0 -fstack-usage -c "$work/sample.cpp" -o sample.o) || {
+  echo "test_stack_usage: sample did not compile"; exit 1; }
+
+python3 - "$work" <<'EOF'
+import io
+import sys
+from contextlib import redirect_stdout
+
+sys.path.insert(0, "../scripts")
+import stack_usage
+
+work = sys.argv[1]
+failures = 0
+output = io.StringIO()
+with redirect_stdout(output):
+    stack_usage.report(work + "/build", "..")
+report = output.getvalue()
+
+frames = stack_usage.read_frames(work + "/build/src")
+for points in stack_usage.TASK_ENTRY_POINTS.values():
+    for entry in points:
+        sizes = [f[1] for f in frames if stack_usage.function_key(f[0]) == entry]
+        rows = [line for line in report.splitlines() if line.split()[:1] == [entry]]
+        if not sizes or len(rows) != 1 or "(not found)" in rows[0]:
+            print("test_stack_usage: %s not found in the report" % entry, file=sys.stderr)
+            failures += 1
+        elif int(rows[0].split()[1]) != max(sizes):
+            print("test_stack_usage: %s reported %s, deepest frame is %d"
+                  % (entry, rows[0].split()[1], max(sizes)), file=sys.stderr)
+            failures += 1
+
+if failures:
+    print("test_stack_usage: FAILED")
+    sys.exit(1)
+print("test_stack_usage: ok")
+EOF
@@ -0,0 +1,198 @@
+/*
+ * TaskBuckets through TaskManager: next task, top N and per-priority counts
+ * against a brute-force scan after every step of random single and batch
+ * edits (including sorts, resets and rolled-back batches); the first-in,
+ * first-out order within a bucket; snapshots keeping their own buckets; and
+ * the cost of the queries against a priority sort. run_tests.sh also builds
+ * it with 1000 tasks.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -Ihost -I../src test_task_buckets.cpp ../src/TaskManager.cpp -o test_task_buckets
+ */
+#include <chrono>
+#include <stdlib.h>
+
+#include "HostTest.h"
+#include "TaskManager.h"
+
+HostSerial Serial;
+
+static void checkAgainstScan(TaskManager& manager) {
+  TaskSnapshot snapshot(manager);
+  uint16_t counts[6][2] = { { 0 } };
+  uint16_t complete = 0;
+  uint8_t best = 0;
+  for (uint16_t i = 0; i < snapshot.getTaskCount(); i++) {
+    const Task* task = snapshot.getTaskByIndex(i);
+    counts[task->priority][task->isComplete ? 1 : 0]++;
+    if (task->isComplete) {
+      complete++;
+    } else if (task->priority > best) {
+      best = task->priority;
+    }
+  }
+
+  const Task* next = snapshot.getNextTask();
+  if (best == 0) {
+    CHECK(next == nullptr);
+  } else {
+    CHECK(next != nullptr && !next->isComplete && next->priority == best);
+  }
+  for (uint8_t priority = 1; priority <= 5; priority++) {
+    CHECK_EQ(snapshot.getPriorityCount(priority, false), counts[priority][0]);
+    CHECK_EQ(snapshot.getPriorityCount(priority, true), counts[priority][1]);
+  }
+  CHECK_EQ(snapshot.getCompletedCount(), complete);
+
+  // Every open task once, highest priority first, and nothing else
+  static const Task* top[TaskManager::MAX_TASKS];
+  uint16_t open = snapshot.getTaskCount() - complete;
+  CHECK_EQ(snapshot.getTopTasks(top, TaskManager::MAX_TASKS), open);
+  for (uint16_t i = 0; i < open; i++) {
+    CHECK(!top[i]->isComplete);
+    if (i > 0) CHECK(top[i]->priority <= top[i - 1]->priority);
+    CHECK(snapshot.getTask(top[i]->id) == top[i]);
+  }
+  for (uint16_t i = 0; i + 1 < open && open <= 64; i++) {
+    for (uint16_t j = i + 1; j < open; j++) CHECK(top[i] != top[j]);
+  }
+  if (open > 0) {
+    const Task* first[1];
+    CHECK_EQ(snapshot.getTopTasks(first, 1), 1);
+    CHECK(first[0] == next);
+  }
+}
+
+static void randomEdit(TaskManager& manager, unsigned& seed, TaskBatch batch, int round) {
+  uint16_t count = manager.getTaskCount();
+  Task task;
+  uint16_t id = (count > 0 && manager.getTaskByIndex(rand_r(&seed) % count, task)) ? task.id : 0;
+  char title[32];
+  switch (rand_r(&seed) % 7) {
+    case 0:
+    case 1:
+      snprintf(title, sizeof(title), "task %d", round);
+      manager.addTask(title, 1 + rand_r(&seed) % 5, rand_r(&seed) % 4, batch);
+      break;
+    case 2:
+      // Inside a batch the id may already be gone: the delete then fails
+      if (id != 0) manager.deleteTask(id, batch);
+      break;
+    case 3:
+      if (id != 0) manager.toggleTaskComplete(id, batch);
+      break;
+    case 4:
+      if (id != 0) manager.editTask(id, nullptr, 1 + rand_r(&seed) % 5, 255, batch);
+      break;
+    case 5:
+      if (rand_r(&seed) % 8 == 0) manager.sortTasks(static_cast<SortBy>(rand_r(&seed) % 4), batch);
+      break;
+    default:
+      if (rand_r(&seed) % 60 == 0) manager.reset(batch);
+      break;
+  }
+}
+
+static void testAgainstScan() {
+  static TaskManager manager;
+  unsigned seed = 7;
+  for (int round = 0; round < 20000; round++) {
+    if (rand_r(&seed) % 10 == 0) {
+      TaskBatch batch = manager.beginBatch();
+      CHECK(batch != NO_BATCH);
+      int edits = 1 + rand_r(&seed) % 20;
+      for (int k = 0; k < edits; k++) randomEdit(manager, seed, batch, round);
+      if (rand_r(&seed) % 4 == 0) {
+        uint32_t version = manager.getVersion();
+        manager.rollbackBatch(batch);
+        CHECK_EQ(manager.getVersion(), version);
+      } else {
+        CHECK(manager.commitBatch(batch));
+      }
+    } else {
+      randomEdit(manager, seed, NO_BATCH, round);
+    }
+    checkAgainstScan(manager);
+  }
+}
+
+static uint16_t idAt(TaskManager& manager, uint16_t index) {
+  Task task;
+  return manager.getTaskByIndex(index, task) ? task.id : 0;
+}
+
+static void testBucketOrder() {
+  TaskManager manager;
+  CHECK(manager.addTask("a", 3, 0));
+  CHECK(manager.addTask("b", 3, 0));
+  CHECK(manager.addTask("c", 5, 0));
+  uint16_t a = idAt(manager, 0), b = idAt(manager, 1), c = idAt(manager, 2);
+
+  Task next;
+  CHECK(manager.getNextTask(next) && next.id == c);
+
+  // A snapshot keeps the buckets of its version
+  {
+    TaskSnapshot before(manager);
+    CHECK(manager.toggleTaskComplete(c));
+    CHECK_EQ(before.getNextTask()->id, c);
+    CHECK_EQ(before.getPriorityCount(5, true), 0);
+  }
+  CHECK(manager.getNextTask(next) && next.id == a);
+  CHECK_EQ(manager.getPriorityCount(5, true), 1);
+
+  // Leaving and re-entering a bucket puts a task at its tail
+  CHECK(manager.toggleTaskComplete(a));
+  CHECK(manager.toggleTaskComplete(a));
+  {
+    TaskSnapshot snapshot(manager);
+    const Task* top[3];
+    CHECK_EQ(snapshot.getTopTasks(top, 3), 2);
+    CHECK_EQ(top[0]->id, b);
+    CHECK_EQ(top[1]->id, a);
+  }
+
+  // A priority edit moves it to its new bucket; a delete renumbers the links
+  CHECK(manager.editTask(a, nullptr, 4));
+  CHECK(manager.getNextTask(next) && next.id == a);
+  CHECK(manager.deleteTask(a));
+  CHECK(manager.getNextTask(next) && next.id == b);
+  CHECK(manager.toggleTaskComplete(b));
+  CHECK(!manager.getNextTask(next));
+  CHECK_EQ(manager.getCompletionPercentage(), 100);
+}
+
+static void benchmark() {
+  static TaskManager manager;
+  srand(3);
+  for (uint16_t i = 0; i < TaskManager::MAX_TASKS; i++) {
+    manager.addTask("bench", 1 + rand() % 5, 0);
+  }
+  uint16_t id = idAt(manager, TaskManager::MAX_TASKS / 2);
+
+  static const int RUNS = 100000;
+  TaskSnapshot* snapshot = new TaskSnapshot(manager);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uintptr_t sink = 0;
+  for (int r = 0; r < RUNS; r++) sink += reinterpret_cast<uintptr_t>(snapshot->getNextTask());
+  double nextUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / RUNS;
+  delete snapshot;
+  CHECK(sink != 0);
+
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < 1000; r++) manager.toggleTaskComplete(id);
+  double toggleUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / 1000;
+
+  start = std::chrono::steady_clock::now();
+  manager.sortTasks(SORT_BY_PRIORITY);
+  double sortUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  printf("%u tasks: next task %.3f us, toggle %.1f us, priority sort %.0f us\n",
+         (unsigned)TaskManager::MAX_TASKS, nextUs, toggleUs, sortUs);
+}
+
+int main() {
+  testAgainstScan();
+  testBucketOrder();
+  benchmark();
+  return hostTestResult("test_task_buckets");
+}
@@ -0,0 +1,237 @@
+/*
+ * TaskManager copy-on-write under concurrency: one writer thread edits
+ * (single operations and batches) while reader threads take snapshots and
+ * check that a pinned version never changes under them; and writes from
+ * outside an open batch being refused. run_tests.sh builds it with
+ * ThreadSanitizer, which also reports any unsynchronized access.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O1 -g -Wall -Wextra -pthread -fsanitize=thread -Ihost -I../src \
+ *       test_task_manager_stress.cpp ../src/TaskManager.cpp -o test_task_manager_stress
+ */
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "HostTest.h"
+#include "TaskManager.h"
+
+HostSerial Serial;
+
+static const int READERS = 3;
+static const int WRITES = 20000;
+
+struct Counters {
+  std::atomic<long> writes;
+  std::atomic<long> failedWrites;
+  std::atomic<long> reads;
+  std::atomic<long> violations;
+  std::atomic<bool> stop;
+
+  Counters() : writes(0), failedWrites(0), reads(0), violations(0), stop(false) {}
+};
+
+static void violation(Counters& counters, const char* what) {
+  if (counters.violations++ < 10) fprintf(stderr, "reader: %s\n", what);
+}
+
+/**
+ * Copies the pinned version, re-reads it after the writer has had time to
+ * run, and checks the invariants a published table must hold.
+ */
+static void reader(TaskManager& manager, Counters& counters, int seed) {
+  uint32_t lastVersion = 0;
+  Task copy[TaskManager::MAX_TASKS];
+  unsigned round = static_cast<unsigned>(seed);
+  while (!counters.stop) {
+    TaskSnapshot snapshot(manager);
+    uint32_t version = snapshot.getVersion();
+    uint16_t count = snapshot.getTaskCount();
+    if (version < lastVersion) violation(counters, "version went backwards");
+    lastVersion = version;
+
+    for (uint16_t i = 0; i < count; i++) {
+      const Task* task = snapshot.getTaskByIndex(i);
+      if (task == nullptr) {
+        violation(counters, "count disagrees with the tasks");
+        count = i;
+        break;
+      }
+      copy[i] = *task;
+    }
+
+    // Every few rounds hold the snapshot long enough for several edits
+    if (++round % 8 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+    if (snapshot.getVersion() != version || snapshot.getTaskCount() != count) {
+      violation(counters, "snapshot header changed");
+    }
+    uint16_t openCount = 0;
+    uint16_t completeCount = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      // Checked against the copy, so a table reused under the snapshot is
+      // reported rather than followed
+      const Task* task = snapshot.getTaskByIndex(i);
+      if (task == nullptr || memcmp(task, &copy[i], sizeof(Task)) != 0) {
+        violation(counters, "pinned task changed");
+        break;
+      }
+      if (snapshot.getTask(copy[i].id) != task) violation(counters, "id lookup disagrees");
+      for (uint16_t j = i + 1; j < count; j++) {
+        if (copy[j].id == copy[i].id) violation(counters, "duplicate id");
+      }
+      if (task->isComplete) completeCount++; else openCount++;
+    }
+
+    // The priority buckets describe the same version as the array
+    uint16_t bucketOpen = 0;
+    uint16_t bucketComplete = 0;
+    for (uint8_t priority = 1; priority <= 5; priority++) {
+      bucketOpen += snapshot.getPriorityCount(priority, false);
+      bucketComplete += snapshot.getPriorityCount(priority, true);
+    }
+    if (bucketOpen != openCount || bucketComplete != completeCount) {
+      violation(counters, "bucket counts disagree with the tasks");
+    }
+    const Task* next = snapshot.getNextTask();
+    if ((next == nullptr) != (openCount == 0)) violation(counters, "next task disagrees");
+    counters.reads++;
+  }
+}
+
+static void writer(TaskManager& manager, Counters& counters, long& expectedCount) {
+  for (int i = 0; i < WRITES; i++) {
+    bool ok = false;
+    Task first;
+    TaskBatch batch;
+    switch (i % 6) {
+      case 0:
+        ok = manager.sortTasks(i % 12 == 0 ? SORT_BY_PRIORITY : SORT_BY_CATEGORY);
+        break;
+      case 1:
+        ok = manager.addTask("stress", 1 + i % 5, i % 4);
+        if (ok) expectedCount++;
+        break;
+      case 2:
+        ok = manager.getTaskByIndex(0, first) && manager.toggleTaskComplete(first.id);
+        break;
+      case 3:
+        ok = manager.getTaskByIndex(0, first) && manager.deleteTask(first.id);
+        if (ok) expectedCount--;
+        break;
+      case 4:
+        ok = manager.getTaskByIndex(1, first) && manager.editTask(first.id, "edited", 1 + i % 5);
+        break;
+      default:
+        // A batch publishes once: readers see all three edits or none
+        batch = manager.beginBatch();
+        ok = batch != NO_BATCH;
+        if (ok) {
+          bool added = manager.addTask("batch a", 2, 0, batch);
+          bool added2 = manager.addTask("batch b", 4, 1, batch);
+          bool removed = manager.getTaskByIndex(2, first) && manager.deleteTask(first.id, batch);
+          ok = manager.commitBatch(batch);
+          if (ok) expectedCount += (added ? 1 : 0) + (added2 ? 1 : 0) - (removed ? 1 : 0);
+        }
+        break;
+    }
+    if (ok) counters.writes++; else counters.failedWrites++;
+  }
+}
+
+/**
+ * An open batch takes only writes that carry its token. Writes from other
+ * threads, or from the opening thread without the token (another coroutine
+ * on the same executor), fail at once and never land in the batch.
+ */
+static void testForeignWrites() {
+  TaskManager manager;
+  CHECK(manager.addTask("kept", 3, 0));
+  Task kept;
+  CHECK(manager.getTaskByIndex(0, kept));
+
+  TaskBatch batch = manager.beginBatch();
+  CHECK(batch != NO_BATCH);
+  CHECK(manager.addTask("imported", 2, 0, batch));
+  CHECK_EQ(manager.beginBatch(), NO_BATCH);
+
+  // Same thread, no token: refused, and the batch is untouched
+  CHECK(!manager.addTask("joined", 1, 0));
+  CHECK(!manager.toggleTaskComplete(kept.id));
+  CHECK(!manager.sortTasks(SORT_BY_PRIORITY));
+  CHECK(!manager.addTask("stale token", 1, 0, static_cast<TaskBatch>(batch + 1)));
+
+  // Another thread: refused without waiting out the write timeout, and
+  // reads and searches keep working against the published version
+  std::atomic<long> elapsedMs(0);
+  std::atomic<int> foreignAdded(0);
+  std::atomic<int> foreignCommitted(0);
+  std::atomic<size_t> found(0);
+  std::thread other([&]() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    foreignAdded = manager.addTask("other task", 1, 0) ? 1 : 0;
+    foreignAdded += manager.deleteTask(kept.id) ? 1 : 0;
+    foreignCommitted = manager.commitBatch(NO_BATCH) ? 1 : 0;
+    manager.rollbackBatch(NO_BATCH);
+    elapsedMs = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    TaskSearchResult result;
+    found = manager.searchTasks("kept", SEARCH_SUBSTRING, &result, 1);
+  });
+  other.join();
+  CHECK_EQ(foreignAdded.load(), 0);
+  CHECK_EQ(foreignCommitted.load(), 0);
+  CHECK(elapsedMs.load() < static_cast<long>(TaskManager::WRITE_TIMEOUT_MS) / 2);
+  CHECK_EQ(found.load(), 1);
+  CHECK_EQ(manager.getTaskCount(), 1);
+
+  // A thread holding the token may finish the batch (the token, not the
+  // thread, owns it)
+  std::thread finisher([&]() {
+    foreignCommitted += manager.addTask("late import", 2, 0, batch) ? 1 : 0;
+    foreignCommitted += manager.commitBatch(batch) ? 1 : 0;
+  });
+  finisher.join();
+  CHECK_EQ(foreignCommitted.load(), 2);
+  CHECK_EQ(manager.getTaskCount(), 3);
+  CHECK(!manager.commitBatch(batch));
+
+  // Writes work again once the batch is closed; a rolled-back batch leaves nothing
+  CHECK(manager.addTask("after", 1, 0));
+  batch = manager.beginBatch();
+  CHECK(manager.reset(batch));
+  manager.rollbackBatch(batch);
+  CHECK_EQ(manager.getTaskCount(), 4);
+  CHECK(manager.addTask("after rollback", 1, 0));
+}
+
+int main() {
+  testForeignWrites();
+
+  TaskManager manager;
+  for (int i = 0; i < 20; i++) {
+    char title[16];
+    snprintf(title, sizeof(title), "task %d", i);
+    manager.addTask(title, 1 + i % 5, i % 4);
+  }
+  long expectedCount = 20;
+
+  Counters counters;
+  std::vector<std::thread> readers;
+  for (int r = 0; r < READERS; r++) {
+    readers.push_back(std::thread(reader, std::ref(manager), std::ref(counters), r));
+  }
+  writer(manager, counters, expectedCount);
+  counters.stop = true;
+  for (size_t r = 0; r < readers.size(); r++) readers[r].join();
+
+  CHECK_EQ(counters.violations.load(), 0);
+  CHECK(counters.reads.load() > 0);
+  CHECK_EQ(manager.getTaskCount(), expectedCount);
+  // Readers pin at most READERS tables, so a free one always turns up in time
+  CHECK_EQ(counters.failedWrites.load(), 0);
+  printf("%ld writes, %ld failed, %ld snapshots checked, version %u\n",
+         counters.writes.load(), counters.failedWrites.load(), counters.reads.load(),
+         (unsigned)manager.getVersion());
+  return hostTestResult("test_task_manager_stress");
+}
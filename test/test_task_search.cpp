@@ -0,0 +1,268 @@
+/*
+ * TaskSearchIndex against a brute-force scan of the same titles: the match
+ * set for prefix and substring queries (trigram and short), through random
+ * insert/update/remove churn and into hash collisions; the ranking order;
+ * TaskManager keeping the index in step with add/edit/delete and batches;
+ * and query time at 10k titles.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -Ihost -I../src test_task_search.cpp ../src/TaskManager.cpp -o test_task_search
+ */
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "HostTest.h"
+#include "TaskManager.h"
+#include "TaskSearchIndex.h"
+
+HostSerial Serial;
+
+static const char* WORDS[] = {
+  "buy", "milk", "call", "mom", "fix", "bike", "write", "report", "pay", "rent",
+  "clean", "garage", "book", "flight", "review", "code", "water", "plants", "Order", "PARTS"
+};
+static const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+// Written independently of the index: lowercase words joined by single spaces
+static std::string normalized(const std::string& title) {
+  std::string out;
+  bool gap = false;
+  for (size_t i = 0; i < title.size(); i++) {
+    unsigned char c = static_cast<unsigned char>(title[i]);
+    if (isalnum(c) || c >= 0x80) {
+      if (gap && !out.empty()) out += ' ';
+      out += static_cast<char>(c < 0x80 ? tolower(c) : c);
+      gap = false;
+    } else {
+      gap = true;
+    }
+  }
+  return out;
+}
+
+static bool brute(const std::string& title, const char* query, TaskSearchMode mode) {
+  std::string text = " " + normalized(title);
+  std::string pattern = normalized(query);
+  if (pattern.empty()) return false;
+  if (mode == SEARCH_PREFIX) pattern = " " + pattern;
+  return text.find(pattern) != std::string::npos;
+}
+
+static std::string randomTitle(unsigned& seed) {
+  std::string title;
+  int words = 1 + rand_r(&seed) % 4;
+  for (int w = 0; w < words; w++) {
+    if (w > 0) title += (rand_r(&seed) % 5 == 0) ? " - " : " ";
+    title += WORDS[rand_r(&seed) % WORD_COUNT];
+  }
+  if (rand_r(&seed) % 3 == 0) title += " " + std::to_string(rand_r(&seed) % 100);
+  return title.substr(0, 31);
+}
+
+template <typename Index>
+static void checkAgainstBrute(const Index& index, const std::vector<std::pair<uint16_t, std::string> >& titles,
+                              const char* query) {
+  static TaskSearchResult results[20000];
+  for (int m = 0; m < 2; m++) {
+    TaskSearchMode mode = static_cast<TaskSearchMode>(m);
+    size_t found = index.search(query, mode, results, 20000);
+    std::set<uint16_t> got, expected;
+    for (size_t i = 0; i < found; i++) {
+      got.insert(results[i].id);
+      if (i > 0) CHECK(results[i - 1].score >= results[i].score);
+    }
+    for (size_t i = 0; i < titles.size(); i++) {
+      if (brute(titles[i].second, query, mode)) expected.insert(titles[i].first);
+    }
+    CHECK_EQ(found, got.size());     // No id twice
+    if (got != expected) {
+      fprintf(stderr, "query \"%s\" mode %d: %u found, %u expected\n",
+              query, m, (unsigned)got.size(), (unsigned)expected.size());
+      CHECK(got == expected);
+    }
+
+    // A short result list holds the best scores of the full one
+    TaskSearchResult top[5];
+    size_t topFound = index.search(query, mode, top, 5);
+    CHECK_EQ(topFound, std::min<size_t>(found, 5));
+    for (size_t i = 0; i < topFound; i++) CHECK_EQ(top[i].score, results[i].score);
+  }
+}
+
+static const char* QUERIES[] = {
+  "milk", "bi", "b", "garage 1", "report 9", "ord", "x", "Buy Milk", "mom-call", "  rent ", "e c",
+  "parts", "ight", "k b", "1", "12", "flight review code water", ""
+};
+
+static void testMatchesBrute() {
+  // 64 buckets for up to 360 postings: collisions on every list
+  static TaskSearchIndex<12> small;
+  static TaskSearchIndex<400> index;
+  std::vector<std::pair<uint16_t, std::string> > smallTitles, titles;
+  unsigned seed = 7;
+  uint16_t nextId = 1;
+
+  for (int round = 0; round < 3000; round++) {
+    int op = rand_r(&seed) % 4;
+    if (op <= 1 || titles.empty()) {
+      std::string title = randomTitle(seed);
+      uint16_t id = nextId++;
+      bool added = index.insert(id, title.c_str());
+      CHECK_EQ(added, titles.size() < 400);
+      if (added) titles.push_back(std::make_pair(id, title));
+      if (small.insert(id, title.c_str())) smallTitles.push_back(std::make_pair(id, title));
+    } else if (op == 2) {
+      size_t pick = rand_r(&seed) % titles.size();
+      std::string title = randomTitle(seed);
+      CHECK(index.update(titles[pick].first, title.c_str()));
+      titles[pick].second = title;
+    } else {
+      size_t pick = rand_r(&seed) % titles.size();
+      uint16_t id = titles[pick].first;
+      CHECK(index.remove(id));
+      CHECK(!index.remove(id));
+      titles.erase(titles.begin() + pick);
+      for (size_t i = 0; i < smallTitles.size(); i++) {
+        if (smallTitles[i].first == id) {
+          CHECK(small.remove(id));
+          smallTitles.erase(smallTitles.begin() + i);
+          break;
+        }
+      }
+    }
+    CHECK_EQ(index.size(), titles.size());
+    if (round % 100 == 0) {
+      for (size_t q = 0; q < sizeof(QUERIES) / sizeof(QUERIES[0]); q++) {
+        checkAgainstBrute(index, titles, QUERIES[q]);
+        checkAgainstBrute(small, smallTitles, QUERIES[q]);
+      }
+    }
+  }
+
+  // Bad input
+  CHECK(!index.insert(0, "zero id"));
+  CHECK(!index.update(60000, "no such id"));
+  TaskSearchResult result;
+  CHECK_EQ(index.search(nullptr, SEARCH_SUBSTRING, &result, 1), 0);
+  CHECK_EQ(index.search("milk", SEARCH_SUBSTRING, &result, 0), 0);
+  CHECK_EQ(index.search("a query longer than any title can be", SEARCH_SUBSTRING, &result, 1), 0);
+}
+
+static void testRanking() {
+  TaskSearchIndex<8> index;
+  index.insert(1, "call the bike shop");
+  index.insert(2, "bike");
+  index.insert(3, "motorbike service");
+  index.insert(4, "fix bike");
+  index.insert(5, "bike lights");
+  index.insert(6, "Bike");
+
+  // Whole title (the shorter first), title prefix, word prefix (earlier first), substring
+  TaskSearchResult results[8];
+  CHECK_EQ(index.search("bike", SEARCH_SUBSTRING, results, 8), 6);
+  CHECK(results[0].id == 2 || results[0].id == 6);
+  CHECK(results[1].id == 2 || results[1].id == 6);
+  CHECK_EQ(results[2].id, 5);
+  CHECK_EQ(results[3].id, 4);
+  CHECK_EQ(results[4].id, 1);
+  CHECK_EQ(results[5].id, 3);
+
+  // A word prefix skips the match inside "motorbike"
+  CHECK_EQ(index.search("bik", SEARCH_PREFIX, results, 8), 5);
+  for (size_t i = 0; i < 5; i++) CHECK(results[i].id != 3);
+
+  // Whole-title matches see through case and separators
+  index.insert(7, "Fix -- BIKE!");
+  CHECK_EQ(index.search("fix bike", SEARCH_SUBSTRING, results, 1), 1);
+  CHECK(results[0].id == 4 || results[0].id == 7);
+}
+
+static size_t searchManager(TaskManager& manager, const char* query, std::vector<uint16_t>& ids) {
+  TaskSearchResult results[TaskManager::MAX_TASKS];
+  size_t found = manager.searchTasks(query, SEARCH_SUBSTRING, results, TaskManager::MAX_TASKS);
+  ids.clear();
+  for (size_t i = 0; i < found; i++) ids.push_back(results[i].id);
+  std::sort(ids.begin(), ids.end());
+  return found;
+}
+
+static void testManagerKeepsIndex() {
+  TaskManager manager;
+  CHECK(manager.addTask("water plants", 2, 0));
+  CHECK(manager.addTask("order parts", 3, 1));
+  CHECK(manager.addTask("water the garden", 1, 0));
+  Task first, second, third;
+  CHECK(manager.getTaskByIndex(0, first));
+  CHECK(manager.getTaskByIndex(1, second));
+  CHECK(manager.getTaskByIndex(2, third));
+
+  std::vector<uint16_t> ids;
+  CHECK_EQ(searchManager(manager, "water", ids), 2);
+
+  // Edit re-indexes, delete unindexes
+  CHECK(manager.editTask(first.id, "repot plants", 2));
+  CHECK_EQ(searchManager(manager, "water", ids), 1);
+  CHECK_EQ(ids[0], third.id);
+  CHECK_EQ(searchManager(manager, "repot", ids), 1);
+  CHECK(manager.deleteTask(third.id));
+  CHECK_EQ(searchManager(manager, "water", ids), 0);
+
+  // A batch rebuilds the index at commit
+  TaskBatch batch = manager.beginBatch();
+  CHECK(batch != NO_BATCH);
+  CHECK(manager.addTask("water lilies", 2, 0, batch));
+  CHECK(manager.editTask(second.id, "order water filter", 3, 255, batch));
+  CHECK(manager.deleteTask(first.id, batch));
+  CHECK(manager.commitBatch(batch));
+  CHECK_EQ(searchManager(manager, "water", ids), 2);
+  CHECK_EQ(searchManager(manager, "plants", ids), 0);
+  CHECK_EQ(searchManager(manager, "parts", ids), 0);
+
+  // Sorting moves tasks, not ids
+  CHECK(manager.sortTasks(SORT_BY_PRIORITY));
+  CHECK_EQ(searchManager(manager, "order", ids), 1);
+  CHECK_EQ(ids[0], second.id);
+
+  // Filling the table to capacity keeps every title findable
+  while (manager.addTask("filler", 1, 0)) {}
+  CHECK_EQ(manager.getTaskCount(), TaskManager::MAX_TASKS);
+  CHECK_EQ(searchManager(manager, "filler", ids), TaskManager::MAX_TASKS - 2);
+}
+
+static void benchmark() {
+  static TaskSearchIndex<10000> index;
+  unsigned seed = 1;
+  for (uint16_t id = 1; id <= 10000; id++) {
+    std::string title = randomTitle(seed) + " " + std::to_string(id);
+    index.insert(id, title.c_str());
+  }
+
+  const char* queries[] = { "milk", "garage 12", "report 99", "ord", "bi", "x" };
+  TaskSearchResult results[10];
+  for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+    for (int m = 0; m < 2; m++) {
+      static const int RUNS = 200;
+      size_t found = 0;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (int r = 0; r < RUNS; r++) {
+        found = index.search(queries[q], static_cast<TaskSearchMode>(m), results, 10);
+      }
+      double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / RUNS;
+      printf("10k titles, %-9s %-9s %2u results %7.1f us\n", queries[q],
+             m == SEARCH_PREFIX ? "prefix" : "substring", (unsigned)found, us);
+    }
+  }
+  printf("index: %u bytes\n", (unsigned)index.getMemoryBytes());
+}
+
+int main() {
+  testMatchesBrute();
+  testRanking();
+  testManagerKeepsIndex();
+  benchmark();
+  return hostTestResult("test_task_search");
+}
@@ -0,0 +1,100 @@
+#!/bin/bash
+# TaskLink end to end: tools/tasklink against its own device emulator over a
+# pty. Import then export must give back the file byte for byte (replace and
+# append, with and without console noise between frames); an import past the
+# capacity must fail and leave the list as it was; tune list/get/set/save/reset
+# must round-trip and range-check.
+#
+# Run: test/test_tasklink_roundtrip.sh (run_tests.sh runs it too)
+
+cd "$(dirname "$0")" || exit 1
+CXX=${CXX:-g++}
+mkdir -p build
+tool=build/tasklink
+work=$(mktemp -d)
+emulators=()
+failures=0
+
+cleanup() {
+  for pid in "${emulators[@]}"; do kill "$pid" 2>/dev/null; done
+  rm -rf "$work"
+}
+trap cleanup EXIT
+
+fail() {
+  echo "test_tasklink_roundtrip: $*" >&2
+  failures=$((failures + 1))
+}
+
+# Starts an emulator; sets $port to its pty
+emulate() {
+  "$tool" emulate "$@" > "$work/emulator.out" &
+  emulators+=($!)
+  port=
+  for _ in $(seq 50); do
+    port=$(head -n 1 "$work/emulator.out")
+    [ -n "$port" ] && return 0
+    sleep 0.1
+  done
+  fail "emulator $* printed no pty"
+  return 1
+}
+
+if ! $CXX -std=c++11 -O2 -Wall -Wextra -I../src ../tools/tasklink.cpp ../src/TaskLinkEndpoint.cpp \
+     ../src/Tunables.cpp -o "$tool"; then
+  echo "test_tasklink_roundtrip: BUILD FAILED"
+  exit 1
+fi
+
+"$tool" generate "$work/twenty.txt" 20
+"$tool" generate "$work/ten.txt" 10
+"$tool" generate "$work/five.txt" 5
+# Edge cases the generator does not produce: longest title, extreme fields
+printf '1\t5\t3\t4294967295\t%s\n0\t1\t0\t0\tx\n' "$(printf 'T%.0s' $(seq 31))" >> "$work/five.txt"
+
+for noise in "" "--noise"; do
+  emulate --capacity 30 $noise || break
+
+  # Replace, then export: the same file
+  "$tool" import "$port" "$work/twenty.txt" > /dev/null || fail "import $noise"
+  "$tool" export "$port" "$work/out.txt" > /dev/null || fail "export $noise"
+  cmp -s "$work/twenty.txt" "$work/out.txt" || fail "replace round trip differs $noise"
+
+  # Append to 27, then an import that would pass 30 is refused whole
+  "$tool" import "$port" "$work/five.txt" --append > /dev/null || fail "append $noise"
+  cat "$work/twenty.txt" "$work/five.txt" > "$work/both.txt"
+  "$tool" export "$port" "$work/out.txt" > /dev/null || fail "export after append $noise"
+  cmp -s "$work/both.txt" "$work/out.txt" || fail "append round trip differs $noise"
+  if "$tool" import "$port" "$work/ten.txt" --append > /dev/null 2> "$work/err.txt"; then
+    fail "import past capacity succeeded $noise"
+  fi
+  grep -q "task list full" "$work/err.txt" || fail "capacity error not reported $noise"
+  "$tool" export "$port" "$work/out.txt" > /dev/null || fail "export after refusal $noise"
+  cmp -s "$work/both.txt" "$work/out.txt" || fail "refused import changed the list $noise"
+
+  # An empty replace clears the list
+  : > "$work/empty.txt"
+  "$tool" import "$port" "$work/empty.txt" > /dev/null || fail "empty import $noise"
+  "$tool" export "$port" "$work/out.txt" > /dev/null || fail "empty export $noise"
+  [ -s "$work/out.txt" ] && fail "empty import left tasks $noise"
+done
+
+# Tunables (the emulator keeps saved values in memory)
+emulate || exit 1
+"$tool" tune "$port" list > "$work/list.txt" || fail "tune list"
+[ "$(wc -l < "$work/list.txt")" -eq 6 ] || fail "tune list: expected 6 tunables"
+default=$("$tool" tune "$port" get debounce_ms) || fail "tune get"
+[ "$("$tool" tune "$port" set debounce_ms 123)" = "debounce_ms = 123" ] || fail "tune set"
+[ "$("$tool" tune "$port" get debounce_ms)" = "debounce_ms = 123" ] || fail "tune get after set"
+"$tool" tune "$port" set debounce_ms 100000 > /dev/null 2>&1 && fail "out-of-range set accepted"
+"$tool" tune "$port" set no_such_tunable 1 > /dev/null 2>&1 && fail "unknown tunable accepted"
+"$tool" tune "$port" save > /dev/null || fail "tune save"
+"$tool" tune "$port" reset > /dev/null || fail "tune reset"
+[ "$("$tool" tune "$port" get debounce_ms)" = "$default" ] || fail "reset did not restore the default"
+
+if [ $failures -eq 0 ]; then
+  echo "test_tasklink_roundtrip: ok"
+else
+  echo "test_tasklink_roundtrip: FAILED"
+  exit 1
+fi
@@ -0,0 +1,242 @@
+/*
+ * TimeSeriesStore: the code length of every bucket for timestamps and values
+ * (checked against the format in the class comment), round trips at the
+ * bucket edges and the int32 extremes, block recycling, block skipping in
+ * query(), and append/query throughput with the Model's history geometry.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_time_series.cpp -o test_time_series
+ */
+#include <chrono>
+#include <limits>
+#include <vector>
+
+#include "HostTest.h"
+#include "TimeSeriesStore.h"
+
+struct Record {
+  uint32_t time;
+  int32_t values[2];
+};
+
+static void collect(void* context, uint32_t time, const int32_t* values) {
+  Record record = { time, { values[0], values[1] } };
+  static_cast<std::vector<Record>*>(context)->push_back(record);
+}
+
+static uint32_t zigzag(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+// Code length from the format: 0 | 10+n1 | 110+n2 | 1110+n3 | 1111+32
+static size_t codeBits(uint32_t zz, uint8_t n1, uint8_t n2, uint8_t n3) {
+  if (zz == 0) return 1;
+  if (zz < (1u << n1)) return 2 + n1;
+  if (zz < (1u << n2)) return 3 + n2;
+  if (zz < (1u << n3)) return 4 + n3;
+  return 4 + 32;
+}
+
+static size_t referenceBits(const std::vector<Record>& records) {
+  size_t bits = 0;
+  uint32_t prevDelta = 0;
+  for (size_t i = 1; i < records.size(); i++) {
+    uint32_t delta = records[i].time - records[i - 1].time;
+    bits += codeBits(zigzag(static_cast<int32_t>(delta - prevDelta)), 7, 9, 12);
+    prevDelta = delta;
+    for (int c = 0; c < 2; c++) {
+      uint32_t step = static_cast<uint32_t>(records[i].values[c]) - static_cast<uint32_t>(records[i - 1].values[c]);
+      bits += codeBits(zigzag(static_cast<int32_t>(step)), 4, 8, 12);
+    }
+  }
+  return bits;
+}
+
+/**
+ * Alternating steps of +step and -step give zigzag codes 2 step and
+ * 2 step - 1, so step = 2^(n-1) puts them on either side of a bucket edge.
+ * The timestamp cadence alternates the same way with timeStep.
+ */
+static std::vector<Record> makeEdgeSeries(uint32_t timeStep, int32_t valueStep, int32_t other) {
+  std::vector<Record> records;
+  uint32_t time = 5000;
+  uint32_t delta = timeStep + 1;
+  int32_t value = 1000;
+  for (int i = 0; i < 33; i++) {
+    Record record = { time, { value, (i & 1) ? other : 0 } };
+    records.push_back(record);
+    delta = (i & 1) ? delta - timeStep : delta + timeStep;
+    time += delta;
+    value = static_cast<int32_t>(static_cast<uint32_t>(value) +
+                                 static_cast<uint32_t>((i & 1) ? -valueStep : valueStep));
+  }
+  return records;
+}
+
+static void checkSeries(const std::vector<Record>& records) {
+  TimeSeriesStore<2, 1024, 2> store;
+  CHECK(store.append(records[0].time, records[0].values));
+  size_t header = store.getBytesUsed();
+  for (size_t i = 1; i < records.size(); i++) {
+    CHECK(store.append(records[i].time, records[i].values));
+  }
+  CHECK_EQ(store.getBlocksUsed(), 1);
+  CHECK_EQ(store.getBytesUsed() - header, (referenceBits(records) + 7) / 8);
+
+  std::vector<Record> decoded;
+  CHECK_EQ(store.query(0, 0xFFFFFFFFu, collect, &decoded), records.size());
+  if (decoded.size() != records.size()) return;
+  for (size_t i = 0; i < records.size(); i++) {
+    CHECK_EQ(decoded[i].time, records[i].time);
+    CHECK_EQ(decoded[i].values[0], records[i].values[0]);
+    CHECK_EQ(decoded[i].values[1], records[i].values[1]);
+  }
+}
+
+static void testBuckets() {
+  // Unchanged values and a steady cadence: the 1-bit code
+  checkSeries(makeEdgeSeries(0, 0, 0));
+
+  // Each timestamp bucket edge (7, 9, 12 bits, then 32)
+  checkSeries(makeEdgeSeries(1u << 6, 0, 0));
+  checkSeries(makeEdgeSeries(1u << 8, 0, 0));
+  checkSeries(makeEdgeSeries(1u << 11, 0, 0));
+  checkSeries(makeEdgeSeries(100000, 0, 0));
+
+  // Each value bucket edge (4, 8, 12 bits, then 32)
+  checkSeries(makeEdgeSeries(0, 1 << 3, 0));
+  checkSeries(makeEdgeSeries(0, 1 << 7, 0));
+  checkSeries(makeEdgeSeries(0, 1 << 11, 0));
+  checkSeries(makeEdgeSeries(0, 1 << 20, 0));
+
+  // Deltas that wrap int32: the full-width code round-trips them
+  checkSeries(makeEdgeSeries(3, 0, std::numeric_limits<int32_t>::min()));
+  checkSeries(makeEdgeSeries(3, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::max()));
+}
+
+static void testOrdering() {
+  TimeSeriesStore<2, 64, 2> store;
+  int32_t values[2] = { 1, 2 };
+  CHECK(store.isEmpty());
+  CHECK(store.append(100, values));
+  CHECK(!store.append(100, values));
+  CHECK(!store.append(99, values));
+  CHECK(store.append(101, values));
+  CHECK_EQ(store.getRecordCount(), 2);
+  CHECK_EQ(store.getAppendCount(), 2);
+}
+
+static void testRecycling() {
+  // 4 blocks of 16 bytes: a few dozen records each, then the oldest goes
+  TimeSeriesStore<2, 16, 4> store;
+  std::vector<Record> appended;
+  for (uint32_t i = 0; i < 2000; i++) {
+    Record record = { 1000 + i * 10, { static_cast<int32_t>(i % 50), static_cast<int32_t>(2000 - i) } };
+    CHECK(store.append(record.time, record.values));
+    appended.push_back(record);
+  }
+  CHECK_EQ(store.getBlocksUsed(), 4);
+  CHECK_EQ(store.getAppendCount(), 2000);
+  CHECK(store.getRecordCount() < 2000);
+  CHECK(store.getBytesUsed() <= store.getCapacityBytes());
+  CHECK_EQ(store.getNewestTime(), appended.back().time);
+
+  // What is left is exactly the newest records, contiguous and intact
+  std::vector<Record> decoded;
+  CHECK_EQ(store.query(0, 0xFFFFFFFFu, collect, &decoded), store.getRecordCount());
+  CHECK_EQ(decoded.front().time, store.getOldestTime());
+  size_t offset = appended.size() - decoded.size();
+  for (size_t i = 0; i < decoded.size(); i++) {
+    CHECK_EQ(decoded[i].time, appended[offset + i].time);
+    CHECK_EQ(decoded[i].values[0], appended[offset + i].values[0]);
+    CHECK_EQ(decoded[i].values[1], appended[offset + i].values[1]);
+  }
+
+  store.clear();
+  CHECK(store.isEmpty());
+  CHECK_EQ(store.getRecordCount(), 0);
+  CHECK(store.append(5, appended[0].values));
+}
+
+static void testQuerySkipsBlocks() {
+  TimeSeriesStore<2, 64, 16> store;
+  for (uint32_t i = 0; i < 5000; i++) {
+    int32_t values[2] = { static_cast<int32_t>(i * 7 % 300), 42 };
+    store.append(10 + i * 2, values);
+  }
+  CHECK_EQ(store.getBlocksUsed(), 16);
+  uint32_t oldest = store.getOldestTime();
+  uint32_t newest = store.getNewestTime();
+
+  // Everything: every block decoded
+  std::vector<Record> all;
+  uint32_t before = store.getBlocksDecoded();
+  store.query(0, 0xFFFFFFFFu, collect, &all);
+  CHECK_EQ(store.getBlocksDecoded() - before, 16);
+  CHECK_EQ(all.size(), store.getRecordCount());
+
+  // Outside the stored span on either side: nothing decoded
+  before = store.getBlocksDecoded();
+  std::vector<Record> none;
+  CHECK_EQ(store.query(0, oldest - 1, collect, &none), 0);
+  CHECK_EQ(store.query(newest + 1, newest + 1000, collect, &none), 0);
+  CHECK_EQ(store.getBlocksDecoded() - before, 0);
+
+  // A narrow range in the middle: one block, at most two if it straddles
+  size_t middle = all.size() / 2;
+  before = store.getBlocksDecoded();
+  std::vector<Record> some;
+  CHECK_EQ(store.query(all[middle].time, all[middle + 3].time, collect, &some), 4);
+  CHECK(store.getBlocksDecoded() - before <= 2);
+  CHECK_EQ(some.front().time, all[middle].time);
+
+  // The newest seconds touch only the newest block
+  before = store.getBlocksDecoded();
+  std::vector<Record> last;
+  CHECK_EQ(store.queryLast(4, collect, &last), 3);
+  CHECK_EQ(store.getBlocksDecoded() - before, 1);
+}
+
+// Counts records without storing them (the query benchmark)
+static void countRecord(void* context, uint32_t, const int32_t* values) {
+  *static_cast<int64_t*>(context) += values[0];
+}
+
+static void benchmark() {
+  // Model::SensorHistory geometry: 2 channels, 16 blocks of 256 bytes
+  TimeSeriesStore<2> store;
+  static const uint32_t RECORDS = 2000000;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < RECORDS; i++) {
+    // A slow drift with a little noise, like a smoothed potentiometer reading
+    int32_t values[2] = { 1500 + static_cast<int32_t>((i / 16) % 200) + static_cast<int32_t>(i % 3),
+                          2200 - static_cast<int32_t>((i / 32) % 100) };
+    store.append(i * 5, values);
+  }
+  double appendSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  int64_t sum = 0;
+  static const int QUERIES = 200;
+  start = std::chrono::steady_clock::now();
+  size_t visited = 0;
+  for (int q = 0; q < QUERIES; q++) {
+    visited += store.query(0, 0xFFFFFFFFu, countRecord, &sum);
+  }
+  double querySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CHECK(visited > 0);
+
+  size_t records = store.getRecordCount();
+  printf("%u records in %u bytes (%.2f bytes/record, raw %u); append %.1f M/s, decode %.1f M records/s\n",
+         (unsigned)records, (unsigned)store.getBytesUsed(),
+         static_cast<double>(store.getBytesUsed()) / records, (unsigned)(4 + 2 * 4),
+         RECORDS / appendSeconds / 1e6, visited / querySeconds / 1e6);
+}
+
+int main() {
+  testBuckets();
+  testOrdering();
+  testRecycling();
+  testQuerySkipsBlocks();
+  benchmark();
+  return hostTestResult("test_time_series");
+}
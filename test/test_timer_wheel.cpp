@@ -0,0 +1,179 @@
+/*
+ * TimerWheel: every timer fires exactly at its expiry across the level
+ * cascades, cancel and re-arm, periodic re-arming, expiries beyond RANGE,
+ * clock jumps, and the cost per tick with thousands of timers pending.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_timer_wheel.cpp ../src/TimerWheel.cpp -o test_timer_wheel
+ */
+#include <chrono>
+#include <stdlib.h>
+#include <vector>
+
+#include "HostTest.h"
+#include "TimerWheel.h"
+
+// Per-timer record of when it fired
+struct Probe {
+  TimerNode node;
+  uint32_t firedAt;
+  int fired;
+};
+
+static uint32_t onFire(TimerNode*, uint32_t now, void* context) {
+  Probe* probe = static_cast<Probe*>(context);
+  probe->firedAt = now;
+  probe->fired++;
+  return 0;
+}
+
+static uint32_t everyTen(TimerNode*, uint32_t now, void* context) {
+  ++*static_cast<int*>(context);
+  return now + 10;
+}
+
+static void arm(TimerWheel& wheel, Probe& probe, uint32_t expires) {
+  probe.node.callback = onFire;
+  probe.node.context = &probe;
+  probe.fired = 0;
+  probe.firedAt = 0;
+  wheel.schedule(probe.node, expires);
+}
+
+static void testExactExpiry() {
+  static const uint32_t START = 1000000;
+  TimerWheel wheel;
+  wheel.reset(START);
+
+  // Expiries spread over every level; every seventh is cancelled
+  std::vector<Probe> probes(20000);
+  std::vector<uint32_t> expiries(probes.size());
+  srand(1);
+  for (size_t i = 0; i < probes.size(); i++) {
+    uint32_t delay = 1 + ((i % 4 == 0) ? rand() % 300000 : rand() % 5000);
+    expiries[i] = START + delay;
+    arm(wheel, probes[i], expiries[i]);
+  }
+  for (size_t i = 0; i < probes.size(); i += 7) {
+    wheel.cancel(probes[i].node);
+    CHECK(!probes[i].node.isPending());
+  }
+  size_t pending = wheel.getPendingCount();
+  CHECK_EQ(pending, probes.size() - (probes.size() + 6) / 7);
+
+  // Advancing in uneven steps fires each one once, at its own second
+  size_t fired = 0;
+  uint32_t now = START;
+  while (now < START + 300001) {
+    now += 1 + rand() % 700;
+    fired += wheel.advance(now);
+  }
+  CHECK_EQ(fired, pending);
+  CHECK_EQ(wheel.getPendingCount(), 0);
+  for (size_t i = 0; i < probes.size(); i++) {
+    if (i % 7 == 0) {
+      CHECK_EQ(probes[i].fired, 0);
+    } else {
+      CHECK_EQ(probes[i].fired, 1);
+      // advance() runs every tick on the way, so the callback sees the expiry itself
+      CHECK_EQ(probes[i].firedAt, expiries[i]);
+    }
+  }
+}
+
+static void testRearmAndPeriodic() {
+  TimerWheel wheel;
+  wheel.reset(100);
+
+  // Re-arming moves the timer instead of adding a second one
+  Probe probe;
+  arm(wheel, probe, 200);
+  wheel.schedule(probe.node, 5000);
+  CHECK_EQ(wheel.getPendingCount(), 1);
+  wheel.advance(4999);
+  CHECK_EQ(probe.fired, 0);
+  wheel.advance(5000);
+  CHECK_EQ(probe.fired, 1);
+  CHECK(!probe.node.isPending());
+
+  // A past expiry fires on the next tick
+  arm(wheel, probe, 10);
+  wheel.advance(5001);
+  CHECK_EQ(probe.firedAt, 5001);
+
+  // Cancelling an idle timer is harmless
+  wheel.cancel(probe.node);
+  CHECK_EQ(wheel.getPendingCount(), 0);
+
+  // A periodic timer re-arms through its return value
+  int count = 0;
+  TimerNode periodic(everyTen, &count);
+  wheel.schedule(periodic, 5010);
+  wheel.advance(5100);
+  CHECK_EQ(count, 10);
+  CHECK(periodic.isPending());
+  wheel.cancel(periodic);
+
+  // Time never moves backwards
+  CHECK_EQ(wheel.advance(10), 0);
+  CHECK_EQ(wheel.getTime(), 5100);
+}
+
+static void testBeyondRangeAndJumps() {
+  TimerWheel wheel;
+  wheel.reset(0);
+
+  // Further out than the wheels reach: parked, then fired on time
+  Probe far;
+  arm(wheel, far, TimerWheel::RANGE + 12345);
+  wheel.advance(TimerWheel::RANGE);
+  CHECK_EQ(far.fired, 0);
+  wheel.advance(TimerWheel::RANGE + 12345);
+  CHECK_EQ(far.fired, 1);
+  CHECK_EQ(far.firedAt, TimerWheel::RANGE + 12345);
+
+  // A clock jump past the range (RTC set forward) fires what expired on the way,
+  // once, and keeps later timers
+  Probe soon, later;
+  uint32_t base = wheel.getTime();
+  arm(wheel, soon, base + 100);
+  arm(wheel, later, base + 3 * TimerWheel::RANGE);
+  wheel.advance(base + 2 * TimerWheel::RANGE);
+  CHECK_EQ(soon.fired, 1);
+  CHECK_EQ(later.fired, 0);
+  CHECK(later.node.isPending());
+  wheel.advance(base + 3 * TimerWheel::RANGE);
+  CHECK_EQ(later.fired, 1);
+
+  // reset() keeps pending timers and re-places them against the new time
+  Probe kept;
+  arm(wheel, kept, wheel.getTime() + 50);
+  wheel.reset(wheel.getTime() + 10);
+  CHECK_EQ(wheel.getPendingCount(), 1);
+  wheel.advance(wheel.getTime() + 40);
+  CHECK_EQ(kept.fired, 1);
+}
+
+static void benchmarkTicks() {
+  TimerWheel wheel;
+  wheel.reset(0);
+  std::vector<Probe> probes(17000);
+  for (size_t i = 0; i < probes.size(); i++) {
+    arm(wheel, probes[i], 1000000 + static_cast<uint32_t>(i) * 50);
+  }
+
+  // Empty ticks: only cascades, nothing due
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  wheel.advance(999999);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CHECK_EQ(wheel.getPendingCount(), probes.size());
+  printf("%u timers pending: %.1f ns per tick\n", (unsigned)probes.size(), seconds * 1e9 / 999999);
+}
+
+int main() {
+  testExactExpiry();
+  testRearmAndPeriodic();
+  testBeyondRangeAndJumps();
+  benchmarkTicks();
+  return hostTestResult("test_timer_wheel");
+}
@@ -0,0 +1,378 @@
+/*
+ * tools/tracedump on synthetic captures: spans matched across cores (task,
+ * mutex with timeout, render, I2C) and instants at the times the records
+ * were written, track names, and the summary counts; CCOUNT interpolated
+ * between SYNCs through a clock change, light sleep, and the wraps of
+ * CCOUNT, the 24-bit SYNC time and the 32-bit frame time; records before
+ * the first SYNC, lost counts, console text and a corrupt frame in the
+ * stream; and a capture without trace frames.
+ *
+ * The test builds the tool into build/ (with ASan/UBSan) and runs it.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_tracedump.cpp -o test_tracedump
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "HostTest.h"
+#include "TaskLinkProtocol.h"
+#include "TraceFormat.h"
+
+static const char* TOOL = "build/tracedump";
+static const char* CAPTURE = "build/tracedump_capture.bin";
+static const char* JSON = "build/tracedump_trace.json";
+static const char* LOG = "build/tracedump_log.txt";
+
+// A console stream as the device would send it
+struct Capture {
+  std::vector<uint8_t> bytes;
+  uint8_t seq;
+
+  Capture() : seq(0) {}
+
+  void text(const char* line) {
+    bytes.insert(bytes.end(), line, line + strlen(line));
+  }
+
+  void frame(uint8_t type, const std::vector<uint8_t>& payload) {
+    uint8_t out[TaskLinkFramer::MAX_FRAME];
+    size_t size = TaskLinkFramer::encode(type, seq++, payload.data(), payload.size(), out);
+    CHECK(size > 0);
+    bytes.insert(bytes.end(), out, out + size);
+  }
+
+  void records(uint8_t core, uint16_t lost, uint32_t syncUs, const std::vector<TraceRecord>& records) {
+    std::vector<uint8_t> payload(TRACE_FRAME_HEADER + records.size() * TRACE_RECORD_SIZE);
+    payload[0] = core;
+    taskLinkPut16(&payload[2], lost);
+    taskLinkPut32(&payload[4], syncUs);
+    for (size_t i = 0; i < records.size(); i++) {
+      tracePackRecord(records[i], &payload[TRACE_FRAME_HEADER + i * TRACE_RECORD_SIZE]);
+    }
+    frame(TASKLINK_TRACE, payload);
+  }
+
+  void name(uint8_t id, uint16_t arg, const char* name) {
+    std::vector<uint8_t> payload(4);
+    payload[0] = id;
+    taskLinkPut16(&payload[1], arg);
+    payload[3] = static_cast<uint8_t>(strlen(name));
+    payload.insert(payload.end(), name, name + strlen(name));
+    frame(TASKLINK_TRACE_NAMES, payload);
+  }
+};
+
+static TraceRecord record(uint32_t cycles, uint8_t type, uint8_t id, uint16_t arg) {
+  TraceRecord result = { cycles, type, id, arg };
+  return result;
+}
+
+// SYNC as writeSync() records it: microseconds 0..23 in (id, arg)
+static TraceRecord sync(uint32_t cycles, uint32_t us) {
+  return record(cycles, TRACE_TYPE_SYNC, static_cast<uint8_t>(us >> 16), static_cast<uint16_t>(us));
+}
+
+static std::string readFile(const char* path) {
+  std::string text;
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) return text;
+  char buffer[4096];
+  size_t got;
+  while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) text.append(buffer, got);
+  fclose(file);
+  return text;
+}
+
+// Runs the tool on the capture; returns its exit status
+static int convert(const Capture& capture, std::string& json, std::string& log) {
+  FILE* file = fopen(CAPTURE, "wb");
+  CHECK(file != nullptr);
+  if (file == nullptr) return -1;
+  if (!capture.bytes.empty()) fwrite(capture.bytes.data(), 1, capture.bytes.size(), file);
+  fclose(file);
+  remove(JSON);
+
+  char command[256];
+  snprintf(command, sizeof(command), "%s %s %s 2> %s", TOOL, CAPTURE, JSON, LOG);
+  int status = system(command);
+  json = readFile(JSON);
+  log = readFile(LOG);
+  return status;
+}
+
+// One trace event: the tool writes one per line
+struct Event {
+  std::string name;
+  std::string phase;
+  double ts;
+  double dur;
+  int tid;
+  std::string args;
+};
+
+static std::string stringField(const std::string& line, const char* key) {
+  std::string prefix = std::string("\"") + key + "\":\"";
+  size_t at = line.find(prefix);
+  if (at == std::string::npos) return "";
+  at += prefix.size();
+  return line.substr(at, line.find('"', at) - at);
+}
+
+static double numberField(const std::string& line, const char* key) {
+  std::string prefix = std::string("\"") + key + "\":";
+  size_t at = line.find(prefix);
+  return at == std::string::npos ? -1 : strtod(line.c_str() + at + prefix.size(), nullptr);
+}
+
+static std::vector<Event> parse(const std::string& json) {
+  std::vector<Event> events;
+  size_t start = 0;
+  while (start < json.size()) {
+    size_t end = json.find('\n', start);
+    if (end == std::string::npos) end = json.size();
+    std::string line = json.substr(start, end - start);
+    start = end + 1;
+    if (line.compare(0, 8, "{\"name\":") != 0) continue;
+
+    Event event;
+    event.name = stringField(line, "name");
+    event.phase = stringField(line, "ph");
+    event.ts = numberField(line, "ts");
+    event.dur = numberField(line, "dur");
+    event.tid = static_cast<int>(numberField(line, "tid"));
+    size_t args = line.find("\"args\":{");
+    event.args = args == std::string::npos ? "" : line.substr(args + 8, line.find('}', args) - args - 8);
+    events.push_back(event);
+  }
+  return events;
+}
+
+// The single event of a name and phase; reports if there are none or several
+static Event find(const std::vector<Event>& events, const std::string& name, const char* phase) {
+  Event found = { "", "", -1, -1, -1, "" };
+  int matches = 0;
+  for (size_t i = 0; i < events.size(); i++) {
+    if (events[i].name == name && events[i].phase == phase) {
+      found = events[i];
+      matches++;
+    }
+  }
+  if (matches != 1) {
+    fprintf(stderr, "\"%s\" (%s): %d events\n", name.c_str(), phase, matches);
+    CHECK_EQ(matches, 1);
+  }
+  return found;
+}
+
+static void checkNear(double value, double expected, int line) {
+  if (fabs(value - expected) > 0.01) {
+    fprintf(stderr, "test_tracedump.cpp:%d: %.3f, expected %.3f\n", line, value, expected);
+    CHECK(fabs(value - expected) <= 0.01);
+  }
+}
+#define CHECK_NEAR(value, expected) checkNear((value), (expected), __LINE__)
+
+static bool contains(const std::string& text, const char* part) {
+  if (text.find(part) != std::string::npos) return true;
+  fprintf(stderr, "missing \"%s\" in:\n%s\n", part, text.c_str());
+  return false;
+}
+
+static void testSpans() {
+  // Both cores at 240 MHz; CCOUNTs differ per core, SYNCs pair them with T0 and T0 + 1000
+  static const uint32_t T0 = 10000000, C0 = 1000000, C1 = 5000000, MHZ = 240;
+  Capture capture;
+  capture.text("ets Jun  8 2016 00:22:57\r\nboot: UI up\r\n");
+  capture.name(TRACE_ID_TASK, 0, "UI executor");
+  capture.name(TRACE_ID_RENDER, 0, "Home");
+
+  std::vector<TraceRecord> core0;
+  core0.push_back(sync(C0, T0));
+  core0.push_back(record(C0, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 4));
+  core0.push_back(record(C0 + MHZ * 100, TRACE_TYPE_BEGIN, TRACE_ID_TASK, 0));
+  core0.push_back(record(C0 + MHZ * 150, TRACE_TYPE_BEGIN, TRACE_ID_MUTEX, TRACE_MUTEX_MODEL_TIME));
+  core0.push_back(record(C0 + MHZ * 200, TRACE_TYPE_BEGIN, TRACE_ID_I2C, 32));
+  core0.push_back(record(C0 + MHZ * 260, TRACE_TYPE_END, TRACE_ID_I2C, 32));
+  core0.push_back(record(C0 + MHZ * 300, TRACE_TYPE_INSTANT, TRACE_ID_INPUT, 5 | 2 << 8));
+  core0.push_back(record(C0 + MHZ * 320, TRACE_TYPE_BEGIN, TRACE_ID_MUTEX, TRACE_MUTEX_MODEL_STATE));
+  core0.push_back(record(C0 + MHZ * 380, TRACE_TYPE_END, TRACE_ID_MUTEX, TRACE_MUTEX_MODEL_STATE));
+  core0.push_back(record(C0 + MHZ * 600, TRACE_TYPE_BEGIN, TRACE_ID_RENDER, 0));
+  core0.push_back(record(C0 + MHZ * 700, TRACE_TYPE_END, TRACE_ID_RENDER, 0));
+  core0.push_back(record(C0 + MHZ * 800, TRACE_TYPE_END, TRACE_ID_TASK, 3));       // Never began
+  core0.push_back(record(C0 + MHZ * 900, TRACE_TYPE_BEGIN, TRACE_ID_RENDER, 1));   // Never ends
+  core0.push_back(sync(C0 + MHZ * 1000, T0 + 1000));
+  capture.records(0, 0, T0 + 1020, core0);
+
+  // The task and the mutex wait end on the other core
+  std::vector<TraceRecord> core1;
+  core1.push_back(sync(C1, T0));
+  core1.push_back(record(C1 + MHZ * 400, TRACE_TYPE_END, TRACE_ID_MUTEX,
+                         TRACE_MUTEX_MODEL_TIME | TRACE_MUTEX_TIMED_OUT));
+  core1.push_back(record(C1 + MHZ * 330, TRACE_TYPE_BEGIN, TRACE_ID_MUTEX, TRACE_MUTEX_MODEL_STATE));
+  core1.push_back(record(C1 + MHZ * 340, TRACE_TYPE_END, TRACE_ID_MUTEX, TRACE_MUTEX_MODEL_STATE));
+  core1.push_back(record(C1 + MHZ * 500, TRACE_TYPE_END, TRACE_ID_TASK, 0));
+  core1.push_back(sync(C1 + MHZ * 1000, T0 + 1000));
+  capture.records(1, 0, T0 + 1010, core1);
+  capture.text("I (1234) render: done\r\n");
+
+  std::string json, log;
+  CHECK_EQ(convert(capture, json, log), 0);
+  CHECK(json.compare(0, 16, "{\"traceEvents\":[") == 0);
+  CHECK(contains(json, "],\"displayTimeUnit\":\"ms\"}"));
+  std::vector<Event> events = parse(json);
+
+  Event button = find(events, "button GPIO4", "i");
+  CHECK_NEAR(button.ts, 0);
+  Event input = find(events, "event 5 (source 2)", "i");
+  CHECK_NEAR(input.ts, 300);
+
+  Event task = find(events, "UI executor", "X");
+  CHECK_NEAR(task.ts, 100);
+  CHECK_NEAR(task.dur, 400);
+  CHECK(contains(task.args, "\"core\":0,\"endCore\":1"));
+
+  Event wait = find(events, "wait Model time (timed out)", "X");
+  CHECK_NEAR(wait.ts, 150);
+  CHECK_NEAR(wait.dur, 250);
+
+  Event i2c = find(events, "I2C", "X");
+  CHECK_NEAR(i2c.ts, 200);
+  CHECK_NEAR(i2c.dur, 60);
+  CHECK(contains(i2c.args, "\"bytes\":32"));
+
+  // Two overlapping waits on one mutex pair first-in, first-out
+  int waits = 0;
+  for (size_t i = 0; i < events.size(); i++) {
+    if (events[i].name != "wait Model state") continue;
+    waits++;
+    bool first = fabs(events[i].ts - 320) < 0.01 && fabs(events[i].dur - 20) < 0.01;
+    bool second = fabs(events[i].ts - 330) < 0.01 && fabs(events[i].dur - 50) < 0.01;
+    CHECK(first || second);
+  }
+  CHECK_EQ(waits, 2);
+
+  Event render = find(events, "Home render", "X");
+  CHECK_NEAR(render.ts, 600);
+  CHECK_NEAR(render.dur, 100);
+
+  // Each lane named once, under its track name
+  for (size_t i = 0; i < events.size(); i++) {
+    if (events[i].phase != "X") continue;
+    int named = 0;
+    for (size_t j = 0; j < events.size(); j++) {
+      if (events[j].name == "thread_name" && events[j].tid == events[i].tid) named++;
+    }
+    CHECK_EQ(named, 1);
+  }
+  CHECK(contains(json, "\"args\":{\"name\":\"UI executor\"}"));
+  CHECK(contains(json, "\"args\":{\"name\":\"Mutex Model time\"}"));
+
+  CHECK(contains(log, "6 spans, 2 instants; 0 records lost on the device, 0 before the first sync, "
+                      "1 ends and 1 begins unmatched"));
+  CHECK(contains(log, "2 frames, 16 records, 0 frame errors"));
+}
+
+static void testClock() {
+  // Starts 3 ms before the 32-bit microsecond clock wraps, with CCOUNT about to wrap
+  static const uint32_t T0 = 0xFFFFFFFFu - 3000, C = 0xFFFF0000u;
+  Capture capture;
+
+  // Written before the first SYNC: cannot be placed
+  std::vector<TraceRecord> early;
+  for (uint16_t i = 0; i < 3; i++) early.push_back(record(C - 1000 + i, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 90 + i));
+  capture.records(0, 7, T0 - 10, early);
+
+  // 80 MHz for 1 ms
+  std::vector<TraceRecord> records;
+  records.push_back(sync(C, T0));
+  records.push_back(record(C + 80 * 250, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 1));
+  records.push_back(sync(C + 80000, T0 + 1000));
+  capture.records(0, 0, T0 + 1005, records);
+  capture.text("noise between frames \xA5\x30 not a frame\r\n");
+
+  // Light sleep: 5 ms pass, CCOUNT counts 0.5 ms of them. Records in there
+  // are placed at the last regular rate, counted from the earlier SYNC.
+  records.clear();
+  records.push_back(record(C + 80000 + 80 * 200, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 2));
+  records.push_back(record(C + 80000 + 80 * 499, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 3));
+  records.push_back(sync(C + 120000, T0 + 6000));
+  capture.records(0, 5, T0 + 6010, records);
+
+  // A copy with one payload byte flipped: fails the CRC and is skipped
+  Capture corrupt;
+  corrupt.records(0, 0, T0 + 6020, std::vector<TraceRecord>(1, record(C + 120001, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 99)));
+  corrupt.bytes[TaskLinkFramer::HEADER_SIZE + TRACE_FRAME_HEADER] ^= 0x40;
+  capture.bytes.insert(capture.bytes.end(), corrupt.bytes.begin(), corrupt.bytes.end());
+
+  // Back to 240 MHz, then records after the last SYNC at that rate. The
+  // frame goes out 200 ms after its SYNC (a backed-up UART): the SYNC time
+  // still comes from its own 24 bits.
+  records.clear();
+  records.push_back(record(C + 120000 + 240 * 100, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 4));
+  records.push_back(sync(C + 120000 + 240000, T0 + 7000));
+  records.push_back(record(C + 120000 + 240000 + 240 * 50, TRACE_TYPE_INSTANT, TRACE_ID_BUTTON, 5));
+  capture.records(0, 0, T0 + 207000, records);
+
+  std::string json, log;
+  CHECK_EQ(convert(capture, json, log), 0);
+  std::vector<Event> events = parse(json);
+
+  // Relative to the first placed record, T0 + 250
+  CHECK_NEAR(find(events, "button GPIO1", "i").ts, 0);
+  CHECK_NEAR(find(events, "button GPIO2", "i").ts, 1200 - 250);
+  CHECK_NEAR(find(events, "button GPIO3", "i").ts, 1499 - 250);
+  CHECK_NEAR(find(events, "button GPIO4", "i").ts, 6100 - 250);
+  CHECK_NEAR(find(events, "button GPIO5", "i").ts, 7050 - 250);
+  for (size_t i = 0; i < events.size(); i++) {
+    CHECK(events[i].name != "button GPIO90" && events[i].name != "button GPIO99");
+  }
+
+  CHECK(contains(log, "0 spans, 5 instants; 12 records lost on the device, 3 before the first sync"));
+  // The corrupt frame and the stray 0xA5 in the console text
+  CHECK(contains(log, "4 frames, 5 records, 2 frame errors"));
+}
+
+static void testNoTrace() {
+  Capture capture;
+  capture.text("just console output\r\n");
+  capture.name(TRACE_ID_TASK, 0, "UI executor");
+  std::string json, log;
+  CHECK(convert(capture, json, log) != 0);
+  CHECK(contains(log, "no trace records in 0 frames"));
+
+  Capture empty;
+  CHECK(convert(empty, json, log) != 0);
+}
+
+static void testRecordFormat() {
+  // The wire layout TraceFormat.h documents: LE32 cycles, type, id, LE16 arg
+  TraceRecord in = record(0x89ABCDEFu, TRACE_TYPE_END, TRACE_ID_MUTEX, 0x8005);
+  uint8_t packed[TRACE_RECORD_SIZE];
+  tracePackRecord(in, packed);
+  static const uint8_t expected[TRACE_RECORD_SIZE] = { 0xEF, 0xCD, 0xAB, 0x89, 2, 2, 0x05, 0x80 };
+  CHECK(memcmp(packed, expected, sizeof(expected)) == 0);
+  TraceRecord out;
+  traceUnpackRecord(packed, out);
+  CHECK_EQ(out.cycles, in.cycles);
+  CHECK_EQ(out.type, in.type);
+  CHECK_EQ(out.id, in.id);
+  CHECK_EQ(out.arg, in.arg);
+}
+
+int main() {
+  if (system("${CXX:-g++} -std=c++11 -O1 -g -Wall -Wextra -fsanitize=address,undefined "
+             "-fno-sanitize-recover=undefined -I../src ../tools/tracedump.cpp -o build/tracedump") != 0) {
+    printf("test_tracedump: BUILD FAILED (tools/tracedump.cpp)\n");
+    return 1;
+  }
+  testRecordFormat();
+  testSpans();
+  testClock();
+  testNoTrace();
+  return hostTestResult("test_tracedump");
+}
@@ -0,0 +1,389 @@
+/*
+ * Tunables: the definitions (names fit NVS keys, defaults within bounds),
+ * set() range checks and watchers (called at registration and on every
+ * change, only for their own id), saved values loaded within bounds, save()
+ * and erase() including storage failures; and TaskLinkEndpoint answering
+ * TUNE_* frames, also in the middle of an import, which a refused TUNE_SET
+ * must not abort. test_tasklink_roundtrip.sh covers the host tool's tune
+ * commands over a pty.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -O2 -Wall -Wextra -I../src test_tunables.cpp ../src/Tunables.cpp ../src/TaskLinkEndpoint.cpp -o test_tunables
+ */
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "HostTest.h"
+#include "TaskConfig.h"
+#include "TaskLinkEndpoint.h"
+#include "Tunables.h"
+
+static void testDefs() {
+  for (uint8_t id = 0; id < TUNE_COUNT; id++) {
+    const TunableDef& def = Tunables::getDef(id);
+    CHECK(strlen(def.name) <= TUNABLE_NAME_MAX);
+    CHECK(def.min <= def.def && def.def <= def.max);
+    CHECK_EQ(Tunables::find(def.name), id);
+    for (uint8_t other = 0; other < id; other++) CHECK(strcmp(Tunables::getDef(other).name, def.name) != 0);
+  }
+  CHECK_EQ(Tunables::find("no_such_tunable"), TUNE_COUNT);
+  CHECK_EQ(Tunables::find(""), TUNE_COUNT);
+  CHECK_EQ(Tunables::getDef(TUNE_DEBOUNCE_MS).def, INPUT_DEBOUNCE_MS);
+  CHECK_EQ(Tunables::getDef(TUNE_UI_PRIORITY).def, TASK_UI_PRIORITY);
+}
+
+// Records what a watcher was told
+struct Watched {
+  int calls;
+  int32_t value;
+};
+
+static void onChange(void* context, int32_t value) {
+  Watched* watched = static_cast<Watched*>(context);
+  watched->calls++;
+  watched->value = value;
+}
+
+static Watched s_debounceA, s_debounceB, s_poll, s_filler;
+
+static void testSetAndWatch() {
+  Tunables* tunables = Tunables::getInstance();
+  tunables->begin(nullptr);
+  for (uint8_t id = 0; id < TUNE_COUNT; id++) CHECK_EQ(tunables->get(id), Tunables::getDef(id).def);
+  CHECK(!tunables->save());             // Nowhere to save to
+  CHECK(tunables->erase());
+
+  // A watcher hears the current value at once
+  CHECK(tunables->watch(TUNE_DEBOUNCE_MS, onChange, &s_debounceA));
+  CHECK(tunables->watch(TUNE_DEBOUNCE_MS, onChange, &s_debounceB));
+  CHECK(tunables->watch(TUNE_POLL_MS, onChange, &s_poll));
+  CHECK_EQ(s_debounceA.calls, 1);
+  CHECK_EQ(s_debounceA.value, INPUT_DEBOUNCE_MS);
+  CHECK_EQ(s_poll.value, INPUT_POLL_MS);
+
+  // Every watcher of a changed tunable, and only those
+  CHECK(tunables->set(TUNE_DEBOUNCE_MS, 60));
+  CHECK_EQ(s_debounceA.calls, 2);
+  CHECK_EQ(s_debounceB.calls, 2);
+  CHECK_EQ(s_debounceB.value, 60);
+  CHECK_EQ(s_poll.calls, 1);
+
+  // Setting the same value is not a change
+  CHECK(tunables->set(TUNE_DEBOUNCE_MS, 60));
+  CHECK_EQ(s_debounceA.calls, 2);
+
+  // Bounds are inclusive; anything outside is refused and changes nothing
+  const TunableDef& def = Tunables::getDef(TUNE_DEBOUNCE_MS);
+  CHECK(tunables->set(TUNE_DEBOUNCE_MS, def.min));
+  CHECK(tunables->set(TUNE_DEBOUNCE_MS, def.max));
+  CHECK(!tunables->set(TUNE_DEBOUNCE_MS, def.min - 1));
+  CHECK(!tunables->set(TUNE_DEBOUNCE_MS, def.max + 1));
+  CHECK(!tunables->set(TUNE_DEBOUNCE_MS, INT32_MIN));
+  CHECK(!tunables->set(TUNE_COUNT, 1));
+  CHECK_EQ(tunables->get(TUNE_DEBOUNCE_MS), def.max);
+  CHECK_EQ(s_debounceA.calls, 4);
+  CHECK_EQ(tunables->get(TUNE_COUNT), 0);
+
+  // Bad registrations, then a full table
+  CHECK(!tunables->watch(TUNE_COUNT, onChange, &s_filler));
+  CHECK(!tunables->watch(TUNE_POLL_MS, nullptr, &s_filler));
+  for (uint8_t i = 3; i < Tunables::MAX_WATCHERS; i++) CHECK(tunables->watch(TUNE_LCD_INTERVAL_MS, onChange, &s_filler));
+  CHECK(!tunables->watch(TUNE_POLL_MS, onChange, &s_filler));
+  CHECK_EQ(s_filler.calls, Tunables::MAX_WATCHERS - 3);
+
+  // erase() without storage still restores the defaults, telling the watchers
+  CHECK(tunables->erase());
+  CHECK_EQ(s_debounceA.value, INPUT_DEBOUNCE_MS);
+  CHECK_EQ(s_debounceA.calls, 5);
+  CHECK_EQ(s_poll.calls, 1);
+}
+
+// NVS stand-in
+class MapStorage : public TunableStorage {
+public:
+  std::map<std::string, int32_t> values;
+  std::string failKey;
+  bool failErase;
+
+  MapStorage() : failErase(false) {}
+
+  bool load(const char* name, int32_t& value) override {
+    std::map<std::string, int32_t>::const_iterator it = values.find(name);
+    if (it == values.end()) return false;
+    value = it->second;
+    return true;
+  }
+
+  bool store(const char* name, int32_t value) override {
+    if (failKey == name) return false;
+    values[name] = value;
+    return true;
+  }
+
+  bool erase() override {
+    if (failErase) return false;
+    values.clear();
+    return true;
+  }
+};
+
+static void testStorage() {
+  Tunables* tunables = Tunables::getInstance();
+
+  // Saved values apply within the current bounds; the rest keep their value
+  MapStorage storage;
+  storage.values["debounce_ms"] = 120;
+  storage.values["poll_ms"] = 0;                 // Below the minimum
+  storage.values["oled_ms"] = 100000;            // Above the maximum
+  storage.values["lcd_ms"] = 20;                 // The minimum itself
+  storage.values["old_tunable"] = 7;             // From an older build
+  tunables->begin(&storage);
+  CHECK_EQ(tunables->get(TUNE_DEBOUNCE_MS), 120);
+  CHECK_EQ(tunables->get(TUNE_POLL_MS), INPUT_POLL_MS);
+  CHECK_EQ(tunables->get(TUNE_OLED_INTERVAL_MS), VIEW_OLED_INTERVAL_MS);
+  CHECK_EQ(tunables->get(TUNE_LCD_INTERVAL_MS), 20);
+
+  // save() writes every value; a failed write is reported, the others still land
+  CHECK(tunables->set(TUNE_UI_PRIORITY, 5));
+  CHECK(tunables->save());
+  CHECK_EQ(storage.values.size(), TUNE_COUNT + 1);
+  for (uint8_t id = 0; id < TUNE_COUNT; id++) CHECK_EQ(storage.values[Tunables::getDef(id).name], tunables->get(id));
+  storage.failKey = "poll_ms";
+  CHECK(tunables->set(TUNE_I2C_PRIORITY, 3));
+  CHECK(!tunables->save());
+  CHECK_EQ(storage.values["i2c_priority"], 3);
+
+  // erase() clears storage and restores the defaults, even if clearing fails
+  CHECK(tunables->erase());
+  CHECK(storage.values.empty());
+  for (uint8_t id = 0; id < TUNE_COUNT; id++) CHECK_EQ(tunables->get(id), Tunables::getDef(id).def);
+  CHECK(tunables->set(TUNE_UI_PRIORITY, 6));
+  storage.failErase = true;
+  CHECK(!tunables->erase());
+  CHECK_EQ(tunables->get(TUNE_UI_PRIORITY), TASK_UI_PRIORITY);
+  tunables->begin(nullptr);
+}
+
+// ---- Over TaskLink ----
+
+class LoopIo : public TaskLinkIo {
+public:
+  std::deque<uint8_t> in;
+  std::vector<uint8_t> out;
+
+  size_t read(uint8_t* data, size_t max) override {
+    size_t count = 0;
+    while (count < max && !in.empty()) {
+      data[count++] = in.front();
+      in.pop_front();
+    }
+    return count;
+  }
+
+  size_t write(const uint8_t* data, size_t length) override {
+    out.insert(out.end(), data, data + length);
+    return length;
+  }
+
+  size_t writable() override { return 4096; }
+};
+
+class ListStore : public TaskLinkStore {
+public:
+  std::vector<TaskLinkRecord> tasks;
+  std::vector<TaskLinkRecord> pending;
+  bool importing;
+
+  ListStore() : importing(false) {}
+
+  bool beginImport(bool replace) override {
+    pending = replace ? std::vector<TaskLinkRecord>() : tasks;
+    importing = true;
+    return true;
+  }
+  bool importTask(const TaskLinkRecord& record) override {
+    pending.push_back(record);
+    return true;
+  }
+  bool commitImport() override {
+    tasks = pending;
+    importing = false;
+    return true;
+  }
+  void abortImport() override { importing = false; }
+  bool beginExport(uint32_t& version, uint16_t& count) override {
+    version = 1;
+    count = static_cast<uint16_t>(tasks.size());
+    return true;
+  }
+  bool exportTask(uint32_t, uint16_t index, TaskLinkRecord& record) override {
+    if (index >= tasks.size()) return false;
+    record = tasks[index];
+    return true;
+  }
+};
+
+struct Host {
+  LoopIo io;
+  ListStore store;
+  TaskLinkEndpoint endpoint;
+  TaskLinkFramer framer;
+  uint32_t now;
+
+  Host() : endpoint(io, store), now(0) {}
+
+  void send(uint8_t type, uint8_t seq, const std::vector<uint8_t>& payload) {
+    uint8_t frame[TaskLinkFramer::MAX_FRAME];
+    size_t size = TaskLinkFramer::encode(type, seq, payload.data(), payload.size(), frame);
+    io.in.insert(io.in.end(), frame, frame + size);
+  }
+
+  // Sends one request and returns the single frame it is answered with
+  TaskLinkFrame request(uint8_t type, uint8_t seq, const std::vector<uint8_t>& payload) {
+    send(type, seq, payload);
+    while (endpoint.poll(now += 10)) {}
+
+    TaskLinkFrame reply;
+    reply.type = 0;
+    int replies = 0;
+    for (size_t i = 0; i < io.out.size(); i++) {
+      if (framer.push(io.out[i])) {
+        reply = framer.frame();
+        replies++;
+      }
+    }
+    io.out.clear();
+    CHECK_EQ(replies, 1);
+    return reply;
+  }
+};
+
+static std::vector<uint8_t> bytes(uint8_t first) {
+  return std::vector<uint8_t>(1, first);
+}
+
+static std::vector<uint8_t> setPayload(uint8_t id, int32_t value) {
+  std::vector<uint8_t> payload(5);
+  payload[0] = id;
+  taskLinkPut32(&payload[1], static_cast<uint32_t>(value));
+  return payload;
+}
+
+static std::vector<uint8_t> tasksPayload(const char* first, const char* second) {
+  std::vector<uint8_t> payload(1 + 2 * 64);
+  payload[0] = 2;
+  size_t length = 1;
+  const char* titles[2] = { first, second };
+  for (int i = 0; i < 2; i++) {
+    TaskLinkRecord record;
+    strncpy(record.title, titles[i], TaskLinkRecord::TITLE_SIZE - 1);
+    length += taskLinkPackRecord(record, &payload[length], payload.size() - length);
+  }
+  payload.resize(length);
+  return payload;
+}
+
+static void checkValue(const TaskLinkFrame& reply, uint8_t id, int32_t value) {
+  CHECK_EQ(reply.type, TASKLINK_TUNE_VALUE);
+  CHECK_EQ(reply.length, 5);
+  CHECK_EQ(reply.payload[0], id);
+  CHECK_EQ(static_cast<int32_t>(taskLinkGet32(reply.payload + 1)), value);
+}
+
+static void checkError(const TaskLinkFrame& reply, uint8_t status) {
+  CHECK_EQ(reply.type, TASKLINK_ERROR);
+  CHECK_EQ(reply.payload[0], status);
+}
+
+static void testEndpoint() {
+  static Host host;
+  Tunables* tunables = Tunables::getInstance();
+
+  // Without a registry every TUNE_* request is refused
+  checkError(host.request(TASKLINK_TUNE_GET, 0, bytes(TUNE_POLL_MS)), TASKLINK_ERR_STATE);
+  host.endpoint.setTunables(tunables);
+
+  // The list, whole and from an offset, matches the registry
+  CHECK(tunables->set(TUNE_OLED_INTERVAL_MS, 300));
+  for (uint8_t first = 0; first <= TUNE_COUNT; first += 4) {
+    TaskLinkFrame list = host.request(TASKLINK_TUNE_LIST, 1, bytes(first));
+    CHECK_EQ(list.type, TASKLINK_TUNE_LIST);
+    CHECK_EQ(list.payload[0], TUNE_COUNT);
+    uint8_t count = list.payload[1];
+    CHECK_EQ(count, first < TUNE_COUNT ? TUNE_COUNT - first : 0);
+    size_t offset = 2;
+    for (uint8_t i = 0; i < count; i++) {
+      TaskLinkTunable tunable;
+      size_t used = taskLinkUnpackTunable(list.payload + offset, list.length - offset, tunable);
+      CHECK(used > 0);
+      if (used == 0) break;
+      offset += used;
+      const TunableDef& def = Tunables::getDef(first + i);
+      CHECK_EQ(tunable.id, first + i);
+      CHECK(strcmp(tunable.name, def.name) == 0);
+      CHECK_EQ(tunable.type, def.type);
+      CHECK_EQ(tunable.min, def.min);
+      CHECK_EQ(tunable.max, def.max);
+      CHECK_EQ(tunable.def, def.def);
+      CHECK_EQ(tunable.value, tunables->get(first + i));
+    }
+    CHECK_EQ(offset, list.length);
+  }
+
+  // Get and set, with their refusals
+  checkValue(host.request(TASKLINK_TUNE_GET, 2, bytes(TUNE_OLED_INTERVAL_MS)), TUNE_OLED_INTERVAL_MS, 300);
+  checkError(host.request(TASKLINK_TUNE_GET, 3, bytes(TUNE_COUNT)), TASKLINK_ERR_RANGE);
+  checkError(host.request(TASKLINK_TUNE_GET, 4, std::vector<uint8_t>()), TASKLINK_ERR_RANGE);
+  int calls = s_poll.calls;
+  checkValue(host.request(TASKLINK_TUNE_SET, 5, setPayload(TUNE_POLL_MS, 25)), TUNE_POLL_MS, 25);
+  CHECK_EQ(s_poll.calls, calls + 1);
+  CHECK_EQ(s_poll.value, 25);
+  checkError(host.request(TASKLINK_TUNE_SET, 6, setPayload(TUNE_POLL_MS, 101)), TASKLINK_ERR_RANGE);
+  checkError(host.request(TASKLINK_TUNE_SET, 7, setPayload(TUNE_COUNT, 1)), TASKLINK_ERR_RANGE);
+  checkError(host.request(TASKLINK_TUNE_SET, 8, bytes(TUNE_POLL_MS)), TASKLINK_ERR_MALFORMED);
+  CHECK_EQ(tunables->get(TUNE_POLL_MS), 25);
+
+  // Tuning in the middle of an import: answered, and a refusal leaves the
+  // transfer running (TASKS keep their own consecutive sequence numbers)
+  TaskLinkFrame credit = host.request(TASKLINK_IMPORT_BEGIN, 20, bytes(TASKLINK_IMPORT_REPLACE));
+  CHECK_EQ(credit.type, TASKLINK_CREDIT);
+  CHECK_EQ(host.request(TASKLINK_TASKS, 21, tasksPayload("one", "two")).type, TASKLINK_CREDIT);
+  checkError(host.request(TASKLINK_TUNE_SET, 90, setPayload(TUNE_DEBOUNCE_MS, 1)), TASKLINK_ERR_RANGE);
+  checkValue(host.request(TASKLINK_TUNE_SET, 91, setPayload(TUNE_DEBOUNCE_MS, 80)), TUNE_DEBOUNCE_MS, 80);
+  CHECK(!host.endpoint.isIdle());
+  CHECK(host.store.importing);
+  CHECK_EQ(host.request(TASKLINK_TASKS, 22, tasksPayload("three", "four")).type, TASKLINK_CREDIT);
+  std::vector<uint8_t> end(2);
+  taskLinkPut16(&end[0], 4);
+  TaskLinkFrame ack = host.request(TASKLINK_IMPORT_END, 23, end);
+  CHECK_EQ(ack.type, TASKLINK_ACK);
+  CHECK_EQ(ack.payload[0], TASKLINK_OK);
+  CHECK_EQ(taskLinkGet16(ack.payload + 1), 4);
+  CHECK_EQ(host.store.tasks.size(), 4);
+  CHECK_EQ(host.endpoint.getFailedTransfers(), 0);
+
+  // Save and reset: ACK, BUSY without storage
+  TaskLinkFrame saved = host.request(TASKLINK_TUNE_SAVE, 30, bytes(0));
+  CHECK_EQ(saved.type, TASKLINK_ACK);
+  CHECK_EQ(saved.payload[0], TASKLINK_ERR_BUSY);
+  MapStorage storage;
+  tunables->begin(&storage);
+  saved = host.request(TASKLINK_TUNE_SAVE, 31, bytes(0));
+  CHECK_EQ(saved.payload[0], TASKLINK_OK);
+  CHECK_EQ(storage.values["debounce_ms"], 80);
+  saved = host.request(TASKLINK_TUNE_SAVE, 32, bytes(TASKLINK_TUNE_ERASE));
+  CHECK_EQ(saved.payload[0], TASKLINK_OK);
+  CHECK(storage.values.empty());
+  CHECK_EQ(tunables->get(TUNE_DEBOUNCE_MS), INPUT_DEBOUNCE_MS);
+  tunables->begin(nullptr);
+}
+
+int main() {
+  testDefs();
+  testSetAndWatch();
+  testStorage();
+  testEndpoint();
+  return hostTestResult("test_tunables");
+}
@@ -0,0 +1,138 @@
+/*
+ * UiSnapshot encode/decode: round trip and every rejection path.
+ * run_tests.sh builds it for the 16x2 LCD and again for 20x4.
+ *
+ * Build (Linux):
+ *   g++ -std=gnu++11 -Wall -Wextra -I../src test_ui_snapshot.cpp ../src/UiSnapshot.cpp -o test_ui_snapshot
+ *   (add -DLCD_PANEL_COLS=20 -DLCD_PANEL_ROWS=4 for the 20x4 panel)
+ */
+#include <string.h>
+
+#include "HostTest.h"
+#include "Crc16.h"
+#include "UiSnapshot.h"
+
+static const size_t FRAME_SIZE = UI_SNAPSHOT_LCD_COLS * UI_SNAPSHOT_LCD_ROWS;
+
+static UiSnapshot makeSnapshot() {
+  UiSnapshot snapshot;
+  snapshot.state = 4;
+  snapshot.menuIndex = 3;
+  snapshot.unixTime = 0xA1B2C3D4u;
+  for (int row = 0; row < UI_SNAPSHOT_LCD_ROWS; row++) {
+    for (int col = 0; col < UI_SNAPSHOT_LCD_COLS; col++) {
+      snapshot.lcdFrame[row][col] = static_cast<char>('A' + (row * 7 + col) % 26);
+    }
+  }
+  return snapshot;
+}
+
+static bool sameSnapshot(const UiSnapshot& a, const UiSnapshot& b) {
+  return a.state == b.state && a.menuIndex == b.menuIndex && a.unixTime == b.unixTime &&
+         memcmp(a.lcdFrame, b.lcdFrame, sizeof(a.lcdFrame)) == 0;
+}
+
+// Rewrites the CRC so a test reaches the check it is aimed at
+static void resealCrc(uint8_t* buffer) {
+  uint16_t crc = crc16Ccitt(buffer, UI_SNAPSHOT_ENCODED_SIZE - 2);
+  buffer[UI_SNAPSHOT_ENCODED_SIZE - 2] = static_cast<uint8_t>(crc);
+  buffer[UI_SNAPSHOT_ENCODED_SIZE - 1] = static_cast<uint8_t>(crc >> 8);
+}
+
+static void testRoundTrip() {
+  UiSnapshot in = makeSnapshot();
+  uint8_t buffer[UI_SNAPSHOT_ENCODED_SIZE + 8];
+  size_t length = encodeUiSnapshot(in, buffer, sizeof(buffer));
+  CHECK_EQ(length, 12 + FRAME_SIZE);
+  CHECK_EQ(length, UI_SNAPSHOT_ENCODED_SIZE);
+
+  UiSnapshot out;
+  memset(&out, 0, sizeof(out));
+  CHECK(decodeUiSnapshot(buffer, length, out));
+  CHECK(sameSnapshot(in, out));
+
+  // The last row is carried too (row 3 on a 20x4 panel)
+  CHECK_EQ(out.lcdFrame[UI_SNAPSHOT_LCD_ROWS - 1][UI_SNAPSHOT_LCD_COLS - 1],
+           in.lcdFrame[UI_SNAPSHOT_LCD_ROWS - 1][UI_SNAPSHOT_LCD_COLS - 1]);
+
+  // Trailing bytes after the snapshot are ignored
+  CHECK(decodeUiSnapshot(buffer, sizeof(buffer), out));
+
+  // Too small for the encoding: nothing written
+  CHECK_EQ(encodeUiSnapshot(in, buffer, UI_SNAPSHOT_ENCODED_SIZE - 1), 0);
+  CHECK_EQ(encodeUiSnapshot(in, nullptr, sizeof(buffer)), 0);
+}
+
+static void testCrcMismatch() {
+  UiSnapshot in = makeSnapshot();
+  uint8_t buffer[UI_SNAPSHOT_ENCODED_SIZE];
+  encodeUiSnapshot(in, buffer, sizeof(buffer));
+
+  // Any single flipped bit is caught, and the output is left alone
+  for (size_t i = 0; i < sizeof(buffer); i++) {
+    for (int bit = 0; bit < 8; bit++) {
+      buffer[i] ^= static_cast<uint8_t>(1 << bit);
+      UiSnapshot out = in;
+      out.menuIndex = 99;
+      CHECK(!decodeUiSnapshot(buffer, sizeof(buffer), out));
+      CHECK_EQ(out.menuIndex, 99);
+      buffer[i] ^= static_cast<uint8_t>(1 << bit);
+    }
+  }
+  UiSnapshot out;
+  CHECK(decodeUiSnapshot(buffer, sizeof(buffer), out));
+}
+
+static void testWrongVersion() {
+  UiSnapshot in = makeSnapshot();
+  uint8_t buffer[UI_SNAPSHOT_ENCODED_SIZE];
+  encodeUiSnapshot(in, buffer, sizeof(buffer));
+
+  // A valid CRC does not make another format version acceptable
+  buffer[2]++;
+  resealCrc(buffer);
+  UiSnapshot out;
+  CHECK(!decodeUiSnapshot(buffer, sizeof(buffer), out));
+
+  buffer[2]--;
+  buffer[0] = 'X';
+  resealCrc(buffer);
+  CHECK(!decodeUiSnapshot(buffer, sizeof(buffer), out));
+}
+
+static void testTruncated() {
+  UiSnapshot in = makeSnapshot();
+  uint8_t buffer[UI_SNAPSHOT_ENCODED_SIZE];
+  encodeUiSnapshot(in, buffer, sizeof(buffer));
+
+  UiSnapshot out;
+  for (size_t length = 0; length < sizeof(buffer); length++) {
+    CHECK(!decodeUiSnapshot(buffer, length, out));
+  }
+  CHECK(!decodeUiSnapshot(nullptr, sizeof(buffer), out));
+}
+
+static void testOtherGeometry() {
+  UiSnapshot in = makeSnapshot();
+  uint8_t buffer[UI_SNAPSHOT_ENCODED_SIZE];
+  encodeUiSnapshot(in, buffer, sizeof(buffer));
+
+  // A snapshot from a build for the other panel (16x2 <-> 20x4) has another
+  // payload size; it must not be read as this panel's frame
+  size_t otherFrame = FRAME_SIZE == 16 * 2 ? 20 * 4 : 16 * 2;
+  buffer[3] = static_cast<uint8_t>(6 + otherFrame);
+  resealCrc(buffer);
+  UiSnapshot out;
+  CHECK(!decodeUiSnapshot(buffer, sizeof(buffer), out));
+}
+
+int main() {
+  testRoundTrip();
+  testCrcMismatch();
+  testWrongVersion();
+  testTruncated();
+  testOtherGeometry();
+  printf("panel %dx%d, %d bytes encoded\n", UI_SNAPSHOT_LCD_COLS, UI_SNAPSHOT_LCD_ROWS,
+         UI_SNAPSHOT_ENCODED_SIZE);
+  return hostTestResult("test_ui_snapshot");
+}
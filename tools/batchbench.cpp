@@ -0,0 +1,132 @@
+/*
+ * Batch bench: TaskManager edits one at a time versus inside one batch.
+ *
+ * Build (Linux):
+ *   g++ -std=c++11 -O2 -pthread -DTASKMANAGER_MAX_TASKS=10000 -I../test/host -I../src \
+ *       batchbench.cpp ../src/TaskManager.cpp -o batchbench
+ *
+ * Usage:
+ *   batchbench [size...]      (default 10 100 1000 10000)
+ *
+ * For each size n, starting from an empty table:
+ *   add single    n addTask() calls, each publishing a new version
+ *   delete single the same n tasks removed with deleteTask(), oldest first
+ *   add batch     n addTask() calls in one beginBatch()/commitBatch()
+ *   delete batch  the same n tasks removed inside one batch
+ *   edit batch    every task renamed and reprioritized in one batch
+ *   sort          one sortTasks(SORT_BY_PRIORITY) outside a batch, for scale
+ * Single edits copy the live rows and rebuild the filtered list per call, so
+ * they grow with n squared; a batch compacts and rebuilds once at commit.
+ * sortTasks() is an exchange sort, also quadratic, batch or not, and a batch
+ * opened on a reordered table insertion-sorts its id map first, which is why
+ * delete batch (run after the sort) costs more than add batch.
+ * Sizes above TASKMANAGER_MAX_TASKS are skipped. The host shim in test/host
+ * stands in for FreeRTOS, so the figures compare the two paths on the host;
+ * they are not ESP32 timings.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#include "TaskManager.h"
+
+HostSerial Serial;
+
+static double nowMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static uint16_t firstId(TaskManager& manager) {
+  Task task;
+  return manager.getTaskByIndex(0, task) ? task.id : 0;
+}
+
+// Keeps the run honest: every path must leave the table it claims to
+static bool expect(bool ok, const char* what, int n) {
+  if (!ok) fprintf(stderr, "batchbench: %s failed at n=%d\n", what, n);
+  return ok;
+}
+
+static bool bench(TaskManager& manager, int n) {
+  char title[32];
+  bool ok = true;
+
+  double start = nowMs();
+  for (int i = 0; i < n; i++) {
+    snprintf(title, sizeof(title), "task %d", i);
+    ok &= manager.addTask(title, 1 + i % 5, i % 4);
+  }
+  double addSingle = nowMs() - start;
+  ok &= expect(manager.getTaskCount() == n, "add single", n);
+
+  uint16_t first = firstId(manager);
+  start = nowMs();
+  for (int i = 0; i < n; i++) ok &= manager.deleteTask(first + i);
+  double deleteSingle = nowMs() - start;
+  ok &= expect(manager.getTaskCount() == 0, "delete single", n);
+
+  start = nowMs();
+  TaskBatch batch = manager.beginBatch();
+  for (int i = 0; i < n; i++) {
+    snprintf(title, sizeof(title), "task %d", i);
+    ok &= manager.addTask(title, 1 + i % 5, i % 4, batch);
+  }
+  ok &= manager.commitBatch(batch);
+  double addBatch = nowMs() - start;
+  ok &= expect(manager.getTaskCount() == n, "add batch", n);
+
+  first = firstId(manager);
+  start = nowMs();
+  batch = manager.beginBatch();
+  for (int i = 0; i < n; i++) {
+    snprintf(title, sizeof(title), "edited %d", i);
+    ok &= manager.editTask(first + i, title, 5 - i % 5, 255, batch);
+  }
+  ok &= manager.commitBatch(batch);
+  double editBatch = nowMs() - start;
+  TaskSearchResult result;
+  ok &= expect(manager.searchTasks("edited", SEARCH_PREFIX, &result, 1) == 1, "edit batch", n);
+
+  start = nowMs();
+  ok &= manager.sortTasks(SORT_BY_PRIORITY);
+  double sort = nowMs() - start;
+
+  start = nowMs();
+  batch = manager.beginBatch();
+  for (int i = 0; i < n; i++) ok &= manager.deleteTask(first + i, batch);
+  ok &= manager.commitBatch(batch);
+  double deleteBatch = nowMs() - start;
+  ok &= expect(manager.getTaskCount() == 0, "delete batch", n);
+
+  printf("%6d %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f\n",
+         n, addSingle, addBatch, deleteSingle, deleteBatch, editBatch, sort);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  std::vector<int> sizes;
+  for (int i = 1; i < argc; i++) sizes.push_back(atoi(argv[i]));
+  if (sizes.empty()) {
+    sizes.push_back(10);
+    sizes.push_back(100);
+    sizes.push_back(1000);
+    sizes.push_back(10000);
+  }
+
+  // About 7 MB at 10k tasks: too big for the stack
+  static TaskManager manager;
+  printf("%6s %12s %12s %12s %12s %12s %12s   (ms)\n",
+         "n", "add single", "add batch", "del single", "del batch", "edit batch", "sort");
+  bool ok = true;
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (sizes[i] <= 0 || sizes[i] > TaskManager::MAX_TASKS) {
+      printf("%6d skipped (TASKMANAGER_MAX_TASKS is %u)\n", sizes[i], (unsigned)TaskManager::MAX_TASKS);
+      continue;
+    }
+    ok &= bench(manager, sizes[i]);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/*
+ * Filter bench: samples per second through each SignalFilters filter.
+ *
+ * Build (Linux):
+ *   g++ -std=c++11 -O2 -I../src filterbench.cpp -o filterbench
+ *
+ * Usage:
+ *   filterbench [samples]      (default 20000000 per filter)
+ *
+ * Input is a noisy sine from SyntheticSource, generated once up front so the
+ * figures cover only the filter. Each filter runs per sample (process(x)) and
+ * as a block (process(in, out, n), in place over 256 samples, the way the
+ * sensor path would hand it a drained batch). The host's figures show the
+ * relative cost of the filters; divide by the ESP32's clock ratio for an
+ * estimate of the target, not a measurement.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#include "SignalFilters.h"
+#include "SyntheticSource.h"
+
+static const size_t BLOCK = 256;
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Keeps the optimizer from discarding the filter output
+static volatile int32_t s_sink;
+
+template <typename Filter>
+static void bench(const char* name, Filter& filter, const std::vector<int16_t>& input, size_t samples) {
+  size_t rounds = samples / input.size();
+  if (rounds == 0) rounds = 1;
+
+  double start = nowSeconds();
+  int32_t sum = 0;
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < input.size(); i++) {
+      sum += filter.process(input[i]);
+    }
+  }
+  double perSample = nowSeconds() - start;
+
+  std::vector<int16_t> block(BLOCK);
+  start = nowSeconds();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i + BLOCK <= input.size(); i += BLOCK) {
+      for (size_t j = 0; j < BLOCK; j++) block[j] = input[i + j];
+      filter.process(&block[0], &block[0], BLOCK);
+      sum += block[BLOCK - 1];
+    }
+  }
+  double blockTime = nowSeconds() - start;
+  s_sink = sum;
+
+  double total = static_cast<double>(rounds) * input.size();
+  printf("%-24s %8.1f M/s per sample %8.1f M/s block\n",
+         name, total / perSample / 1e6, total / blockTime / 1e6);
+}
+
+// Decimator writes fewer samples than it reads: its own block signature
+static void benchDecimator(const std::vector<int16_t>& input, size_t samples) {
+  Decimator<int16_t> decimator(200);
+  size_t rounds = samples / input.size();
+  if (rounds == 0) rounds = 1;
+
+  double start = nowSeconds();
+  int32_t sum = 0;
+  int16_t out;
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < input.size(); i++) {
+      if (decimator.process(input[i], out)) sum += out;
+    }
+  }
+  double perSample = nowSeconds() - start;
+
+  std::vector<int16_t> block(BLOCK);
+  start = nowSeconds();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i + BLOCK <= input.size(); i += BLOCK) {
+      size_t written = decimator.process(&input[i], &block[0], BLOCK);
+      if (written > 0) sum += block[0];
+    }
+  }
+  double blockTime = nowSeconds() - start;
+  s_sink = sum;
+
+  double total = static_cast<double>(rounds) * input.size();
+  printf("%-24s %8.1f M/s per sample %8.1f M/s block\n",
+         "Decimator /200", total / perSample / 1e6, total / blockTime / 1e6);
+}
+
+int main(int argc, char** argv) {
+  size_t samples = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000000;
+
+  // 64 k samples: large enough to defeat branch history, small enough for the cache
+  SyntheticSource source;
+  uint8_t channel = 0;
+  source.setWaveform(0, SyntheticWaveform(SHAPE_SINE, 7.0f, 1500, 2048, 200));
+  source.begin(&channel, 1, 20000);
+  std::vector<SensorSample> raw(65536);
+  source.read(&raw[0], raw.size());
+  std::vector<int16_t> input(raw.size());
+  for (size_t i = 0; i < raw.size(); i++) {
+    input[i] = static_cast<int16_t>(raw[i].raw);
+  }
+
+  MovingAverage<int16_t, 8> average8;
+  MovingAverage<int16_t, 10> average10;
+  ExponentialFilter<int16_t, 2> exponential;
+  MedianFilter<int16_t, 3> median3;
+  MedianFilter<int16_t, 9> median9;
+  BiquadCascade<int16_t, 1> biquad1;
+  BiquadCascade<int16_t, 2> biquad2;
+  biquad1.setCoefficients(BiquadCoefficients::lowPass(20000.0f, 1000.0f));
+  biquad2.setCoefficients(BiquadCoefficients::lowPass(20000.0f, 1000.0f));
+
+  bench("MovingAverage<8>", average8, input, samples);
+  bench("MovingAverage<10>", average10, input, samples);
+  bench("ExponentialFilter<2>", exponential, input, samples);
+  bench("MedianFilter<3>", median3, input, samples);
+  bench("MedianFilter<9>", median9, input, samples);
+  bench("BiquadCascade<1>", biquad1, input, samples);
+  bench("BiquadCascade<2>", biquad2, input, samples);
+  benchDecimator(input, samples);
+  return 0;
+}
@@ -0,0 +1,294 @@
+/*
+ * Load bench: the LoadGenerator against a host model of the input pipeline.
+ *
+ * Build (Linux):
+ *   g++ -std=c++11 -O2 -pthread -I../src loadbench.cpp ../src/LoadGenerator.cpp \
+ *       ../src/Coroutine.cpp -o loadbench
+ *
+ * Usage:
+ *   loadbench [sustained|burst|walk] [options]
+ * Options:
+ *   --rate N          Events per second (sustained, walk)            [1000]
+ *   --burst N         Events per burst                               [32]
+ *   --period MS       Time between bursts                            [500]
+ *   --duration MS     Length of the run                              [5000]
+ *   --handle-us N     Controller cost per event                      [50]
+ *   --frame-us N      Render cost per frame                          [8000]
+ *   --interval-ms N   Minimum time between frames (view update rate) [250]
+ *   --seed N          Random walk seed                               [1]
+ *
+ * Three threads stand in for the target's tasks, each running a CoExecutor
+ * like ExecutorTask does: the generator posts into a FixedPool-backed FIFO
+ * of the controller's size, the controller drains it and marks the model
+ * changed, and the view renders at most once per interval. Costs are spent
+ * busy-waiting, so the figures show where the queue saturates for a given
+ * handling and render cost rather than the host's own speed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Coroutine.h"
+#include "FixedPool.h"
+#include "LoadGenerator.h"
+
+// Controller::EVENT_POOL_SIZE
+static const size_t EVENT_POOL_SIZE = 16;
+
+static uint32_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint32_t>(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000u);
+}
+
+static uint32_t nowMs() {
+  return nowUs() / 1000u;
+}
+
+static void spin(uint32_t us) {
+  uint32_t start = nowUs();
+  while (nowUs() - start < us) {
+  }
+}
+
+// Pool lock for producers and consumers on different threads
+struct PoolMutexLock {
+  std::mutex m_mutex;
+  void lock() { m_mutex.lock(); }
+  void unlock() { m_mutex.unlock(); }
+};
+
+// CoExecutor on a thread, blocking between passes (host ExecutorTask)
+class HostExecutor {
+public:
+  HostExecutor() : m_woken(false), m_stop(false) {
+    m_executor.setWakeHook(wakeHook, this);
+  }
+
+  void spawn(Coroutine& coroutine) { m_executor.spawn(coroutine); }
+
+  void start() { m_thread = std::thread(&HostExecutor::run, this); }
+
+  void stop() {
+    m_stop = true;
+    wakeHook(this, false);
+    m_thread.join();
+  }
+
+private:
+  CoExecutor m_executor;
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_woken;
+  std::atomic<bool> m_stop;
+
+  static void wakeHook(void* context, bool) {
+    HostExecutor* self = static_cast<HostExecutor*>(context);
+    std::lock_guard<std::mutex> guard(self->m_mutex);
+    self->m_woken = true;
+    self->m_wake.notify_one();
+  }
+
+  void run() {
+    while (!m_stop) {
+      uint32_t wait = m_executor.runOnce(nowMs());
+      if (wait == 0) continue;
+      std::unique_lock<std::mutex> guard(m_mutex);
+      std::chrono::milliseconds timeout(wait == CO_FOREVER ? 100 : wait);
+      m_wake.wait_for(guard, timeout, [this] { return m_woken; });
+      m_woken = false;
+    }
+  }
+};
+
+struct BenchEvent {
+  int event;
+  uint32_t postedUs;
+  BenchEvent* next;
+
+  BenchEvent(int e, uint32_t posted) : event(e), postedUs(posted), next(nullptr) {}
+};
+
+// The view: renders whenever the model changed, at most once per interval
+class BenchView : public Coroutine {
+public:
+  BenchView(uint32_t frameUs, uint32_t intervalMs)
+    : m_frameUs(frameUs), m_intervalMs(intervalMs), m_frames(0) {}
+
+  CoSignal& changed() { return m_changed; }
+  uint32_t getFrames() const { return m_frames; }
+
+protected:
+  void step() override {
+    CO_BEGIN();
+    while (true) {
+      CO_AWAIT(m_changed.poll(this));
+      spin(m_frameUs);
+      m_frames++;
+      CO_DELAY(m_intervalMs);
+    }
+    CO_END();
+  }
+
+private:
+  CoSignal m_changed;
+  uint32_t m_frameUs;
+  uint32_t m_intervalMs;
+  std::atomic<uint32_t> m_frames;
+};
+
+// The controller: pooled FIFO drained on every wake, as Controller::dispatchEvents()
+class BenchController : public Coroutine {
+public:
+  BenchController(LoadGenerator& load, BenchView& view, uint32_t handleUs)
+    : m_load(load), m_view(view), m_handleUs(handleUs), m_head(nullptr), m_tail(nullptr) {}
+
+  static bool post(void* context, int event, uint32_t postedUs) {
+    BenchController* self = static_cast<BenchController*>(context);
+    BenchEvent* item = self->m_pool.create(event, postedUs);
+    if (item == nullptr) return false;
+
+    self->m_queueLock.lock();
+    if (self->m_tail != nullptr) {
+      self->m_tail->next = item;
+    } else {
+      self->m_head = item;
+    }
+    self->m_tail = item;
+    self->m_queueLock.unlock();
+    self->m_wake.set();
+    return true;
+  }
+
+  size_t getHighWater() const { return m_pool.getHighWater(); }
+
+protected:
+  void step() override {
+    CO_BEGIN();
+    while (true) {
+      CO_AWAIT(m_wake.poll(this));
+      while (BenchEvent* item = pop()) {
+        spin(m_handleUs);
+        m_load.recordHandled(item->postedUs);
+        m_pool.destroy(item);
+        m_view.changed().set();
+      }
+    }
+    CO_END();
+  }
+
+private:
+  LoadGenerator& m_load;
+  BenchView& m_view;
+  uint32_t m_handleUs;
+  FixedPool<BenchEvent, EVENT_POOL_SIZE, PoolMutexLock> m_pool;
+  PoolMutexLock m_queueLock;
+  BenchEvent* m_head;
+  BenchEvent* m_tail;
+  CoSignal m_wake;
+
+  BenchEvent* pop() {
+    m_queueLock.lock();
+    BenchEvent* item = m_head;
+    if (item != nullptr) {
+      m_head = item->next;
+      if (m_head == nullptr) m_tail = nullptr;
+    }
+    m_queueLock.unlock();
+    return item;
+  }
+};
+
+static int usage() {
+  fprintf(stderr,
+          "usage: loadbench [sustained|burst|walk] [--rate N] [--burst N] [--period MS]\n"
+          "                 [--duration MS] [--handle-us N] [--frame-us N] [--interval-ms N]\n"
+          "                 [--seed N]\n");
+  return 2;
+}
+
+int main(int argc, char** argv) {
+  LoadProfile profile;
+  profile.rateHz = 1000;
+  profile.durationMs = 5000;
+  uint32_t handleUs = 50;
+  uint32_t frameUs = 8000;
+  uint32_t intervalMs = 250;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (strcmp(argv[i], "sustained") == 0) {
+      profile.pattern = LOAD_SUSTAINED;
+    } else if (strcmp(argv[i], "burst") == 0) {
+      profile.pattern = LOAD_BURST;
+    } else if (strcmp(argv[i], "walk") == 0) {
+      profile.pattern = LOAD_RANDOM_WALK;
+    } else if (value == nullptr) {
+      return usage();
+    } else if (strcmp(argv[i], "--rate") == 0) {
+      profile.rateHz = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--burst") == 0) {
+      profile.burstSize = static_cast<uint16_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(argv[i], "--period") == 0) {
+      profile.burstPeriodMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--duration") == 0) {
+      profile.durationMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--handle-us") == 0) {
+      handleUs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--frame-us") == 0) {
+      frameUs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--interval-ms") == 0) {
+      intervalMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      profile.seed = strtoul(argv[++i], nullptr, 10);
+    } else {
+      return usage();
+    }
+  }
+
+  // Same mix as the target's LOAD_TEST build: down, up, select1, select2, left
+  static const int mix[] = { 1, 0, 4, 5, 2 };
+  LoadGenerator load(nowUs);
+  BenchView view(frameUs, intervalMs);
+  BenchController controller(load, view, handleUs);
+  load.setEventMix(mix, sizeof(mix) / sizeof(mix[0]));
+  if (!load.begin(profile, BenchController::post, &controller)) {
+    fprintf(stderr, "invalid load profile\n");
+    return 2;
+  }
+
+  HostExecutor producer, consumer, renderer;
+  producer.spawn(load);
+  consumer.spawn(controller);
+  renderer.spawn(view);
+  consumer.start();
+  renderer.start();
+  producer.start();
+
+  while (!load.isFinished()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  // Let the controller drain what is still queued
+  std::this_thread::sleep_for(std::chrono::milliseconds(EVENT_POOL_SIZE * handleUs / 1000 + 50));
+  producer.stop();
+  consumer.stop();
+  renderer.stop();
+
+  LoadReport report;
+  load.getReport(report);
+  report.frames = view.getFrames();
+  report.queueHighWater = static_cast<uint32_t>(controller.getHighWater());
+  report.queueCapacity = EVENT_POOL_SIZE;
+
+  char line[256];
+  report.format(line, sizeof(line));
+  puts(line);
+  return report.dropped == 0 ? 0 : 1;
+}
@@ -0,0 +1,636 @@
+/*
+ * TaskLink host tool: import/export tasks and tune a device over a serial port or pty.
+ *
+ * Build (Linux):
+ *   g++ -std=c++11 -O2 -I../src tasklink.cpp ../src/TaskLinkEndpoint.cpp ../src/Tunables.cpp -o tasklink
+ *
+ * Usage:
+ *   tasklink export <port> <file>             Device tasks -> file
+ *   tasklink import <port> <file> [--append]  File -> device (replaces the list by default)
+ *   tasklink tune <port> list                 Tunables with bounds, defaults and values
+ *   tasklink tune <port> get|set NAME [VALUE] Read or change one tunable (live, not saved)
+ *   tasklink tune <port> save|reset           Persist the current values / restore defaults
+ *   tasklink emulate [--capacity N] [--noise] Device end on a new pty (prints its path)
+ *   tasklink generate <file> <count>          Test file with count tasks
+ * Options: --baud <rate> (serial ports only; ignored by ptys)
+ *
+ * Task files hold one task per line, tab separated:
+ *   complete  priority  category  dueTime  title
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TaskLinkEndpoint.h"
+
+static const int REPLY_TIMEOUT_MS = 5000;
+static const uint8_t EXPORT_WINDOW = 4;
+
+static uint32_t nowMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint32_t>(ts.tv_sec * 1000u + ts.tv_nsec / 1000000u);
+}
+
+static speed_t baudConstant(long baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B115200;
+  }
+}
+
+static bool makeRaw(int fd, long baud) {
+  struct termios tio;
+  if (tcgetattr(fd, &tio) != 0) return false;
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, baudConstant(baud));
+  cfsetospeed(&tio, baudConstant(baud));
+  tio.c_cflag |= CLOCAL | CREAD;
+  return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t length) {
+  while (length > 0) {
+    ssize_t n = write(fd, data, length);
+    if (n < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        struct pollfd p = { fd, POLLOUT, 0 };
+        poll(&p, 1, 100);
+        continue;
+      }
+      return false;
+    }
+    data += n;
+    length -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Text file <-> record
+static bool parseLine(char* line, TaskLinkRecord& record) {
+  unsigned complete, priority, category;
+  unsigned long due;
+  int offset = 0;
+  if (sscanf(line, "%u\t%u\t%u\t%lu\t%n", &complete, &priority, &category, &due, &offset) < 4 ||
+      offset == 0) {
+    return false;
+  }
+  char* title = line + offset;
+  title[strcspn(title, "\r\n")] = '\0';
+  record.complete = complete != 0;
+  record.priority = static_cast<uint8_t>(priority);
+  record.category = static_cast<uint8_t>(category);
+  record.dueTime = static_cast<uint32_t>(due);
+  strncpy(record.title, title, TaskLinkRecord::TITLE_SIZE - 1);
+  record.title[TaskLinkRecord::TITLE_SIZE - 1] = '\0';
+  return record.title[0] != '\0';
+}
+
+static void printRecord(FILE* out, const TaskLinkRecord& record) {
+  fprintf(out, "%u\t%u\t%u\t%lu\t%s\n", record.complete ? 1u : 0u, record.priority,
+          record.category, static_cast<unsigned long>(record.dueTime), record.title);
+}
+
+/**
+ * Host end of the protocol over a file descriptor.
+ */
+class HostLink {
+public:
+  explicit HostLink(int fd) : m_fd(fd), m_seq(0) {}
+
+  bool send(uint8_t type, const uint8_t* payload, size_t length) {
+    uint8_t frame[TaskLinkFramer::MAX_FRAME];
+    size_t size = TaskLinkFramer::encode(type, m_seq++, payload, length, frame);
+    return size > 0 && writeAll(m_fd, frame, size);
+  }
+
+  // Waits for the next valid frame; bytes outside frames (device log) are skipped
+  bool receive(TaskLinkFrame& frame, int timeoutMs) {
+    uint32_t deadline = nowMs() + static_cast<uint32_t>(timeoutMs);
+    while (true) {
+      while (m_pos < m_length) {
+        if (m_framer.push(m_buffer[m_pos++])) {
+          // Trace builds interleave their own stream (tools/tracedump.cpp)
+          uint8_t type = m_framer.frame().type;
+          if (type == TASKLINK_TRACE || type == TASKLINK_TRACE_NAMES) continue;
+          frame = m_framer.frame();
+          return true;
+        }
+      }
+      int32_t left = static_cast<int32_t>(deadline - nowMs());
+      if (left <= 0) return false;
+      struct pollfd p = { m_fd, POLLIN, 0 };
+      if (poll(&p, 1, left) <= 0) continue;
+      ssize_t n = read(m_fd, m_buffer, sizeof(m_buffer));
+      if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+      if (n <= 0) return false;
+      m_pos = 0;
+      m_length = static_cast<size_t>(n);
+    }
+  }
+
+  uint32_t getFrameErrors() const { return m_framer.getErrorCount(); }
+
+private:
+  int m_fd;
+  uint8_t m_seq;
+  TaskLinkFramer m_framer;
+  uint8_t m_buffer[1024];
+  size_t m_pos = 0;
+  size_t m_length = 0;
+};
+
+static const char* statusName(uint8_t status) {
+  static const char* names[] = {
+    "ok", "bad state", "busy", "task list full", "changed during export",
+    "lost frame", "timeout", "malformed payload", "out of range"
+  };
+  return status < sizeof(names) / sizeof(names[0]) ? names[status] : "unknown";
+}
+
+static int importFile(int fd, const char* path, bool append) {
+  FILE* in = fopen(path, "r");
+  if (in == nullptr) {
+    perror(path);
+    return 1;
+  }
+
+  HostLink link(fd);
+  TaskLinkFrame frame;
+  uint8_t flags = append ? 0 : TASKLINK_IMPORT_REPLACE;
+  if (!link.send(TASKLINK_IMPORT_BEGIN, &flags, 1) || !link.receive(frame, REPLY_TIMEOUT_MS)) {
+    fprintf(stderr, "no reply to IMPORT_BEGIN\n");
+    return 1;
+  }
+  if (frame.type != TASKLINK_CREDIT) {
+    fprintf(stderr, "import refused: %s\n", statusName(frame.length ? frame.payload[0] : 0));
+    return 1;
+  }
+  unsigned credits = frame.payload[0];
+
+  uint32_t started = nowMs();
+  uint8_t payload[TaskLinkFrame::MAX_PAYLOAD];
+  size_t length = 1;
+  uint8_t count = 0;
+  uint32_t sent = 0;
+  unsigned frames = 0;
+  char line[256];
+  bool more = true;
+  while (more || count > 0) {
+    TaskLinkRecord record;
+    size_t used = 0;
+    if (more) {
+      if (fgets(line, sizeof(line), in) == nullptr) {
+        more = false;
+      } else if (!parseLine(line, record)) {
+        continue;
+      } else {
+        used = taskLinkPackRecord(record, payload + length, sizeof(payload) - length);
+      }
+    }
+
+    // Send when the frame is full (the record did not fit) or the file ended
+    if (used == 0 && count > 0) {
+      while (credits == 0) {
+        if (!link.receive(frame, REPLY_TIMEOUT_MS)) {
+          fprintf(stderr, "device stopped granting credits\n");
+          return 1;
+        }
+        if (frame.type == TASKLINK_CREDIT) {
+          credits += frame.payload[0];
+        } else if (frame.type == TASKLINK_ERROR) {
+          fprintf(stderr, "import failed: %s\n", statusName(frame.payload[0]));
+          return 1;
+        }
+      }
+      payload[0] = count;
+      link.send(TASKLINK_TASKS, payload, length);
+      credits--;
+      frames++;
+      sent += count;
+      length = 1;
+      count = 0;
+      if (more && used == 0) {
+        used = taskLinkPackRecord(record, payload + length, sizeof(payload) - length);
+      }
+    }
+    if (used > 0) {
+      length += used;
+      count++;
+    }
+  }
+  fclose(in);
+
+  uint8_t end[2];
+  taskLinkPut16(end, static_cast<uint16_t>(sent));
+  link.send(TASKLINK_IMPORT_END, end, sizeof(end));
+  while (link.receive(frame, REPLY_TIMEOUT_MS)) {
+    if (frame.type == TASKLINK_CREDIT) continue;
+    if (frame.type == TASKLINK_ACK) {
+      uint32_t ms = nowMs() - started;
+      printf("imported %u tasks in %u frames, %lu ms (%u frame errors)\n",
+             taskLinkGet16(frame.payload + 1), frames, static_cast<unsigned long>(ms),
+             link.getFrameErrors());
+      return 0;
+    }
+    fprintf(stderr, "import failed: %s\n", statusName(frame.payload[0]));
+    return 1;
+  }
+  fprintf(stderr, "no reply to IMPORT_END\n");
+  return 1;
+}
+
+static int exportFile(int fd, const char* path) {
+  FILE* out = fopen(path, "w");
+  if (out == nullptr) {
+    perror(path);
+    return 1;
+  }
+
+  HostLink link(fd);
+  TaskLinkFrame frame;
+  uint8_t window = EXPORT_WINDOW;
+  if (!link.send(TASKLINK_EXPORT_REQUEST, &window, 1) || !link.receive(frame, REPLY_TIMEOUT_MS) ||
+      frame.type != TASKLINK_EXPORT_BEGIN) {
+    fprintf(stderr, "export refused\n");
+    return 1;
+  }
+
+  uint32_t started = nowMs();
+  uint16_t expected = taskLinkGet16(frame.payload);
+  uint8_t seq = static_cast<uint8_t>(frame.seq + 1);
+  uint32_t received = 0;
+  while (link.receive(frame, REPLY_TIMEOUT_MS)) {
+    if (frame.type == TASKLINK_TASKS) {
+      if (frame.seq != seq++) {
+        uint8_t status = TASKLINK_ERR_SEQUENCE;
+        link.send(TASKLINK_ERROR, &status, 1);
+        fprintf(stderr, "export failed: lost frame\n");
+        return 1;
+      }
+      size_t offset = 1;
+      for (uint8_t i = 0; i < frame.payload[0]; i++) {
+        TaskLinkRecord record;
+        size_t used = taskLinkUnpackRecord(frame.payload + offset, frame.length - offset, record);
+        if (used == 0) break;
+        offset += used;
+        printRecord(out, record);
+        received++;
+      }
+      uint8_t credit = 1;
+      link.send(TASKLINK_CREDIT, &credit, 1);
+    } else if (frame.type == TASKLINK_EXPORT_END) {
+      fclose(out);
+      printf("exported %lu of %u tasks, %lu ms (%u frame errors)\n",
+             static_cast<unsigned long>(received), expected,
+             static_cast<unsigned long>(nowMs() - started), link.getFrameErrors());
+      return received == expected ? 0 : 1;
+    } else if (frame.type == TASKLINK_ERROR) {
+      fprintf(stderr, "export failed: %s\n", statusName(frame.payload[0]));
+      return 1;
+    }
+  }
+  fprintf(stderr, "export timed out\n");
+  return 1;
+}
+
+// Waits for the reply to a TUNE_* request; ERROR replies are reported
+static bool receiveTuneReply(HostLink& link, uint8_t type, TaskLinkFrame& frame) {
+  while (link.receive(frame, REPLY_TIMEOUT_MS)) {
+    if (frame.type == type) return true;
+    if (frame.type == TASKLINK_ERROR) {
+      fprintf(stderr, "tune failed: %s\n", statusName(frame.length ? frame.payload[0] : 0));
+      return false;
+    }
+  }
+  fprintf(stderr, "no reply from device\n");
+  return false;
+}
+
+static bool listTunables(HostLink& link, std::vector<TaskLinkTunable>& tunables) {
+  TaskLinkFrame frame;
+  uint8_t total = 1;
+  while (tunables.size() < total) {
+    uint8_t first = static_cast<uint8_t>(tunables.size());
+    if (!link.send(TASKLINK_TUNE_LIST, &first, 1) || !receiveTuneReply(link, TASKLINK_TUNE_LIST, frame)) {
+      return false;
+    }
+    if (frame.length < 2 || frame.payload[1] == 0) break;
+    total = frame.payload[0];
+    size_t offset = 2;
+    for (uint8_t i = 0; i < frame.payload[1]; i++) {
+      TaskLinkTunable tunable;
+      size_t used = taskLinkUnpackTunable(frame.payload + offset, frame.length - offset, tunable);
+      if (used == 0) break;
+      offset += used;
+      tunables.push_back(tunable);
+    }
+  }
+  return true;
+}
+
+static const char* tunableTypeName(uint8_t type) {
+  static const char* names[] = { "int", "bool", "ms", "priority" };
+  return type < sizeof(names) / sizeof(names[0]) ? names[type] : "?";
+}
+
+static int tune(int fd, const std::vector<const char*>& args) {
+  HostLink link(fd);
+  TaskLinkFrame frame;
+  const char* action = args[1];
+
+  if (strcmp(action, "save") == 0 || strcmp(action, "reset") == 0) {
+    uint8_t flags = strcmp(action, "reset") == 0 ? TASKLINK_TUNE_ERASE : 0;
+    if (!link.send(TASKLINK_TUNE_SAVE, &flags, 1) || !receiveTuneReply(link, TASKLINK_ACK, frame)) {
+      return 1;
+    }
+    if (frame.length < 1 || frame.payload[0] != TASKLINK_OK) {
+      fprintf(stderr, "%s failed: %s\n", action, statusName(frame.length ? frame.payload[0] : 0));
+      return 1;
+    }
+    printf(flags ? "saved values erased, defaults restored\n" : "values saved\n");
+    return 0;
+  }
+
+  // Names are resolved on the device's own list, so the tool works across firmware versions
+  std::vector<TaskLinkTunable> tunables;
+  if (!listTunables(link, tunables)) return 1;
+
+  if (strcmp(action, "list") == 0 && args.size() == 2) {
+    for (size_t i = 0; i < tunables.size(); i++) {
+      const TaskLinkTunable& t = tunables[i];
+      printf("%-15s %-8s %8ld  [%ld..%ld, default %ld]\n", t.name, tunableTypeName(t.type),
+             static_cast<long>(t.value), static_cast<long>(t.min), static_cast<long>(t.max),
+             static_cast<long>(t.def));
+    }
+    return 0;
+  }
+
+  bool set = strcmp(action, "set") == 0 && args.size() == 4;
+  if (!set && !(strcmp(action, "get") == 0 && args.size() == 3)) return -1;
+
+  const TaskLinkTunable* found = nullptr;
+  for (size_t i = 0; i < tunables.size(); i++) {
+    if (strcmp(tunables[i].name, args[2]) == 0) found = &tunables[i];
+  }
+  if (found == nullptr) {
+    fprintf(stderr, "unknown tunable: %s\n", args[2]);
+    return 1;
+  }
+
+  uint8_t payload[5];
+  payload[0] = found->id;
+  if (set) {
+    char* end;
+    long value = strtol(args[3], &end, 0);
+    if (*end != '\0') {
+      fprintf(stderr, "not a number: %s\n", args[3]);
+      return 1;
+    }
+    if (value < found->min || value > found->max) {
+      fprintf(stderr, "%s must be within %ld..%ld\n", found->name,
+              static_cast<long>(found->min), static_cast<long>(found->max));
+      return 1;
+    }
+    taskLinkPut32(payload + 1, static_cast<uint32_t>(value));
+  }
+  if (!link.send(set ? TASKLINK_TUNE_SET : TASKLINK_TUNE_GET, payload, set ? 5 : 1) ||
+      !receiveTuneReply(link, TASKLINK_TUNE_VALUE, frame) || frame.length < 5) {
+    return 1;
+  }
+  printf("%s = %ld\n", found->name, static_cast<long>(static_cast<int32_t>(taskLinkGet32(frame.payload + 1))));
+  return 0;
+}
+
+/**
+ * Device emulator: the firmware's TaskLinkEndpoint over a pty.
+ */
+class PtyIo : public TaskLinkIo {
+public:
+  explicit PtyIo(int fd) : m_fd(fd) {}
+  size_t read(uint8_t* data, size_t max) override {
+    ssize_t n = ::read(m_fd, data, max);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+  }
+  size_t write(const uint8_t* data, size_t length) override {
+    return writeAll(m_fd, data, length) ? length : 0;
+  }
+  size_t writable() override { return 4096; }
+private:
+  int m_fd;
+};
+
+class MemoryStore : public TaskLinkStore {
+public:
+  explicit MemoryStore(size_t capacity) : m_capacity(capacity), m_version(1), m_nextId(1) {}
+
+  bool beginImport(bool replace) override {
+    m_staging = replace ? std::vector<TaskLinkRecord>() : m_tasks;
+    return true;
+  }
+  bool importTask(const TaskLinkRecord& record) override {
+    if (m_staging.size() >= m_capacity) return false;
+    m_staging.push_back(record);
+    m_staging.back().id = m_nextId++;
+    return true;
+  }
+  bool commitImport() override {
+    m_tasks.swap(m_staging);
+    m_version++;
+    return true;
+  }
+  void abortImport() override { m_staging.clear(); }
+  bool beginExport(uint32_t& version, uint16_t& count) override {
+    version = m_version;
+    count = static_cast<uint16_t>(m_tasks.size());
+    return true;
+  }
+  bool exportTask(uint32_t version, uint16_t index, TaskLinkRecord& record) override {
+    if (version != m_version || index >= m_tasks.size()) return false;
+    record = m_tasks[index];
+    return true;
+  }
+  size_t size() const { return m_tasks.size(); }
+
+private:
+  size_t m_capacity;
+  uint32_t m_version;
+  uint16_t m_nextId;
+  std::vector<TaskLinkRecord> m_tasks;
+  std::vector<TaskLinkRecord> m_staging;
+};
+
+// Saved tunables for the emulator's lifetime
+class MemoryTunableStorage : public TunableStorage {
+public:
+  bool load(const char* name, int32_t& value) override {
+    for (size_t i = 0; i < m_values.size(); i++) {
+      if (m_values[i].first == name) {
+        value = m_values[i].second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool store(const char* name, int32_t value) override {
+    for (size_t i = 0; i < m_values.size(); i++) {
+      if (m_values[i].first == name) {
+        m_values[i].second = value;
+        return true;
+      }
+    }
+    m_values.push_back(std::make_pair(std::string(name), value));
+    return true;
+  }
+
+  bool erase() override {
+    m_values.clear();
+    return true;
+  }
+
+private:
+  std::vector<std::pair<std::string, int32_t> > m_values;
+};
+
+static int emulate(size_t capacity, bool noise) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    perror("pty");
+    return 1;
+  }
+  const char* name = ptsname(master);
+
+  // Holding the slave open keeps the pty alive between client sessions
+  int slave = open(name, O_RDWR | O_NOCTTY);
+  if (slave < 0 || !makeRaw(slave, 115200)) {
+    perror(name);
+    return 1;
+  }
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  printf("%s\n", name);
+  fflush(stdout);
+
+  PtyIo io(master);
+  MemoryStore store(capacity);
+  TaskLinkEndpoint endpoint(io, store);
+  MemoryTunableStorage tunableStorage;
+  Tunables::getInstance()->begin(&tunableStorage);
+  endpoint.setTunables(Tunables::getInstance());
+  uint32_t lastNoise = nowMs();
+  while (true) {
+    struct pollfd p = { master, POLLIN, 0 };
+    poll(&p, 1, 10);
+    while (endpoint.poll(nowMs())) {
+    }
+
+    // Log text between frames, as the firmware's console would produce
+    if (noise && nowMs() - lastNoise > 20) {
+      char text[64];
+      int n = snprintf(text, sizeof(text), "[emu] %u tasks\r\n", static_cast<unsigned>(store.size()));
+      writeAll(master, reinterpret_cast<uint8_t*>(text), static_cast<size_t>(n));
+      lastNoise = nowMs();
+    }
+  }
+}
+
+static int generate(const char* path, unsigned long count) {
+  static const char* words[] = {
+    "buy", "milk", "call", "mom", "fix", "bike", "write", "report", "pay", "rent",
+    "clean", "garage", "book", "flight", "review", "code", "water", "plants"
+  };
+  static const size_t WORDS = sizeof(words) / sizeof(words[0]);
+  FILE* out = fopen(path, "w");
+  if (out == nullptr) {
+    perror(path);
+    return 1;
+  }
+  unsigned seed = 1;
+  for (unsigned long i = 0; i < count; i++) {
+    TaskLinkRecord record;
+    seed = seed * 1103515245u + 12345u;
+    record.complete = (seed >> 16) % 4 == 0;
+    record.priority = static_cast<uint8_t>(1 + (seed >> 8) % 5);
+    record.category = static_cast<uint8_t>((seed >> 20) % 4);
+    record.dueTime = (seed >> 12) % 3 == 0 ? 1800000000u + static_cast<uint32_t>(i) * 60 : 0;
+    snprintf(record.title, sizeof(record.title), "%s %s %lu",
+             words[(seed >> 16) % WORDS], words[(seed >> 24) % WORDS], i);
+    printRecord(out, record);
+  }
+  fclose(out);
+  return 0;
+}
+
+static int usage() {
+  fprintf(stderr,
+          "usage: tasklink export <port> <file> [--baud N]\n"
+          "       tasklink import <port> <file> [--append] [--baud N]\n"
+          "       tasklink tune <port> list|get NAME|set NAME VALUE|save|reset [--baud N]\n"
+          "       tasklink emulate [--capacity N] [--noise]\n"
+          "       tasklink generate <file> <count>\n");
+  return 2;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) return usage();
+
+  long baud = 115200;
+  bool append = false;
+  bool noise = false;
+  size_t capacity = 30;
+  std::vector<const char*> args;
+  for (int i = 2; i < argc; i++) {
+    if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+      baud = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+      capacity = static_cast<size_t>(atol(argv[++i]));
+    } else if (strcmp(argv[i], "--append") == 0) {
+      append = true;
+    } else if (strcmp(argv[i], "--noise") == 0) {
+      noise = true;
+    } else {
+      args.push_back(argv[i]);
+    }
+  }
+
+  const char* command = argv[1];
+  if (strcmp(command, "emulate") == 0) return emulate(capacity, noise);
+  if (strcmp(command, "generate") == 0 && args.size() == 2) {
+    return generate(args[0], strtoul(args[1], nullptr, 10));
+  }
+  bool tuning = strcmp(command, "tune") == 0;
+  if (tuning ? args.size() < 2 : args.size() != 2) return usage();
+
+  int fd = open(args[0], O_RDWR | O_NOCTTY);
+  if (fd < 0 || !makeRaw(fd, baud)) {
+    perror(args[0]);
+    return 1;
+  }
+  int result;
+  if (tuning) {
+    result = tune(fd, args);
+    if (result < 0) result = usage();
+  } else if (strcmp(command, "import") == 0) {
+    result = importFile(fd, args[1], append);
+  } else if (strcmp(command, "export") == 0) {
+    result = exportFile(fd, args[1]);
+  } else {
+    result = usage();
+  }
+  close(fd);
+  return result;
+}
@@ -0,0 +1,371 @@
+/*
+ * Trace dump: converts a TRACE_ENABLE capture into Chrome trace JSON.
+ *
+ * Build (Linux):
+ *   g++ -std=c++11 -O2 -I../src tracedump.cpp -o tracedump
+ *
+ * Usage:
+ *   stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > capture.bin
+ *   tracedump capture.bin [trace.json]     (- reads stdin; JSON goes to stdout by default)
+ *
+ * Open the JSON in chrome://tracing or ui.perfetto.dev. Console text in the
+ * capture is skipped; only CRC-checked TASKLINK_TRACE and TASKLINK_TRACE_NAMES
+ * frames are read.
+ *
+ * Timestamps: each core's records are placed on the esp_timer timeline by
+ * interpolating their CCOUNT between the SYNC records around them. An
+ * interval whose CCOUNT advanced slower than the slowest CPU clock spent part
+ * of its time in light sleep (CCOUNT stops); its records are placed with the
+ * clock rate of the last regular interval instead, counted from the earlier
+ * SYNC. Records before a core's first SYNC cannot be placed and are dropped.
+ *
+ * BEGIN and END are matched by (id, arg) across both cores, since tasks are
+ * not pinned and a span may end on the other core than it began.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TaskLinkProtocol.h"
+#include "TraceFormat.h"
+
+static const int CORES = 2;
+
+// Slowest CPU clock in cycles per microsecond (XTAL); below it CCOUNT was stopped
+static const double MIN_CLOCK_MHZ = 40.0;
+// Assumed clock until a core has one regular interval
+static const double DEFAULT_CLOCK_MHZ = 240.0;
+
+// Lanes (Chrome "tid") per track kind
+static const int LANE_TASK = 1;
+static const int LANE_RENDER = 100;
+static const int LANE_MUTEX = 200;
+static const int LANE_I2C = 300;
+static const int LANE_INPUT = 400;
+
+struct TimedRecord {
+  double us;
+  int core;
+  uint32_t order;     // Capture order, keeps ties stable
+  TraceRecord record;
+};
+
+struct Sync {
+  uint32_t cycles;
+  uint64_t us;
+};
+
+// Places one core's records between its SYNCs
+class CoreTimeline {
+public:
+  CoreTimeline() : m_hasSync(false), m_mhz(DEFAULT_CLOCK_MHZ), m_unplaced(0) {}
+
+  void add(const TraceRecord& record, uint64_t syncUs, int core, uint32_t order,
+           std::vector<TimedRecord>& out) {
+    if (record.type != TRACE_TYPE_SYNC) {
+      if (!m_hasSync) {
+        m_unplaced++;
+        return;
+      }
+      TimedRecord timed = { 0, core, order, record };
+      m_pending.push_back(timed);
+      return;
+    }
+
+    // Bits 0..23 of the SYNC; the rest from the frame's send time, which is later
+    uint32_t low = (static_cast<uint32_t>(record.id) << 16) | record.arg;
+    Sync sync;
+    sync.cycles = record.cycles;
+    sync.us = syncUs - ((static_cast<uint32_t>(syncUs) - low) & 0xFFFFFFu);
+
+    if (m_hasSync) {
+      uint32_t cycles = sync.cycles - m_last.cycles;
+      double us = static_cast<double>(sync.us - m_last.us);
+      bool regular = us > 0 && cycles >= us * MIN_CLOCK_MHZ;
+      if (regular) m_mhz = cycles / us;
+      place(regular ? cycles / us : m_mhz, us, out);
+    }
+    m_last = sync;
+    m_hasSync = true;
+  }
+
+  // Records after the last SYNC, at the last known clock rate
+  void finish(std::vector<TimedRecord>& out) {
+    place(m_mhz, -1, out);
+  }
+
+  uint32_t getUnplaced() const { return m_unplaced; }
+
+private:
+  bool m_hasSync;
+  Sync m_last;
+  double m_mhz;
+  uint32_t m_unplaced;
+  std::vector<TimedRecord> m_pending;
+
+  // limitUs < 0: no later SYNC to clamp to
+  void place(double mhz, double limitUs, std::vector<TimedRecord>& out) {
+    for (size_t i = 0; i < m_pending.size(); i++) {
+      TimedRecord& timed = m_pending[i];
+      double offset = (timed.record.cycles - m_last.cycles) / mhz;
+      if (limitUs >= 0 && offset > limitUs) offset = limitUs;
+      timed.us = static_cast<double>(m_last.us) + offset;
+      out.push_back(timed);
+    }
+    m_pending.clear();
+  }
+};
+
+// Writes the JSON and matches spans
+class ChromeWriter {
+public:
+  ChromeWriter(FILE* out) : m_out(out), m_first(true), m_unmatched(0), m_spans(0), m_instants(0) {
+    fputs("{\"traceEvents\":[\n", m_out);
+  }
+
+  void setName(uint8_t id, uint16_t arg, const std::string& name) {
+    m_names[key(id, arg)] = name;
+  }
+
+  void add(const TimedRecord& timed, double originUs) {
+    const TraceRecord& record = timed.record;
+    double us = timed.us - originUs;
+
+    if (record.type == TRACE_TYPE_INSTANT) {
+      char name[64];
+      if (record.id == TRACE_ID_BUTTON) {
+        snprintf(name, sizeof(name), "button GPIO%u", record.arg);
+      } else {
+        snprintf(name, sizeof(name), "event %u (source %u)", record.arg & 0xFF, record.arg >> 8);
+      }
+      event("{\"name\":\"%s\",\"cat\":\"input\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,"
+            "\"pid\":1,\"tid\":%d,\"args\":{\"core\":%d}}",
+            name, us, LANE_INPUT, timed.core);
+      lane(LANE_INPUT, "Input");
+      m_instants++;
+      return;
+    }
+
+    uint16_t arg = record.id == TRACE_ID_MUTEX ? record.arg & ~TRACE_MUTEX_TIMED_OUT : record.arg;
+    // I2C spans carry their size, not a track: all transfers share one lane
+    uint32_t match = record.id == TRACE_ID_I2C ? key(record.id, 0) : key(record.id, arg);
+    if (record.type == TRACE_TYPE_BEGIN) {
+      m_open[match].push_back(timed);
+      return;
+    }
+    if (record.type != TRACE_TYPE_END) return;
+
+    std::deque<TimedRecord>& open = m_open[match];
+    if (open.empty()) {
+      m_unmatched++;
+      return;
+    }
+    TimedRecord begin = open.front();
+    open.pop_front();
+    span(begin, timed, originUs);
+  }
+
+  void finish(uint32_t lost, uint32_t unplaced) {
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", m_out);
+    size_t open = 0;
+    for (std::map<uint32_t, std::deque<TimedRecord> >::const_iterator it = m_open.begin();
+         it != m_open.end(); ++it) {
+      open += it->second.size();
+    }
+    fprintf(stderr, "%u spans, %u instants; %u records lost on the device, %u before the first sync, "
+            "%u ends and %u begins unmatched\n",
+            m_spans, m_instants, lost, unplaced, m_unmatched, static_cast<unsigned>(open));
+  }
+
+private:
+  FILE* m_out;
+  bool m_first;
+  uint32_t m_unmatched;
+  uint32_t m_spans;
+  uint32_t m_instants;
+  std::map<uint32_t, std::string> m_names;
+  std::map<uint32_t, std::deque<TimedRecord> > m_open;
+  std::map<int, bool> m_lanes;
+
+  static uint32_t key(uint8_t id, uint16_t arg) {
+    return (static_cast<uint32_t>(id) << 16) | arg;
+  }
+
+  std::string trackName(uint8_t id, uint16_t arg, const char* kind) const {
+    std::map<uint32_t, std::string>::const_iterator it = m_names.find(key(id, arg));
+    if (it != m_names.end()) return it->second;
+    char name[32];
+    snprintf(name, sizeof(name), "%s %u", kind, arg);
+    return name;
+  }
+
+  void span(const TimedRecord& begin, const TimedRecord& end, double originUs) {
+    const TraceRecord& record = begin.record;
+    std::string name;
+    const char* category;
+    int tid;
+    char args[64];
+    snprintf(args, sizeof(args), "\"core\":%d,\"endCore\":%d", begin.core, end.core);
+
+    switch (record.id) {
+      case TRACE_ID_TASK:
+        name = trackName(record.id, record.arg, "task");
+        category = "task";
+        tid = LANE_TASK + record.arg;
+        lane(tid, name);
+        break;
+      case TRACE_ID_RENDER:
+        name = trackName(record.id, record.arg, "view") + " render";
+        category = "render";
+        tid = LANE_RENDER + record.arg;
+        lane(tid, name);
+        break;
+      case TRACE_ID_MUTEX:
+        name = std::string("wait ") + traceMutexName(record.arg);
+        if (end.record.arg & TRACE_MUTEX_TIMED_OUT) name += " (timed out)";
+        category = "mutex";
+        tid = LANE_MUTEX + record.arg;
+        lane(tid, std::string("Mutex ") + traceMutexName(record.arg));
+        break;
+      case TRACE_ID_I2C:
+        name = "I2C";
+        category = "i2c";
+        tid = LANE_I2C;
+        lane(tid, "I2C");
+        snprintf(args, sizeof(args), "\"core\":%d,\"bytes\":%u", begin.core, record.arg);
+        break;
+      default:
+        return;
+    }
+
+    double start = begin.us - originUs;
+    event("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+          "\"pid\":1,\"tid\":%d,\"args\":{%s}}",
+          name.c_str(), category, start, end.us - begin.us, tid, args);
+    m_spans++;
+  }
+
+  // Names a lane the first time it is used
+  void lane(int tid, const std::string& name) {
+    if (m_lanes[tid]) return;
+    m_lanes[tid] = true;
+    event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+          tid, name.c_str());
+    event("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+          tid, tid);
+  }
+
+  void event(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    if (!m_first) fputs(",\n", m_out);
+    m_first = false;
+    va_list args;
+    va_start(args, format);
+    vfprintf(m_out, format, args);
+    va_end(args);
+  }
+};
+
+static int usage() {
+  fprintf(stderr, "usage: tracedump <capture|-> [trace.json]\n");
+  return 2;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) return usage();
+
+  FILE* in = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+  if (in == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+  FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+  if (out == nullptr) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  TaskLinkFramer framer;
+  CoreTimeline timelines[CORES];
+  std::vector<TimedRecord> records;
+  std::vector<std::pair<uint32_t, std::string> > names;
+  uint64_t frameUs = 0;        // syncUs of the frames, unwrapped to 64 bits
+  bool haveFrame = false;
+  uint32_t lost = 0;
+  uint32_t order = 0;
+  uint32_t frames = 0;
+
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (!framer.push(static_cast<uint8_t>(c))) continue;
+    const TaskLinkFrame& frame = framer.frame();
+
+    if (frame.type == TASKLINK_TRACE_NAMES) {
+      for (size_t i = 0; i + 4 <= frame.length; ) {
+        const uint8_t* entry = frame.payload + i;
+        size_t length = entry[3];
+        if (i + 4 + length > frame.length) break;
+        uint32_t key = (static_cast<uint32_t>(entry[0]) << 16) | taskLinkGet16(entry + 1);
+        names.push_back(std::make_pair(key, std::string(reinterpret_cast<const char*>(entry + 4), length)));
+        i += 4 + length;
+      }
+      continue;
+    }
+    if (frame.type != TASKLINK_TRACE || frame.length < TRACE_FRAME_HEADER) continue;
+
+    int core = frame.payload[0];
+    if (core >= CORES) continue;
+    uint32_t syncUs = taskLinkGet32(frame.payload + 4);
+    if (!haveFrame) {
+      frameUs = syncUs;
+      haveFrame = true;
+    } else {
+      // Frames of both cores interleave, so syncUs may step back slightly
+      frameUs += static_cast<int32_t>(syncUs - static_cast<uint32_t>(frameUs));
+    }
+    lost += taskLinkGet16(frame.payload + 2);
+    frames++;
+
+    for (size_t i = TRACE_FRAME_HEADER; i + TRACE_RECORD_SIZE <= frame.length; i += TRACE_RECORD_SIZE) {
+      TraceRecord record;
+      traceUnpackRecord(frame.payload + i, record);
+      timelines[core].add(record, frameUs, core, order++, records);
+    }
+  }
+  if (in != stdin) fclose(in);
+
+  uint32_t unplaced = 0;
+  for (int core = 0; core < CORES; core++) {
+    timelines[core].finish(records);
+    unplaced += timelines[core].getUnplaced();
+  }
+  if (records.empty()) {
+    fprintf(stderr, "no trace records in %u frames (%u frame errors)\n", frames, framer.getErrorCount());
+    return 1;
+  }
+
+  std::stable_sort(records.begin(), records.end(), [](const TimedRecord& a, const TimedRecord& b) {
+    return a.us < b.us || (a.us == b.us && a.order < b.order);
+  });
+
+  ChromeWriter writer(out);
+  for (size_t i = 0; i < names.size(); i++) {
+    writer.setName(static_cast<uint8_t>(names[i].first >> 16), static_cast<uint16_t>(names[i].first),
+                   names[i].second);
+  }
+  double origin = records.front().us;
+  for (size_t i = 0; i < records.size(); i++) {
+    writer.add(records[i], origin);
+  }
+  writer.finish(lost, unplaced);
+  if (out != stdout) fclose(out);
+
+  fprintf(stderr, "%u frames, %u records, %u frame errors\n",
+          frames, static_cast<unsigned>(records.size()), framer.getErrorCount());
+  return 0;
+}